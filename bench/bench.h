@@ -0,0 +1,103 @@
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Minimal benchmark harness for run1c_bench.
+//
+//   RUN1C_BENCHMARK(CopyBuffered) {
+//       while (state.keepRunning()) { ... }
+//       state.setBytesProcessed(bytesPerIteration * state.iterations());
+//   }
+//
+// RUN1C_BENCHMARK_SIZED(HistorySearch) registers HistorySearch/10, /1k, /100k
+// and /1M; state.entryCount() is the size of the data set to generate.
+class BenchmarkState {
+public:
+    explicit BenchmarkState(std::chrono::nanoseconds minTime, size_t entryCount = 0);
+
+    // Drives the measured loop. Iterations run until minTime has elapsed
+    bool keepRunning();
+
+    // Excludes per-iteration setup and cleanup from the measurement
+    void pauseTiming();
+    void resumeTiming();
+
+    void setBytesProcessed(uint64_t bytes) { bytesProcessed = bytes; }
+    void setItemsProcessed(uint64_t items) { itemsProcessed = items; }
+    void setLabel(const std::string& text) { label = text; }
+
+    // Marks the benchmark as not applicable here (e.g. unsupported filesystem)
+    void skip(const std::string& reason);
+
+    uint64_t iterations() const { return iterationCount; }
+    bool isSkipped() const { return skipped; }
+    double elapsedNs() const { return static_cast<double>(elapsed.count()); }
+    uint64_t getBytesProcessed() const { return bytesProcessed; }
+    uint64_t getItemsProcessed() const { return itemsProcessed; }
+    const std::string& getLabel() const { return label; }
+
+    // Data set size of a sized benchmark, 0 otherwise
+    size_t entryCount() const { return entries; }
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    std::chrono::nanoseconds minTime;
+    std::chrono::nanoseconds elapsed{0};
+    std::chrono::nanoseconds paused{0};
+    Clock::time_point start;
+    Clock::time_point pauseStart;
+    uint64_t iterationCount = 0;
+    uint64_t nextCheck = 1;
+    uint64_t bytesProcessed = 0;
+    uint64_t itemsProcessed = 0;
+    size_t entries = 0;
+    bool started = false;
+    bool skipped = false;
+    std::string label;
+};
+
+using BenchmarkFunction = void (*)(BenchmarkState&);
+
+// Entry counts of the synthetic data sets, see bench_data.h
+inline constexpr size_t benchmarkSizes[] = {10, 1000, 100000, 1000000};
+
+struct RegisteredBenchmark {
+    std::string name;
+    BenchmarkFunction function;
+    size_t entryCount = 0;
+};
+
+class BenchmarkRegistry {
+public:
+    static bool add(const char* name, BenchmarkFunction function);
+    // One benchmark per benchmarkSizes entry, named "<name>/<size>"
+    static bool addSized(const char* name, BenchmarkFunction function);
+    static std::vector<RegisteredBenchmark>& all();
+};
+
+#define RUN1C_BENCHMARK(name) \
+    static void name(BenchmarkState& state); \
+    static const bool name##Registered = BenchmarkRegistry::add(#name, name); \
+    static void name(BenchmarkState& state)
+
+#define RUN1C_BENCHMARK_SIZED(name) \
+    static void name(BenchmarkState& state); \
+    static const bool name##Registered = BenchmarkRegistry::addSized(#name, name); \
+    static void name(BenchmarkState& state)
+
+// Keeps the optimizer from discarding a computed value
+template <typename T>
+inline void doNotOptimize(const T& value) {
+#if defined(__GNUC__) || defined(__clang__)
+    asm volatile("" : : "g"(&value) : "memory");
+#else
+    static volatile const void* sink;
+    sink = &value;
+#endif
+}
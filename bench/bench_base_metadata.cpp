@@ -0,0 +1,41 @@
+#include "bench.h"
+#include "bench_data.h"
+#include "base_metadata.h"
+#include "frame_arena.h"
+#include <string>
+#include <vector>
+
+// The metadata cache that validates history bases in the background: filling
+// it for every base (a stat per base, none of the generated ones exist) and
+// the per-row summary lookup the history list makes each frame.
+
+RUN1C_BENCHMARK_SIZED(MetadataCacheFill) {
+    std::vector<std::string> inputs = generateInputs(state.entryCount());
+    while (state.keepRunning()) {
+        BaseMetadataCache cache;
+        for (const auto& input : inputs) {
+            cache.request(input);
+        }
+        cache.waitIdle();
+    }
+    state.setItemsProcessed(state.iterations() * inputs.size());
+}
+
+RUN1C_BENCHMARK_SIZED(MetadataCacheLookup) {
+    std::vector<std::string> inputs = generateInputs(state.entryCount());
+    BaseMetadataCache cache;
+    for (const auto& input : inputs) {
+        cache.request(input);
+    }
+    cache.waitIdle();
+
+    FrameArena arena;
+    uint64_t lookup = 0;
+    while (state.keepRunning()) {
+        doNotOptimize(cache.lookupSummary(inputs[(lookup * 7919) % inputs.size()], arena));
+        if (++lookup % 1024 == 0) {
+            arena.reset();
+        }
+    }
+    state.setItemsProcessed(state.iterations());
+}
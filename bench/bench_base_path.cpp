@@ -0,0 +1,29 @@
+#include "bench.h"
+#include "bench_data.h"
+#include "base_path.h"
+#include "history.h"
+#include <string>
+#include <vector>
+
+// Path extraction over the synthetic inputs: extractBasePath alone, and the
+// history key, which extracts and canonicalizes file paths before hashing.
+
+RUN1C_BENCHMARK_SIZED(ExtractBasePath) {
+    std::vector<std::string> inputs = generateInputs(state.entryCount());
+    while (state.keepRunning()) {
+        for (const auto& input : inputs) {
+            doNotOptimize(extractBasePath(input));
+        }
+    }
+    state.setItemsProcessed(state.iterations() * inputs.size());
+}
+
+RUN1C_BENCHMARK_SIZED(HistoryKeyHash) {
+    std::vector<std::string> inputs = generateInputs(state.entryCount());
+    while (state.keepRunning()) {
+        for (const auto& input : inputs) {
+            doNotOptimize(historyKeyHash(input));
+        }
+    }
+    state.setItemsProcessed(state.iterations() * inputs.size());
+}
@@ -0,0 +1,46 @@
+#include "bench.h"
+#include "batch_resolver.h"
+#include "error_handler.h"
+#include <sstream>
+
+// --resolve throughput on inputs that fail extraction, which isolates the
+// reader / worker / writer pipeline from filesystem latency.
+
+namespace {
+
+std::string makeInputs(size_t count) {
+    std::string inputs;
+    for (size_t i = 0; i < count; ++i) {
+        inputs += "Srvr=\"server" + std::to_string(i % 16) + "\";Ref=\"base" + std::to_string(i) + "\";\n";
+    }
+    return inputs;
+}
+
+void runResolver(BenchmarkState& state, bool ordered) {
+    const size_t inputCount = 10000;
+    std::string inputs = makeInputs(inputCount);
+    ErrorHandler::setLogLevel(LogLevel::None);
+
+    RUN1C launcher("");
+    BatchResolver::Options options;
+    options.ordered = ordered;
+
+    while (state.keepRunning()) {
+        std::istringstream in(inputs);
+        std::ostringstream out;
+        doNotOptimize(BatchResolver(launcher, options).run(in, out));
+    }
+    state.setItemsProcessed(inputCount * state.iterations());
+    state.setBytesProcessed(inputs.size() * state.iterations());
+    ErrorHandler::setLogLevel(LogLevel::Info);
+}
+
+} // namespace
+
+RUN1C_BENCHMARK(ResolveUnordered) {
+    runResolver(state, false);
+}
+
+RUN1C_BENCHMARK(ResolveOrdered) {
+    runResolver(state, true);
+}
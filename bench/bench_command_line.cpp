@@ -0,0 +1,75 @@
+#include "bench.h"
+#include "command_line.h"
+#include "config.h"
+#include "history.h"
+#include "launcher.h"
+#include "persistent_storage.h"
+#include <filesystem>
+#include <iostream>
+#include <sstream>
+
+// Headless launch lifetime minus the child spawn: argument parsing and
+// validation (dry run) plus the history promotion that follows a launch.
+
+namespace {
+
+std::filesystem::path benchDirectory() {
+    std::filesystem::path directory = std::filesystem::temp_directory_path() / "run1c_bench_cli";
+    std::filesystem::create_directories(directory / "Base");
+    return directory;
+}
+
+// Silences progress output for the duration of a benchmark
+class QuietOutput {
+public:
+    QuietOutput() : original(std::cout.rdbuf(sink.rdbuf())) {}
+    ~QuietOutput() { std::cout.rdbuf(original); }
+private:
+    std::ostringstream sink;
+    std::streambuf* original;
+};
+
+} // namespace
+
+RUN1C_BENCHMARK(HeadlessLaunchDryRun) {
+    std::string basePath = (benchDirectory() / "Base").string();
+    QuietOutput quiet;
+
+    if (!RUN1C("").prepare(basePath)) {
+        state.skip("base path format not supported on this platform");
+        return;
+    }
+
+    while (state.keepRunning()) {
+        CommandLineOptions options = parseCommandLine({"--launch", "File=\"" + basePath + "\";", "--dry-run"});
+        doNotOptimize(runLaunchCommand(options));
+    }
+    state.setItemsProcessed(state.iterations());
+}
+
+RUN1C_BENCHMARK(HeadlessHistoryPromoteSave) {
+    std::string storagePath = (benchDirectory() / "storage.ini").string();
+    PersistentStorage::setVerbose(false);
+    {
+        PersistentStorage storage(storagePath);
+        std::vector<std::string> history;
+        for (int i = 0; i < 100; ++i) {
+            history.push_back("File=\"C:\\Bases\\Base" + std::to_string(i) + "\";");
+        }
+        storage.put(historyStorageKey, history);
+        storage.save();
+    }
+
+    while (state.keepRunning()) {
+        PersistentStorage storage(storagePath);
+        storage.load();
+        History history;
+        history.load(storage);
+        history.recordLaunch("File=\"C:\\Bases\\Base0\";", false);
+        history.save(storage);
+        storage.save();
+    }
+    state.setItemsProcessed(state.iterations());
+    state.setLabel("100-entry history");
+    PersistentStorage::setVerbose(true);
+}
@@ -0,0 +1,49 @@
+#include "bench.h"
+#include "config.h"
+#include <filesystem>
+#include <fstream>
+
+// Reading a setting: one atomic load of the published snapshot, the
+// compatibility getter that copies the string out, and the previous getter
+// that re-validated the custom path and re-read the environment per call.
+// ConfigLoadFile is the cost of one hot reload, paid on the watcher thread;
+// the file does not change, so it publishes nothing.
+
+RUN1C_BENCHMARK(ConfigSnapshotRead) {
+    while (state.keepRunning()) {
+        doNotOptimize(Config::current().starterPath.size());
+    }
+    state.setItemsProcessed(state.iterations());
+}
+
+RUN1C_BENCHMARK(ConfigGetterCopy) {
+    while (state.keepRunning()) {
+        doNotOptimize(Config::get1CStarterPath());
+    }
+    state.setItemsProcessed(state.iterations());
+}
+
+RUN1C_BENCHMARK(ConfigRevalidatingBaseline) {
+    std::string custom = Config::get1CStarterPath();
+    while (state.keepRunning()) {
+        // As get1CStarterPath() did before snapshots: check the custom path, fall back to the default
+        std::string path = Config::is1CStarterValid(custom) ? custom : Config::getDefault1CStarterPath();
+        doNotOptimize(path);
+    }
+    state.setItemsProcessed(state.iterations());
+}
+
+RUN1C_BENCHMARK(ConfigLoadFile) {
+    std::string path = (std::filesystem::temp_directory_path() / "run1c_bench_config.ini").string();
+    {
+        std::ofstream file(path, std::ios::trunc);
+        file << "# Benchmark settings\nbaseFontSize = 20\nsnapshotRetention = 5\nsingleInstanceEnabled = false\n";
+    }
+    while (state.keepRunning()) {
+        doNotOptimize(Config::loadFile(path));
+    }
+    std::filesystem::remove(path);
+    Config::loadFile(path);
+    state.setItemsProcessed(state.iterations());
+    state.setLabel("unchanged file, nothing published");
+}
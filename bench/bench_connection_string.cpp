@@ -0,0 +1,64 @@
+#include "bench.h"
+#include "connection_string.h"
+#include <regex>
+#include <string>
+#include <vector>
+
+// Connection strings per second: the allocation-free tokenizer against the
+// drive-path regex that was used before, on a mix of base kinds.
+
+namespace {
+
+const std::vector<std::string>& corpus() {
+    static const std::vector<std::string> inputs = [] {
+        std::vector<std::string> result;
+        for (int i = 0; i < 256; ++i) {
+            std::string n = std::to_string(i);
+            switch (i % 4) {
+            case 0: result.push_back("File=\"C:\\Bases\\Торговля " + n + "\";"); break;
+            case 1: result.push_back("Connect=File=\"\\\\server\\share\\Bases\\Base" + n + "\";Usr=\"Иванов\";"); break;
+            case 2: result.push_back("Srvr=\"app" + n + ":1541\";Ref=\"trade_" + n + "\";"); break;
+            default: result.push_back("ws=\"https://host/base" + n + "\";"); break;
+            }
+        }
+        return result;
+    }();
+    return inputs;
+}
+
+size_t corpusBytes() {
+    size_t bytes = 0;
+    for (const auto& input : corpus()) {
+        bytes += input.size();
+    }
+    return bytes;
+}
+
+} // namespace
+
+RUN1C_BENCHMARK(ConnectionStringTokenize) {
+    const auto& inputs = corpus();
+    while (state.keepRunning()) {
+        for (const auto& input : inputs) {
+            ConnectionString connection;
+            doNotOptimize(parseConnectionString(input, connection));
+            doNotOptimize(connection.kind);
+        }
+    }
+    state.setItemsProcessed(state.iterations() * inputs.size());
+    state.setBytesProcessed(state.iterations() * corpusBytes());
+}
+
+RUN1C_BENCHMARK(ConnectionStringRegexBaseline) {
+    static const std::regex filepathRegex("([a-zA-Z]:\\\\[^\"]+?)(?=\"|$)", std::regex_constants::ECMAScript);
+    const auto& inputs = corpus();
+    while (state.keepRunning()) {
+        for (const auto& input : inputs) {
+            std::smatch match;
+            doNotOptimize(std::regex_search(input, match, filepathRegex));
+        }
+    }
+    state.setItemsProcessed(state.iterations() * inputs.size());
+    state.setBytesProcessed(state.iterations() * corpusBytes());
+    state.setLabel("drive paths only");
+}
@@ -0,0 +1,101 @@
+#include "bench_data.h"
+#include "persistent_storage.h"
+#include <filesystem>
+#include <iterator>
+#include <map>
+#include <string_view>
+
+namespace {
+
+const char* const departments[] = {"Trade", "Accounting", "Payroll", "Warehouse", "Retail", "Manufacturing"};
+
+std::string departmentOf(size_t i) {
+    return departments[(i / 7) % std::size(departments)];
+}
+
+} // namespace
+
+std::vector<std::string> generateInputs(size_t count) {
+    std::vector<std::string> inputs;
+    inputs.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        std::string n = std::to_string(i);
+        std::string department = departmentOf(i);
+        switch (i % 10) {
+            case 0: case 1: case 2: case 3: case 4:
+                inputs.push_back("File=\"C:\\Bases\\" + department + "\\" + department + " " + n + "\";");
+                break;
+            case 5:
+                inputs.push_back("\"D:\\1C Bases\\" + department + " " + n + "\\1Cv8.1CD\"");
+                break;
+            case 6:
+                inputs.push_back("\\\\fileserver\\bases\\" + department + "_" + n);
+                break;
+            case 7: case 8:
+                inputs.push_back("Srvr=\"app" + std::to_string(i % 16) + ".corp.local\";Ref=\"" + department + "_" + n + "\";");
+                break;
+            default:
+                inputs.push_back("ws=\"https://1c.corp.local/" + department + "_" + n + "\";");
+                break;
+        }
+    }
+    return inputs;
+}
+
+void generateStorage(PersistentStorage& storage, size_t count) {
+    std::vector<std::string> inputs = generateInputs(count);
+
+    std::vector<std::string> stats;
+    std::vector<std::string> names;
+    stats.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        HistoryEntry entry;
+        entry.input = inputs[i];
+        if (i % 4 == 0) {
+            // Launched over the last days, later indices more recently and more often
+            entry.launchCount = static_cast<uint32_t>(1 + i % 23);
+            entry.configCount = entry.launchCount / 5;
+            entry.enterpriseCount = entry.launchCount - entry.configCount;
+            entry.lastLaunch = benchDataNow - static_cast<int64_t>(count - i) * 60;
+            entry.score = entry.launchCount;
+        } else {
+            names.push_back(inputs[i] + "\t" + departmentOf(i) + " / Base " + std::to_string(i));
+        }
+        stats.push_back(History::formatEntry(entry));
+    }
+
+    std::vector<std::string_view> views(inputs.begin(), inputs.end());
+    storage.putArray(historyStorageKey, views);
+    views.assign(stats.begin(), stats.end());
+    storage.putArray(historyStatsStorageKey, views);
+    views.assign(names.begin(), names.end());
+    storage.putArray(historyNamesStorageKey, views);
+}
+
+History generateHistory(size_t count) {
+    // Kept in memory, but the constructor creates the file
+    std::string path = (std::filesystem::temp_directory_path() / "run1c_bench_generated.ini").string();
+    PersistentStorage::setVerbose(false);
+    PersistentStorage storage(path);
+    std::filesystem::remove(path);
+    generateStorage(storage, count);
+    History history;
+    history.load(storage, benchDataNow);
+    return history;
+}
+
+const std::string& generateStorageFile(size_t count) {
+    static std::map<size_t, std::string> files;
+    auto found = files.find(count);
+    if (found != files.end()) {
+        return found->second;
+    }
+
+    std::string path = (std::filesystem::temp_directory_path() / ("run1c_bench_history_" + std::to_string(count) + ".ini")).string();
+    std::filesystem::remove(path);
+    PersistentStorage::setVerbose(false);
+    PersistentStorage storage(path);
+    generateStorage(storage, count);
+    storage.save();
+    return files.emplace(count, path).first->second;
+}
@@ -0,0 +1,28 @@
+#pragma once
+
+#include "history.h"
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+class PersistentStorage;
+
+// Synthetic data for the sized benchmarks, the same on every run. Inputs mix
+// the shapes users type: File="..." and bare or quoted paths to file bases,
+// Srvr/Ref server bases and ws= web bases.
+
+// Launch time of the newest generated entry
+inline constexpr int64_t benchDataNow = 1760000000;
+
+// count distinct bases, input i always the same string
+std::vector<std::string> generateInputs(size_t count);
+
+// History of count bases as History::save would store it: every fourth base
+// launched, with decaying scores, the rest imported with a display name
+void generateStorage(PersistentStorage& storage, size_t count);
+History generateHistory(size_t count);
+
+// A storage file holding generateStorage(count) in the temp directory,
+// written on first use and reused for the rest of the run
+const std::string& generateStorageFile(size_t count);
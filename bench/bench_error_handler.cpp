@@ -0,0 +1,94 @@
+#include "bench.h"
+#include "bench_data.h"
+#include "base_path.h"
+#include "error_handler.h"
+#include <filesystem>
+#include <iostream>
+#include <streambuf>
+#include <string>
+#include <vector>
+
+// Logging below and at the log level: a filtered message costs the level
+// check and building its text, a written one a console line plus an append
+// to run1c_error.log. Path validation stats every extracted base path.
+
+namespace {
+
+// Discards everything written to it
+class NullBuffer : public std::streambuf {
+protected:
+    int overflow(int c) override { return c; }
+    std::streamsize xsputn(const char*, std::streamsize count) override { return count; }
+};
+
+// Runs with the given log level, the console silenced and the working
+// directory in a scratch folder, so run1c_error.log lands there
+class LogSandbox {
+public:
+    explicit LogSandbox(LogLevel level) : previousLevel(ErrorHandler::getLogLevel()) {
+        ErrorHandler::setLogLevel(level);
+        previousCout = std::cout.rdbuf(&null);
+        previousCerr = std::cerr.rdbuf(&null);
+        previousDirectory = std::filesystem::current_path();
+        directory = std::filesystem::temp_directory_path() / "run1c_bench_log";
+        std::filesystem::create_directories(directory);
+        std::filesystem::current_path(directory);
+    }
+
+    ~LogSandbox() {
+        std::filesystem::current_path(previousDirectory);
+        std::error_code error;
+        std::filesystem::remove_all(directory, error);
+        std::cout.rdbuf(previousCout);
+        std::cerr.rdbuf(previousCerr);
+        ErrorHandler::setLogLevel(previousLevel);
+    }
+
+private:
+    NullBuffer null;
+    LogLevel previousLevel;
+    std::streambuf* previousCout;
+    std::streambuf* previousCerr;
+    std::filesystem::path previousDirectory;
+    std::filesystem::path directory;
+};
+
+} // namespace
+
+RUN1C_BENCHMARK(LogInfoFiltered) {
+    LogSandbox sandbox(LogLevel::Warning);
+    std::vector<std::string> inputs = generateInputs(1000);
+    uint64_t message = 0;
+    while (state.keepRunning()) {
+        ErrorHandler::logInfo("Path validation failed: path does not exist: " + inputs[message++ % inputs.size()]);
+    }
+    state.setItemsProcessed(state.iterations());
+}
+
+RUN1C_BENCHMARK(LogWarningWritten) {
+    LogSandbox sandbox(LogLevel::Info);
+    std::vector<std::string> inputs = generateInputs(1000);
+    uint64_t message = 0;
+    while (state.keepRunning()) {
+        ErrorHandler::logWarning("Path validation failed: path does not exist: " + inputs[message++ % inputs.size()]);
+    }
+    state.setItemsProcessed(state.iterations());
+}
+
+RUN1C_BENCHMARK_SIZED(ValidatePath) {
+    std::vector<std::string> paths;
+    for (const auto& input : generateInputs(state.entryCount())) {
+        if (auto path = extractBasePath(input)) {
+            paths.push_back(*path);
+        }
+    }
+
+    // Missing paths log at Info level, which would measure the log instead
+    LogSandbox sandbox(LogLevel::Warning);
+    while (state.keepRunning()) {
+        for (const auto& path : paths) {
+            doNotOptimize(ErrorHandler::validatePath(path));
+        }
+    }
+    state.setItemsProcessed(state.iterations() * paths.size());
+}
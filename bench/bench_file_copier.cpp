@@ -0,0 +1,106 @@
+#include "bench.h"
+#include "file_copier.h"
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+
+namespace {
+
+// Source file shared by all copy benchmarks, size overridable via RUN1C_BENCH_COPY_MB
+class CopyFixture {
+public:
+    CopyFixture() {
+        directory = std::filesystem::temp_directory_path() / "run1c_bench_copy";
+        std::filesystem::create_directories(directory);
+        source = directory / "1Cv8.1CD";
+        target = directory / "copy.1CD";
+
+        const char* sizeOverride = std::getenv("RUN1C_BENCH_COPY_MB");
+        uint64_t megabytes = sizeOverride ? std::strtoull(sizeOverride, nullptr, 10) : 256;
+        size = megabytes * 1024 * 1024;
+
+        std::vector<char> chunk(1024 * 1024);
+        for (size_t i = 0; i < chunk.size(); ++i) {
+            chunk[i] = static_cast<char>(i * 31 % 251);
+        }
+        std::ofstream file(source, std::ios::binary | std::ios::trunc);
+        for (uint64_t written = 0; written < size; written += chunk.size()) {
+            file.write(chunk.data(), static_cast<std::streamsize>(chunk.size()));
+        }
+    }
+
+    ~CopyFixture() {
+        std::error_code ec;
+        std::filesystem::remove_all(directory, ec);
+    }
+
+    std::filesystem::path directory;
+    std::filesystem::path source;
+    std::filesystem::path target;
+    uint64_t size = 0;
+};
+
+CopyFixture& fixture() {
+    static CopyFixture instance;
+    return instance;
+}
+
+void benchmarkMethod(BenchmarkState& state, FileCopier::Method method) {
+    CopyFixture& files = fixture();
+    while (state.keepRunning()) {
+        if (!FileCopier::copyFileWith(method, files.source.string(), files.target.string())) {
+            state.skip(std::string(FileCopier::methodName(method)) + " not supported here");
+            break;
+        }
+        state.pauseTiming();
+        std::filesystem::remove(files.target);
+        state.resumeTiming();
+    }
+    state.setBytesProcessed(files.size * state.iterations());
+}
+
+} // namespace
+
+RUN1C_BENCHMARK(CopyStdFilesystem) {
+    CopyFixture& files = fixture();
+    while (state.keepRunning()) {
+        std::filesystem::copy(files.source, files.target, std::filesystem::copy_options::overwrite_existing);
+        state.pauseTiming();
+        std::filesystem::remove(files.target);
+        state.resumeTiming();
+    }
+    state.setBytesProcessed(files.size * state.iterations());
+}
+
+RUN1C_BENCHMARK(CopyFileAuto) {
+    CopyFixture& files = fixture();
+    FileCopier::Method used = FileCopier::Method::Buffered;
+    while (state.keepRunning()) {
+        used = FileCopier::copyFile(files.source.string(), files.target.string());
+        state.pauseTiming();
+        std::filesystem::remove(files.target);
+        state.resumeTiming();
+    }
+    state.setBytesProcessed(files.size * state.iterations());
+    state.setLabel(std::string("picked ") + FileCopier::methodName(used));
+}
+
+RUN1C_BENCHMARK(CopyReflink) {
+    benchmarkMethod(state, FileCopier::Method::Reflink);
+}
+
+RUN1C_BENCHMARK(CopyFileRange) {
+    benchmarkMethod(state, FileCopier::Method::CopyFileRange);
+}
+
+RUN1C_BENCHMARK(CopySendFile) {
+    benchmarkMethod(state, FileCopier::Method::SendFile);
+}
+
+RUN1C_BENCHMARK(CopySystem) {
+    benchmarkMethod(state, FileCopier::Method::SystemCopy);
+}
+
+RUN1C_BENCHMARK(CopyBuffered) {
+    benchmarkMethod(state, FileCopier::Method::Buffered);
+}
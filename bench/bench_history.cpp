@@ -0,0 +1,125 @@
+#include "bench.h"
+#include "bench_data.h"
+#include "history.h"
+#include <algorithm>
+
+// Re-ranking after a launch: the O(log n) re-insertion in History::recordLaunch
+// against re-sorting the whole list by frecency, on a 1000-entry history.
+// Lookup by base: the hash index in History::find against a linear scan
+// comparing inputs exactly, which also misses differently written inputs.
+// HistoryPromote and HistorySearch repeat both on the synthetic data sets.
+
+namespace {
+
+const int historySize = 1000;
+const int64_t startTime = 1760000000;
+
+History makeHistory() {
+    History history;
+    for (int i = 0; i < historySize; ++i) {
+        history.recordLaunch("File=\"C:\\Bases\\Base" + std::to_string(i) + "\";", i % 4 == 0, startTime + i * 600);
+    }
+    return history;
+}
+
+} // namespace
+
+RUN1C_BENCHMARK(HistoryRecordLaunch) {
+    History history = makeHistory();
+    int64_t now = startTime + historySize * 600;
+    uint64_t launch = 0;
+
+    while (state.keepRunning()) {
+        // Cycle through entries so each launch moves a different one to the top
+        const HistoryEntry& entry = history.recordLaunch("File=\"C:\\Bases\\Base" + std::to_string(launch % historySize) + "\";", false, now);
+        doNotOptimize(&entry);
+        now += 60;
+        ++launch;
+    }
+    state.setItemsProcessed(state.iterations());
+    state.setLabel(std::to_string(historySize) + " entries");
+}
+
+RUN1C_BENCHMARK(HistoryFullResort) {
+    History history = makeHistory();
+    std::vector<HistoryEntry> entries;
+    for (const HistoryEntry* entry : history.ordered()) {
+        entries.push_back(*entry);
+    }
+    int64_t now = startTime + historySize * 600;
+    uint64_t launch = 0;
+
+    while (state.keepRunning()) {
+        // Baseline: update the entry in place, then sort everything again
+        HistoryEntry& entry = entries[launch % historySize];
+        entry.score = entry.frecency(now) + 1.0;
+        entry.lastLaunch = now;
+        std::sort(entries.begin(), entries.end(), [now](const HistoryEntry& a, const HistoryEntry& b) {
+            return a.frecency(now) < b.frecency(now);
+        });
+        doNotOptimize(entries.data());
+        now += 60;
+        ++launch;
+    }
+    state.setItemsProcessed(state.iterations());
+    state.setLabel(std::to_string(historySize) + " entries");
+}
+
+RUN1C_BENCHMARK(HistoryFindByKey) {
+    History history = makeHistory();
+    uint64_t lookup = 0;
+
+    while (state.keepRunning()) {
+        // Differently written than stored, found through the canonical key
+        doNotOptimize(history.find("c:\\bases\\base" + std::to_string(lookup % historySize) + "\\"));
+        ++lookup;
+    }
+    state.setItemsProcessed(state.iterations());
+    state.setLabel(std::to_string(historySize) + " entries");
+}
+
+RUN1C_BENCHMARK(HistoryFindLinearBaseline) {
+    History history = makeHistory();
+    std::vector<HistoryEntry> entries;
+    for (const HistoryEntry* entry : history.ordered()) {
+        entries.push_back(*entry);
+    }
+    uint64_t lookup = 0;
+
+    while (state.keepRunning()) {
+        std::string input = "File=\"C:\\Bases\\Base" + std::to_string(lookup % historySize) + "\";";
+        doNotOptimize(&*std::find_if(entries.begin(), entries.end(), [&input](const HistoryEntry& entry) { return entry.input == input; }));
+        ++lookup;
+    }
+    state.setItemsProcessed(state.iterations());
+    state.setLabel("exact input match");
+}
+
+RUN1C_BENCHMARK_SIZED(HistoryPromote) {
+    size_t count = state.entryCount();
+    History history = generateHistory(count);
+    std::vector<std::string> inputs = generateInputs(count);
+    int64_t now = benchDataNow;
+    uint64_t launch = 0;
+
+    while (state.keepRunning()) {
+        // A stride through the inputs, so launches land all over the list
+        doNotOptimize(&history.recordLaunch(inputs[(launch * 7919) % count], launch % 8 == 0, now));
+        now += 60;
+        ++launch;
+    }
+    state.setItemsProcessed(state.iterations());
+}
+
+RUN1C_BENCHMARK_SIZED(HistorySearch) {
+    size_t count = state.entryCount();
+    History history = generateHistory(count);
+    std::vector<std::string> inputs = generateInputs(count);
+    uint64_t lookup = 0;
+
+    while (state.keepRunning()) {
+        doNotOptimize(history.find(inputs[(lookup * 7919) % count]));
+        ++lookup;
+    }
+    state.setItemsProcessed(state.iterations());
+}
@@ -0,0 +1,84 @@
+#include "bench.h"
+#include "history.h"
+#include "ibases_importer.h"
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+// ibases.v8i import on a synthetic 50k-entry list: the single parsing pass
+// over the content, a full import into empty history, and a re-import of
+// an unchanged file which must stop at the mtime and size check.
+
+namespace {
+
+const size_t entryCount = 50000;
+
+const std::string& content() {
+    static const std::string text = [] {
+        std::string result = "\xEF\xBB\xBF";
+        result.reserve(entryCount * 200);
+        for (size_t i = 0; i < entryCount; ++i) {
+            std::string n = std::to_string(i);
+            if (i % 100 == 0) {
+                result += "[Отдел " + n + "]\r\nFolder=/\r\nOrderInTree=" + n + "\r\n\r\n";
+            }
+            result += "[Торговля " + n + "]\r\n";
+            if (i % 3 == 0) {
+                result += "Connect=Srvr=\"app" + std::to_string(i % 16) + "\";Ref=\"trade_" + n + "\";\r\n";
+            } else {
+                result += "Connect=File=\"C:\\Bases\\Торговля " + n + "\";\r\n";
+            }
+            result += "ID=00000000-0000-0000-0000-" + std::string(12 - n.size(), '0') + n + "\r\n";
+            result += "OrderInList=" + n + "\r\nFolder=/Отдел " + std::to_string(i / 100 * 100) + "\r\nExternal=0\r\n\r\n";
+        }
+        return result;
+    }();
+    return text;
+}
+
+const std::string& contentPath() {
+    static const std::string path = [] {
+        std::string result = (std::filesystem::temp_directory_path() / "run1c_bench_ibases.v8i").string();
+        std::ofstream file(result, std::ios::binary | std::ios::trunc);
+        file << content();
+        return result;
+    }();
+    return path;
+}
+
+} // namespace
+
+RUN1C_BENCHMARK(IbasesParse) {
+    const std::string& text = content();
+    while (state.keepRunning()) {
+        size_t bases = 0;
+        doNotOptimize(parseIbases(text, [&bases](const IbasesSection&) { ++bases; }));
+        doNotOptimize(bases);
+    }
+    state.setItemsProcessed(state.iterations() * entryCount);
+    state.setBytesProcessed(state.iterations() * text.size());
+}
+
+RUN1C_BENCHMARK(IbasesImportFull) {
+    const std::string& path = contentPath();
+    while (state.keepRunning()) {
+        History history;
+        IbasesImportState importState;
+        doNotOptimize(importIbases(path, history, importState).added);
+    }
+    state.setItemsProcessed(state.iterations() * entryCount);
+    state.setBytesProcessed(state.iterations() * content().size());
+    state.setLabel("mapped file into empty history");
+}
+
+RUN1C_BENCHMARK(IbasesImportUnchanged) {
+    const std::string& path = contentPath();
+    History history;
+    IbasesImportState importState;
+    importIbases(path, history, importState);
+    while (state.keepRunning()) {
+        doNotOptimize(importIbases(path, history, importState).fileChanged);
+    }
+    state.setItemsProcessed(state.iterations());
+    state.setLabel("mtime and size check");
+}
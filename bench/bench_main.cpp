@@ -0,0 +1,230 @@
+#include "bench.h"
+#include "bench_report.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <map>
+
+BenchmarkState::BenchmarkState(std::chrono::nanoseconds minTime, size_t entryCount) : minTime(minTime), entries(entryCount) {
+}
+
+bool BenchmarkState::keepRunning() {
+    if (!started) {
+        started = true;
+        start = Clock::now();
+        return !skipped;
+    }
+
+    iterationCount++;
+    if (skipped) {
+        return false;
+    }
+    if (iterationCount < nextCheck) {
+        return true;
+    }
+
+    // Reading the clock is checked at doubling intervals to keep its cost out of tight loops
+    elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start) - paused;
+    if (elapsed >= minTime) {
+        return false;
+    }
+    nextCheck = iterationCount * 2;
+    return true;
+}
+
+void BenchmarkState::pauseTiming() {
+    pauseStart = Clock::now();
+}
+
+void BenchmarkState::resumeTiming() {
+    paused += std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - pauseStart);
+}
+
+void BenchmarkState::skip(const std::string& reason) {
+    skipped = true;
+    label = reason;
+}
+
+namespace {
+
+// 10, 1k, 100k, 1M
+std::string sizeName(size_t size) {
+    if (size >= 1000000 && size % 1000000 == 0) return std::to_string(size / 1000000) + "M";
+    if (size >= 1000 && size % 1000 == 0) return std::to_string(size / 1000) + "k";
+    return std::to_string(size);
+}
+
+} // namespace
+
+bool BenchmarkRegistry::add(const char* name, BenchmarkFunction function) {
+    all().push_back({name, function});
+    return true;
+}
+
+bool BenchmarkRegistry::addSized(const char* name, BenchmarkFunction function) {
+    for (size_t size : benchmarkSizes) {
+        all().push_back({std::string(name) + "/" + sizeName(size), function, size});
+    }
+    return true;
+}
+
+std::vector<RegisteredBenchmark>& BenchmarkRegistry::all() {
+    static std::vector<RegisteredBenchmark> benchmarks;
+    return benchmarks;
+}
+
+namespace {
+
+void printUsage() {
+    std::printf("Usage: run1c_bench [--filter <substring>] [--min-time <ms>] [--max-size <entries>] [--repetitions <n>]\n"
+                "                   [--json <file>] [--baseline <file>] [--threshold <percent>]\n"
+                "\n"
+                "  --max-size     skip sized benchmarks over this many entries\n"
+                "  --repetitions  run each benchmark n times and keep the fastest\n"
+                "  --json         write the results as JSON, the format of --baseline\n"
+                "  --baseline     compare ns/iter against a stored run, fail on regressions\n"
+                "  --threshold    allowed slowdown against the baseline, default 20 (%%)\n");
+}
+
+std::string formatRate(double perSecond, const char* unit) {
+    static const char* prefixes[] = {"", "K", "M", "G"};
+    size_t prefix = 0;
+    while (perSecond >= 1000.0 && prefix + 1 < std::size(prefixes)) {
+        perSecond /= 1000.0;
+        prefix++;
+    }
+    char buffer[32];
+    std::snprintf(buffer, sizeof(buffer), "%.2f %s%s/s", perSecond, prefixes[prefix], unit);
+    return buffer;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    std::string filter;
+    long minTimeMs = 500;
+    size_t maxSize = 0;
+    long repetitions = 1;
+    std::string jsonPath;
+    std::string baselinePath;
+    double threshold = 20.0;
+
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--filter") == 0 && i + 1 < argc) {
+            filter = argv[++i];
+        } else if (std::strcmp(argv[i], "--min-time") == 0 && i + 1 < argc) {
+            minTimeMs = std::strtol(argv[++i], nullptr, 10);
+        } else if (std::strcmp(argv[i], "--max-size") == 0 && i + 1 < argc) {
+            maxSize = std::strtoull(argv[++i], nullptr, 10);
+        } else if (std::strcmp(argv[i], "--repetitions") == 0 && i + 1 < argc) {
+            repetitions = std::max(1L, std::strtol(argv[++i], nullptr, 10));
+        } else if (std::strcmp(argv[i], "--json") == 0 && i + 1 < argc) {
+            jsonPath = argv[++i];
+        } else if (std::strcmp(argv[i], "--baseline") == 0 && i + 1 < argc) {
+            baselinePath = argv[++i];
+        } else if (std::strcmp(argv[i], "--threshold") == 0 && i + 1 < argc) {
+            threshold = std::strtod(argv[++i], nullptr);
+        } else {
+            printUsage();
+            return 1;
+        }
+    }
+
+    std::map<std::string, double> baseline;
+    if (!baselinePath.empty()) {
+        std::string error;
+        auto loaded = readBaseline(baselinePath, &error);
+        if (!loaded) {
+            std::fprintf(stderr, "run1c_bench: %s\n", error.c_str());
+            return 1;
+        }
+        baseline = std::move(*loaded);
+    }
+
+    std::vector<BenchmarkResult> results;
+    std::vector<std::string> regressions;
+    std::printf("%-40s %12s %14s %9s %16s  %s\n", "Benchmark", "Iterations", "ns/iter", "Baseline", "Throughput", "Notes");
+    for (const RegisteredBenchmark& benchmark : BenchmarkRegistry::all()) {
+        if (!filter.empty() && benchmark.name.find(filter) == std::string::npos) {
+            continue;
+        }
+        if (maxSize && benchmark.entryCount > maxSize) {
+            continue;
+        }
+
+        BenchmarkResult result;
+        result.name = benchmark.name;
+        for (long repetition = 0; repetition < repetitions; ++repetition) {
+            BenchmarkState state{std::chrono::milliseconds(minTimeMs), benchmark.entryCount};
+            benchmark.function(state);
+            if (state.isSkipped()) {
+                result.skipped = true;
+                result.label = state.getLabel();
+                break;
+            }
+
+            double seconds = state.elapsedNs() / 1e9;
+            double nsPerIteration = state.iterations() ? state.elapsedNs() / state.iterations() : 0.0;
+            if (repetition > 0 && nsPerIteration >= result.nsPerIteration) {
+                continue;
+            }
+            result.iterations = state.iterations();
+            result.nsPerIteration = nsPerIteration;
+            result.bytesPerSecond = seconds > 0 ? state.getBytesProcessed() / seconds : 0.0;
+            result.itemsPerSecond = seconds > 0 ? state.getItemsProcessed() / seconds : 0.0;
+            result.label = state.getLabel();
+        }
+        results.push_back(result);
+
+        if (result.skipped) {
+            std::printf("%-40s %12s %14s %9s %16s  %s\n", result.name.c_str(), "-", "-", "-", "-", result.label.c_str());
+            continue;
+        }
+
+        std::string throughput;
+        if (result.bytesPerSecond > 0) {
+            throughput = formatRate(result.bytesPerSecond, "B");
+        } else if (result.itemsPerSecond > 0) {
+            throughput = formatRate(result.itemsPerSecond, "items");
+        }
+
+        // Change in ns/iter against the baseline, "new" for benchmarks it does not have
+        char change[16] = "";
+        if (!baselinePath.empty()) {
+            auto stored = baseline.find(result.name);
+            if (stored == baseline.end() || stored->second <= 0) {
+                std::snprintf(change, sizeof(change), "new");
+            } else {
+                double percent = (result.nsPerIteration / stored->second - 1.0) * 100.0;
+                std::snprintf(change, sizeof(change), "%+.1f%%", percent);
+                if (percent > threshold) {
+                    regressions.push_back(result.name + " " + change);
+                }
+            }
+        }
+
+        std::printf("%-40s %12llu %14.1f %9s %16s  %s\n", result.name.c_str(), static_cast<unsigned long long>(result.iterations),
+            result.nsPerIteration, change, throughput.c_str(), result.label.c_str());
+        std::fflush(stdout);
+    }
+
+    if (!jsonPath.empty()) {
+        std::ofstream file(jsonPath, std::ios::binary | std::ios::trunc);
+        file << formatResultsJson(results);
+        if (!file) {
+            std::fprintf(stderr, "run1c_bench: cannot write %s\n", jsonPath.c_str());
+            return 1;
+        }
+    }
+
+    if (!regressions.empty()) {
+        std::printf("\n%zu benchmark(s) slower than %s by more than %.0f%%:\n", regressions.size(), baselinePath.c_str(), threshold);
+        for (const auto& regression : regressions) {
+            std::printf("  %s\n", regression.c_str());
+        }
+        return 1;
+    }
+    return 0;
+}
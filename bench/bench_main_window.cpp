@@ -0,0 +1,92 @@
+#include "bench.h"
+#include "ui_harness.h"
+#include <cstdio>
+#include <optional>
+#include <string>
+
+// MainWindow frames on a headless ImGui context, at three history sizes.
+// Idle frames measure the steady cost of the window; replays run the
+// recorded scripts from tests/fixtures/ui and report thread CPU time per
+// frame, which is what a UI change moves even on a CI box without a GPU.
+
+namespace {
+
+void benchmarkIdleFrames(BenchmarkState& state, size_t historySize) {
+    UiHarness harness;
+    harness.fillHistory(historySize);
+    for (int i = 0; i < 10; ++i) {
+        harness.frame();
+    }
+
+    int64_t cpuNs = 0;
+    while (state.keepRunning()) {
+        cpuNs += harness.frame();
+    }
+    char label[64];
+    std::snprintf(label, sizeof(label), "%.1f us CPU/frame", cpuNs / 1000.0 / state.iterations());
+    state.setItemsProcessed(state.iterations());
+    state.setLabel(label);
+}
+
+void benchmarkReplay(BenchmarkState& state, const char* scriptName, size_t historySize) {
+    std::string error;
+    auto script = InputScript::load(std::string(RUN1C_UI_SCRIPTS_DIR) + "/" + scriptName, &error);
+    if (!script) {
+        state.skip(error);
+        return;
+    }
+
+    UiHarness::ReplayResult total;
+    std::optional<UiHarness> harness;
+    while (state.keepRunning()) {
+        // A fresh window each time, so every replay starts from the same state
+        state.pauseTiming();
+        harness.reset();
+        harness.emplace();
+        harness->fillHistory(historySize);
+        state.resumeTiming();
+
+        UiHarness::ReplayResult result = harness->replay(*script);
+        total.frameCpuNs.insert(total.frameCpuNs.end(), result.frameCpuNs.begin(), result.frameCpuNs.end());
+        if (!result.failures.empty()) {
+            state.skip("replay failed, " + result.failures.front());
+            return;
+        }
+    }
+
+    char label[96];
+    std::snprintf(label, sizeof(label), "%zu frames, CPU/frame mean %.1f us, p99 %.1f us", total.frameCpuNs.size() / state.iterations(),
+        total.totalCpuNs() / 1000.0 / total.frameCpuNs.size(), total.percentileCpuNs(0.99) / 1000.0);
+    state.setItemsProcessed(total.frameCpuNs.size());
+    state.setLabel(label);
+}
+
+} // namespace
+
+RUN1C_BENCHMARK(MainWindowIdle10) {
+    benchmarkIdleFrames(state, 10);
+}
+
+RUN1C_BENCHMARK(MainWindowIdle1k) {
+    benchmarkIdleFrames(state, 1000);
+}
+
+RUN1C_BENCHMARK(MainWindowIdle100k) {
+    benchmarkIdleFrames(state, 100000);
+}
+
+RUN1C_BENCHMARK(MainWindowReplaySearch1k) {
+    benchmarkReplay(state, "search_launch.script", 1000);
+}
+
+RUN1C_BENCHMARK(MainWindowReplayNavigation10) {
+    benchmarkReplay(state, "history_navigation.script", 10);
+}
+
+RUN1C_BENCHMARK(MainWindowReplayNavigation1k) {
+    benchmarkReplay(state, "history_navigation.script", 1000);
+}
+
+RUN1C_BENCHMARK(MainWindowReplayNavigation100k) {
+    benchmarkReplay(state, "history_navigation.script", 100000);
+}
@@ -0,0 +1,60 @@
+#include "bench.h"
+#include "metrics.h"
+#include <atomic>
+#include <chrono>
+
+// Cost of recording a metric on the launch path, which should stay at a few
+// nanoseconds, next to a shared atomic counter; and of one Prometheus export
+// of the launcher's metrics.
+
+RUN1C_BENCHMARK(CounterAdd) {
+    MetricsRegistry registry;
+    Counter counter = registry.counter("bench_events_total", "Events");
+    while (state.keepRunning()) {
+        counter.add();
+    }
+    doNotOptimize(counter.value());
+    state.setItemsProcessed(state.iterations());
+}
+
+RUN1C_BENCHMARK(SharedAtomicAddBaseline) {
+    std::atomic<uint64_t> counter{0};
+    while (state.keepRunning()) {
+        counter.fetch_add(1, std::memory_order_relaxed);
+    }
+    doNotOptimize(counter.load());
+    state.setItemsProcessed(state.iterations());
+}
+
+RUN1C_BENCHMARK(HistogramObserve) {
+    MetricsRegistry registry;
+    Histogram histogram = registry.histogram("bench_duration_seconds", "Durations");
+    int64_t ns = 0;
+    while (state.keepRunning()) {
+        // Walks through every bucket
+        histogram.observe(std::chrono::nanoseconds(ns));
+        ns = (ns * 7 + 1'000'003) % 6'000'000'000;
+    }
+    doNotOptimize(histogram.count());
+    state.setItemsProcessed(state.iterations());
+}
+
+RUN1C_BENCHMARK(MetricsTimerScope) {
+    MetricsRegistry registry;
+    Histogram histogram = registry.histogram("bench_scope_seconds", "Scopes");
+    while (state.keepRunning()) {
+        MetricsTimer timer(histogram);
+    }
+    doNotOptimize(histogram.count());
+    state.setItemsProcessed(state.iterations());
+}
+
+RUN1C_BENCHMARK(MetricsExportText) {
+    const LauncherMetrics& metrics = LauncherMetrics::get();
+    metrics.launches(false).add();
+    metrics.frame.observe(std::chrono::milliseconds(16));
+    while (state.keepRunning()) {
+        doNotOptimize(MetricsRegistry::global().exportText());
+    }
+    state.setItemsProcessed(state.iterations());
+}
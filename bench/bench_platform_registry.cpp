@@ -0,0 +1,114 @@
+#include "bench.h"
+#include "platform_registry.h"
+#include "process_spawner.h"
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+#ifndef _WIN32
+#include <sys/stat.h>
+#endif
+
+// Finding the installed platforms in a tree of 12 versions: a full parallel
+// scan, and the per-launch check of an unchanged cache (one stat per root).
+// On POSIX, what launching 1cv8 directly saves: a stand-in starter that
+// lists the versions and runs the platform, against running it directly.
+
+namespace {
+
+const int versionCount = 12;
+
+struct PlatformTree {
+    std::filesystem::path root;
+    std::string platform;   // Newest stand-in 1cv8
+    std::string starter;    // Stand-in 1cestart
+
+    PlatformTree() {
+        root = std::filesystem::temp_directory_path() / "run1c_bench_platforms" / "1cv8";
+        std::filesystem::remove_all(root.parent_path());
+        std::filesystem::create_directories(root / "common");
+        for (int i = 0; i < versionCount; ++i) {
+            std::filesystem::path bin = root / ("8.3." + std::to_string(13 + i) + ".1000") / "bin";
+            std::filesystem::create_directories(bin);
+#ifdef _WIN32
+            platform = (bin / "1cv8.exe").string();
+            std::ofstream(platform).close();
+#else
+            platform = (bin / "1cv8").string();
+            writeScript(platform, "#!/bin/sh\nexit 0\n");
+#endif
+        }
+#ifndef _WIN32
+        // Like 1cestart: look at the installed versions, then start the chosen one and exit
+        starter = (root / "common" / "1cestart").string();
+        writeScript(starter, "#!/bin/sh\nfor version in \"" + root.string() + "\"/*/bin/1cv8; do :; done\n\""
+            + platform + "\" \"$@\"\n");
+#endif
+    }
+
+    ~PlatformTree() {
+        std::error_code ec;
+        std::filesystem::remove_all(root.parent_path(), ec);
+    }
+
+#ifndef _WIN32
+    static void writeScript(const std::string& path, const std::string& text) {
+        std::ofstream(path, std::ios::trunc) << text;
+        ::chmod(path.c_str(), 0755);
+    }
+#endif
+};
+
+const PlatformTree& tree() {
+    static const PlatformTree instance;
+    return instance;
+}
+
+} // namespace
+
+RUN1C_BENCHMARK(PlatformScan) {
+    std::string root = tree().root.string();
+    while (state.keepRunning()) {
+        PlatformRegistry registry({root});
+        registry.refresh();
+        doNotOptimize(registry.select());
+    }
+    state.setItemsProcessed(state.iterations() * versionCount);
+}
+
+RUN1C_BENCHMARK(PlatformRefreshCached) {
+    PlatformRegistry registry({tree().root.string()});
+    registry.refresh();
+    while (state.keepRunning()) {
+        doNotOptimize(registry.refresh());
+        doNotOptimize(registry.select());
+    }
+    state.setItemsProcessed(state.iterations());
+}
+
+#ifndef _WIN32
+RUN1C_BENCHMARK(LaunchThroughStarter) {
+    ProcessSpawner& spawner = ProcessSpawner::instance();
+    std::vector<std::string> args = {"ENTERPRISE", "/F", "/tmp/base"};
+    while (state.keepRunning()) {
+        spawner.spawn(tree().starter, args);
+        spawner.waitAll(std::chrono::seconds(10));
+    }
+    state.setItemsProcessed(state.iterations());
+    state.setLabel("starter lists versions, runs 1cv8");
+}
+
+RUN1C_BENCHMARK(LaunchDirect) {
+    ProcessSpawner& spawner = ProcessSpawner::instance();
+    PlatformRegistry registry({tree().root.string()});
+    registry.refresh();
+    std::vector<std::string> args = {"ENTERPRISE", "/F", "/tmp/base"};
+    while (state.keepRunning()) {
+        registry.refresh();
+        spawner.spawn(registry.select()->executable, args);
+        spawner.waitAll(std::chrono::seconds(10));
+    }
+    state.setItemsProcessed(state.iterations());
+    state.setLabel("cached registry, 1cv8 spawned directly");
+}
+#endif
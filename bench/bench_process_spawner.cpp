@@ -0,0 +1,74 @@
+#include "bench.h"
+#include "process_spawner.h"
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#ifdef _WIN32
+#include "utils.h"
+#else
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+// Spawn-to-exit latency of a trivial child. The parent carries a touched
+// ballast (RUN1C_BENCH_BALLAST_MB, 256 MB by default) as the GUI process does
+// with SDL, GL and fonts, which is what makes fork-based spawning expensive.
+
+namespace {
+
+const std::vector<char>& ballast() {
+    static std::vector<char> memory = [] {
+        const char* sizeOverride = std::getenv("RUN1C_BENCH_BALLAST_MB");
+        size_t megabytes = sizeOverride ? std::strtoull(sizeOverride, nullptr, 10) : 256;
+        std::vector<char> bytes(megabytes * 1024 * 1024);
+        std::memset(bytes.data(), 1, bytes.size());
+        return bytes;
+    }();
+    return memory;
+}
+
+std::string trivialProgram(std::vector<std::string>& args) {
+#ifdef _WIN32
+    args = {"/c", "exit 0"};
+    return getEnvironmentVariable("ComSpec");
+#else
+    args.clear();
+    return "/bin/true";
+#endif
+}
+
+} // namespace
+
+RUN1C_BENCHMARK(SpawnAndReap) {
+    doNotOptimize(ballast().data());
+    std::vector<std::string> args;
+    std::string program = trivialProgram(args);
+    ProcessSpawner& spawner = ProcessSpawner::instance();
+
+    while (state.keepRunning()) {
+        spawner.spawn(program, args);
+        spawner.waitAll(std::chrono::seconds(10));
+    }
+    state.setItemsProcessed(state.iterations());
+    state.setLabel(spawner.backendName());
+}
+
+#ifndef _WIN32
+// Baseline the spawner replaces: fork copies the page tables of the ballast
+RUN1C_BENCHMARK(ForkExecAndWait) {
+    doNotOptimize(ballast().data());
+
+    while (state.keepRunning()) {
+        pid_t pid = fork();
+        if (pid == 0) {
+            execl("/bin/true", "/bin/true", static_cast<char*>(nullptr));
+            _exit(127);
+        }
+        int status = 0;
+        waitpid(pid, &status, 0);
+    }
+    state.setItemsProcessed(state.iterations());
+    state.setLabel("fork + execl + waitpid");
+}
+#endif
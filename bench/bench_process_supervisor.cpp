@@ -0,0 +1,58 @@
+#include "bench.h"
+#include "process_supervisor.h"
+#include <algorithm>
+
+// Cost of one sampling pass over a few hundred real processes (the background
+// thread's work per tick), with and without the walk over the system process
+// list that looks for children, and of the snapshot read the UI does every frame.
+
+namespace {
+
+const size_t trackedProcesses = 500;
+
+void trackSystemProcesses(ProcessSupervisor& supervisor) {
+    std::vector<ListedProcess> processes = ProcessSupervisor::listProcesses();
+    processes.resize(std::min(processes.size(), trackedProcesses));
+    for (const ListedProcess& process : processes) {
+        supervisor.track(process.pid, "bench", "ENTERPRISE");
+    }
+}
+
+} // namespace
+
+RUN1C_BENCHMARK(SupervisorSamplePass) {
+    ProcessSupervisor supervisor(std::chrono::hours(1));
+    trackSystemProcesses(supervisor);
+    size_t tracked = supervisor.snapshot()->size();
+
+    while (state.keepRunning()) {
+        supervisor.sampleNow();
+    }
+    state.setItemsProcessed(state.iterations() * tracked);
+    state.setLabel(std::to_string(tracked) + " processes");
+}
+
+RUN1C_BENCHMARK(SupervisorSampleTrackedOnly) {
+    // No grace period: the pass reads the tracked processes and looks for no children
+    ProcessSupervisor supervisor(std::chrono::hours(1), std::chrono::milliseconds(0));
+    trackSystemProcesses(supervisor);
+    size_t tracked = supervisor.snapshot()->size();
+
+    while (state.keepRunning()) {
+        supervisor.sampleNow();
+    }
+    state.setItemsProcessed(state.iterations() * tracked);
+    state.setLabel(std::to_string(tracked) + " processes");
+}
+
+RUN1C_BENCHMARK(SupervisorSnapshotRead) {
+    ProcessSupervisor supervisor(std::chrono::hours(1));
+    trackSystemProcesses(supervisor);
+    supervisor.sampleNow();
+
+    while (state.keepRunning()) {
+        ProcessSupervisor::Snapshot snapshot = supervisor.snapshot();
+        doNotOptimize(snapshot->size());
+    }
+    state.setItemsProcessed(state.iterations());
+}
@@ -0,0 +1,51 @@
+#include "bench.h"
+#include "regex_cache.h"
+#include "utils.h"
+#include <regex>
+#include <string>
+
+// replaceWithRegex on a short input with a handful of recurring patterns:
+// through the compiled-pattern cache, with a precompiled handle, and
+// compiling the pattern on every call as before.
+
+namespace {
+
+const char* patterns[] = {"\\bFile=\"([^\"]+)\"", "\\s+", "[\\\\/]+$", "\\bUsr=\"[^\"]*\";?"};
+const size_t patternCount = sizeof(patterns) / sizeof(patterns[0]);
+const std::string input = "File=\"C:\\Bases\\Trade\\\";Usr=\"Иванов\";  ";
+
+} // namespace
+
+RUN1C_BENCHMARK(RegexReplaceCached) {
+    size_t call = 0;
+    while (state.keepRunning()) {
+        std::string text = input;
+        replaceWithRegex(text, patterns[call++ % patternCount], "");
+        doNotOptimize(text.data());
+    }
+    state.setItemsProcessed(state.iterations());
+    RegexCache::Stats stats = RegexCache::global().stats();
+    state.setLabel(std::to_string(stats.hits) + " hits, " + std::to_string(stats.misses) + " misses");
+}
+
+RUN1C_BENCHMARK(RegexReplacePrecompiled) {
+    RegexCache::Handle regex = RegexCache::global().get(patterns[0]);
+    while (state.keepRunning()) {
+        std::string text = input;
+        replaceWithRegex(text, *regex, "");
+        doNotOptimize(text.data());
+    }
+    state.setItemsProcessed(state.iterations());
+}
+
+RUN1C_BENCHMARK(RegexReplaceCompileEachCall) {
+    size_t call = 0;
+    while (state.keepRunning()) {
+        std::string text = input;
+        std::regex regex(patterns[call++ % patternCount]);
+        text = std::regex_replace(text, regex, "");
+        doNotOptimize(text.data());
+    }
+    state.setItemsProcessed(state.iterations());
+    state.setLabel("previous behavior");
+}
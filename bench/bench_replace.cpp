@@ -0,0 +1,67 @@
+#include "bench.h"
+#include "utils.h"
+#include <string>
+#include <vector>
+
+// Substring replacement on a 1 MB input with a match every few bytes: the
+// single-pass SubstringReplacer against the find + in-place replace loop
+// that replaceSubstring used before, once per pattern.
+
+namespace {
+
+const std::vector<std::pair<std::string, std::string>>& replacements() {
+    static const std::vector<std::pair<std::string, std::string>> pairs = {
+        {"%BASE%", "C:\\Bases\\Торговля"},
+        {"%USER%", "Иванов"},
+        {"\\", "/"},
+        {"\"", "\\\""},
+    };
+    return pairs;
+}
+
+const std::string& denseText() {
+    static const std::string text = [] {
+        std::string result;
+        while (result.size() < 1024 * 1024) {
+            result += "File=\"%BASE%\\1Cv8.1CD\";Usr=\"%USER%\";";
+        }
+        return result;
+    }();
+    return text;
+}
+
+void replaceInPlace(std::string& str, const std::string& from, const std::string& to) {
+    size_t startPos = 0;
+    while ((startPos = str.find(from, startPos)) != std::string::npos) {
+        str.replace(startPos, from.length(), to);
+        startPos += to.length();
+    }
+}
+
+} // namespace
+
+RUN1C_BENCHMARK(SubstringReplacerDense) {
+    SubstringReplacer replacer(replacements());
+    const std::string& text = denseText();
+    while (state.keepRunning()) {
+        std::string result = replacer.replace(text);
+        doNotOptimize(result.data());
+    }
+    state.setBytesProcessed(state.iterations() * text.size());
+    state.setLabel("4 patterns, one pass");
+}
+
+RUN1C_BENCHMARK(ReplaceInPlaceBaseline) {
+    const std::string& text = denseText();
+    while (state.keepRunning()) {
+        // Pattern by pattern, later ones also see text inserted by earlier ones;
+        // only the cost is compared
+        std::string result = text;
+        for (const auto& [from, to] : replacements()) {
+            replaceInPlace(result, from, to);
+        }
+        doNotOptimize(result.data());
+    }
+    state.setBytesProcessed(state.iterations() * text.size());
+    state.setLabel("find + replace per pattern");
+}
@@ -0,0 +1,143 @@
+#include "bench_report.h"
+#include "json.h"
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iterator>
+#include <string_view>
+
+namespace {
+
+void appendNumber(std::string& out, const char* key, double value) {
+    char buffer[64];
+    std::snprintf(buffer, sizeof(buffer), ", \"%s\": %.6g", key, value);
+    out += buffer;
+}
+
+// Reads a JSON string starting at the opening quote, pos ends past the closing one.
+// \uXXXX escapes are kept as written, names and labels never need them
+bool readString(std::string_view text, size_t& pos, std::string& out) {
+    out.clear();
+    for (++pos; pos < text.size(); ++pos) {
+        char c = text[pos];
+        if (c == '"') {
+            ++pos;
+            return true;
+        }
+        if (c == '\\' && pos + 1 < text.size()) {
+            c = text[++pos];
+            switch (c) {
+                case 'b': out += '\b'; break;
+                case 'f': out += '\f'; break;
+                case 'n': out += '\n'; break;
+                case 'r': out += '\r'; break;
+                case 't': out += '\t'; break;
+                case 'u': out += "\\u"; break;
+                default:  out += c;
+            }
+        } else {
+            out += c;
+        }
+    }
+    return false;
+}
+
+} // namespace
+
+std::string formatResultsJson(const std::vector<BenchmarkResult>& results) {
+    std::string out = "{\n  \"benchmarks\": [\n";
+    for (size_t i = 0; i < results.size(); ++i) {
+        const BenchmarkResult& result = results[i];
+        out += "    {\"name\": ";
+        appendJsonString(out, result.name);
+        if (result.skipped) {
+            out += ", \"skipped\": true";
+        } else {
+            out += ", \"iterations\": " + std::to_string(result.iterations);
+            appendNumber(out, "ns_per_iter", result.nsPerIteration);
+            if (result.bytesPerSecond > 0) appendNumber(out, "bytes_per_second", result.bytesPerSecond);
+            if (result.itemsPerSecond > 0) appendNumber(out, "items_per_second", result.itemsPerSecond);
+        }
+        if (!result.label.empty()) {
+            out += ", \"label\": ";
+            appendJsonString(out, result.label);
+        }
+        out += i + 1 < results.size() ? "},\n" : "}\n";
+    }
+    out += "  ]\n}\n";
+    return out;
+}
+
+std::optional<std::map<std::string, double>> readBaseline(const std::string& path, std::string* error) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        if (error) *error = "cannot open " + path;
+        return std::nullopt;
+    }
+    std::string content((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    std::string_view text = content;
+
+    // Only the flat objects formatResultsJson writes are understood: a string
+    // followed by ':' is a key, the value after it is recorded for "name",
+    // "ns_per_iter" and "skipped", and a closing brace ends the benchmark
+    std::map<std::string, double> baseline;
+    std::string name;
+    std::string key;
+    std::string token;
+    double nsPerIteration = -1.0;
+    bool skipped = false;
+    size_t pos = 0;
+    while (pos < text.size()) {
+        char c = text[pos];
+        if (c == '"') {
+            if (!readString(text, pos, token)) {
+                if (error) *error = path + ": unterminated string";
+                return std::nullopt;
+            }
+            size_t next = text.find_first_not_of(" \t\r\n", pos);
+            if (next != std::string_view::npos && text[next] == ':') {
+                key = token;
+                pos = next + 1;
+            } else if (key == "name") {
+                name = token;
+            }
+        } else if (c == '-' || (c >= '0' && c <= '9')) {
+            char* end = nullptr;
+            double value = std::strtod(content.c_str() + pos, &end);
+            if (end == content.c_str() + pos) {
+                if (error) *error = path + ": bad number at offset " + std::to_string(pos);
+                return std::nullopt;
+            }
+            if (key == "ns_per_iter") {
+                nsPerIteration = value;
+            }
+            pos = end - content.c_str();
+        } else if (text.substr(pos, 4) == "true") {
+            skipped = skipped || key == "skipped";
+            pos += 4;
+        } else if (c == '{') {
+            name.clear();
+            nsPerIteration = -1.0;
+            skipped = false;
+            ++pos;
+        } else if (c == '}') {
+            if (!name.empty() && nsPerIteration >= 0 && !skipped) {
+                baseline[name] = nsPerIteration;
+            }
+            name.clear();
+            ++pos;
+        } else if (c == ',' || c == '[' || c == ']' || c == ' ' || c == '\t' || c == '\r' || c == '\n') {
+            ++pos;
+        } else if (text.substr(pos, 5) == "false" || text.substr(pos, 4) == "null") {
+            pos += text[pos] == 'f' ? 5 : 4;
+        } else {
+            if (error) *error = path + ": unexpected '" + std::string(1, c) + "' at offset " + std::to_string(pos);
+            return std::nullopt;
+        }
+    }
+    if (baseline.empty()) {
+        if (error) *error = path + ": no benchmarks";
+        return std::nullopt;
+    }
+    return baseline;
+}
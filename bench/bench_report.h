@@ -0,0 +1,26 @@
+#pragma once
+
+#include <cstdint>
+#include <map>
+#include <optional>
+#include <string>
+#include <vector>
+
+// One finished benchmark as run1c_bench reports it
+struct BenchmarkResult {
+    std::string name;
+    uint64_t iterations = 0;
+    double nsPerIteration = 0.0;
+    double bytesPerSecond = 0.0;
+    double itemsPerSecond = 0.0;
+    std::string label;
+    bool skipped = false;
+};
+
+// {"benchmarks": [{"name": ..., "iterations": ..., "ns_per_iter": ..., ...}, ...]},
+// one benchmark per line so baseline diffs stay readable
+std::string formatResultsJson(const std::vector<BenchmarkResult>& results);
+
+// ns_per_iter by name from a file written by formatResultsJson; skipped
+// benchmarks are left out. std::nullopt with the reason in error if unreadable
+std::optional<std::map<std::string, double>> readBaseline(const std::string& path, std::string* error = nullptr);
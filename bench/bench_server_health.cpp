@@ -0,0 +1,93 @@
+#include "bench.h"
+#include "server_health.h"
+#include "error_handler.h"
+#include "history.h"
+#include "task_runtime.h"
+#include <string>
+#include <thread>
+#include <vector>
+
+#ifndef _WIN32
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+// One probe round over 64 loopback servers that refuse the connection: the
+// prober's non-blocking sockets in one task on the I/O pool, against a blocking connect on
+// a thread per host.
+
+#ifndef _WIN32
+
+namespace {
+
+const int hostCount = 64;
+
+// A port nothing listens on, on any 127.0.0.x
+uint16_t closedPort() {
+    static const uint16_t port = [] {
+        int socket = ::socket(AF_INET, SOCK_STREAM, 0);
+        sockaddr_in address = {};
+        address.sin_family = AF_INET;
+        address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        socklen_t length = sizeof(address);
+        ::bind(socket, reinterpret_cast<sockaddr*>(&address), sizeof(address));
+        ::getsockname(socket, reinterpret_cast<sockaddr*>(&address), &length);
+        ::close(socket);
+        return ntohs(address.sin_port);
+    }();
+    return port;
+}
+
+std::string host(int index) {
+    return "127.0." + std::to_string(1 + index / 200) + "." + std::to_string(1 + index % 200);
+}
+
+} // namespace
+
+RUN1C_BENCHMARK(ServerProbeRound) {
+    std::vector<std::string> bases;
+    for (int i = 0; i < hostCount; ++i) {
+        bases.push_back("Srvr=\"" + host(i) + ":" + std::to_string(closedPort()) + "\";Ref=\"base\";");
+    }
+    ErrorHandler::setLogLevel(LogLevel::Warning);
+    TaskRuntime runtime(1, 1);
+    while (state.keepRunning()) {
+        ServerHealthProber prober(runtime, std::chrono::seconds(2));
+        for (const auto& base : bases) {
+            prober.watch(base);
+        }
+        prober.waitIdle();
+        doNotOptimize(prober.health(historyKeyHash(bases.back())));
+    }
+    ErrorHandler::setLogLevel(LogLevel::Info);
+    state.setItemsProcessed(state.iterations() * hostCount);
+    state.setLabel("64 hosts, epoll in one task");
+}
+
+RUN1C_BENCHMARK(ServerProbeThreadPerHostBaseline) {
+    while (state.keepRunning()) {
+        std::vector<std::thread> threads;
+        std::vector<int> results(hostCount);
+        for (int i = 0; i < hostCount; ++i) {
+            threads.emplace_back([i, &results] {
+                int socket = ::socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+                sockaddr_in address = {};
+                address.sin_family = AF_INET;
+                ::inet_pton(AF_INET, host(i).c_str(), &address.sin_addr);
+                address.sin_port = htons(closedPort());
+                results[i] = ::connect(socket, reinterpret_cast<sockaddr*>(&address), sizeof(address));
+                ::close(socket);
+            });
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+        doNotOptimize(results.back());
+    }
+    state.setItemsProcessed(state.iterations() * hostCount);
+    state.setLabel("64 hosts, blocking connect per thread");
+}
+
+#endif
@@ -0,0 +1,176 @@
+#include "bench.h"
+#include "allocation_stats.h"
+#include "bench_data.h"
+#include "history.h"
+#include "persistent_storage.h"
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <string>
+#include <variant>
+
+// Loading a storage file with a 100k-entry history: the arena-backed
+// PersistentStorage against the previous layout (a string per line, arrays
+// copied out by getArray), with heap allocations and bytes per load.
+// HistoryLoad and the getArray pair show the cost for readers on top.
+// StorageLoad and StorageSave cover the synthetic data sets, history included.
+
+namespace {
+
+const size_t entryCount = 100000;
+
+const std::string& storagePath() {
+    static const std::string path = [] {
+        std::string result = (std::filesystem::temp_directory_path() / "run1c_bench_storage.ini").string();
+        std::filesystem::remove(result);
+        PersistentStorage::setVerbose(false);
+        PersistentStorage storage(result);
+        History history;
+        std::vector<HistoryImport> imports;
+        for (size_t i = 0; i < entryCount; ++i) {
+            std::string n = std::to_string(i);
+            std::string input = i % 3 == 0 ? "Srvr=\"app" + std::to_string(i % 16) + "\";Ref=\"trade_" + n + "\";"
+                                           : "File=\"C:\\Bases\\Trade " + n + "\";";
+            if (i % 4 == 0) {
+                history.recordLaunch(input, i % 8 == 0, 1760000000 + static_cast<int64_t>(i));
+            } else {
+                imports.push_back({input, "Department " + std::to_string(i / 100) + " / Trade " + n});
+            }
+        }
+        history.importEntries(imports);
+        history.save(storage);
+        storage.save();
+        return result;
+    }();
+    return path;
+}
+
+// The load from before the arena, kept as the baseline
+using LegacyStore = std::map<std::string, std::variant<std::string, std::vector<std::string>>>;
+
+LegacyStore legacyLoad(const std::string& path) {
+    std::ifstream infile(path);
+    std::vector<std::string> lines;
+    std::string line;
+    while (std::getline(infile, line)) {
+        line.erase(0, line.find_first_not_of(" \t\r\n"));
+        line.erase(line.find_last_not_of(" \t\r\n") + 1);
+        if (!line.empty()) {
+            lines.push_back(line);
+        }
+    }
+
+    LegacyStore store;
+    for (size_t i = 0; i < lines.size(); ++i) {
+        if (lines[i].rfind("[array:", 0) == 0) {
+            std::string key = lines[i].substr(7, lines[i].size() - 8);
+            std::vector<std::string> array;
+            while (i + 1 < lines.size() && lines[i + 1].front() != '[') {
+                array.push_back(lines[++i]);
+            }
+            store.emplace(key, array);
+        } else if (i + 1 < lines.size()) {
+            store.emplace(lines[i].substr(1, lines[i].size() - 2), lines[i + 1]);
+            ++i;
+        }
+    }
+    return store;
+}
+
+// Allocations per iteration since start, plus extra notes
+void reportAllocations(BenchmarkState& state, const AllocationCounts& start, const std::string& notes = "") {
+    AllocationCounts end = AllocationStats::process();
+    uint64_t iterations = state.iterations() ? state.iterations() : 1;
+    char text[128];
+    snprintf(text, sizeof(text), "%llu allocs, %.1f MB/iter",
+        static_cast<unsigned long long>((end.allocations - start.allocations) / iterations),
+        (end.bytes - start.bytes) / iterations / 1e6);
+    state.setLabel(text + notes);
+}
+
+} // namespace
+
+RUN1C_BENCHMARK(StorageLoadArena) {
+    const std::string& path = storagePath();
+    uint64_t bytes = std::filesystem::file_size(path);
+    StringArena::Stats arena;
+    AllocationCounts start = AllocationStats::process();
+    while (state.keepRunning()) {
+        PersistentStorage storage(path);
+        storage.load();
+        arena = storage.arenaStats();
+        doNotOptimize(arena);
+    }
+    reportAllocations(state, start, ", arena " + std::to_string(arena.reservedBytes / 1000) + " KB in " + std::to_string(arena.chunks) + " chunks");
+    state.setBytesProcessed(state.iterations() * bytes);
+}
+
+RUN1C_BENCHMARK(StorageLoadLegacyBaseline) {
+    const std::string& path = storagePath();
+    uint64_t bytes = std::filesystem::file_size(path);
+    AllocationCounts start = AllocationStats::process();
+    while (state.keepRunning()) {
+        LegacyStore store = legacyLoad(path);
+        doNotOptimize(store);
+    }
+    reportAllocations(state, start);
+    state.setBytesProcessed(state.iterations() * bytes);
+}
+
+RUN1C_BENCHMARK(HistoryLoad) {
+    PersistentStorage storage(storagePath());
+    storage.load();
+    AllocationCounts start = AllocationStats::process();
+    while (state.keepRunning()) {
+        History history;
+        doNotOptimize(history.load(storage));
+    }
+    reportAllocations(state, start);
+    state.setItemsProcessed(state.iterations() * entryCount);
+}
+
+RUN1C_BENCHMARK(StorageGetArrayView) {
+    PersistentStorage storage(storagePath());
+    storage.load();
+    AllocationCounts start = AllocationStats::process();
+    while (state.keepRunning()) {
+        doNotOptimize(storage.getArrayView(historyStatsStorageKey));
+    }
+    reportAllocations(state, start);
+}
+
+RUN1C_BENCHMARK(StorageGetArrayCopy) {
+    PersistentStorage storage(storagePath());
+    storage.load();
+    AllocationCounts start = AllocationStats::process();
+    while (state.keepRunning()) {
+        doNotOptimize(storage.getArray(historyStatsStorageKey));
+    }
+    reportAllocations(state, start);
+}
+
+RUN1C_BENCHMARK_SIZED(StorageLoad) {
+    const std::string& path = generateStorageFile(state.entryCount());
+    uint64_t bytes = std::filesystem::file_size(path);
+    while (state.keepRunning()) {
+        PersistentStorage storage(path);
+        storage.load();
+        History history;
+        doNotOptimize(history.load(storage, benchDataNow));
+    }
+    state.setBytesProcessed(state.iterations() * bytes);
+}
+
+RUN1C_BENCHMARK_SIZED(StorageSave) {
+    size_t count = state.entryCount();
+    History history = generateHistory(count);
+    std::string path = (std::filesystem::temp_directory_path() / "run1c_bench_save.ini").string();
+    PersistentStorage::setVerbose(false);
+    PersistentStorage storage(path);
+    while (state.keepRunning()) {
+        history.save(storage);
+        storage.save();
+    }
+    state.setBytesProcessed(state.iterations() * std::filesystem::file_size(path));
+    std::filesystem::remove(path);
+}
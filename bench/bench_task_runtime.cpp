@@ -0,0 +1,82 @@
+#include "bench.h"
+#include "task_runtime.h"
+#include <algorithm>
+#include <atomic>
+#include <future>
+#include <vector>
+
+// Scheduling overhead of the task runtime: one hop onto the CPU pool and back
+// to the waiting thread, fanning a batch of small tasks out to the pool next
+// to the std::async it replaces, and the per-frame UI drain.
+
+RUN1C_BENCHMARK(TaskScheduleRoundTrip) {
+    TaskRuntime runtime(2, 1);
+    auto hop = [&]() -> Task<int> {
+        co_await runtime.cpu().schedule();
+        co_return 1;
+    };
+    uint64_t total = 0;
+    while (state.keepRunning()) {
+        total += blockingWait(hop());
+    }
+    doNotOptimize(total);
+    state.setItemsProcessed(state.iterations());
+}
+
+RUN1C_BENCHMARK_SIZED(TaskFanOut) {
+    TaskRuntime runtime(0, 1);
+    std::atomic<uint64_t> sum{0};
+    auto leaf = [&](uint64_t value) -> Task<void> {
+        co_await runtime.cpu().schedule();
+        sum.fetch_add(value, std::memory_order_relaxed);
+    };
+    while (state.keepRunning()) {
+        for (size_t i = 0; i < state.entryCount(); ++i) {
+            runtime.spawn(leaf(i));
+        }
+        runtime.cpu().waitIdle();
+    }
+    doNotOptimize(sum.load());
+    state.setItemsProcessed(state.iterations() * state.entryCount());
+}
+
+// Same work through std::async, a thread per task. Capped: a million threads is not a baseline
+RUN1C_BENCHMARK_SIZED(AsyncFanOut) {
+    size_t count = std::min<size_t>(state.entryCount(), 1000);
+    std::atomic<uint64_t> sum{0};
+    std::vector<std::future<void>> futures;
+    futures.reserve(count);
+    while (state.keepRunning()) {
+        for (size_t i = 0; i < count; ++i) {
+            futures.push_back(std::async(std::launch::async, [&sum, i] { sum.fetch_add(i, std::memory_order_relaxed); }));
+        }
+        for (auto& future : futures) {
+            future.get();
+        }
+        futures.clear();
+    }
+    doNotOptimize(sum.load());
+    state.setItemsProcessed(state.iterations() * count);
+}
+
+RUN1C_BENCHMARK(UiExecutorDrain) {
+    TaskRuntime runtime(1, 1);
+    UiExecutor& ui = runtime.ui();
+    bool stopping = false;
+    auto waiter = [&]() -> Task<void> {
+        while (!stopping) {
+            co_await ui.schedule();
+        }
+    };
+    // 16 continuations per frame, each posting itself again for the next one
+    const size_t waiting = 16;
+    for (size_t i = 0; i < waiting; ++i) {
+        runtime.spawn(waiter());
+    }
+    while (state.keepRunning()) {
+        doNotOptimize(ui.drain());
+    }
+    stopping = true;
+    ui.drain();
+    state.setItemsProcessed(state.iterations() * waiting);
+}
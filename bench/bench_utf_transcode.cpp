@@ -0,0 +1,97 @@
+#include "bench.h"
+#include "bench_data.h"
+#include "utf_transcode.h"
+#include <algorithm>
+#include <string>
+#include <vector>
+
+// UTF-8 <-> UTF-16 throughput of the block fast paths against the scalar
+// reference, on ASCII paths, Cyrillic names and mixed launch command lines.
+// TranscodeInputs converts the synthetic inputs one by one, as launches do.
+
+namespace {
+
+std::string repeat(const std::string& text, size_t bytes) {
+    std::string result;
+    while (result.size() < bytes) {
+        result += text;
+    }
+    return result;
+}
+
+const std::string& asciiText() {
+    static const std::string text = repeat("C:\\Program Files\\1cv8\\common\\1cestart.exe ENTERPRISE /F ", 64 * 1024);
+    return text;
+}
+
+const std::string& cyrillicText() {
+    static const std::string text = repeat("БухгалтерияПредприятияТорговляСклад", 64 * 1024);
+    return text;
+}
+
+const std::string& mixedText() {
+    static const std::string text = repeat("ENTERPRISE /F \"C:\\Базы\\Торговля и склад 3.0\" /N \"Иванов\" ", 64 * 1024);
+    return text;
+}
+
+template <typename Convert>
+void runUtf8ToUtf16(BenchmarkState& state, const std::string& text, Convert convert) {
+    std::vector<char16_t> output(utf16Capacity(text.size()));
+    while (state.keepRunning()) {
+        doNotOptimize(convert(text, output.data(), output.size()).written);
+    }
+    state.setBytesProcessed(state.iterations() * text.size());
+}
+
+template <typename Convert>
+void runUtf16ToUtf8(BenchmarkState& state, const std::string& text, Convert convert) {
+    std::u16string input = toUtf16(text);
+    std::vector<char> output(utf8Capacity(input.size()));
+    while (state.keepRunning()) {
+        doNotOptimize(convert(input, output.data(), output.size()).written);
+    }
+    state.setBytesProcessed(state.iterations() * input.size() * sizeof(char16_t));
+}
+
+} // namespace
+
+RUN1C_BENCHMARK(Utf8ToUtf16Ascii) { runUtf8ToUtf16(state, asciiText(), utf8ToUtf16); }
+RUN1C_BENCHMARK(Utf8ToUtf16AsciiScalar) { runUtf8ToUtf16(state, asciiText(), utf8ToUtf16Scalar); }
+RUN1C_BENCHMARK(Utf8ToUtf16Cyrillic) { runUtf8ToUtf16(state, cyrillicText(), utf8ToUtf16); }
+RUN1C_BENCHMARK(Utf8ToUtf16CyrillicScalar) { runUtf8ToUtf16(state, cyrillicText(), utf8ToUtf16Scalar); }
+RUN1C_BENCHMARK(Utf8ToUtf16Mixed) { runUtf8ToUtf16(state, mixedText(), utf8ToUtf16); }
+RUN1C_BENCHMARK(Utf8ToUtf16MixedScalar) { runUtf8ToUtf16(state, mixedText(), utf8ToUtf16Scalar); }
+
+RUN1C_BENCHMARK(Utf16ToUtf8Ascii) { runUtf16ToUtf8(state, asciiText(), utf16ToUtf8); }
+RUN1C_BENCHMARK(Utf16ToUtf8AsciiScalar) { runUtf16ToUtf8(state, asciiText(), utf16ToUtf8Scalar); }
+RUN1C_BENCHMARK(Utf16ToUtf8Cyrillic) { runUtf16ToUtf8(state, cyrillicText(), utf16ToUtf8); }
+RUN1C_BENCHMARK(Utf16ToUtf8CyrillicScalar) { runUtf16ToUtf8(state, cyrillicText(), utf16ToUtf8Scalar); }
+RUN1C_BENCHMARK(Utf16ToUtf8Mixed) { runUtf16ToUtf8(state, mixedText(), utf16ToUtf8); }
+RUN1C_BENCHMARK(Utf16ToUtf8MixedScalar) { runUtf16ToUtf8(state, mixedText(), utf16ToUtf8Scalar); }
+
+RUN1C_BENCHMARK(Utf16BufferPath) {
+    const std::string path = "C:\\Базы\\Торговля и склад 3.0\\1Cv8.1CD";
+    while (state.keepRunning()) {
+        Utf16Buffer<> wide(path);
+        doNotOptimize(wide.data());
+    }
+    state.setItemsProcessed(state.iterations());
+    state.setLabel("stack buffer, no allocation");
+}
+
+RUN1C_BENCHMARK_SIZED(TranscodeInputs) {
+    std::vector<std::string> inputs = generateInputs(state.entryCount());
+    uint64_t bytes = 0;
+    size_t longest = 0;
+    for (const auto& input : inputs) {
+        bytes += input.size();
+        longest = std::max(longest, input.size());
+    }
+    std::vector<char16_t> output(utf16Capacity(longest));
+    while (state.keepRunning()) {
+        for (const auto& input : inputs) {
+            doNotOptimize(utf8ToUtf16(input, output.data(), output.size()).written);
+        }
+    }
+    state.setBytesProcessed(state.iterations() * bytes);
+}
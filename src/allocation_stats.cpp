@@ -0,0 +1,70 @@
+#include "allocation_stats.h"
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+namespace {
+
+std::atomic<uint64_t> processAllocations{0};
+std::atomic<uint64_t> processBytes{0};
+std::atomic<uint64_t> imguiAllocations{0};
+std::atomic<uint64_t> imguiBytes{0};
+
+// Plain counters, constant initialized, so operator new can touch them on any thread
+thread_local AllocationCounts threadCounts;
+
+} // namespace
+
+// Replaces the global allocator for every binary that uses AllocationStats.
+// Array and nothrow forms forward here; aligned forms keep the default
+void* operator new(std::size_t size) {
+    processAllocations.fetch_add(1, std::memory_order_relaxed);
+    processBytes.fetch_add(size, std::memory_order_relaxed);
+    threadCounts.allocations++;
+    threadCounts.bytes += size;
+    if (void* memory = std::malloc(size ? size : 1)) {
+        return memory;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* memory) noexcept {
+    std::free(memory);
+}
+
+void operator delete(void* memory, std::size_t) noexcept {
+    std::free(memory);
+}
+
+AllocationCounts AllocationStats::process() {
+    return {processAllocations.load(std::memory_order_relaxed), processBytes.load(std::memory_order_relaxed)};
+}
+
+AllocationCounts AllocationStats::thread() {
+    return threadCounts;
+}
+
+AllocationCounts AllocationStats::imgui() {
+    return {imguiAllocations.load(std::memory_order_relaxed), imguiBytes.load(std::memory_order_relaxed)};
+}
+
+void* AllocationStats::imguiAlloc(size_t size, void*) {
+    imguiAllocations.fetch_add(1, std::memory_order_relaxed);
+    imguiBytes.fetch_add(size, std::memory_order_relaxed);
+    threadCounts.allocations++;
+    threadCounts.bytes += size;
+    return std::malloc(size);
+}
+
+void AllocationStats::imguiFree(void* memory, void*) {
+    std::free(memory);
+}
+
+void FrameAllocationStats::beginFrame() {
+    start = AllocationStats::thread();
+}
+
+void FrameAllocationStats::endFrame() {
+    last = AllocationStats::thread() - start;
+    quiet = last.allocations == 0 ? quiet + 1 : 0;
+}
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// Heap allocations counted by the replacement operator new in
+// allocation_stats.cpp and by the ImGui allocator hooks below
+struct AllocationCounts {
+    uint64_t allocations = 0;
+    uint64_t bytes = 0;
+
+    AllocationCounts operator-(const AllocationCounts& start) const {
+        return {allocations - start.allocations, bytes - start.bytes};
+    }
+};
+
+class AllocationStats {
+public:
+    // operator new on every thread since startup
+    static AllocationCounts process();
+
+    // operator new and ImGui on the calling thread
+    static AllocationCounts thread();
+
+    // ImGui on every thread
+    static AllocationCounts imgui();
+
+    // For ImGui::SetAllocatorFunctions(), installed before ImGui::CreateContext()
+    static void* imguiAlloc(size_t size, void* userData);
+    static void imguiFree(void* memory, void* userData);
+};
+
+// Allocations made by the UI thread between beginFrame() and endFrame().
+// An idle frame allocates nothing once widgets and draw lists have grown
+// to their working size
+class FrameAllocationStats {
+public:
+    void beginFrame();
+    void endFrame();
+
+    const AllocationCounts& lastFrame() const { return last; }
+
+    // Frames in a row, up to the last one, that did not allocate
+    uint64_t quietFrames() const { return quiet; }
+
+private:
+    AllocationCounts start;
+    AllocationCounts last;
+    uint64_t quiet = 0;
+};
@@ -0,0 +1,321 @@
+#include "base_metadata.h"
+#include "base_path.h"
+#include "frame_arena.h"
+#include "mapped_file.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <filesystem>
+#include <tuple>
+
+namespace {
+
+const char databaseSignature[8] = {'1', 'C', 'D', 'B', 'M', 'S', 'V', '8'};
+const char* databaseFileName = "1Cv8.1CD";
+
+uint32_t readUInt32LE(const uint8_t* data) {
+    return static_cast<uint32_t>(data[0])
+        | (static_cast<uint32_t>(data[1]) << 8)
+        | (static_cast<uint32_t>(data[2]) << 16)
+        | (static_cast<uint32_t>(data[3]) << 24);
+}
+
+std::string formatSize(uint64_t bytes) {
+    static const char* units[] = {"B", "KB", "MB", "GB", "TB"};
+    double value = static_cast<double>(bytes);
+    size_t unit = 0;
+    while (value >= 1024.0 && unit + 1 < std::size(units)) {
+        value /= 1024.0;
+        unit++;
+    }
+    char buffer[32];
+    if (unit == 0) {
+        std::snprintf(buffer, sizeof(buffer), "%llu %s", static_cast<unsigned long long>(bytes), units[unit]);
+    } else {
+        std::snprintf(buffer, sizeof(buffer), "%.1f %s", value, units[unit]);
+    }
+    return buffer;
+}
+
+std::string formatTime(int64_t secondsSinceEpoch) {
+    std::time_t time = static_cast<std::time_t>(secondsSinceEpoch);
+    std::tm local{};
+#ifdef _WIN32
+    if (localtime_s(&local, &time) != 0) return "";
+#else
+    if (localtime_r(&time, &local) == nullptr) return "";
+#endif
+    char buffer[32];
+    std::strftime(buffer, sizeof(buffer), "%Y-%m-%d %H:%M", &local);
+    return buffer;
+}
+
+} // namespace
+
+std::string BaseInspector::resolveDatabaseFile(const std::string& basePath) {
+    std::filesystem::path path(basePath);
+    if (isDatabaseFileName(path.filename().string())) {
+        return basePath;
+    }
+    return (path / databaseFileName).string();
+}
+
+bool BaseInspector::statFile(const std::string& databaseFile, BaseMetadata& out) {
+    out.databaseFile = databaseFile;
+
+    std::error_code ec;
+    uint64_t size = std::filesystem::file_size(databaseFile, ec);
+    if (ec) {
+        out.error = "database file not found";
+        return false;
+    }
+
+    auto writeTime = std::filesystem::last_write_time(databaseFile, ec);
+    if (ec) {
+        out.error = "cannot read modification time";
+        return false;
+    }
+
+    auto systemTime = std::chrono::file_clock::to_sys(writeTime);
+    out.fileSize = size;
+    out.lastModified = std::chrono::duration_cast<std::chrono::seconds>(systemTime.time_since_epoch()).count();
+    return true;
+}
+
+bool BaseInspector::readHeader(BaseMetadata& out) {
+    MappedFile file;
+    if (!file.open(out.databaseFile, headerMapSize)) {
+        out.valid = false;
+        out.error = "cannot map database file";
+        return false;
+    }
+    return parseHeader(file.data(), file.size(), out);
+}
+
+bool BaseInspector::parseHeader(const uint8_t* data, size_t size, BaseMetadata& out) {
+    out.valid = false;
+
+    // sig[8], ver[4], length (pages), unknown, pagesize (8.3.8+)
+    if (data == nullptr || size < 20) {
+        out.error = "header is truncated";
+        return false;
+    }
+    if (std::memcmp(data, databaseSignature, sizeof(databaseSignature)) != 0) {
+        out.error = "not a 1CD file";
+        return false;
+    }
+
+    const uint8_t* version = data + 8;
+    out.formatVersion = std::to_string(version[0]) + "." + std::to_string(version[1]) + "."
+        + std::to_string(version[2]) + "." + std::to_string(version[3]);
+    out.pageCount = readUInt32LE(data + 12);
+
+    bool hasPageSize = std::make_tuple(version[0], version[1], version[2]) >= std::make_tuple(8, 3, 8);
+    if (hasPageSize) {
+        if (size < 24) {
+            out.error = "header is truncated";
+            return false;
+        }
+        uint32_t pageSize = readUInt32LE(data + 20);
+        bool isPowerOfTwo = pageSize != 0 && (pageSize & (pageSize - 1)) == 0;
+        if (!isPowerOfTwo || pageSize < legacyPageSize || pageSize > 65536) {
+            out.error = "invalid page size";
+            return false;
+        }
+        out.pageSize = pageSize;
+    } else {
+        out.pageSize = legacyPageSize;
+    }
+
+    out.valid = true;
+    out.error.clear();
+    return true;
+}
+
+BaseMetadata BaseInspector::inspect(const std::string& basePath) {
+    BaseMetadata metadata;
+    if (statFile(resolveDatabaseFile(basePath), metadata)) {
+        readHeader(metadata);
+    }
+    metadata.summary = formatSummary(metadata);
+    return metadata;
+}
+
+std::string BaseInspector::formatSummary(const BaseMetadata& metadata) {
+    if (!metadata.valid) {
+        return metadata.error;
+    }
+    return formatSize(metadata.fileSize) + "  " + metadata.formatVersion + "  "
+        + formatSize(metadata.pageSize) + " pages  " + formatTime(metadata.lastModified);
+}
+
+BaseMetadataCache::BaseMetadataCache(unsigned workerCount) {
+    if (workerCount == 0) {
+        workerCount = std::clamp(std::thread::hardware_concurrency(), 1u, 4u);
+    }
+    for (unsigned i = 0; i < workerCount; ++i) {
+        workers.emplace_back(&BaseMetadataCache::workerLoop, this);
+    }
+}
+
+BaseMetadataCache::~BaseMetadataCache() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+        queue.clear();
+    }
+    wakeCondition.notify_all();
+    for (auto& worker : workers) {
+        worker.join();
+    }
+}
+
+void BaseMetadataCache::request(const std::string& input) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!pending.insert(input).second) {
+            return;
+        }
+        queue.push_back(input);
+    }
+    wakeCondition.notify_one();
+}
+
+std::optional<BaseMetadata> BaseMetadataCache::lookup(const std::string& input) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = byInput.find(input);
+    if (it == byInput.end()) {
+        return std::nullopt;
+    }
+    return it->second;
+}
+
+const char* BaseMetadataCache::lookupSummary(const std::string& input, FrameArena& arena) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = byInput.find(input);
+    if (it == byInput.end()) {
+        return nullptr;
+    }
+    return arena.copy(it->second.summary);
+}
+
+void BaseMetadataCache::waitIdle() {
+    std::unique_lock<std::mutex> lock(mutex);
+    idleCondition.wait(lock, [this] { return queue.empty() && busyWorkers == 0; });
+}
+
+std::vector<std::string> BaseMetadataCache::serialize() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    std::vector<std::string> lines;
+    for (const auto& [file, metadata] : byFile) {
+        if (!metadata.valid) continue;
+        // Path goes last so it may contain any character except line breaks
+        lines.push_back(std::to_string(metadata.fileSize) + "|" + std::to_string(metadata.lastModified) + "|"
+            + metadata.formatVersion + "|" + std::to_string(metadata.pageSize) + "|"
+            + std::to_string(metadata.pageCount) + "|" + file);
+    }
+    return lines;
+}
+
+void BaseMetadataCache::deserialize(const std::vector<std::string>& lines) {
+    std::lock_guard<std::mutex> lock(mutex);
+    for (const auto& line : lines) {
+        std::vector<std::string> fields;
+        size_t start = 0;
+        while (fields.size() < 5) {
+            size_t end = line.find('|', start);
+            if (end == std::string::npos) break;
+            fields.push_back(line.substr(start, end - start));
+            start = end + 1;
+        }
+        if (fields.size() != 5 || start >= line.size()) {
+            continue; // Skip malformed entries
+        }
+
+        try {
+            BaseMetadata metadata;
+            metadata.databaseFile = line.substr(start);
+            metadata.fileSize = std::stoull(fields[0]);
+            metadata.lastModified = std::stoll(fields[1]);
+            metadata.formatVersion = fields[2];
+            metadata.pageSize = static_cast<uint32_t>(std::stoul(fields[3]));
+            metadata.pageCount = static_cast<uint32_t>(std::stoul(fields[4]));
+            metadata.valid = true;
+            metadata.summary = BaseInspector::formatSummary(metadata);
+            byFile[metadata.databaseFile] = metadata;
+        } catch (const std::exception&) {
+            continue;
+        }
+    }
+}
+
+size_t BaseMetadataCache::hitCount() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return hits;
+}
+
+size_t BaseMetadataCache::missCount() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return misses;
+}
+
+void BaseMetadataCache::workerLoop() {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+        wakeCondition.wait(lock, [this] { return stopping || !queue.empty(); });
+        if (stopping) {
+            return;
+        }
+
+        std::string input = std::move(queue.front());
+        queue.pop_front();
+        busyWorkers++;
+
+        lock.unlock();
+        BaseMetadata metadata = process(input);
+        lock.lock();
+
+        byInput[input] = std::move(metadata);
+        pending.erase(input);
+        busyWorkers--;
+        if (queue.empty() && busyWorkers == 0) {
+            idleCondition.notify_all();
+        }
+    }
+}
+
+BaseMetadata BaseMetadataCache::process(const std::string& input) {
+    BaseMetadata metadata;
+
+    auto basePath = extractBasePath(input);
+    if (!basePath) {
+        metadata.error = "not a file base";
+        metadata.summary = BaseInspector::formatSummary(metadata);
+        return metadata;
+    }
+
+    if (!BaseInspector::statFile(BaseInspector::resolveDatabaseFile(*basePath), metadata)) {
+        metadata.summary = BaseInspector::formatSummary(metadata);
+        return metadata;
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = byFile.find(metadata.databaseFile);
+        if (it != byFile.end() && it->second.fileSize == metadata.fileSize
+            && it->second.lastModified == metadata.lastModified) {
+            hits++;
+            return it->second;
+        }
+        misses++;
+    }
+
+    BaseInspector::readHeader(metadata);
+    metadata.summary = BaseInspector::formatSummary(metadata);
+
+    std::lock_guard<std::mutex> lock(mutex);
+    byFile[metadata.databaseFile] = metadata;
+    return metadata;
+}
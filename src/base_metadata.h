@@ -0,0 +1,102 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+
+class FrameArena;
+
+// Facts about a file base read from the header of its 1Cv8.1CD
+struct BaseMetadata {
+    std::string databaseFile;   // Resolved path to 1Cv8.1CD
+    uint64_t fileSize = 0;      // Bytes
+    int64_t lastModified = 0;   // Seconds since the Unix epoch
+    std::string formatVersion;  // e.g. "8.3.8.0"
+    uint32_t pageSize = 0;      // Bytes
+    uint32_t pageCount = 0;
+    bool valid = false;
+    std::string error;          // Set when valid is false
+    std::string summary;        // Preformatted text for the history list
+};
+
+class BaseInspector {
+public:
+    // Only the leading page of the file is mapped, the header itself is 24 bytes
+    static constexpr size_t headerMapSize = 4096;
+    static constexpr uint32_t legacyPageSize = 4096;
+
+    // Returns the 1Cv8.1CD path for a base directory or the file path itself
+    static std::string resolveDatabaseFile(const std::string& basePath);
+
+    // Fills databaseFile, fileSize and lastModified. Returns false if the file is missing
+    static bool statFile(const std::string& databaseFile, BaseMetadata& out);
+
+    // Maps the header page of out.databaseFile and parses it
+    static bool readHeader(BaseMetadata& out);
+
+    // Parses the 1CD root header (signature, version, page count, page size)
+    static bool parseHeader(const uint8_t* data, size_t size, BaseMetadata& out);
+
+    // Resolves, stats and reads the header of a base in one go
+    static BaseMetadata inspect(const std::string& basePath);
+
+    // Formats size, version, page size and modification time for display
+    static std::string formatSummary(const BaseMetadata& metadata);
+};
+
+// Gathers BaseMetadata for history entries on background threads.
+// Header reads are cached by (database file, size, mtime), so a base is only
+// re-read when its file actually changes.
+class BaseMetadataCache {
+public:
+    explicit BaseMetadataCache(unsigned workerCount = 0);
+    ~BaseMetadataCache();
+
+    BaseMetadataCache(const BaseMetadataCache&) = delete;
+    BaseMetadataCache& operator=(const BaseMetadataCache&) = delete;
+
+    // Queues (re)inspection of the base referenced by raw input. No-op if already queued
+    void request(const std::string& input);
+
+    // Returns the last gathered metadata for input, std::nullopt while it is pending
+    std::optional<BaseMetadata> lookup(const std::string& input) const;
+
+    // Just the summary, copied into the frame arena instead of the whole record. Null while pending
+    const char* lookupSummary(const std::string& input, FrameArena& arena) const;
+
+    // Blocks until all queued requests are processed
+    void waitIdle();
+
+    // Persistence of cached headers, one entry per line
+    std::vector<std::string> serialize() const;
+    void deserialize(const std::vector<std::string>& lines);
+
+    // Number of requests answered from cache / by reading the header
+    size_t hitCount() const;
+    size_t missCount() const;
+
+private:
+    void workerLoop();
+    BaseMetadata process(const std::string& input);
+
+    mutable std::mutex mutex;
+    std::condition_variable wakeCondition;
+    std::condition_variable idleCondition;
+    std::deque<std::string> queue;
+    std::set<std::string> pending;
+    std::map<std::string, BaseMetadata> byInput;
+    std::map<std::string, BaseMetadata> byFile;
+    size_t busyWorkers = 0;
+    size_t hits = 0;
+    size_t misses = 0;
+    bool stopping = false;
+    std::vector<std::thread> workers;
+};
@@ -0,0 +1,142 @@
+#include "base_path.h"
+#include "connection_string.h"
+#include <algorithm>
+#include <cctype>
+#include <regex>
+
+namespace {
+
+bool isAbsoluteBasePath(const std::string& path) {
+    bool drivePath = path.size() >= 3 && std::isalpha(static_cast<unsigned char>(path[0])) && path[1] == ':' && (path[2] == '\\' || path[2] == '/');
+    bool uncPath = path.size() > 2 && path[0] == '\\' && path[1] == '\\';
+#ifndef _WIN32
+    if (!path.empty() && path[0] == '/') {
+        return true;
+    }
+#endif
+    return drivePath || uncPath;
+}
+
+} // namespace
+
+std::optional<std::string> extractBasePath(const std::string& input) {
+    // Well-formed connection strings, including UNC paths and quoted values with ; or ""
+    ConnectionString connection;
+    if (parseConnectionString(input, connection)) {
+        if (connection.kind != ConnectionKind::File) {
+            return std::nullopt;
+        }
+        std::string path = connection.file.str();
+        if (isAbsoluteBasePath(path)) {
+            if (path.length() > 3 && path.back() == '\\') {
+                path.pop_back();
+            } else if (path.length() > 1 && path.back() == '/') {
+                path.pop_back();
+            }
+            return path;
+        }
+    }
+
+    // Bare or quoted path, the usual input, without running the regex below
+    std::string bare = input.size() >= 2 && input.front() == '"' && input.back() == '"' ? input.substr(1, input.size() - 2) : input;
+    if (bare.find('"') == std::string::npos && isAbsoluteBasePath(bare)) {
+        if (bare.length() > 3 && (bare.back() == '\\' || bare.back() == '/')) {
+            bare.pop_back();
+        }
+        return bare;
+    }
+
+    // Drive or UNC path anywhere in the input, e.g. a bare or quoted path. The
+    // drive letter must start a word so URLs like https://host are not taken
+    static const std::regex filepathRegex("((?:\\b[a-zA-Z]:[\\\\/]|\\\\\\\\[^\\\\\"]+\\\\)[^\"]+?)(?=\"|$)", std::regex_constants::ECMAScript);
+    std::smatch m;
+
+    if (std::regex_search(input, m, filepathRegex)) {
+        std::string path = m[0].str();
+
+        // Remove any trailing separator except for root paths like "C:\"
+        if (path.length() > 3 && (path.back() == '\\' || path.back() == '/')) {
+            path.pop_back();
+        }
+        return path;
+    }
+
+#ifndef _WIN32
+    // Linux file bases: an absolute path at the start of the input or of a quoted value
+    static const std::regex posixPathRegex("(?:^|\")(/[^\"]+?)(?=\"|$)", std::regex_constants::ECMAScript);
+    if (std::regex_search(input, m, posixPathRegex)) {
+        std::string path = m[1].str();
+        if (path.length() > 1 && path.back() == '/') {
+            path.pop_back();
+        }
+        return path;
+    }
+#endif
+
+    return std::nullopt;
+}
+
+std::string foldCase(const std::string& text) {
+    std::string result = text;
+    for (size_t i = 0; i < result.size(); ++i) {
+        unsigned char c = static_cast<unsigned char>(result[i]);
+        if (c >= 'A' && c <= 'Z') {
+            result[i] = static_cast<char>(c + ('a' - 'A'));
+        } else if (c == 0xD0 && i + 1 < result.size()) {
+            // U+0400..U+042F: Ѐ-Џ to ѐ-џ (D1 90..9F), А-П to а-п (D0 B0..BF), Р-Я to р-я (D1 80..8F)
+            unsigned char next = static_cast<unsigned char>(result[i + 1]);
+            if (next >= 0x80 && next <= 0x8F) {
+                result[i] = static_cast<char>(0xD1);
+                result[i + 1] = static_cast<char>(next + 0x10);
+            } else if (next >= 0x90 && next <= 0x9F) {
+                result[i + 1] = static_cast<char>(next + 0x20);
+            } else if (next >= 0xA0 && next <= 0xAF) {
+                result[i] = static_cast<char>(0xD1);
+                result[i + 1] = static_cast<char>(next - 0x20);
+            }
+            ++i;
+        }
+    }
+    return result;
+}
+
+std::string canonicalBasePath(const std::string& path) {
+    bool posixPath = !path.empty() && path[0] == '/';
+    char separator = posixPath ? '/' : '\\';
+
+    // Unify separators and collapse runs, keeping the leading \\ of UNC paths
+    std::string result;
+    result.reserve(path.size());
+    for (char c : path) {
+        if (!posixPath && c == '/') {
+            c = '\\';
+        }
+        if (c == separator && !result.empty() && result.back() == separator && !(result.size() == 1 && !posixPath)) {
+            continue;
+        }
+        result.push_back(c);
+    }
+
+    // The database file stands for its directory
+    size_t nameStart = result.find_last_of(separator);
+    if (nameStart != std::string::npos && isDatabaseFileName(result.substr(nameStart + 1))) {
+        result.erase(nameStart + 1);
+    }
+
+    // Drop trailing separators, but not from roots like C:\ or /
+    size_t rootLength = posixPath ? 1 : (result.size() >= 3 && result[1] == ':' ? 3 : 2);
+    while (result.size() > rootLength && result.back() == separator) {
+        result.pop_back();
+    }
+
+    return posixPath ? result : foldCase(result);
+}
+
+bool isDatabaseFileName(const std::string& filename) {
+    static const std::string databaseFileName = "1cv8.1cd";
+    if (filename.size() != databaseFileName.size()) {
+        return false;
+    }
+    return std::equal(filename.begin(), filename.end(), databaseFileName.begin(),
+        [](unsigned char a, unsigned char b) { return std::tolower(a) == b; });
+}
@@ -0,0 +1,23 @@
+#pragma once
+
+#include <optional>
+#include <string>
+
+// Extracts a file base path (X:\..., X:/... or \\server\share\...) from raw user input
+// such as `File="C:\Bases\Trade";` or a quoted path. Trailing backslashes are
+// removed except for drive roots. Outside Windows absolute POSIX paths are
+// accepted as well. Returns std::nullopt if no path is found, including for
+// server and web bases.
+std::optional<std::string> extractBasePath(const std::string& input);
+
+// Lower case for ASCII and Cyrillic letters (UTF-8), the letters Windows
+// compares case-insensitively in base paths. Other bytes are kept
+std::string foldCase(const std::string& text);
+
+// Canonical form of an extracted base path for comparisons: separators
+// unified and collapsed, no trailing separator or 1Cv8.1CD file name, and
+// case-folded for drive and UNC paths (POSIX paths keep their case)
+std::string canonicalBasePath(const std::string& path);
+
+// Returns true if the file name is 1Cv8.1CD (case-insensitive)
+bool isDatabaseFileName(const std::string& filename);
@@ -0,0 +1,203 @@
+#include "base_snapshot.h"
+#include <algorithm>
+#include <cstdio>
+#include <ctime>
+#include <filesystem>
+
+namespace {
+
+const char* partialSuffix = ".partial";
+
+// FNV-1a, stable across compilers so retention keeps finding older snapshots
+uint32_t pathHash(const std::string& path) {
+    uint32_t hash = 2166136261u;
+    for (unsigned char c : path) {
+        hash ^= c;
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+std::string timestamp() {
+    std::time_t now = std::time(nullptr);
+    std::tm local{};
+#ifdef _WIN32
+    localtime_s(&local, &now);
+#else
+    localtime_r(&now, &local);
+#endif
+    char buffer[32];
+    std::strftime(buffer, sizeof(buffer), "%Y%m%d_%H%M%S", &local);
+    return buffer;
+}
+
+bool endsWith(const std::string& value, const std::string& suffix) {
+    return value.size() >= suffix.size() && value.compare(value.size() - suffix.size(), suffix.size(), suffix) == 0;
+}
+
+} // namespace
+
+BaseSnapshot::BaseSnapshot(std::string baseDirectory, std::string snapshotRoot, size_t retention)
+    : baseDirectory(std::move(baseDirectory)), snapshotRoot(std::move(snapshotRoot)), retention(retention) {
+}
+
+BaseSnapshot::~BaseSnapshot() {
+    if (worker.joinable()) {
+        cancel();
+        worker.join();
+    }
+}
+
+void BaseSnapshot::start() {
+    if (worker.joinable()) {
+        return;
+    }
+    state = State::Running;
+    worker = std::thread(&BaseSnapshot::run, this);
+}
+
+bool BaseSnapshot::waitFor(std::chrono::milliseconds timeout) {
+    std::unique_lock<std::mutex> lock(mutex);
+    return finishedCondition.wait_for(lock, timeout, [this] { return isFinished(); });
+}
+
+void BaseSnapshot::cancel() {
+    progress.cancelled = true;
+}
+
+bool BaseSnapshot::markBaseOpened() {
+    std::lock_guard<std::mutex> lock(mutex);
+    if (copyDone) {
+        return false;
+    }
+    baseOpened = true;
+    return true;
+}
+
+bool BaseSnapshot::isFinished() const {
+    State current = state.load();
+    return current == State::Completed || current == State::Failed || current == State::Cancelled
+        || current == State::Inconsistent;
+}
+
+std::string BaseSnapshot::getDestination() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return destination;
+}
+
+std::string BaseSnapshot::getError() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return error;
+}
+
+FileCopier::Method BaseSnapshot::getMethod() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return method;
+}
+
+std::string BaseSnapshot::snapshotPrefix(const std::string& baseDirectory) {
+    std::string folder = std::filesystem::path(baseDirectory).filename().string();
+    if (folder.empty()) {
+        folder = "base";
+    }
+    char hash[16];
+    std::snprintf(hash, sizeof(hash), "%08x", pathHash(baseDirectory));
+    return folder + "_" + hash + "_";
+}
+
+std::vector<std::string> BaseSnapshot::applyRetention(const std::string& snapshotRoot, const std::string& baseDirectory, size_t keep) {
+    std::vector<std::string> removed;
+    if (keep == 0) {
+        return removed; // Retention disabled
+    }
+
+    std::error_code ec;
+    std::string prefix = snapshotPrefix(baseDirectory);
+    std::vector<std::filesystem::path> snapshots;
+    for (const auto& entry : std::filesystem::directory_iterator(snapshotRoot, ec)) {
+        std::string name = entry.path().filename().string();
+        if (entry.is_directory() && name.rfind(prefix, 0) == 0 && !endsWith(name, partialSuffix)) {
+            snapshots.push_back(entry.path());
+        }
+    }
+
+    // Timestamps sort lexicographically, oldest first
+    std::sort(snapshots.begin(), snapshots.end());
+    while (snapshots.size() > keep) {
+        std::filesystem::remove_all(snapshots.front(), ec);
+        removed.push_back(snapshots.front().string());
+        snapshots.erase(snapshots.begin());
+    }
+    return removed;
+}
+
+void BaseSnapshot::run() {
+    std::filesystem::path source(baseDirectory);
+    std::filesystem::path target = std::filesystem::path(snapshotRoot) / (snapshotPrefix(baseDirectory) + timestamp());
+    for (int suffix = 2; std::filesystem::exists(target); ++suffix) {
+        target = std::filesystem::path(target.string() + "_" + std::to_string(suffix));
+    }
+    std::filesystem::path partial(target.string() + partialSuffix);
+
+    State finalState = State::Completed;
+    std::string finalError;
+    FileCopier::Method largestFileMethod = FileCopier::Method::Buffered;
+
+    try {
+        std::vector<std::filesystem::directory_entry> entries;
+        uint64_t totalBytes = 0;
+        for (const auto& entry : std::filesystem::recursive_directory_iterator(source)) {
+            if (entry.is_regular_file()) {
+                totalBytes += entry.file_size();
+            }
+            entries.push_back(entry);
+        }
+        progress.bytesTotal = totalBytes;
+
+        std::filesystem::create_directories(partial);
+        uint64_t largestFile = 0;
+        for (const auto& entry : entries) {
+            std::filesystem::path destination = partial / std::filesystem::relative(entry.path(), source);
+            if (entry.is_directory()) {
+                std::filesystem::create_directories(destination);
+            } else if (entry.is_regular_file()) {
+                FileCopier::Method used = FileCopier::copyFile(entry.path().string(), destination.string(), &progress);
+                if (entry.file_size() >= largestFile) {
+                    largestFile = entry.file_size();
+                    largestFileMethod = used;
+                }
+            }
+        }
+
+        // 1Cv8.1CD may have been written to during the copy, so it must not
+        // look complete or push a consistent snapshot out of retention
+        bool opened = false;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            copyDone = true;
+            opened = baseOpened;
+        }
+        if (opened) {
+            finalState = State::Inconsistent;
+            finalError = "The base was opened before the copy finished";
+            target = partial;
+        } else {
+            std::filesystem::rename(partial, target);
+            applyRetention(snapshotRoot, baseDirectory, retention);
+        }
+    } catch (const std::exception& e) {
+        std::error_code ec;
+        std::filesystem::remove_all(partial, ec);
+        finalState = progress.cancelled ? State::Cancelled : State::Failed;
+        finalError = e.what();
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        destination = finalState == State::Completed || finalState == State::Inconsistent ? target.string() : "";
+        error = finalError;
+        method = largestFileMethod;
+        state = finalState;
+    }
+    finishedCondition.notify_all();
+}
@@ -0,0 +1,82 @@
+#pragma once
+
+#include "file_copier.h"
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Background copy of a file base directory taken before opening it in the Configurator.
+// The copy is written to "<name>.partial" and renamed once complete, so an
+// interrupted snapshot is never mistaken for a usable one. A copy the
+// Configurator may have written into while it ran stays ".partial" too.
+class BaseSnapshot {
+public:
+    enum class State {
+        Pending,
+        Running,
+        Completed,
+        Failed,
+        Cancelled,
+        Inconsistent    // Copied while the base was open; kept as .partial, left out of retention
+    };
+
+    BaseSnapshot(std::string baseDirectory, std::string snapshotRoot, size_t retention);
+    ~BaseSnapshot();
+
+    BaseSnapshot(const BaseSnapshot&) = delete;
+    BaseSnapshot& operator=(const BaseSnapshot&) = delete;
+
+    // Starts copying on a background thread
+    void start();
+
+    // Waits until the snapshot finishes or the timeout expires. Returns true if finished
+    bool waitFor(std::chrono::milliseconds timeout);
+
+    // Requests cancellation, the partial copy is removed
+    void cancel();
+
+    // Records that the base is being opened. Returns true if the copy was not
+    // done yet: the snapshot then ends Inconsistent instead of Completed
+    bool markBaseOpened();
+
+    State getState() const { return state.load(); }
+    bool isFinished() const;
+    uint64_t getBytesCopied() const { return progress.bytesCopied.load(); }
+    uint64_t getBytesTotal() const { return progress.bytesTotal.load(); }
+    const std::string& getBaseDirectory() const { return baseDirectory; }
+
+    // Valid once finished; the .partial directory of an Inconsistent snapshot
+    std::string getDestination() const;
+    std::string getError() const;
+    FileCopier::Method getMethod() const;
+
+    // Snapshot directories of a base are named "<folder>_<path hash>_<YYYYmmdd_HHMMSS>"
+    static std::string snapshotPrefix(const std::string& baseDirectory);
+
+    // Deletes the oldest complete snapshots of a base so that at most keep remain.
+    // Returns the removed directories.
+    static std::vector<std::string> applyRetention(const std::string& snapshotRoot, const std::string& baseDirectory, size_t keep);
+
+private:
+    void run();
+
+    std::string baseDirectory;
+    std::string snapshotRoot;
+    size_t retention;
+
+    CopyProgress progress;
+    std::atomic<State> state{State::Pending};
+    std::thread worker;
+
+    mutable std::mutex mutex;
+    std::condition_variable finishedCondition;
+    bool copyDone = false;
+    bool baseOpened = false;
+    std::string destination;
+    std::string error;
+    FileCopier::Method method = FileCopier::Method::Buffered;
+};
@@ -0,0 +1,153 @@
+#include "batch_resolver.h"
+#include "base_metadata.h"
+#include "json.h"
+#include <algorithm>
+#include <thread>
+#include <vector>
+
+BatchResolver::BatchResolver(const RUN1C& launcher, Options options)
+    : launcher(launcher), options(options) {
+    if (this->options.threads == 0) {
+        this->options.threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+    if (this->options.maxInFlight == 0) {
+        this->options.maxInFlight = static_cast<size_t>(this->options.threads) * 64;
+    }
+}
+
+std::string BatchResolver::resolve(size_t index, const std::string& input, bool& valid) const {
+    std::string line = "{\"index\":" + std::to_string(index) + ",\"input\":";
+    appendJsonString(line, input);
+
+    std::string error;
+    auto plan = launcher.prepare(input, options.configMode, &error);
+    valid = plan.has_value();
+    if (!plan) {
+        line += ",\"valid\":false,\"error\":";
+        appendJsonString(line, error);
+        line += '}';
+        return line;
+    }
+
+    line += ",\"valid\":true,\"path\":";
+    appendJsonString(line, plan->basePath);
+    line += ",\"mode\":";
+    appendJsonString(line, plan->args.front());
+    line += ",\"args\":[";
+    for (size_t i = 0; i < plan->args.size(); ++i) {
+        if (i > 0) {
+            line += ',';
+        }
+        appendJsonString(line, plan->args[i]);
+    }
+    line += ']';
+
+    if (options.withMetadata && plan->kind == ConnectionKind::File) {
+        BaseMetadata metadata = BaseInspector::inspect(plan->basePath);
+        if (metadata.valid) {
+            line += ",\"metadata\":{\"size\":" + std::to_string(metadata.fileSize) + ",\"version\":";
+            appendJsonString(line, metadata.formatVersion);
+            line += ",\"pageSize\":" + std::to_string(metadata.pageSize)
+                + ",\"pageCount\":" + std::to_string(metadata.pageCount)
+                + ",\"modified\":" + std::to_string(metadata.lastModified) + '}';
+        } else {
+            line += ",\"metadata\":null,\"metadataError\":";
+            appendJsonString(line, metadata.error);
+        }
+    }
+
+    line += '}';
+    return line;
+}
+
+// Called with the mutex held
+void BatchResolver::emit(size_t index, std::string line, std::ostream& out) {
+    if (!options.ordered) {
+        if (!line.empty()) {
+            out << line << '\n';
+        }
+        --inFlight;
+        slotCondition.notify_one();
+        return;
+    }
+
+    // Results wait in the buffer until every earlier index is written; inFlight
+    // covers the buffer too, which keeps it bounded by maxInFlight
+    reorderBuffer.emplace(index, std::move(line));
+    while (!reorderBuffer.empty() && reorderBuffer.begin()->first == nextIndex) {
+        if (!reorderBuffer.begin()->second.empty()) {
+            out << reorderBuffer.begin()->second << '\n';
+        }
+        reorderBuffer.erase(reorderBuffer.begin());
+        ++nextIndex;
+        --inFlight;
+    }
+    slotCondition.notify_one();
+}
+
+void BatchResolver::workerLoop(std::ostream& out) {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+        jobCondition.wait(lock, [this] { return !jobs.empty() || inputFinished; });
+        if (jobs.empty()) {
+            return;
+        }
+
+        Job job = std::move(jobs.front());
+        jobs.pop_front();
+        lock.unlock();
+
+        bool valid = false;
+        std::string line = resolve(job.index, job.input, valid);
+
+        lock.lock();
+        ++(valid ? summary.valid : summary.invalid);
+        emit(job.index, std::move(line), out);
+    }
+}
+
+BatchResolver::Summary BatchResolver::run(std::istream& in, std::ostream& out) {
+    summary = Summary();
+    reorderBuffer.clear();
+    nextIndex = 0;
+    inFlight = 0;
+    inputFinished = false;
+
+    std::vector<std::thread> workers;
+    for (unsigned i = 0; i < options.threads; ++i) {
+        workers.emplace_back(&BatchResolver::workerLoop, this, std::ref(out));
+    }
+
+    std::string input;
+    for (size_t index = 0; std::getline(in, input); ++index) {
+        if (!input.empty() && input.back() == '\r') {
+            input.pop_back();
+        }
+
+        std::unique_lock<std::mutex> lock(mutex);
+        slotCondition.wait(lock, [this] { return inFlight < options.maxInFlight; });
+        ++inFlight;
+
+        if (input.empty()) {
+            // Keeps the ordered output contiguous without queueing any work
+            emit(index, std::string(), out);
+            continue;
+        }
+
+        ++summary.total;
+        jobs.push_back({index, std::move(input)});
+        jobCondition.notify_one();
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        inputFinished = true;
+    }
+    jobCondition.notify_all();
+
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    out.flush();
+    return summary;
+}
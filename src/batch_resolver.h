@@ -0,0 +1,63 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <istream>
+#include <map>
+#include <mutex>
+#include <ostream>
+#include <string>
+
+#include "launcher.h"
+
+// Resolves one input per line on a pool of worker threads and writes one JSON
+// object per line (NDJSON) as results complete. Lines are read only while
+// fewer than maxInFlight results are outstanding, so memory stays bounded
+// regardless of input size.
+class BatchResolver {
+public:
+    struct Options {
+        unsigned threads = 0;       // 0 = hardware concurrency
+        size_t maxInFlight = 0;     // 0 = 64 per thread
+        bool ordered = false;       // Emit results in input order
+        bool configMode = false;    // Resolve as for Shift+Enter
+        bool withMetadata = true;   // Read the 1CD header of valid bases
+    };
+
+    struct Summary {
+        size_t total = 0;
+        size_t valid = 0;
+        size_t invalid = 0;
+    };
+
+    BatchResolver(const RUN1C& launcher, Options options);
+
+    // Reads inputs until EOF. index is the 0-based line number, blank lines produce no output
+    Summary run(std::istream& in, std::ostream& out);
+
+    // Resolves a single input into its JSON line (without the trailing newline)
+    std::string resolve(size_t index, const std::string& input, bool& valid) const;
+
+private:
+    struct Job {
+        size_t index;
+        std::string input;
+    };
+
+    void workerLoop(std::ostream& out);
+    void emit(size_t index, std::string line, std::ostream& out);
+
+    const RUN1C& launcher;
+    Options options;
+
+    std::mutex mutex;
+    std::condition_variable jobCondition;
+    std::condition_variable slotCondition;
+    std::deque<Job> jobs;
+    std::map<size_t, std::string> reorderBuffer;
+    size_t nextIndex = 0;
+    size_t inFlight = 0;
+    bool inputFinished = false;
+    Summary summary;
+};
@@ -0,0 +1,128 @@
+#include "cancellation.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <map>
+#include <mutex>
+#include <thread>
+#include <utility>
+
+namespace detail {
+
+struct CancellationState {
+    std::mutex mutex;
+    std::condition_variable callbacksDone;
+    std::atomic<bool> cancelled{false};
+    std::map<uint64_t, std::function<void()>> callbacks;
+    uint64_t nextId = 1;
+    bool running = false;                   // cancel() is running the callbacks
+    std::thread::id runningThread;
+    CancellationRegistration parentRegistration;
+
+    void cancel() {
+        std::map<uint64_t, std::function<void()>> toRun;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (cancelled.load(std::memory_order_relaxed)) {
+                return;
+            }
+            cancelled.store(true, std::memory_order_release);
+            toRun.swap(callbacks);
+            running = true;
+            runningThread = std::this_thread::get_id();
+        }
+
+        for (auto& [id, callback] : toRun) {
+            callback();
+        }
+
+        std::lock_guard<std::mutex> lock(mutex);
+        running = false;
+        callbacksDone.notify_all();
+    }
+};
+
+} // namespace detail
+
+CancellationRegistration::CancellationRegistration(std::shared_ptr<detail::CancellationState> state, uint64_t id)
+    : state(std::move(state)), id(id) {
+}
+
+CancellationRegistration::CancellationRegistration(CancellationRegistration&& other) noexcept
+    : state(std::move(other.state)), id(other.id) {
+}
+
+CancellationRegistration& CancellationRegistration::operator=(CancellationRegistration&& other) noexcept {
+    if (this != &other) {
+        reset();
+        state = std::move(other.state);
+        id = other.id;
+    }
+    return *this;
+}
+
+CancellationRegistration::~CancellationRegistration() {
+    reset();
+}
+
+void CancellationRegistration::reset() {
+    if (!state) {
+        return;
+    }
+    {
+        std::unique_lock<std::mutex> lock(state->mutex);
+        // Not in the map any more: cancel() took it. Unless this is that very
+        // callback unregistering itself, wait until the batch has returned
+        if (state->callbacks.erase(id) == 0 && state->running && state->runningThread != std::this_thread::get_id()) {
+            state->callbacksDone.wait(lock, [this] { return !state->running; });
+        }
+    }
+    state.reset();
+}
+
+bool CancellationToken::isCancelled() const {
+    return state && state->cancelled.load(std::memory_order_acquire);
+}
+
+void CancellationToken::throwIfCancelled() const {
+    if (isCancelled()) {
+        throw TaskCancelled();
+    }
+}
+
+CancellationRegistration CancellationToken::onCancel(std::function<void()> callback) const {
+    if (!state) {
+        return {};
+    }
+    {
+        std::lock_guard<std::mutex> lock(state->mutex);
+        if (!state->cancelled.load(std::memory_order_relaxed)) {
+            uint64_t id = state->nextId++;
+            state->callbacks.emplace(id, std::move(callback));
+            return CancellationRegistration(state, id);
+        }
+    }
+    callback();
+    return {};
+}
+
+CancellationSource::CancellationSource() : state(std::make_shared<detail::CancellationState>()) {
+}
+
+CancellationSource::CancellationSource(const CancellationToken& parent) : CancellationSource() {
+    // The parent holds a weak reference only, so a long-lived parent does not keep children alive
+    std::weak_ptr<detail::CancellationState> child = state;
+    state->parentRegistration = parent.onCancel([child] {
+        if (auto target = child.lock()) {
+            target->cancel();
+        }
+    });
+}
+
+bool CancellationSource::isCancelled() const {
+    return state->cancelled.load(std::memory_order_acquire);
+}
+
+void CancellationSource::cancel() {
+    state->cancel();
+}
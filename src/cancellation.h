@@ -0,0 +1,71 @@
+#pragma once
+
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <memory>
+
+namespace detail {
+struct CancellationState;
+}
+
+// Thrown by throwIfCancelled() and by awaits that observe a cancelled token
+class TaskCancelled : public std::exception {
+public:
+    const char* what() const noexcept override { return "task cancelled"; }
+};
+
+// Keeps a cancellation callback registered. Destroying or resetting it
+// unregisters the callback; if the callback is running on another thread at
+// that moment, this waits for it to return, so whatever it captured can go
+class CancellationRegistration {
+public:
+    CancellationRegistration() = default;
+    CancellationRegistration(std::shared_ptr<detail::CancellationState> state, uint64_t id);
+    CancellationRegistration(CancellationRegistration&& other) noexcept;
+    CancellationRegistration& operator=(CancellationRegistration&& other) noexcept;
+    ~CancellationRegistration();
+
+    void reset();
+
+private:
+    std::shared_ptr<detail::CancellationState> state;
+    uint64_t id = 0;
+};
+
+// Read side of a CancellationSource. A default-constructed token is never cancelled
+class CancellationToken {
+public:
+    CancellationToken() = default;
+
+    bool isCancelled() const;
+    bool canBeCancelled() const { return state != nullptr; }
+    void throwIfCancelled() const;
+
+    // Runs callback on the thread that cancels, or right here if the token is
+    // cancelled already. It runs at most once
+    [[nodiscard]] CancellationRegistration onCancel(std::function<void()> callback) const;
+
+private:
+    friend class CancellationSource;
+    explicit CancellationToken(std::shared_ptr<detail::CancellationState> state) : state(std::move(state)) {}
+
+    std::shared_ptr<detail::CancellationState> state;
+};
+
+// Copies share one cancellation state
+class CancellationSource {
+public:
+    CancellationSource();
+    // Also cancelled when parent is, e.g. a timeout under a caller's token
+    explicit CancellationSource(const CancellationToken& parent);
+
+    CancellationToken token() const { return CancellationToken(state); }
+    bool isCancelled() const;
+
+    // Runs the registered callbacks on the calling thread. Later calls do nothing
+    void cancel();
+
+private:
+    std::shared_ptr<detail::CancellationState> state;
+};
@@ -0,0 +1,250 @@
+#include "command_line.h"
+#include "batch_resolver.h"
+#include "config.h"
+#include "error_handler.h"
+#include "history.h"
+#include "ibases_importer.h"
+#include "launcher.h"
+#include "persistent_storage.h"
+#include "platform_registry.h"
+#include "process_spawner.h"
+#include "single_instance.h"
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+
+CommandLineOptions parseCommandLine(const std::vector<std::string>& args) {
+    CommandLineOptions options;
+
+    for (size_t i = 0; i < args.size(); ++i) {
+        const std::string& arg = args[i];
+        if (arg == "--launch") {
+            if (i + 1 >= args.size()) {
+                options.command = CommandLineOptions::Command::Invalid;
+                options.error = "--launch requires an input";
+                return options;
+            }
+            options.command = CommandLineOptions::Command::Launch;
+            options.input = args[++i];
+        } else if (arg == "--resolve") {
+            options.command = CommandLineOptions::Command::Resolve;
+        } else if (arg == "--import-ibases") {
+            options.command = CommandLineOptions::Command::Import;
+            if (i + 1 < args.size() && args[i + 1].rfind("--", 0) != 0) {
+                options.inputFile = args[++i];
+            }
+        } else if (arg == "--input") {
+            if (i + 1 >= args.size()) {
+                options.command = CommandLineOptions::Command::Invalid;
+                options.error = "--input requires a file name";
+                return options;
+            }
+            options.inputFile = args[++i];
+        } else if (arg == "--ordered") {
+            options.ordered = true;
+        } else if (arg == "--threads") {
+            int threads = 0;
+            try {
+                threads = i + 1 < args.size() ? std::stoi(args[++i]) : 0;
+            } catch (const std::exception&) {
+                threads = 0;
+            }
+            if (threads <= 0) {
+                options.command = CommandLineOptions::Command::Invalid;
+                options.error = "--threads requires a positive number";
+                return options;
+            }
+            options.threads = static_cast<unsigned>(threads);
+        } else if (arg == "--config") {
+            options.configMode = true;
+        } else if (arg == "--dry-run") {
+            options.dryRun = true;
+        } else if (arg == "--help" || arg == "-h") {
+            options.command = CommandLineOptions::Command::Help;
+            return options;
+        } else {
+            options.command = CommandLineOptions::Command::Invalid;
+            options.error = "Unknown argument: " + arg;
+            return options;
+        }
+    }
+
+    if (options.command == CommandLineOptions::Command::Gui && (options.configMode || options.dryRun)) {
+        options.command = CommandLineOptions::Command::Invalid;
+        options.error = "--config and --dry-run require --launch";
+    } else if (options.command == CommandLineOptions::Command::Import && (options.configMode || options.dryRun)) {
+        options.command = CommandLineOptions::Command::Invalid;
+        options.error = "--import-ibases does not launch, --config and --dry-run do not apply";
+    } else if (options.command != CommandLineOptions::Command::Resolve
+               && ((!options.inputFile.empty() && options.command != CommandLineOptions::Command::Import)
+                   || options.ordered || options.threads != 0)) {
+        options.command = CommandLineOptions::Command::Invalid;
+        options.error = "--input, --ordered and --threads require --resolve";
+    } else if (options.command == CommandLineOptions::Command::Resolve && options.dryRun) {
+        options.command = CommandLineOptions::Command::Invalid;
+        options.error = "--resolve never launches, --dry-run is not needed";
+    }
+    return options;
+}
+
+CommandLineOptions parseCommandLine(int argc, char** argv) {
+    std::vector<std::string> args;
+    for (int i = 1; i < argc; ++i) {
+        args.emplace_back(argv[i]);
+    }
+    return parseCommandLine(args);
+}
+
+void printUsage(std::ostream& out) {
+    out << "Usage:\n"
+        << "  run1c                                   Start the launcher window\n"
+        << "  run1c --launch \"<input>\" [--config]     Launch a base without opening the window\n"
+        << "  run1c --resolve [--input <file>]        Resolve one input per line to NDJSON\n"
+        << "  run1c --import-ibases [<file>]          Add the bases of a 1C ibases.v8i list to history\n"
+        << "\n"
+        << "Options:\n"
+        << "  --config         Open the base in Configurator mode\n"
+        << "  --dry-run        Validate and print the 1C command line without launching\n"
+        << "  --input <file>   Read --resolve inputs from a file instead of stdin\n"
+        << "  --ordered        Write --resolve results in input order\n"
+        << "  --threads <N>    Worker threads for --resolve (default: CPU count)\n"
+        << "  --help           Show this message\n";
+}
+
+std::vector<std::string> forwardedArguments(const CommandLineOptions& options) {
+    if (options.command == CommandLineOptions::Command::Import) {
+        // The running launcher may have a different working directory
+        std::string path = options.inputFile.empty() ? Config::getIbasesPath() : options.inputFile;
+        return {"--import-ibases", std::filesystem::absolute(path).string()};
+    }
+    if (options.command != CommandLineOptions::Command::Launch) {
+        return {};
+    }
+    std::vector<std::string> args = {"--launch", options.input};
+    if (options.configMode) {
+        args.push_back("--config");
+    }
+    return args;
+}
+
+int runLaunchCommand(const CommandLineOptions& options) {
+    PersistentStorage::setVerbose(false);
+
+    RUN1C run1c;
+    PersistentStorage storage;
+    storage.load();
+
+    // Platforms found by earlier runs, checked against the disk before the launch
+    std::shared_ptr<PlatformRegistry> platforms;
+    if (Config::get(ConfigKeys::directLaunch)) {
+        platforms = std::make_shared<PlatformRegistry>(PlatformRegistry::defaultRoots(run1c.getStarterPath()));
+        platforms->deserialize(storage.getArray(platformRegistryStorageKey));
+        platforms->deserializePins(storage.getArray(platformPinsStorageKey));
+        run1c.setPlatformRegistry(platforms);
+    }
+
+    if (options.dryRun) {
+        auto plan = run1c.prepare(options.input, options.configMode);
+        if (!plan) {
+            return 1;
+        }
+        std::cout << formatCommandLine(run1c.programFor(options.input, *plan), plan->args) << std::endl;
+        return 0;
+    }
+
+    // A resident launcher owns the history in memory, so it has to do the launch
+    if (Config::isSingleInstanceEnabled() && forwardToInstance(Config::getInstanceEndpoint(), forwardedArguments(options))) {
+        return 0;
+    }
+
+    if (!run1c.run(options.input, options.configMode)) {
+        return 1;
+    }
+
+    History history;
+    history.load(storage);
+    history.recordLaunch(options.input, options.configMode);
+    history.save(storage);
+    if (platforms) {
+        storage.put(platformRegistryStorageKey, platforms->serialize());
+    }
+    storage.save();
+
+    // run() has seen the starter exec'd (posix_spawn / CreateProcessW report that), so 1C is not
+    // waited for. A snapshot started before the Configurator would be cut short by exiting
+    run1c.waitForSnapshot();
+    return 0;
+}
+
+int runResolveCommand(const CommandLineOptions& options) {
+    std::ifstream file;
+    if (!options.inputFile.empty()) {
+        file.open(options.inputFile);
+        if (!file.is_open()) {
+            std::cerr << "Cannot open input file: " << options.inputFile << std::endl;
+            return 1;
+        }
+    }
+    std::istream& in = options.inputFile.empty() ? std::cin : file;
+
+    // Per-input failures are reported in the output, not as log lines
+    LogLevel previousLevel = ErrorHandler::getLogLevel();
+    ErrorHandler::setLogLevel(LogLevel::None);
+
+    BatchResolver::Options resolverOptions;
+    resolverOptions.threads = options.threads;
+    resolverOptions.ordered = options.ordered;
+    resolverOptions.configMode = options.configMode;
+
+    RUN1C run1c("");
+    BatchResolver resolver(run1c, resolverOptions);
+    BatchResolver::Summary summary = resolver.run(in, std::cout);
+
+    ErrorHandler::setLogLevel(previousLevel);
+    std::cerr << "Resolved " << summary.total << " inputs: " << summary.valid << " valid, "
+              << summary.invalid << " invalid" << std::endl;
+    return 0;
+}
+
+int runImportCommand(const CommandLineOptions& options) {
+    PersistentStorage::setVerbose(false);
+
+    // A resident launcher would overwrite the imported history on its next save
+    if (Config::isSingleInstanceEnabled() && forwardToInstance(Config::getInstanceEndpoint(), forwardedArguments(options))) {
+        std::cout << "Import handed to the running launcher" << std::endl;
+        return 0;
+    }
+
+    std::string path = options.inputFile.empty() ? Config::getIbasesPath() : options.inputFile;
+    PersistentStorage storage;
+    storage.load();
+    History history;
+    history.load(storage);
+    IbasesImportState state;
+    state.load(storage);
+
+    IbasesImportResult result = importIbases(path, history, state);
+    if (!result.error.empty()) {
+        std::cerr << result.error << std::endl;
+        return 1;
+    }
+    if (!result.fileChanged) {
+        std::cout << path << " is unchanged since the last import" << std::endl;
+        return 0;
+    }
+
+    // Version= pins, used when launching the platform directly
+    PlatformRegistry pins({});
+    pins.deserializePins(storage.getArray(platformPinsStorageKey));
+    for (const auto& [input, version] : result.versions) {
+        pins.setPin(input, version);
+    }
+
+    history.save(storage);
+    state.save(storage);
+    storage.put(platformPinsStorageKey, pins.serializePins());
+    storage.save();
+    std::cout << "Imported " << path << ": " << result.sections << " sections, " << result.changedSections
+              << " new or changed, " << result.added << " added to history" << std::endl;
+    return 0;
+}
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <ostream>
+#include <string>
+#include <vector>
+
+struct CommandLineOptions {
+    enum class Command {
+        Gui,        // No arguments, start the window
+        Launch,     // --launch "<input>" [--config] [--dry-run]
+        Resolve,    // --resolve [--input <file>] [--ordered] [--threads N] [--config]
+        Import,     // --import-ibases [<file>]
+        Help,       // --help
+        Invalid     // error holds the reason
+    };
+
+    Command command = Command::Gui;
+    std::string input;
+    bool configMode = false;
+    bool dryRun = false;
+    std::string inputFile;  // --resolve reads stdin when empty, --import-ibases uses Config::getIbasesPath()
+    bool ordered = false;
+    unsigned threads = 0;   // 0 = hardware concurrency
+    std::string error;
+};
+
+CommandLineOptions parseCommandLine(const std::vector<std::string>& args);
+CommandLineOptions parseCommandLine(int argc, char** argv);
+
+void printUsage(std::ostream& out);
+
+// Arguments sent to a running launcher: --launch requests, or none to raise its window
+std::vector<std::string> forwardedArguments(const CommandLineOptions& options);
+
+// Headless launch: same extraction, validation and history promotion as the
+// UI path, without SDL, OpenGL or fonts. Returns the process exit code.
+int runLaunchCommand(const CommandLineOptions& options);
+
+// Batch resolution: one input per line from stdin or --input, NDJSON on stdout
+// and a summary on stderr. Returns the process exit code.
+int runResolveCommand(const CommandLineOptions& options);
+
+// Merges the bases of an ibases.v8i file into history, or hands the import to
+// a running launcher. Returns the process exit code.
+int runImportCommand(const CommandLineOptions& options);
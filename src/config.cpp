@@ -1,120 +1,470 @@
-#include "config.h"
-#include "utils.h"
-#include <filesystem>
-
-// Static member definitions
-std::optional<std::string> Config::customFontPath;
-std::optional<std::string> Config::custom1CStarterPath;
-std::optional<std::string> Config::customStoragePath;
-int Config::baseFontSize = 18;
-
-std::string Config::getDefaultFontPath() {
-    return "C:\\Windows\\Fonts\\segoeui.ttf";
-}
-
-std::string Config::getFontPath() {
-    if (customFontPath.has_value() && isValidPath(customFontPath.value())) {
-        return customFontPath.value();
-    }
-    return getDefaultFontPath();
-}
-
-void Config::setCustomFontPath(const std::string& path) {
-    if (isValidPath(path)) {
-        customFontPath = path;
-    }
-}
-
-std::string Config::getDefault1CStarterPath() {
-    try {
-        return getEnvironmentVariable("PROGRAMFILES") + "\\1cv8\\common\\1cestart.exe";
-    } catch (const std::exception&) {
-        return "C:\\Program Files\\1cv8\\common\\1cestart.exe";
-    }
-}
-
-std::string Config::get1CStarterPath() {
-    if (custom1CStarterPath.has_value() && is1CStarterValid(custom1CStarterPath.value())) {
-        return custom1CStarterPath.value();
-    }
-    return getDefault1CStarterPath();
-}
-
-void Config::setCustom1CStarterPath(const std::string& path) {
-    if (is1CStarterValid(path)) {
-        custom1CStarterPath = path;
-    }
-}
-
-int Config::getBaseFontSize() {
-    return baseFontSize;
-}
-
-void Config::setBaseFontSize(int size) {
-    if (size >= 8 && size <= 72) {
-        baseFontSize = size;
-    }
-}
-
-std::string Config::getStorageFilePath() {
-    if (customStoragePath.has_value()) {
-        return customStoragePath.value();
-    }
-    
-    #ifdef _WIN32
-    // Windows: Use %LOCALAPPDATA%
-    try {
-        std::string appdata = getEnvironmentVariable("LOCALAPPDATA");
-        return appdata + "\\RUN1C\\run1c_storage.ini";
-    } catch(...) {
-        // Fallback to %USERPROFILE% if LOCALAPPDATA not available
-        try {
-            std::string userprofile = getEnvironmentVariable("USERPROFILE");
-            return userprofile + "\\AppData\\Local\\RUN1C\\run1c_storage.ini";
-        } catch(...) {
-            // Fallback to current directory
-        }
-    }
-    #elif defined(__APPLE__)
-    // macOS: Use ~/Library/Application Support/
-    const char* home = std::getenv("HOME");
-    if (home != nullptr) {
-        return std::string(home) + "/Library/Application Support/RUN1C/run1c_storage.ini";
-    }
-    #else
-    // Linux/Unix: Use ~/.config/
-    const char* home = std::getenv("HOME");
-    if (home != nullptr) {
-        return std::string(home) + "/.config/run1c/run1c_storage.ini";
-    }
-    #endif
-    
-    // Fallback to current directory
-    return "run1c_storage.ini";
-}
-
-void Config::setStorageFilePath(const std::string& path) {
-    customStoragePath = path;
-}
-
-
-bool Config::isValidPath(const std::string& path) {
-    if (path.empty()) {
-        return false;
-    }
-    try {
-        return std::filesystem::exists(path);
-    } catch (const std::exception&) {
-        return false;
-    }
-}
-
-bool Config::is1CStarterValid(const std::string& path) {
-    if (!isValidPath(path)) {
-        return false;
-    }
-    
-    // Check if the file ends with 1cestart.exe
-    std::filesystem::path filepath(path);
-    return filepath.filename() == "1cestart.exe";
+#include "config.h"
+#include "utils.h"
+#include <atomic>
+#include <charconv>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <memory>
+#include <mutex>
+
+namespace {
+
+// Constant-initialized, so current() works even from static initializers
+std::atomic<const ConfigSnapshot*> currentSnapshot{nullptr};
+
+// Everything a new snapshot is built from; only touched by writers
+struct ConfigLayers {
+    std::mutex mutex;
+    std::map<std::string, std::string, std::less<>> file;
+    std::map<std::string, std::string, std::less<>> overrides;
+    std::vector<std::unique_ptr<const ConfigSnapshot>> published;   // Readers may hold any of them
+};
+
+ConfigLayers& layers() {
+    static ConfigLayers instance;
+    return instance;
+}
+
+std::string_view trimmed(std::string_view text) {
+    size_t first = text.find_first_not_of(" \t\r\n");
+    if (first == std::string_view::npos) {
+        return {};
+    }
+    return text.substr(first, text.find_last_not_of(" \t\r\n") + 1 - first);
+}
+
+bool parseValue(std::string_view text, std::string& value) {
+    value = std::string(text);
+    return true;
+}
+
+bool parseValue(std::string_view text, bool& value) {
+    if (text == "true" || text == "1") {
+        value = true;
+    } else if (text == "false" || text == "0") {
+        value = false;
+    } else {
+        return false;
+    }
+    return true;
+}
+
+template <typename T>
+bool parseValue(std::string_view text, T& value) {
+    auto [end, error] = std::from_chars(text.data(), text.data() + text.size(), value);
+    return error == std::errc() && end == text.data() + text.size();
+}
+
+std::string formatValue(const std::string& value) { return value; }
+std::string formatValue(bool value) { return value ? "true" : "false"; }
+template <typename T>
+std::string formatValue(T value) { return std::to_string(value); }
+
+bool isKnownKey(std::string_view name) {
+    return std::apply([name](const auto&... key) { return ((key.name == name) || ...); }, ConfigKeys::all);
+}
+
+// Overrides win over the file; a value that does not parse or validate falls
+// through to the next layer and finally to the default. File values are
+// checked even when overridden, so mistakes in the file are always reported
+template <typename T>
+void resolveKey(ConfigLayers& state, const ConfigKey<T>& key, ConfigSnapshot& snapshot, std::vector<std::string>* errors) {
+    bool resolved = false;
+    for (const auto* layer : {&state.overrides, &state.file}) {
+        auto it = layer->find(key.name);
+        if (it == layer->end() || (resolved && errors == nullptr)) {
+            continue;
+        }
+        T value{};
+        if (parseValue(it->second, value) && (key.validate == nullptr || key.validate(value))) {
+            if (!resolved) {
+                snapshot.*key.field = std::move(value);
+                resolved = true;
+            }
+        } else if (errors != nullptr && layer == &state.file) {
+            errors->push_back(std::string(key.name) + ": invalid value '" + it->second + "'");
+        }
+    }
+    if (!resolved) {
+        snapshot.*key.field = key.defaultValue(snapshot);
+    }
+}
+
+// Builds a snapshot from the layers and makes it current, unless it has the
+// values of the current one (a reload of an unchanged file). The replaced
+// snapshot is retired, not freed: readers may still hold it. Caller holds state.mutex
+const ConfigSnapshot* publish(ConfigLayers& state, std::vector<std::string>* errors = nullptr) {
+    auto snapshot = std::make_unique<ConfigSnapshot>();
+    std::apply([&](const auto&... key) { (resolveKey(state, key, *snapshot, errors), ...); }, ConfigKeys::all);
+
+    const ConfigSnapshot* previous = currentSnapshot.load(std::memory_order_acquire);
+    if (previous != nullptr) {
+        snapshot->version = previous->version;
+        if (*snapshot == *previous) {
+            return previous;
+        }
+    }
+    snapshot->version++;
+    const ConfigSnapshot* result = snapshot.get();
+    state.published.push_back(std::move(snapshot));
+    currentSnapshot.store(result, std::memory_order_release);
+    return result;
+}
+
+} // namespace
+
+const ConfigSnapshot& Config::current() {
+    const ConfigSnapshot* snapshot = currentSnapshot.load(std::memory_order_acquire);
+    if (snapshot == nullptr) {
+        ConfigLayers& state = layers();
+        std::lock_guard<std::mutex> lock(state.mutex);
+        snapshot = currentSnapshot.load(std::memory_order_acquire);
+        if (snapshot == nullptr) {
+            snapshot = publish(state);
+        }
+    }
+    return *snapshot;
+}
+
+template <typename T>
+bool Config::set(const ConfigKey<T>& key, const T& value) {
+    if (key.validate != nullptr && !key.validate(value)) {
+        return false;
+    }
+    ConfigLayers& state = layers();
+    std::lock_guard<std::mutex> lock(state.mutex);
+    state.overrides[std::string(key.name)] = formatValue(value);
+    publish(state);
+    return true;
+}
+
+template bool Config::set(const ConfigKey<std::string>&, const std::string&);
+template bool Config::set(const ConfigKey<int>&, const int&);
+template bool Config::set(const ConfigKey<size_t>&, const size_t&);
+template bool Config::set(const ConfigKey<bool>&, const bool&);
+
+void Config::clearOverrides() {
+    ConfigLayers& state = layers();
+    std::lock_guard<std::mutex> lock(state.mutex);
+    state.overrides.clear();
+    publish(state);
+}
+
+template <typename T>
+bool Config::persist(const ConfigKey<T>& key, const T& value, const std::string& path) {
+    if (key.validate != nullptr && !key.validate(value)) {
+        return false;
+    }
+
+    // Comments, other keys and their line endings are kept as they are
+    std::vector<std::string> lines;
+    bool replaced = false;
+    {
+        std::ifstream file(path);
+        std::string line;
+        for (size_t lineNumber = 1; std::getline(file, line); ++lineNumber) {
+            std::string_view text = trimmed(line);
+            bool bom = lineNumber == 1 && text.substr(0, 3) == "\xEF\xBB\xBF";
+            if (bom) {
+                text = trimmed(text.substr(3));
+            }
+            size_t equals = text.find('=');
+            if (!replaced && equals != std::string_view::npos && trimmed(text.substr(0, equals)) == key.name) {
+                bool crlf = line.ends_with('\r');
+                line = std::string(bom ? "\xEF\xBB\xBF" : "") + std::string(key.name) + " = " + formatValue(value) + (crlf ? "\r" : "");
+                replaced = true;
+            }
+            lines.push_back(std::move(line));
+        }
+    }
+    if (!replaced) {
+        lines.push_back(std::string(key.name) + " = " + formatValue(value));
+    }
+
+    // Written aside and renamed over, so the watcher never reads half a file
+    std::error_code error;
+    std::filesystem::path target(path);
+    if (target.has_parent_path()) {
+        std::filesystem::create_directories(target.parent_path(), error);
+    }
+    std::string temporary = path + ".tmp";
+    {
+        std::ofstream file(temporary, std::ios::binary | std::ios::trunc);
+        for (const auto& line : lines) {
+            file << line << '\n';
+        }
+        if (!file.flush()) {
+            return false;
+        }
+    }
+    std::filesystem::rename(temporary, target, error);
+    if (error) {
+        std::filesystem::remove(temporary, error);
+        return false;
+    }
+
+    {
+        ConfigLayers& state = layers();
+        std::lock_guard<std::mutex> lock(state.mutex);
+        auto it = state.overrides.find(key.name);
+        if (it != state.overrides.end()) {
+            state.overrides.erase(it);
+        }
+    }
+    loadFile(path);
+    return true;
+}
+
+template bool Config::persist(const ConfigKey<std::string>&, const std::string&, const std::string&);
+template bool Config::persist(const ConfigKey<int>&, const int&, const std::string&);
+template bool Config::persist(const ConfigKey<size_t>&, const size_t&, const std::string&);
+template bool Config::persist(const ConfigKey<bool>&, const bool&, const std::string&);
+
+std::vector<std::string> Config::loadFile(const std::string& path) {
+    std::vector<std::string> errors;
+    std::map<std::string, std::string, std::less<>> values;
+
+    std::ifstream file(path);
+    std::string line;
+    for (size_t lineNumber = 1; std::getline(file, line); ++lineNumber) {
+        std::string_view text = trimmed(line);
+        if (lineNumber == 1 && text.substr(0, 3) == "\xEF\xBB\xBF") {
+            text = trimmed(text.substr(3));
+        }
+        if (text.empty() || text.front() == '#' || text.front() == ';') {
+            continue;
+        }
+        size_t equals = text.find('=');
+        std::string_view name = trimmed(text.substr(0, equals));
+        if (equals == std::string_view::npos || !isKnownKey(name)) {
+            errors.push_back("line " + std::to_string(lineNumber) + ": " +
+                (equals == std::string_view::npos ? "expected key = value" : "unknown key " + std::string(name)));
+            continue;
+        }
+        values[std::string(name)] = std::string(trimmed(text.substr(equals + 1)));
+    }
+
+    // Validation touches the filesystem, so it runs here on the caller's
+    // thread; readers only see the finished snapshot
+    ConfigLayers& state = layers();
+    std::lock_guard<std::mutex> lock(state.mutex);
+    state.file = std::move(values);
+    publish(state, &errors);
+    return errors;
+}
+
+std::string Config::getConfigFilePath() {
+    std::filesystem::path storageDir = std::filesystem::path(getDefaultStorageFilePath()).parent_path();
+    return (storageDir / "run1c_config.ini").string();
+}
+
+std::string Config::getDefaultFontPath() {
+    return "C:\\Windows\\Fonts\\segoeui.ttf";
+}
+
+std::string Config::getFontPath() {
+    return current().fontPath;
+}
+
+void Config::setCustomFontPath(const std::string& path) {
+    set(ConfigKeys::fontPath, path);
+}
+
+std::string Config::getDefault1CStarterPath() {
+    #ifdef _WIN32
+    try {
+        return getEnvironmentVariable("PROGRAMFILES") + "\\1cv8\\common\\1cestart.exe";
+    } catch (const std::exception&) {
+        return "C:\\Program Files\\1cv8\\common\\1cestart.exe";
+    }
+    #else
+    // Default location of the Linux 1C:Enterprise packages
+    return "/opt/1cv8/common/1cestart";
+    #endif
+}
+
+std::string Config::get1CStarterPath() {
+    return current().starterPath;
+}
+
+void Config::setCustom1CStarterPath(const std::string& path) {
+    set(ConfigKeys::starterPath, path);
+}
+
+int Config::getBaseFontSize() {
+    return current().baseFontSize;
+}
+
+void Config::setBaseFontSize(int size) {
+    set(ConfigKeys::baseFontSize, size);
+}
+
+std::string Config::getDefaultStorageFilePath() {
+    #ifdef _WIN32
+    // Windows: Use %LOCALAPPDATA%
+    try {
+        std::string appdata = getEnvironmentVariable("LOCALAPPDATA");
+        return appdata + "\\RUN1C\\run1c_storage.ini";
+    } catch(...) {
+        // Fallback to %USERPROFILE% if LOCALAPPDATA not available
+        try {
+            std::string userprofile = getEnvironmentVariable("USERPROFILE");
+            return userprofile + "\\AppData\\Local\\RUN1C\\run1c_storage.ini";
+        } catch(...) {
+            // Fallback to current directory
+        }
+    }
+    #elif defined(__APPLE__)
+    // macOS: Use ~/Library/Application Support/
+    const char* home = std::getenv("HOME");
+    if (home != nullptr) {
+        return std::string(home) + "/Library/Application Support/RUN1C/run1c_storage.ini";
+    }
+    #else
+    // Linux/Unix: Use ~/.config/
+    const char* home = std::getenv("HOME");
+    if (home != nullptr) {
+        return std::string(home) + "/.config/run1c/run1c_storage.ini";
+    }
+    #endif
+    
+    // Fallback to current directory
+    return "run1c_storage.ini";
+}
+
+std::string Config::getStorageFilePath() {
+    return current().storageFilePath;
+}
+
+void Config::setStorageFilePath(const std::string& path) {
+    set(ConfigKeys::storageFilePath, path);
+}
+
+bool Config::isSnapshotEnabled() {
+    return current().snapshotEnabled;
+}
+
+void Config::setSnapshotEnabled(bool enabled) {
+    set(ConfigKeys::snapshotEnabled, enabled);
+}
+
+std::string Config::getDefaultSnapshotDirectory(const std::string& storageFilePath) {
+    // Keep snapshots next to the storage file
+    std::filesystem::path storageDir = std::filesystem::path(storageFilePath).parent_path();
+    return (storageDir / "snapshots").string();
+}
+
+std::string Config::getSnapshotDirectory() {
+    return current().snapshotDirectory;
+}
+
+void Config::setSnapshotDirectory(const std::string& path) {
+    set(ConfigKeys::snapshotDirectory, path);
+}
+
+size_t Config::getSnapshotRetention() {
+    return current().snapshotRetention;
+}
+
+void Config::setSnapshotRetention(size_t count) {
+    set(ConfigKeys::snapshotRetention, count);
+}
+
+int Config::getSnapshotWaitTimeoutMs() {
+    return current().snapshotWaitTimeoutMs;
+}
+
+void Config::setSnapshotWaitTimeoutMs(int timeoutMs) {
+    set(ConfigKeys::snapshotWaitTimeoutMs, timeoutMs);
+}
+
+bool Config::isSingleInstanceEnabled() {
+    return current().singleInstanceEnabled;
+}
+
+void Config::setSingleInstanceEnabled(bool enabled) {
+    set(ConfigKeys::singleInstanceEnabled, enabled);
+}
+
+std::string Config::getDefaultInstanceEndpoint() {
+    #ifdef _WIN32
+    // Named pipes are machine-wide, keep one launcher per user
+    try {
+        return "\\\\.\\pipe\\run1c-" + getEnvironmentVariable("USERNAME");
+    } catch (...) {
+        return "\\\\.\\pipe\\run1c";
+    }
+    #else
+    const char* runtimeDir = std::getenv("XDG_RUNTIME_DIR");
+    if (runtimeDir != nullptr && *runtimeDir != '\0') {
+        return std::string(runtimeDir) + "/run1c.sock";
+    }
+    const char* user = std::getenv("USER");
+    return std::string("/tmp/run1c-") + (user != nullptr ? user : "user") + ".sock";
+    #endif
+}
+
+std::string Config::getInstanceEndpoint() {
+    return current().instanceEndpoint;
+}
+
+void Config::setInstanceEndpoint(const std::string& endpoint) {
+    set(ConfigKeys::instanceEndpoint, endpoint);
+}
+
+bool Config::isIbasesImportEnabled() {
+    return current().ibasesImportEnabled;
+}
+
+void Config::setIbasesImportEnabled(bool enabled) {
+    set(ConfigKeys::ibasesImportEnabled, enabled);
+}
+
+std::string Config::getDefaultIbasesPath() {
+    #ifdef _WIN32
+    // Written by 1cestart to %APPDATA%\1C\1CEStart
+    try {
+        return getEnvironmentVariable("APPDATA") + "\\1C\\1CEStart\\ibases.v8i";
+    } catch (...) {
+        return "ibases.v8i";
+    }
+    #else
+    const char* home = std::getenv("HOME");
+    return std::string(home != nullptr ? home : ".") + "/.1C/1cestart/ibases.v8i";
+    #endif
+}
+
+std::string Config::getIbasesPath() {
+    return current().ibasesPath;
+}
+
+void Config::setIbasesPath(const std::string& path) {
+    set(ConfigKeys::ibasesPath, path);
+}
+
+
+bool Config::isValidPath(const std::string& path) {
+    if (path.empty()) {
+        return false;
+    }
+    try {
+        return std::filesystem::exists(path);
+    } catch (const std::exception&) {
+        return false;
+    }
+}
+
+bool Config::is1CStarterValid(const std::string& path) {
+    if (!isValidPath(path)) {
+        return false;
+    }
+    
+    // Check if the file ends with 1cestart.exe
+    std::filesystem::path filepath(path);
+    #ifdef _WIN32
+    return filepath.filename() == "1cestart.exe";
+    #else
+    return filepath.filename() == "1cestart" || filepath.filename() == "1cestart.exe";
+    #endif
 }
\ No newline at end of file
@@ -1,10 +1,86 @@
 #pragma once
 
+#include <cstddef>
+#include <cstdint>
 #include <string>
-#include <optional>
+#include <string_view>
+#include <tuple>
+#include <vector>
 
+// Resolved settings. Published snapshots are immutable and kept until
+// shutdown, so a reference from Config::current() stays valid. Only a
+// changed file or an override publishes one, so few ever pile up
+struct ConfigSnapshot {
+    std::string fontPath;
+    std::string starterPath;
+    int baseFontSize = 0;
+    std::string storageFilePath;
+    bool snapshotEnabled = false;
+    std::string snapshotDirectory;
+    size_t snapshotRetention = 0;
+    int snapshotWaitTimeoutMs = 0;
+    bool singleInstanceEnabled = false;
+    std::string instanceEndpoint;
+    bool ibasesImportEnabled = false;
+    std::string ibasesPath;
+    std::string metricsFile;
+    std::string metricsEndpoint;
+    int metricsIntervalMs = 0;
+    bool directLaunch = false;
+    bool serverProbeEnabled = false;
+    int serverProbeTimeoutMs = 0;
+    int serverProbeTtlSeconds = 0;
+    uint64_t version = 0;       // Increases with every published snapshot
+
+    bool operator==(const ConfigSnapshot&) const = default;
+};
+
+// One setting: its name in the config file, its place in the snapshot, the
+// default (computed from the settings resolved before it) and the check a
+// value must pass. Values failing the check are ignored
+template <typename T>
+struct ConfigKey {
+    using Type = T;
+    std::string_view name;
+    T ConfigSnapshot::* field;
+    T (*defaultValue)(const ConfigSnapshot& resolved);
+    bool (*validate)(const T& value);
+};
+
+// Settings come from three layers: defaults, the config file (hot-reloaded
+// by ConfigWatcher) and values set at runtime through the setters, which
+// win over the file. Every change builds and validates a new snapshot and,
+// unless it resolves to the same values, publishes it with one atomic pointer store
 class Config {
 public:
+    // Current snapshot; a single atomic load
+    static const ConfigSnapshot& current();
+
+    template <typename T>
+    static const T& get(const ConfigKey<T>& key) { return current().*key.field; }
+
+    // Runtime override; returns false (and changes nothing) if key.validate rejects it
+    template <typename T>
+    static bool set(const ConfigKey<T>& key, const T& value);
+
+    // Writes key = value into the config file, replacing the key's line or
+    // appending one, drops a runtime override of the key and reloads the file.
+    // For settings changed in the UI: they outlive the process and later edits
+    // of the file still apply. Returns false if rejected or the write fails
+    template <typename T>
+    static bool persist(const ConfigKey<T>& key, const T& value, const std::string& path = getConfigFilePath());
+
+    // Drops every runtime override and publishes; tests reset with it
+    static void clearOverrides();
+
+    // Replaces the file layer with the key = value lines of path and publishes
+    // the result. A missing file clears the layer. Returns one message per
+    // line that was skipped (unknown key, unreadable or rejected value)
+    static std::vector<std::string> loadFile(const std::string& path);
+
+    // run1c_config.ini next to the default storage file
+    static std::string getConfigFilePath();
+
     // Font configuration
     static std::string getDefaultFontPath();
     static std::string getFontPath();
@@ -19,16 +95,91 @@ public:
     static int getBaseFontSize();
     static void setBaseFontSize(int size);
     
+    static std::string getDefaultStorageFilePath();
     static std::string getStorageFilePath();
     static void setStorageFilePath(const std::string& path);
+
+    // Snapshot of a file base before opening it in the Configurator
+    static bool isSnapshotEnabled();
+    static void setSnapshotEnabled(bool enabled);
+    static std::string getDefaultSnapshotDirectory(const std::string& storageFilePath);
+    static std::string getSnapshotDirectory();
+    static void setSnapshotDirectory(const std::string& path);
+    static size_t getSnapshotRetention();
+    static void setSnapshotRetention(size_t count);
+    static int getSnapshotWaitTimeoutMs();
+    static void setSnapshotWaitTimeoutMs(int timeoutMs);
+
+    // Single instance: later invocations forward to the running launcher
+    static bool isSingleInstanceEnabled();
+    static void setSingleInstanceEnabled(bool enabled);
+    static std::string getDefaultInstanceEndpoint();
+    static std::string getInstanceEndpoint();
+    static void setInstanceEndpoint(const std::string& endpoint);
+
+    // Bases from 1C's own list (ibases.v8i), merged into history at startup
+    static bool isIbasesImportEnabled();
+    static void setIbasesImportEnabled(bool enabled);
+    static std::string getDefaultIbasesPath();
+    static std::string getIbasesPath();
+    static void setIbasesPath(const std::string& path);
     
     // Validation
     static bool isValidPath(const std::string& path);
     static bool is1CStarterValid(const std::string& path);
 
-private:
-    static std::optional<std::string> customFontPath;
-    static std::optional<std::string> custom1CStarterPath;
-    static std::optional<std::string> customStoragePath;
-    static int baseFontSize;
-};
\ No newline at end of file
+};
+
+namespace ConfigKeys {
+
+inline bool notEmpty(const std::string& value) { return !value.empty(); }
+
+inline constexpr ConfigKey<std::string> fontPath{"fontPath", &ConfigSnapshot::fontPath,
+    [](const ConfigSnapshot&) { return Config::getDefaultFontPath(); }, &Config::isValidPath};
+inline constexpr ConfigKey<std::string> starterPath{"starterPath", &ConfigSnapshot::starterPath,
+    [](const ConfigSnapshot&) { return Config::getDefault1CStarterPath(); }, &Config::is1CStarterValid};
+inline constexpr ConfigKey<int> baseFontSize{"baseFontSize", &ConfigSnapshot::baseFontSize,
+    [](const ConfigSnapshot&) { return 18; }, [](const int& size) { return size >= 8 && size <= 72; }};
+inline constexpr ConfigKey<std::string> storageFilePath{"storageFilePath", &ConfigSnapshot::storageFilePath,
+    [](const ConfigSnapshot&) { return Config::getDefaultStorageFilePath(); }, &notEmpty};
+inline constexpr ConfigKey<bool> snapshotEnabled{"snapshotEnabled", &ConfigSnapshot::snapshotEnabled,
+    [](const ConfigSnapshot&) { return false; }, nullptr};
+inline constexpr ConfigKey<std::string> snapshotDirectory{"snapshotDirectory", &ConfigSnapshot::snapshotDirectory,
+    [](const ConfigSnapshot& resolved) { return Config::getDefaultSnapshotDirectory(resolved.storageFilePath); }, &notEmpty};
+inline constexpr ConfigKey<size_t> snapshotRetention{"snapshotRetention", &ConfigSnapshot::snapshotRetention,
+    [](const ConfigSnapshot&) { return size_t(3); }, nullptr};
+inline constexpr ConfigKey<int> snapshotWaitTimeoutMs{"snapshotWaitTimeoutMs", &ConfigSnapshot::snapshotWaitTimeoutMs,
+    [](const ConfigSnapshot&) { return 3000; }, [](const int& timeoutMs) { return timeoutMs >= 0; }};
+inline constexpr ConfigKey<bool> singleInstanceEnabled{"singleInstanceEnabled", &ConfigSnapshot::singleInstanceEnabled,
+    [](const ConfigSnapshot&) { return true; }, nullptr};
+inline constexpr ConfigKey<std::string> instanceEndpoint{"instanceEndpoint", &ConfigSnapshot::instanceEndpoint,
+    [](const ConfigSnapshot&) { return Config::getDefaultInstanceEndpoint(); }, &notEmpty};
+inline constexpr ConfigKey<bool> ibasesImportEnabled{"ibasesImportEnabled", &ConfigSnapshot::ibasesImportEnabled,
+    [](const ConfigSnapshot&) { return true; }, nullptr};
+inline constexpr ConfigKey<std::string> ibasesPath{"ibasesPath", &ConfigSnapshot::ibasesPath,
+    [](const ConfigSnapshot&) { return Config::getDefaultIbasesPath(); }, &notEmpty};
+// Prometheus text export, off while empty; read at startup
+inline constexpr ConfigKey<std::string> metricsFile{"metricsFile", &ConfigSnapshot::metricsFile,
+    [](const ConfigSnapshot&) { return std::string(); }, nullptr};
+inline constexpr ConfigKey<std::string> metricsEndpoint{"metricsEndpoint", &ConfigSnapshot::metricsEndpoint,
+    [](const ConfigSnapshot&) { return std::string(); }, nullptr};
+inline constexpr ConfigKey<int> metricsIntervalMs{"metricsIntervalMs", &ConfigSnapshot::metricsIntervalMs,
+    [](const ConfigSnapshot&) { return 10000; }, [](const int& intervalMs) { return intervalMs >= 100; }};
+// Start the base's platform (1cv8) directly instead of through the starter
+inline constexpr ConfigKey<bool> directLaunch{"directLaunch", &ConfigSnapshot::directLaunch,
+    [](const ConfigSnapshot&) { return false; }, nullptr};
+// Reachability of server bases shown in the history list; read at startup
+inline constexpr ConfigKey<bool> serverProbeEnabled{"serverProbeEnabled", &ConfigSnapshot::serverProbeEnabled,
+    [](const ConfigSnapshot&) { return true; }, nullptr};
+inline constexpr ConfigKey<int> serverProbeTimeoutMs{"serverProbeTimeoutMs", &ConfigSnapshot::serverProbeTimeoutMs,
+    [](const ConfigSnapshot&) { return 2000; }, [](const int& timeoutMs) { return timeoutMs >= 50; }};
+inline constexpr ConfigKey<int> serverProbeTtlSeconds{"serverProbeTtlSeconds", &ConfigSnapshot::serverProbeTtlSeconds,
+    [](const ConfigSnapshot&) { return 60; }, [](const int& seconds) { return seconds >= 5; }};
+
+// In resolution order: a default may only read the keys before it
+inline constexpr auto all = std::make_tuple(fontPath, starterPath, baseFontSize, storageFilePath, snapshotEnabled,
+    snapshotDirectory, snapshotRetention, snapshotWaitTimeoutMs, singleInstanceEnabled, instanceEndpoint,
+    ibasesImportEnabled, ibasesPath, metricsFile, metricsEndpoint, metricsIntervalMs, directLaunch,
+    serverProbeEnabled, serverProbeTimeoutMs, serverProbeTtlSeconds);
+
+} // namespace ConfigKeys
\ No newline at end of file
@@ -0,0 +1,60 @@
+#include "config_watcher.h"
+#include "config.h"
+#include <filesystem>
+
+ConfigWatcher::ConfigWatcher(std::string path, std::chrono::milliseconds interval, ErrorCallback onErrors)
+    : path(std::move(path)), interval(interval), onErrors(std::move(onErrors)) {
+    lastState = readState();
+    watcher = std::thread(&ConfigWatcher::watchLoop, this);
+}
+
+ConfigWatcher::~ConfigWatcher() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wakeCondition.notify_all();
+    watcher.join();
+}
+
+bool ConfigWatcher::poll() {
+    FileState state = readState();
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (state == lastState) {
+            return false;
+        }
+        lastState = state;
+    }
+
+    std::vector<std::string> errors = Config::loadFile(path);
+    if (!errors.empty() && onErrors) {
+        onErrors(errors);
+    }
+    return true;
+}
+
+ConfigWatcher::FileState ConfigWatcher::readState() const {
+    FileState state;
+    std::error_code error;
+    auto modified = std::filesystem::last_write_time(path, error);
+    if (error) {
+        return state;
+    }
+    state.exists = true;
+    state.modified = static_cast<int64_t>(modified.time_since_epoch().count());
+    state.size = std::filesystem::file_size(path, error);
+    return state;
+}
+
+void ConfigWatcher::watchLoop() {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (!stopping) {
+        if (wakeCondition.wait_for(lock, interval, [this] { return stopping; })) {
+            break;
+        }
+        lock.unlock();
+        poll();
+        lock.lock();
+    }
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Hot reload of the config file. A background thread checks its modification
+// time and size and, when either changes, runs Config::loadFile there, so
+// parsing and validation never happen on the UI thread. Readers pick up the
+// new snapshot through Config::current()
+class ConfigWatcher {
+public:
+    // Called on the watcher thread with the messages from Config::loadFile
+    using ErrorCallback = std::function<void(const std::vector<std::string>&)>;
+
+    // The file is assumed to be loaded already; only later changes reload it
+    explicit ConfigWatcher(std::string path, std::chrono::milliseconds interval = std::chrono::seconds(1),
+        ErrorCallback onErrors = nullptr);
+    ~ConfigWatcher();
+
+    ConfigWatcher(const ConfigWatcher&) = delete;
+    ConfigWatcher& operator=(const ConfigWatcher&) = delete;
+
+    // Checks once on the calling thread (tests). Returns true if the file was reloaded
+    bool poll();
+
+private:
+    struct FileState {
+        bool exists = false;
+        int64_t modified = 0;
+        uintmax_t size = 0;
+
+        bool operator==(const FileState&) const = default;
+    };
+
+    FileState readState() const;
+    void watchLoop();
+
+    std::string path;
+    std::chrono::milliseconds interval;
+    ErrorCallback onErrors;
+
+    std::mutex mutex;           // Guards lastState and stopping
+    std::condition_variable wakeCondition;
+    FileState lastState;
+    bool stopping = false;
+    std::thread watcher;
+};
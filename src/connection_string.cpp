@@ -0,0 +1,186 @@
+#include "connection_string.h"
+
+namespace {
+
+bool isSpace(char c) {
+    return c == ' ' || c == '\t' || c == '\r' || c == '\n';
+}
+
+// ASCII-only case folding, UTF-8 bytes of Cyrillic keys compare as is
+bool equalsIgnoreCase(std::string_view a, std::string_view b) {
+    if (a.size() != b.size()) {
+        return false;
+    }
+    for (size_t i = 0; i < a.size(); ++i) {
+        char x = a[i];
+        char y = b[i];
+        if (x >= 'A' && x <= 'Z') x = static_cast<char>(x - 'A' + 'a');
+        if (y >= 'A' && y <= 'Z') y = static_cast<char>(y - 'A' + 'a');
+        if (x != y) {
+            return false;
+        }
+    }
+    return true;
+}
+
+std::string_view trimTrailing(std::string_view text) {
+    while (!text.empty() && isSpace(text.back())) {
+        text.remove_suffix(1);
+    }
+    return text;
+}
+
+} // namespace
+
+std::string ConnectionValue::str() const {
+    if (!escaped) {
+        return std::string(text);
+    }
+    std::string result;
+    result.reserve(text.size());
+    for (size_t i = 0; i < text.size(); ++i) {
+        result.push_back(text[i]);
+        if (text[i] == '"' && i + 1 < text.size() && text[i + 1] == '"') {
+            ++i;
+        }
+    }
+    return result;
+}
+
+ConnectionStringTokenizer::ConnectionStringTokenizer(std::string_view input) : input(input) {
+}
+
+bool ConnectionStringTokenizer::next(ConnectionField& field) {
+    if (error) {
+        return false;
+    }
+
+    // Empty fields (;;) and whitespace between fields are ignored
+    while (position < input.size() && (isSpace(input[position]) || input[position] == ';')) {
+        ++position;
+    }
+    if (position >= input.size()) {
+        return false;
+    }
+
+    size_t equals = input.find_first_of("=;\"", position);
+    if (equals == std::string_view::npos || input[equals] != '=') {
+        error = true;
+        return false;
+    }
+    field.key = trimTrailing(input.substr(position, equals - position));
+    if (field.key.empty()) {
+        error = true;
+        return false;
+    }
+
+    position = equals + 1;
+    while (position < input.size() && isSpace(input[position])) {
+        ++position;
+    }
+
+    field.value = ConnectionValue();
+    if (position < input.size() && input[position] == '"') {
+        size_t start = ++position;
+        while (true) {
+            size_t quote = input.find('"', position);
+            if (quote == std::string_view::npos) {
+                error = true;   // Unterminated quoted value
+                return false;
+            }
+            if (quote + 1 < input.size() && input[quote + 1] == '"') {
+                field.value.escaped = true;
+                position = quote + 2;
+                continue;
+            }
+            field.value.text = input.substr(start, quote - start);
+            position = quote + 1;
+            break;
+        }
+
+        // Only whitespace may follow the closing quote
+        while (position < input.size() && isSpace(input[position])) {
+            ++position;
+        }
+        if (position < input.size() && input[position] != ';') {
+            error = true;
+            return false;
+        }
+    } else {
+        size_t end = input.find(';', position);
+        if (end == std::string_view::npos) {
+            end = input.size();
+        }
+        field.value.text = trimTrailing(input.substr(position, end - position));
+        if (field.value.text.find('"') != std::string_view::npos) {
+            error = true;
+            return false;
+        }
+        position = end;
+    }
+    return true;
+}
+
+bool parseConnectionString(std::string_view input, ConnectionString& out) {
+    out = ConnectionString();
+
+    while (!input.empty() && isSpace(input.front())) {
+        input.remove_prefix(1);
+    }
+    static constexpr std::string_view connectPrefix = "Connect=";
+    if (input.size() >= connectPrefix.size() && equalsIgnoreCase(input.substr(0, connectPrefix.size()), connectPrefix)) {
+        input.remove_prefix(connectPrefix.size());
+    }
+
+    ConnectionStringTokenizer tokenizer(input);
+    ConnectionField field;
+    while (tokenizer.next(field)) {
+        if (equalsIgnoreCase(field.key, "File")) {
+            out.file = field.value;
+        } else if (equalsIgnoreCase(field.key, "Srvr")) {
+            out.server = field.value;
+        } else if (equalsIgnoreCase(field.key, "Ref")) {
+            out.ref = field.value;
+        } else if (equalsIgnoreCase(field.key, "ws")) {
+            out.webUrl = field.value;
+        }
+    }
+    if (tokenizer.failed()) {
+        return false;
+    }
+
+    if (!out.file.empty()) {
+        out.kind = ConnectionKind::File;
+    } else if (!out.server.empty() && !out.ref.empty()) {
+        out.kind = ConnectionKind::Server;
+    } else if (!out.webUrl.empty()) {
+        out.kind = ConnectionKind::Web;
+    }
+    return out.kind != ConnectionKind::None;
+}
+
+std::vector<std::string> connectionArguments(const ConnectionString& connection) {
+    switch (connection.kind) {
+    case ConnectionKind::File:
+        return {"/F", connection.file.str()};
+    case ConnectionKind::Server:
+        return {"/S", connectionDisplayName(connection)};
+    case ConnectionKind::Web:
+        return {"/WS", connection.webUrl.str()};
+    default:
+        return {};
+    }
+}
+
+std::string connectionDisplayName(const ConnectionString& connection) {
+    switch (connection.kind) {
+    case ConnectionKind::File:
+        return connection.file.str();
+    case ConnectionKind::Server:
+        return connection.server.str() + "\\" + connection.ref.str();
+    case ConnectionKind::Web:
+        return connection.webUrl.str();
+    default:
+        return "";
+    }
+}
@@ -0,0 +1,67 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+// A value as written in the connection string, without the surrounding quotes.
+// Views point into the parsed input, which must outlive them
+struct ConnectionValue {
+    std::string_view text;
+    bool escaped = false;       // Quoted value with doubled quotes ("" stands for ")
+
+    bool empty() const { return text.empty(); }
+
+    // Copy with doubled quotes collapsed
+    std::string str() const;
+};
+
+// One key=value pair in input order
+struct ConnectionField {
+    std::string_view key;
+    ConnectionValue value;
+};
+
+// Splits the key=value;key="value"; syntax of 1C connection strings (ibases.v8i
+// Connect= lines, clipboard strings) without allocating. Keys may be any UTF-8
+// text, quoted values may contain ; and = and escape quotes by doubling them
+class ConnectionStringTokenizer {
+public:
+    explicit ConnectionStringTokenizer(std::string_view input);
+
+    // Returns false at the end of the input or on a syntax error
+    bool next(ConnectionField& field);
+
+    bool failed() const { return error; }
+
+private:
+    std::string_view input;
+    size_t position = 0;
+    bool error = false;
+};
+
+enum class ConnectionKind {
+    None,
+    File,       // File=
+    Server,     // Srvr= and Ref=
+    Web         // ws=
+};
+
+struct ConnectionString {
+    ConnectionKind kind = ConnectionKind::None;
+    ConnectionValue file;
+    ConnectionValue server;
+    ConnectionValue ref;
+    ConnectionValue webUrl;
+};
+
+// Keys are matched case-insensitively, unknown keys (Usr=, Pwd=, ...) are skipped.
+// A leading Connect= from ibases.v8i is accepted. Returns false on a syntax
+// error or if no base is specified
+bool parseConnectionString(std::string_view input, ConnectionString& out);
+
+// 1cestart arguments selecting the base: /F <path>, /S <server>\<ref> or /WS <url>
+std::vector<std::string> connectionArguments(const ConnectionString& connection);
+
+// Human-readable base location: the path, server\ref or the URL
+std::string connectionDisplayName(const ConnectionString& connection);
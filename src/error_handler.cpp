@@ -1,15 +1,24 @@
 #include "error_handler.h"
+#include "metrics.h"
 #include <iostream>
 #include <fstream>
 #include <filesystem>
+#ifdef _WIN32
 #include <Windows.h>
+#else
+#include <cerrno>
+#include <cstring>
+#endif
 
 // Static member definition
 ErrorHandler::ErrorCallback ErrorHandler::errorCallback;
+std::atomic<LogLevel> ErrorHandler::logLevel{LogLevel::Info};
 
 void ErrorHandler::showError(ErrorType type, const std::string& details) {
-    std::string message = formatErrorMessage(type, details);
-    std::cerr << "[ERROR] " << message << std::endl;
+    LauncherMetrics::get().error(type).add();
+    if (isLogged(LogLevel::Error)) {
+        std::cerr << "[ERROR] " << formatErrorMessage(type, details) << std::endl;
+    }
     
     if (errorCallback) {
         errorCallback(type, details);
@@ -17,11 +26,14 @@ void ErrorHandler::showError(ErrorType type, const std::string& details) {
 }
 
 void ErrorHandler::showErrorWithDialog(ErrorType type, const std::string& details) {
+    LauncherMetrics::get().error(type).add();
     std::string message = formatErrorMessage(type, details);
     std::cerr << "[ERROR] " << message << std::endl;
     
+#ifdef _WIN32
     // Show Windows message box
     MessageBoxA(nullptr, message.c_str(), "RUN1C Error", MB_OK | MB_ICONERROR);
+#endif
     
     if (errorCallback) {
         errorCallback(type, details);
@@ -53,7 +65,11 @@ bool ErrorHandler::validate1CPath(const std::string& path) {
     
     try {
         std::filesystem::path filepath(path);
+#ifdef _WIN32
         return filepath.filename() == "1cestart.exe";
+#else
+        return filepath.filename() == "1cestart" || filepath.filename() == "1cestart.exe";
+#endif
     } catch (const std::exception& e) {
         logError(ErrorType::InvalidPath, "1C path validation failed: " + std::string(e.what()));
         return false;
@@ -97,6 +113,7 @@ std::string ErrorHandler::getErrorMessage(ErrorType type) {
 }
 
 std::string ErrorHandler::getLastErrorString() {
+#ifdef _WIN32
     DWORD errorCode = GetLastError();
     if (errorCode == 0) {
         return "No error";
@@ -117,6 +134,13 @@ std::string ErrorHandler::getLastErrorString() {
     LocalFree(messageBuffer);
     
     return "Error " + std::to_string(errorCode) + ": " + message;
+#else
+    int errorCode = errno;
+    if (errorCode == 0) {
+        return "No error";
+    }
+    return "Error " + std::to_string(errorCode) + ": " + std::strerror(errorCode);
+#endif
 }
 
 void ErrorHandler::setErrorCallback(ErrorCallback callback) {
@@ -128,6 +152,10 @@ void ErrorHandler::clearErrorCallback() {
 }
 
 void ErrorHandler::logError(ErrorType type, const std::string& details) {
+    // Counted even when the log level hides it
+    LauncherMetrics::get().error(type).add();
+    if (!isLogged(LogLevel::Error)) return;
+
     std::string message = formatErrorMessage(type, details);
     std::cerr << "[ERROR] " << message << std::endl;
     
@@ -140,6 +168,8 @@ void ErrorHandler::logError(ErrorType type, const std::string& details) {
 }
 
 void ErrorHandler::logWarning(const std::string& message) {
+    if (!isLogged(LogLevel::Warning)) return;
+
     std::cerr << "[WARNING] " << message << std::endl;
     
     std::ofstream logFile("run1c_error.log", std::ios::app);
@@ -150,6 +180,8 @@ void ErrorHandler::logWarning(const std::string& message) {
 }
 
 void ErrorHandler::logInfo(const std::string& message) {
+    if (!isLogged(LogLevel::Info)) return;
+
     std::cout << "[INFO] " << message << std::endl;
     
     std::ofstream logFile("run1c_error.log", std::ios::app);
@@ -159,6 +191,18 @@ void ErrorHandler::logInfo(const std::string& message) {
     }
 }
 
+void ErrorHandler::setLogLevel(LogLevel level) {
+    logLevel = level;
+}
+
+LogLevel ErrorHandler::getLogLevel() {
+    return logLevel.load();
+}
+
+bool ErrorHandler::isLogged(LogLevel level) {
+    return level >= logLevel.load(std::memory_order_relaxed);
+}
+
 std::string ErrorHandler::formatErrorMessage(ErrorType type, const std::string& details) {
     std::string baseMessage = getErrorMessage(type);
     if (!details.empty()) {
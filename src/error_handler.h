@@ -1,5 +1,6 @@
 #pragma once
 
+#include <atomic>
 #include <string>
 #include <functional>
 
@@ -13,6 +14,14 @@ enum class ErrorType {
     ProcessCreationFailed
 };
 
+// Messages below the current level are not written to the console or the log file
+enum class LogLevel {
+    Info,
+    Warning,
+    Error,
+    None
+};
+
 class ErrorHandler {
 public:
     using ErrorCallback = std::function<void(ErrorType, const std::string&)>;
@@ -38,8 +47,12 @@ public:
     static void logError(ErrorType type, const std::string& details);
     static void logWarning(const std::string& message);
     static void logInfo(const std::string& message);
+    static void setLogLevel(LogLevel level);
+    static LogLevel getLogLevel();
 
 private:
     static ErrorCallback errorCallback;
+    static std::atomic<LogLevel> logLevel;
+    static bool isLogged(LogLevel level);
     static std::string formatErrorMessage(ErrorType type, const std::string& details);
 };
\ No newline at end of file
@@ -0,0 +1,237 @@
+#include "file_copier.h"
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <vector>
+
+#ifdef _WIN32
+#include <Windows.h>
+#include "utf_transcode.h"
+#else
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#ifdef __linux__
+#include <linux/fs.h>
+#include <sys/ioctl.h>
+#include <sys/sendfile.h>
+#endif
+#endif
+
+namespace {
+
+void throwIfCancelled(const CopyProgress* progress) {
+    if (progress && progress->cancelled.load(std::memory_order_relaxed)) {
+        throw std::runtime_error("Copy cancelled");
+    }
+}
+
+void addProgress(CopyProgress* progress, uint64_t bytes) {
+    if (progress) {
+        progress->bytesCopied.fetch_add(bytes, std::memory_order_relaxed);
+    }
+}
+
+bool copyBuffered(const std::string& from, const std::string& to, CopyProgress* progress) {
+    std::ifstream in(std::filesystem::path(from), std::ios::binary);
+    if (!in.is_open()) {
+        throw std::runtime_error("Cannot open source file: " + from);
+    }
+    std::ofstream out(std::filesystem::path(to), std::ios::binary | std::ios::trunc);
+    if (!out.is_open()) {
+        throw std::runtime_error("Cannot create destination file: " + to);
+    }
+
+    std::vector<char> buffer(1024 * 1024);
+    while (in) {
+        throwIfCancelled(progress);
+        in.read(buffer.data(), static_cast<std::streamsize>(buffer.size()));
+        std::streamsize count = in.gcount();
+        if (count <= 0) break;
+        if (!out.write(buffer.data(), count)) {
+            throw std::runtime_error("Write failed: " + to);
+        }
+        addProgress(progress, static_cast<uint64_t>(count));
+    }
+    if (in.bad()) {
+        throw std::runtime_error("Read failed: " + from);
+    }
+    return true;
+}
+
+#ifdef _WIN32
+
+struct SystemCopyContext {
+    CopyProgress* progress;
+    uint64_t startBytes;
+};
+
+DWORD CALLBACK systemCopyProgress(LARGE_INTEGER, LARGE_INTEGER transferred, LARGE_INTEGER, LARGE_INTEGER,
+    DWORD, DWORD, HANDLE, HANDLE, LPVOID data) {
+    auto* context = static_cast<SystemCopyContext*>(data);
+    if (context->progress) {
+        context->progress->bytesCopied.store(context->startBytes + static_cast<uint64_t>(transferred.QuadPart), std::memory_order_relaxed);
+        if (context->progress->cancelled.load(std::memory_order_relaxed)) {
+            return PROGRESS_CANCEL;
+        }
+    }
+    return PROGRESS_CONTINUE;
+}
+
+bool copySystem(const std::string& from, const std::string& to, CopyProgress* progress) {
+    SystemCopyContext context{progress, progress ? progress->bytesCopied.load() : 0};
+    Utf16Buffer<> source(from);
+    Utf16Buffer<> target(to);
+    if (!CopyFileExW(source.wide(), target.wide(), systemCopyProgress, &context, nullptr, 0)) {
+        throwIfCancelled(progress);
+        throw std::runtime_error("CopyFileEx failed with error " + std::to_string(GetLastError()) + ": " + from);
+    }
+    return true;
+}
+
+#else
+
+// Owns the descriptors of one copy attempt
+struct CopyFiles {
+    int in = -1;
+    int out = -1;
+    uint64_t size = 0;
+
+    CopyFiles(const std::string& from, const std::string& to) {
+        in = ::open(from.c_str(), O_RDONLY | O_CLOEXEC);
+        if (in < 0) {
+            throw std::runtime_error("Cannot open source file: " + from + ": " + std::strerror(errno));
+        }
+        struct stat st;
+        if (fstat(in, &st) != 0) {
+            ::close(in);
+            throw std::runtime_error("Cannot stat source file: " + from);
+        }
+        size = static_cast<uint64_t>(st.st_size);
+        out = ::open(to.c_str(), O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, st.st_mode & 0777);
+        if (out < 0) {
+            ::close(in);
+            throw std::runtime_error("Cannot create destination file: " + to + ": " + std::strerror(errno));
+        }
+    }
+
+    ~CopyFiles() {
+        ::close(in);
+        ::close(out);
+    }
+};
+
+// Errors meaning "not supported for this pair of files", as opposed to I/O failures
+bool isUnsupported(int error) {
+    return error == ENOSYS || error == EXDEV || error == EINVAL || error == EOPNOTSUPP
+        || error == ENOTTY || error == EBADF || error == EPERM;
+}
+
+bool copyReflink(const std::string& from, const std::string& to, CopyProgress* progress) {
+#if defined(__linux__) && defined(FICLONE)
+    CopyFiles files(from, to);
+    if (ioctl(files.out, FICLONE, files.in) != 0) {
+        return false;
+    }
+    addProgress(progress, files.size);
+    return true;
+#else
+    (void)from; (void)to; (void)progress;
+    return false;
+#endif
+}
+
+bool copyKernel(FileCopier::Method method, const std::string& from, const std::string& to, CopyProgress* progress) {
+#ifdef __linux__
+    CopyFiles files(from, to);
+    uint64_t copied = 0;
+    while (copied < files.size) {
+        throwIfCancelled(progress);
+        size_t chunk = static_cast<size_t>(std::min<uint64_t>(FileCopier::chunkSize, files.size - copied));
+        ssize_t result = method == FileCopier::Method::CopyFileRange
+            ? copy_file_range(files.in, nullptr, files.out, nullptr, chunk, 0)
+            : sendfile(files.out, files.in, nullptr, chunk);
+        if (result < 0) {
+            if (errno == EINTR) continue;
+            if (copied == 0 && isUnsupported(errno)) {
+                return false;
+            }
+            throw std::runtime_error(std::string(FileCopier::methodName(method)) + " failed: " + std::strerror(errno));
+        }
+        if (result == 0) break; // Source shrank while copying
+        copied += static_cast<uint64_t>(result);
+        addProgress(progress, static_cast<uint64_t>(result));
+    }
+    return true;
+#else
+    (void)method; (void)from; (void)to; (void)progress;
+    return false;
+#endif
+}
+
+#endif
+
+} // namespace
+
+FileCopier::Method FileCopier::copyFile(const std::string& from, const std::string& to, CopyProgress* progress) {
+#ifdef _WIN32
+    const Method methods[] = {Method::SystemCopy, Method::Buffered};
+#else
+    const Method methods[] = {Method::Reflink, Method::CopyFileRange, Method::SendFile, Method::Buffered};
+#endif
+    for (Method method : methods) {
+        if (copyFileWith(method, from, to, progress)) {
+            return method;
+        }
+    }
+    throw std::runtime_error("No copy method available for: " + from);
+}
+
+bool FileCopier::copyFileWith(Method method, const std::string& from, const std::string& to, CopyProgress* progress) {
+    throwIfCancelled(progress);
+
+    bool copied = false;
+    switch (method) {
+#ifdef _WIN32
+        case Method::SystemCopy:
+            copied = copySystem(from, to, progress);
+            break;
+#else
+        case Method::Reflink:
+            copied = copyReflink(from, to, progress);
+            break;
+        case Method::CopyFileRange:
+        case Method::SendFile:
+            copied = copyKernel(method, from, to, progress);
+            break;
+#endif
+        case Method::Buffered:
+            copied = copyBuffered(from, to, progress);
+            break;
+        default:
+            return false;
+    }
+
+    if (copied) {
+        std::error_code ec;
+        auto writeTime = std::filesystem::last_write_time(from, ec);
+        if (!ec) {
+            std::filesystem::last_write_time(to, writeTime, ec);
+        }
+    }
+    return copied;
+}
+
+const char* FileCopier::methodName(Method method) {
+    switch (method) {
+        case Method::Reflink: return "reflink";
+        case Method::CopyFileRange: return "copy_file_range";
+        case Method::SendFile: return "sendfile";
+        case Method::SystemCopy: return "CopyFileEx";
+        case Method::Buffered: return "buffered";
+        default: return "unknown";
+    }
+}
@@ -0,0 +1,38 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+// Shared between a copy in progress and its observers
+struct CopyProgress {
+    std::atomic<uint64_t> bytesCopied{0};
+    std::atomic<uint64_t> bytesTotal{0};
+    std::atomic<bool> cancelled{false};
+};
+
+class FileCopier {
+public:
+    // Ordered from cheapest to most expensive
+    enum class Method {
+        Reflink,        // Copy-on-write clone (FICLONE), no data is copied
+        CopyFileRange,  // In-kernel copy_file_range
+        SendFile,       // In-kernel sendfile
+        SystemCopy,     // CopyFileExW, lets Windows pick block cloning or an in-kernel copy
+        Buffered        // Plain read/write loop
+    };
+
+    // Copies a single file using the cheapest method the platform and
+    // filesystem support. Overwrites the destination and keeps the source
+    // modification time. Throws std::runtime_error on failure or cancellation.
+    static Method copyFile(const std::string& from, const std::string& to, CopyProgress* progress = nullptr);
+
+    // Copies using one specific method. Returns false if the method is not
+    // supported here (the destination is left empty), throws on I/O errors.
+    static bool copyFileWith(Method method, const std::string& from, const std::string& to, CopyProgress* progress = nullptr);
+
+    static const char* methodName(Method method);
+
+    // Chunk size for copy loops, progress and cancellation are checked between chunks
+    static constexpr size_t chunkSize = 8 * 1024 * 1024;
+};
@@ -0,0 +1,124 @@
+#include "font_atlas_cache.h"
+#include "imgui.h"
+#include "misc/freetype/imgui_freetype.h"
+
+#include <algorithm>
+#include <cmath>
+#include <filesystem>
+#include <utility>
+
+// Declared in imgui_context.h; null on every thread until it sets a context
+thread_local ImGuiContext* run1cImGuiContext = nullptr;
+
+float dpiScaleFor(float dpi) {
+    const float windowsDefaultDPI = 96.0f;
+    if (!(dpi > 0.0f)) {
+        return 1.0f;
+    }
+    return std::max(0.5f, std::round(dpi / windowsDefaultDPI * 2.0f) * 0.5f);
+}
+
+FontAtlasCache::FontAtlasCache(std::string fontPath, int baseFontSize, size_t capacity)
+    : fontPath(std::move(fontPath)), baseFontSize(baseFontSize), capacity(std::max<size_t>(capacity, 2)) {
+    worker = std::thread(&FontAtlasCache::workerLoop, this);
+}
+
+FontAtlasCache::~FontAtlasCache() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+        queue.clear();
+    }
+    wakeCondition.notify_all();
+    worker.join();
+}
+
+void FontAtlasCache::request(float scale) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (atlases.count(scale) || !pending.insert(scale).second) {
+            return;
+        }
+        queue.push_back(scale);
+    }
+    wakeCondition.notify_one();
+}
+
+ImFontAtlas* FontAtlasCache::find(float scale) {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto found = atlases.find(scale);
+    if (found == atlases.end()) {
+        return nullptr;
+    }
+    found->second.lastUse = ++useCount;
+
+    while (atlases.size() > capacity) {
+        auto oldest = std::min_element(atlases.begin(), atlases.end(), [](const auto& a, const auto& b) {
+            return a.second.lastUse < b.second.lastUse;
+        });
+        atlases.erase(oldest);
+    }
+    return found->second.atlas.get();
+}
+
+void FontAtlasCache::waitIdle() {
+    std::unique_lock<std::mutex> lock(mutex);
+    idleCondition.wait(lock, [this] { return pending.empty(); });
+}
+
+size_t FontAtlasCache::size() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return atlases.size();
+}
+
+std::unique_ptr<ImFontAtlas> FontAtlasCache::build(const std::string& fontPath, int baseFontSize, float scale) {
+    auto atlas = std::make_unique<ImFontAtlas>();
+
+    ImFontConfig fontCfg;
+    fontCfg.FontBuilderFlags |= ImGuiFreeTypeBuilderFlags_MonoHinting | ImGuiFreeTypeBuilderFlags_Monochrome; // No antialiasing, strict hinting
+    fontCfg.PixelSnapH = true;
+    fontCfg.RasterizerDensity = scale;
+    const float fontSize = std::floor(baseFontSize * scale);
+
+    std::error_code error;
+    ImFont* font = nullptr;
+    if (!fontPath.empty() && std::filesystem::is_regular_file(fontPath, error)) {
+        font = atlas->AddFontFromFileTTF(fontPath.c_str(), fontSize, &fontCfg, atlas->GetGlyphRangesCyrillic());
+    }
+    if (font == nullptr) {
+        fontCfg.SizePixels = fontSize;
+        atlas->AddFontDefault(&fontCfg);
+    }
+
+    // Rasterized here rather than on the first upload
+    unsigned char* pixels = nullptr;
+    int width = 0;
+    int height = 0;
+    atlas->GetTexDataAsRGBA32(&pixels, &width, &height);
+    return atlas;
+}
+
+void FontAtlasCache::workerLoop() {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (true) {
+        wakeCondition.wait(lock, [this] { return stopping || !queue.empty(); });
+        if (stopping) {
+            return;
+        }
+
+        float scale = queue.front();
+        queue.pop_front();
+
+        // No ImGui context on this thread: allocations of the build are not
+        // recorded into the UI context, which the render thread uses meanwhile
+        lock.unlock();
+        std::unique_ptr<ImFontAtlas> atlas = build(fontPath, baseFontSize, scale);
+        lock.lock();
+
+        atlases[scale].atlas = std::move(atlas);
+        pending.erase(scale);
+        if (pending.empty()) {
+            idleCondition.notify_all();
+        }
+    }
+}
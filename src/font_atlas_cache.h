@@ -0,0 +1,72 @@
+#pragma once
+
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+
+struct ImFontAtlas;
+
+// UI scale for a display DPI in half steps, 1.0 when the DPI is unknown
+float dpiScaleFor(float dpi);
+
+// Font atlases per UI scale, rasterized on a worker thread so that moving the
+// window to a display of another density does not stall a frame. The worker
+// has no ImGui context (the context is per thread, see imgui_context.h). The last few
+// scales are kept: moving back and forth between displays reuses their atlases.
+class FontAtlasCache {
+public:
+    // capacity is at least 2, so switching scales never evicts the atlas switched from
+    FontAtlasCache(std::string fontPath, int baseFontSize, size_t capacity = 3);
+    ~FontAtlasCache();
+
+    FontAtlasCache(const FontAtlasCache&) = delete;
+    FontAtlasCache& operator=(const FontAtlasCache&) = delete;
+
+    // Queues a build for scale. No-op if it is built or queued already
+    void request(float scale);
+
+    // The built atlas for scale, now the most recently used one; null while it
+    // is pending or if it was never requested. Atlases over capacity are
+    // destroyed here, so call it from the render thread only
+    ImFontAtlas* find(float scale);
+
+    // Blocks until all queued builds are done
+    void waitIdle();
+
+    // Built atlases kept
+    size_t size() const;
+
+    // The font at floor(baseFontSize * scale) pixels, rasterized at scale
+    // density, or the built-in font if fontPath does not exist. Built and
+    // converted to RGBA, ready for upload. Needs no ImGui context
+    static std::unique_ptr<ImFontAtlas> build(const std::string& fontPath, int baseFontSize, float scale);
+
+private:
+    struct Entry {
+        std::unique_ptr<ImFontAtlas> atlas;
+        uint64_t lastUse = 0;
+    };
+
+    void workerLoop();
+
+    const std::string fontPath;
+    const int baseFontSize;
+    const size_t capacity;
+
+    mutable std::mutex mutex;
+    std::condition_variable wakeCondition;
+    std::condition_variable idleCondition;
+    std::deque<float> queue;
+    std::set<float> pending;            // Queued or being built
+    std::map<float, Entry> atlases;
+    uint64_t useCount = 0;
+    bool stopping = false;
+    std::thread worker;
+};
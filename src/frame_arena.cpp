@@ -0,0 +1,68 @@
+#include "frame_arena.h"
+#include <algorithm>
+#include <cstdarg>
+#include <cstdio>
+#include <cstring>
+
+FrameArena::FrameArena(size_t chunkSize) : chunkSize(chunkSize) {
+}
+
+const char* FrameArena::copy(std::string_view text) {
+    char* target = allocate(text.size() + 1);
+    std::memcpy(target, text.data(), text.size());
+    target[text.size()] = '\0';
+    return target;
+}
+
+const char* FrameArena::format(const char* format, ...) {
+    va_list args;
+    va_start(args, format);
+    va_list retry;
+    va_copy(retry, args);
+
+    // Formats straight into the free space; only text that does not fit is formatted twice
+    int length = std::vsnprintf(cursor, remaining, format, args);
+    va_end(args);
+    if (length < 0) {
+        va_end(retry);
+        return "";
+    }
+
+    const char* result = cursor;
+    if (static_cast<size_t>(length) < remaining) {
+        allocate(static_cast<size_t>(length) + 1);
+    } else {
+        char* target = allocate(static_cast<size_t>(length) + 1);
+        std::vsnprintf(target, static_cast<size_t>(length) + 1, format, retry);
+        result = target;
+    }
+    va_end(retry);
+    return result;
+}
+
+void FrameArena::reset() {
+    // A frame that needed several chunks gets one of their combined size,
+    // the next frame like it fits without growing
+    if (chunks.size() > 1) {
+        chunks.clear();
+        chunks.push_back({std::unique_ptr<char[]>(new char[reserved]), reserved});
+    }
+    cursor = chunks.empty() ? nullptr : chunks.front().data.get();
+    remaining = chunks.empty() ? 0 : chunks.front().size;
+    used = 0;
+}
+
+char* FrameArena::allocate(size_t size) {
+    if (size > remaining) {
+        size_t newChunkSize = std::max(chunkSize, size);
+        chunks.push_back({std::unique_ptr<char[]>(new char[newChunkSize]), newChunkSize});
+        reserved += newChunkSize;
+        cursor = chunks.back().data.get();
+        remaining = newChunkSize;
+    }
+    char* result = cursor;
+    cursor += size;
+    remaining -= size;
+    used += size;
+    return result;
+}
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <string_view>
+#include <vector>
+
+// Bump allocator for strings that only live until the end of a frame: row
+// labels, formatted numbers, text copied out from under a lock. reset() at
+// the start of each frame rewinds it and keeps the memory, so once it has
+// grown to the busiest frame it stops allocating
+class FrameArena {
+public:
+    explicit FrameArena(size_t chunkSize = 16 * 1024);
+
+    FrameArena(FrameArena&&) noexcept = default;
+    FrameArena& operator=(FrameArena&&) noexcept = default;
+
+    // Null-terminated copy of text
+    const char* copy(std::string_view text);
+
+    // printf into the arena
+    const char* format(const char* format, ...);
+
+    // Invalidates everything handed out since the previous reset
+    void reset();
+
+    size_t usedBytes() const { return used; }
+    size_t reservedBytes() const { return reserved; }
+
+private:
+    struct Chunk {
+        std::unique_ptr<char[]> data;
+        size_t size = 0;
+    };
+
+    char* allocate(size_t size);
+
+    size_t chunkSize;
+    std::vector<Chunk> chunks;
+    char* cursor = nullptr;
+    size_t remaining = 0;
+    size_t used = 0;
+    size_t reserved = 0;
+};
@@ -0,0 +1,469 @@
+#include "history.h"
+#include "base_path.h"
+#include "connection_string.h"
+#include "persistent_storage.h"
+#include <algorithm>
+#include <cctype>
+#include <charconv>
+#include <cmath>
+#include <cstdio>
+#include <limits>
+#include <numeric>
+#include <unordered_map>
+#include <unordered_set>
+
+double HistoryEntry::frecency(int64_t now) const {
+    double elapsed = static_cast<double>(std::max<int64_t>(now - lastLaunch, 0));
+    return score * std::exp2(-elapsed / History::halfLifeSeconds);
+}
+
+double HistoryEntry::rank() const {
+    if (score <= 0.0) {
+        return -std::numeric_limits<double>::infinity();
+    }
+    return std::log2(score) + static_cast<double>(lastLaunch) / History::halfLifeSeconds;
+}
+
+namespace {
+
+std::string_view trimmed(std::string_view text) {
+    while (!text.empty() && std::isspace(static_cast<unsigned char>(text.front()))) {
+        text.remove_prefix(1);
+    }
+    while (!text.empty() && std::isspace(static_cast<unsigned char>(text.back()))) {
+        text.remove_suffix(1);
+    }
+    return text;
+}
+
+// Launches of other go to kept, as if both had been one entry all along
+void mergeEntry(HistoryEntry& kept, const HistoryEntry& other) {
+    int64_t lastLaunch = std::max(kept.lastLaunch, other.lastLaunch);
+    kept.score = kept.frecency(lastLaunch) + other.frecency(lastLaunch);
+    if (other.lastLaunch > kept.lastLaunch) {
+        kept.input = other.input;
+    }
+    kept.lastLaunch = lastLaunch;
+    kept.launchCount += other.launchCount;
+    kept.enterpriseCount += other.enterpriseCount;
+    kept.configCount += other.configCount;
+    if (kept.name.empty()) {
+        kept.name = other.name;
+    }
+}
+
+// Cuts text into the lines ending at ends
+std::vector<std::string_view> splitAt(const std::string& text, const std::vector<size_t>& ends) {
+    std::vector<std::string_view> lines;
+    lines.reserve(ends.size());
+    size_t begin = 0;
+    for (size_t end : ends) {
+        lines.emplace_back(text.data() + begin, end - begin);
+        begin = end;
+    }
+    return lines;
+}
+
+} // namespace
+
+std::string historyBaseKey(const std::string& input) {
+    ConnectionString connection;
+    if (parseConnectionString(input, connection)) {
+        if (connection.kind == ConnectionKind::Server) {
+            return "srvr:" + foldCase(connection.server.str()) + '\\' + foldCase(connection.ref.str());
+        }
+        if (connection.kind == ConnectionKind::Web) {
+            std::string url = connection.webUrl.str();
+            while (url.size() > 1 && url.back() == '/') {
+                url.pop_back();
+            }
+            return "ws:" + url;
+        }
+    }
+    if (auto path = extractBasePath(input)) {
+        return "file:" + canonicalBasePath(*path);
+    }
+    return std::string(trimmed(input));
+}
+
+namespace {
+
+uint64_t hashBaseKey(std::string_view baseKey) {
+    uint64_t hash = 1469598103934665603ull;
+    for (unsigned char c : baseKey) {
+        hash = (hash ^ c) * 1099511628211ull;
+    }
+    return hash;
+}
+
+} // namespace
+
+uint64_t historyKeyHash(const std::string& input) {
+    return hashBaseKey(historyBaseKey(input));
+}
+
+size_t History::load(const PersistentStorage& storage, int64_t now) {
+    entries.clear();
+    nodes.clear();
+    index.clear();
+    root = none;
+    topSeq = 0;
+    bottomSeq = 0;
+    size_t merged = 0;
+
+    // Views into storage, which is not modified while loading
+    auto stats = storage.getArrayView(historyStatsStorageKey);
+    auto legacy = storage.getArrayView(historyStorageKey);
+    index.reserve(std::max(stats.size(), legacy.size()));
+
+    std::unordered_map<std::string_view, std::string_view> names;
+    for (std::string_view line : storage.getArrayView(historyNamesStorageKey)) {
+        size_t tab = line.find('\t');
+        if (tab != std::string_view::npos) {
+            names[line.substr(0, tab)] = line.substr(tab + 1);
+        }
+    }
+
+    // Older versions compared inputs exactly, so one base may have been stored
+    // several times; such entries are collapsed here
+    std::unordered_set<std::string_view> known;
+    known.reserve(stats.size() + legacy.size());
+    auto add = [&](HistoryEntry&& entry) {
+        auto name = names.find(entry.input);
+        if (name != names.end()) {
+            entry.name = name->second;
+        }
+        std::string baseKey = historyBaseKey(entry.input);
+        uint64_t key = hashBaseKey(baseKey);
+        uint32_t id = lookup(key, entry.input, baseKey);
+        if (id == none) {
+            append(std::move(entry), key);
+        } else {
+            mergeEntry(entries[id], entry);
+            ++merged;
+        }
+    };
+
+    for (std::string_view line : stats) {
+        HistoryEntry entry;
+        if (parseEntry(line, entry) && known.insert(line.substr(line.size() - entry.input.size())).second) {
+            add(std::move(entry));
+        }
+    }
+
+    // Entries from the MRU-only format, or added by an older version since.
+    // One second apart so the most recent one still ranks highest
+    for (size_t i = 0; i < legacy.size(); ++i) {
+        if (!known.insert(legacy[i]).second) {
+            continue;
+        }
+        HistoryEntry entry;
+        entry.input = std::string(legacy[i]);
+        entry.launchCount = 1;
+        entry.lastLaunch = now - static_cast<int64_t>(legacy.size() - 1 - i);
+        entry.score = 1.0;
+        add(std::move(entry));
+    }
+
+    // Stable, so entries of equal rank keep their stored order
+    std::vector<uint32_t> order(entries.size());
+    std::iota(order.begin(), order.end(), 0u);
+    std::stable_sort(order.begin(), order.end(), [this](uint32_t a, uint32_t b) {
+        return entries[a].rank() < entries[b].rank();
+    });
+    for (uint32_t id : order) {
+        link(id, ++topSeq);
+    }
+    return merged;
+}
+
+void History::save(PersistentStorage& storage) const {
+    // Lines are formatted into one buffer per array and stored from views
+    std::vector<std::string_view> inputs;
+    std::string stats;
+    std::string names;
+    std::vector<size_t> statsEnds;
+    std::vector<size_t> namesEnds;
+    inputs.reserve(entries.size());
+    stats.reserve(entries.size() * 64);
+    statsEnds.reserve(entries.size());
+    for (const HistoryEntry* stored : ordered()) {
+        const HistoryEntry& entry = *stored;
+        inputs.push_back(entry.input);
+        appendEntry(stats, entry);
+        statsEnds.push_back(stats.size());
+        if (!entry.name.empty()) {
+            names += entry.input;
+            names += '\t';
+            names += entry.name;
+            namesEnds.push_back(names.size());
+        }
+    }
+    storage.putArray(historyStorageKey, inputs);
+    storage.putArray(historyStatsStorageKey, splitAt(stats, statsEnds));
+    if (!namesEnds.empty()) {
+        storage.putArray(historyNamesStorageKey, splitAt(names, namesEnds));
+    }
+}
+
+const HistoryEntry& History::recordLaunch(const std::string& input, bool isConfigMode, int64_t now) {
+    std::string baseKey = historyBaseKey(input);
+    uint64_t key = hashBaseKey(baseKey);
+    uint32_t id = lookup(key, input, baseKey);
+    if (id == none) {
+        HistoryEntry entry;
+        entry.input = input;
+        entry.lastLaunch = now;
+        id = append(std::move(entry), key);
+    } else {
+        root = erase(root, id);
+    }
+    HistoryEntry& entry = entries[id];
+
+    entry.score = entry.frecency(now) + 1.0;
+    entry.lastLaunch = std::max(entry.lastLaunch, now);
+    entry.launchCount++;
+    (isConfigMode ? entry.configCount : entry.enterpriseCount)++;
+
+    // Only this entry's rank changed: it goes back into the tree at its new
+    // place, above entries of equal rank, the others stay where they are
+    link(id, ++topSeq);
+    return entry;
+}
+
+size_t History::importEntries(const std::vector<HistoryImport>& imports) {
+    std::vector<uint32_t> added;
+    for (const auto& import : imports) {
+        std::string baseKey = historyBaseKey(import.input);
+        uint64_t key = hashBaseKey(baseKey);
+        uint32_t id = lookup(key, import.input, baseKey);
+        if (id != none) {
+            entries[id].name = import.name;
+            continue;
+        }
+        HistoryEntry entry;
+        entry.input = import.input;
+        entry.name = import.name;
+        added.push_back(append(std::move(entry), key));
+    }
+
+    // Never launched, so they rank below everything; the first import is shown first
+    for (size_t i = 0; i < added.size(); ++i) {
+        link(added[i], bottomSeq - 1 - static_cast<int64_t>(i));
+    }
+    bottomSeq -= static_cast<int64_t>(added.size());
+    return added.size();
+}
+
+const HistoryEntry& History::at(size_t position) const {
+    uint32_t node = root;
+    for (;;) {
+        size_t leftSize = subtreeSize(nodes[node].left);
+        if (position == leftSize) {
+            return entries[node];
+        }
+        if (position < leftSize) {
+            node = nodes[node].left;
+        } else {
+            position -= leftSize + 1;
+            node = nodes[node].right;
+        }
+    }
+}
+
+size_t History::positionOf(const HistoryEntry& entry) const {
+    uint32_t id = none;
+    for (auto [it, end] = index.equal_range(entry.key); id == none; ++it) {
+        if (&entries[it->second] == &entry) {
+            id = it->second;
+        }
+    }
+    size_t position = 0;
+    uint32_t node = root;
+    while (node != id) {
+        if (before(id, node)) {
+            node = nodes[node].left;
+        } else {
+            position += subtreeSize(nodes[node].left) + 1;
+            node = nodes[node].right;
+        }
+    }
+    return position + subtreeSize(nodes[id].left);
+}
+
+std::vector<const HistoryEntry*> History::ordered() const {
+    std::vector<const HistoryEntry*> result;
+    result.reserve(entries.size());
+    std::vector<uint32_t> path;
+    uint32_t node = root;
+    while (node != none || !path.empty()) {
+        while (node != none) {
+            path.push_back(node);
+            node = nodes[node].left;
+        }
+        node = path.back();
+        path.pop_back();
+        result.push_back(&entries[node]);
+        node = nodes[node].right;
+    }
+    return result;
+}
+
+std::vector<const HistoryEntry*> History::top(size_t k) const {
+    std::vector<const HistoryEntry*> result;
+    result.reserve(std::min(k, entries.size()));
+    for (size_t i = 0; i < k && i < entries.size(); ++i) {
+        result.push_back(&at(entries.size() - 1 - i));
+    }
+    return result;
+}
+
+const HistoryEntry* History::find(const std::string& input) const {
+    std::string baseKey = historyBaseKey(input);
+    uint32_t id = lookup(hashBaseKey(baseKey), input, baseKey);
+    return id != none ? &entries[id] : nullptr;
+}
+
+uint32_t History::lookup(uint64_t key, const std::string& input, const std::string& baseKey) const {
+    // The hash alone would merge two bases that collide and lose the launches of
+    // one. The same input is the same base, without deriving the base key again
+    for (auto [it, end] = index.equal_range(key); it != end; ++it) {
+        const std::string& stored = entries[it->second].input;
+        if (stored == input || historyBaseKey(stored) == baseKey) {
+            return it->second;
+        }
+    }
+    return none;
+}
+
+uint32_t History::append(HistoryEntry&& entry, uint64_t key) {
+    uint32_t id = static_cast<uint32_t>(entries.size());
+    entry.key = key;
+    entries.push_back(std::move(entry));
+    nodes.emplace_back();
+    index.emplace(key, id);
+    return id;
+}
+
+void History::link(uint32_t id, int64_t seq) {
+    Node& node = nodes[id];
+    node.rank = entries[id].rank();
+    node.seq = seq;
+    // A mix of the id stands in for a random priority, which keeps the tree shallow
+    uint64_t mixed = (static_cast<uint64_t>(id) + 1) * 0x9e3779b97f4a7c15ull;
+    mixed = (mixed ^ (mixed >> 30)) * 0xbf58476d1ce4e5b9ull;
+    mixed = (mixed ^ (mixed >> 27)) * 0x94d049bb133111ebull;
+    node.priority = static_cast<uint32_t>(mixed >> 32);
+    node.size = 1;
+    node.left = none;
+    node.right = none;
+    root = insert(root, id);
+}
+
+bool History::before(uint32_t a, uint32_t b) const {
+    if (nodes[a].rank != nodes[b].rank) {
+        return nodes[a].rank < nodes[b].rank;
+    }
+    return nodes[a].seq < nodes[b].seq;
+}
+
+void History::update(uint32_t node) {
+    nodes[node].size = 1 + subtreeSize(nodes[node].left) + subtreeSize(nodes[node].right);
+}
+
+void History::split(uint32_t node, uint32_t pivot, uint32_t& left, uint32_t& right) {
+    if (node == none) {
+        left = none;
+        right = none;
+        return;
+    }
+    if (before(node, pivot)) {
+        split(nodes[node].right, pivot, nodes[node].right, right);
+        left = node;
+    } else {
+        split(nodes[node].left, pivot, left, nodes[node].left);
+        right = node;
+    }
+    update(node);
+}
+
+uint32_t History::merge(uint32_t left, uint32_t right) {
+    if (left == none) {
+        return right;
+    }
+    if (right == none) {
+        return left;
+    }
+    if (nodes[left].priority > nodes[right].priority) {
+        nodes[left].right = merge(nodes[left].right, right);
+        update(left);
+        return left;
+    }
+    nodes[right].left = merge(left, nodes[right].left);
+    update(right);
+    return right;
+}
+
+uint32_t History::insert(uint32_t node, uint32_t id) {
+    if (node == none) {
+        return id;
+    }
+    if (nodes[id].priority > nodes[node].priority) {
+        split(node, id, nodes[id].left, nodes[id].right);
+        update(id);
+        return id;
+    }
+    if (before(id, node)) {
+        nodes[node].left = insert(nodes[node].left, id);
+    } else {
+        nodes[node].right = insert(nodes[node].right, id);
+    }
+    update(node);
+    return node;
+}
+
+uint32_t History::erase(uint32_t node, uint32_t id) {
+    if (node == id) {
+        return merge(nodes[id].left, nodes[id].right);
+    }
+    if (before(id, node)) {
+        nodes[node].left = erase(nodes[node].left, id);
+    } else {
+        nodes[node].right = erase(nodes[node].right, id);
+    }
+    update(node);
+    return node;
+}
+
+std::string History::formatEntry(const HistoryEntry& entry) {
+    std::string line;
+    appendEntry(line, entry);
+    return line;
+}
+
+void History::appendEntry(std::string& out, const HistoryEntry& entry) {
+    char numbers[128];
+    snprintf(numbers, sizeof(numbers), "%u %u %u %lld %.9g ", entry.launchCount, entry.enterpriseCount, entry.configCount,
+        static_cast<long long>(entry.lastLaunch), entry.score);
+    out += numbers;
+    out += entry.input;
+}
+
+bool History::parseEntry(std::string_view line, HistoryEntry& entry) {
+    const char* position = line.data();
+    const char* end = line.data() + line.size();
+    auto field = [&](auto& value) {
+        while (position != end && *position == ' ') {
+            ++position;
+        }
+        auto [next, error] = std::from_chars(position, end, value);
+        position = next;
+        return error == std::errc();
+    };
+    if (!field(entry.launchCount) || !field(entry.enterpriseCount) || !field(entry.configCount) ||
+        !field(entry.lastLaunch) || !field(entry.score) || position == end || *position != ' ') {
+        return false;
+    }
+    entry.input.assign(position + 1, end);
+    return !entry.input.empty();
+}
@@ -0,0 +1,135 @@
+#pragma once
+
+#include <cstdint>
+#include <ctime>
+#include <deque>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+class PersistentStorage;
+
+// History key in PersistentStorage, most frecent entry is stored last.
+// Still written as plain inputs so older versions can read the file
+inline constexpr const char* historyStorageKey = "basesHistory";
+
+// Launch statistics per entry: "<launches> <enterprise> <config> <lastLaunch> <score> <input>"
+inline constexpr const char* historyStatsStorageKey = "basesHistoryStats";
+
+// Display names of named entries: "<input>\t<name>"
+inline constexpr const char* historyNamesStorageKey = "basesHistoryNames";
+
+struct HistoryEntry {
+    std::string input;
+    std::string name;               // Human-readable name, e.g. from ibases.v8i (may be empty)
+    uint32_t launchCount = 0;
+    uint32_t enterpriseCount = 0;   // Launches from before the statistics existed count in neither mode
+    uint32_t configCount = 0;
+    int64_t lastLaunch = 0;         // Seconds since the Unix epoch
+    double score = 0.0;             // Launch count decayed to lastLaunch
+    uint64_t key = 0;               // historyKeyHash(input), recomputed on load rather than stored
+
+    // Decayed launch count at time now
+    double frecency(int64_t now) const;
+
+    // Ordering key, log2 of the score shifted to a common time base. Every score
+    // decays at the same rate, so the order only changes when an entry is launched
+    double rank() const;
+};
+
+// A base added to history without launching it
+struct HistoryImport {
+    std::string input;
+    std::string name;
+};
+
+// Identifies the base an input refers to, so differently written inputs for the
+// same base are merged: "file:" and the canonical path, "srvr:" and the
+// case-folded server\ref, "ws:" and the URL, or the trimmed input itself
+std::string historyBaseKey(const std::string& input);
+
+// 64-bit FNV-1a of historyBaseKey, the lookup key of history. Entries whose
+// hashes match are only merged if their base keys match too
+uint64_t historyKeyHash(const std::string& input);
+
+// History ordered by frecency: launches weighted by how recent they are
+class History {
+public:
+    // A launch counts half as much after this time
+    static constexpr int64_t halfLifeSeconds = 14 * 24 * 60 * 60;
+
+    // Reads both storage keys; entries only present in the legacy list are
+    // migrated with one launch each, keeping their previous order. Entries
+    // for the same base are collapsed into one; returns how many were merged
+    // so the caller can save the cleaned-up list
+    size_t load(const PersistentStorage& storage, int64_t now = static_cast<int64_t>(std::time(nullptr)));
+    void save(PersistentStorage& storage) const;
+
+    // Counts a launch of the base and moves its entry to the new position in
+    // O(log n). An existing entry for the same base keeps its original input.
+    // Entries never move in memory, the reference stays valid until load()
+    const HistoryEntry& recordLaunch(const std::string& input, bool isConfigMode, int64_t now = static_cast<int64_t>(std::time(nullptr)));
+
+    // Entry at a position, lowest rank first: the most frecent one is at size() - 1. O(log n)
+    const HistoryEntry& at(size_t position) const;
+    // Position of an entry of this history, as counted by at(). O(log n)
+    size_t positionOf(const HistoryEntry& entry) const;
+
+    // Every entry, lowest rank first
+    std::vector<const HistoryEntry*> ordered() const;
+
+    // The k most frecent entries, best first
+    std::vector<const HistoryEntry*> top(size_t k) const;
+
+    // Adds bases that are not in history yet below all launched entries, in the
+    // given order. Existing entries for the same base keep their rank and take
+    // the new name. Returns the number of added entries
+    size_t importEntries(const std::vector<HistoryImport>& imports);
+
+    // Entry for the same base as input, in O(1)
+    const HistoryEntry* find(const std::string& input) const;
+    size_t size() const { return entries.size(); }
+    bool empty() const { return entries.empty(); }
+
+    // Storage line format for one entry, exposed for tests
+    static std::string formatEntry(const HistoryEntry& entry);
+    static void appendEntry(std::string& out, const HistoryEntry& entry);
+    static bool parseEntry(std::string_view line, HistoryEntry& entry);
+
+private:
+    static constexpr uint32_t none = UINT32_MAX;
+
+    // Node of the order tree, a treap keyed by (rank, seq) with subtree sizes.
+    // Node i belongs to entries[i]
+    struct Node {
+        double rank = 0.0;
+        int64_t seq = 0;                // Breaks rank ties: launched later ranks higher, imports go lowest
+        uint32_t priority = 0;
+        uint32_t size = 1;
+        uint32_t left = none;
+        uint32_t right = none;
+    };
+
+    // Puts entries[id] into the tree at its current rank
+    void link(uint32_t id, int64_t seq);
+    bool before(uint32_t a, uint32_t b) const;
+    uint32_t subtreeSize(uint32_t node) const { return node == none ? 0 : nodes[node].size; }
+    void update(uint32_t node);
+    // Nodes ordered before pivot go to left, the rest to right
+    void split(uint32_t node, uint32_t pivot, uint32_t& left, uint32_t& right);
+    uint32_t merge(uint32_t left, uint32_t right);
+    uint32_t insert(uint32_t node, uint32_t id);
+    uint32_t erase(uint32_t node, uint32_t id);
+    // Id of the entry for the base of input, given its base key and hash; none if there is none
+    uint32_t lookup(uint64_t key, const std::string& input, const std::string& baseKey) const;
+    // Adds entry under key to entries and the index, not to the tree
+    uint32_t append(HistoryEntry&& entry, uint64_t key);
+
+    std::deque<HistoryEntry> entries;               // In insertion order, never moved
+    std::vector<Node> nodes;
+    uint32_t root = none;
+    int64_t topSeq = 0;
+    int64_t bottomSeq = 0;
+    std::unordered_multimap<uint64_t, uint32_t> index;  // Entry key to entry ids, more than one on a hash collision
+};
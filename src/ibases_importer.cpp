@@ -0,0 +1,184 @@
+#include "ibases_importer.h"
+#include "history.h"
+#include "mapped_file.h"
+#include "persistent_storage.h"
+#include <charconv>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <sstream>
+#include <vector>
+
+namespace {
+
+const uint64_t fnvOffset = 1469598103934665603ull;
+const uint64_t fnvPrime = 1099511628211ull;
+
+uint64_t hashBytes(uint64_t hash, std::string_view bytes) {
+    for (unsigned char c : bytes) {
+        hash = (hash ^ c) * fnvPrime;
+    }
+    return hash;
+}
+
+std::string_view trim(std::string_view text) {
+    while (!text.empty() && (text.front() == ' ' || text.front() == '\t')) {
+        text.remove_prefix(1);
+    }
+    while (!text.empty() && (text.back() == ' ' || text.back() == '\t' || text.back() == '\r')) {
+        text.remove_suffix(1);
+    }
+    return text;
+}
+
+bool startsWith(std::string_view text, std::string_view prefix) {
+    return text.size() >= prefix.size() && text.compare(0, prefix.size(), prefix) == 0;
+}
+
+} // namespace
+
+size_t parseIbases(std::string_view content, const std::function<void(const IbasesSection&)>& onSection) {
+    static constexpr std::string_view utf8Bom = "\xEF\xBB\xBF";
+    if (startsWith(content, utf8Bom)) {
+        content.remove_prefix(utf8Bom.size());
+    }
+
+    size_t sections = 0;
+    bool inSection = false;
+    IbasesSection section;
+
+    auto finish = [&]() {
+        if (inSection) {
+            ++sections;
+            if (!section.connect.empty()) {
+                onSection(section);
+            }
+        }
+    };
+
+    size_t position = 0;
+    while (position < content.size()) {
+        const char* lineEnd = static_cast<const char*>(std::memchr(content.data() + position, '\n', content.size() - position));
+        size_t end = lineEnd ? static_cast<size_t>(lineEnd - content.data()) : content.size();
+        std::string_view line = trim(content.substr(position, end - position));
+        position = end + 1;
+
+        if (line.size() >= 2 && line.front() == '[' && line.back() == ']') {
+            finish();
+            inSection = true;
+            section = IbasesSection();
+            section.name = line.substr(1, line.size() - 2);
+            section.hash = fnvOffset;
+        } else if (!inSection || line.empty()) {
+            continue;
+        } else if (startsWith(line, "Connect=")) {
+            section.connect = trim(line.substr(8));
+        } else if (startsWith(line, "Folder=")) {
+            section.folder = trim(line.substr(7));
+        } else if (startsWith(line, "Version=")) {
+            section.version = trim(line.substr(8));
+        }
+
+        // Hash trimmed lines so line endings and indentation do not count as changes
+        section.hash = hashBytes(section.hash, line);
+        section.hash = hashBytes(section.hash, "\n");
+    }
+    finish();
+    return sections;
+}
+
+std::string ibasesDisplayName(const IbasesSection& section) {
+    std::string_view folder = section.folder;
+    while (!folder.empty() && folder.front() == '/') {
+        folder.remove_prefix(1);
+    }
+    if (folder.empty()) {
+        return std::string(section.name);
+    }
+    return std::string(folder) + " / " + std::string(section.name);
+}
+
+void IbasesImportState::load(const PersistentStorage& storage) {
+    *this = IbasesImportState();
+    auto lines = storage.getArrayView(ibasesImportStorageKey);
+    if (lines.empty()) {
+        return;
+    }
+
+    // "<modified> <size> <path>", then one section hash per line
+    std::istringstream header{std::string(lines[0])};
+    header >> modified >> size;
+    if (header.fail() || header.get() != ' ') {
+        *this = IbasesImportState();
+        return;
+    }
+    std::getline(header, path);
+
+    sectionHashes.reserve(lines.size() - 1);
+    for (size_t i = 1; i < lines.size(); ++i) {
+        uint64_t hash = 0;
+        std::from_chars(lines[i].data(), lines[i].data() + lines[i].size(), hash, 16);
+        sectionHashes.insert(hash);
+    }
+}
+
+void IbasesImportState::save(PersistentStorage& storage) const {
+    if (path.empty()) {
+        return;
+    }
+    std::vector<std::string> lines;
+    lines.reserve(sectionHashes.size() + 1);
+    lines.push_back(std::to_string(modified) + ' ' + std::to_string(size) + ' ' + path);
+    for (uint64_t hash : sectionHashes) {
+        char hex[17];
+        snprintf(hex, sizeof(hex), "%016llx", static_cast<unsigned long long>(hash));
+        lines.push_back(hex);
+    }
+    storage.put(ibasesImportStorageKey, lines);
+}
+
+IbasesImportResult importIbases(const std::string& path, History& history, IbasesImportState& state) {
+    IbasesImportResult result;
+
+    std::error_code ec;
+    auto modified = std::filesystem::last_write_time(path, ec);
+    uint64_t size = ec ? 0 : std::filesystem::file_size(path, ec);
+    if (ec) {
+        result.error = "Cannot read " + path + ": " + ec.message();
+        return result;
+    }
+    int64_t modifiedTicks = static_cast<int64_t>(modified.time_since_epoch().count());
+    if (state.path == path && state.modified == modifiedTicks && state.size == size) {
+        return result;
+    }
+    result.fileChanged = true;
+
+    MappedFile file;
+    if (size > 0 && !file.open(path)) {
+        result.error = "Cannot map " + path;
+        return result;
+    }
+
+    // Sections seen by the previous import of the same file are skipped by hash
+    bool samePath = state.path == path;
+    std::unordered_set<uint64_t> seen;
+    std::vector<HistoryImport> imports;
+    std::string_view content(reinterpret_cast<const char*>(file.data()), file.size());
+    result.sections = parseIbases(content, [&](const IbasesSection& section) {
+        seen.insert(section.hash);
+        if (samePath && state.sectionHashes.count(section.hash) != 0) {
+            return;
+        }
+        imports.push_back({std::string(section.connect), ibasesDisplayName(section)});
+        result.versions.emplace_back(std::string(section.connect), std::string(section.version));
+    });
+
+    result.changedSections = imports.size();
+    result.added = history.importEntries(imports);
+
+    state.path = path;
+    state.modified = modifiedTicks;
+    state.size = size;
+    state.sectionHashes = std::move(seen);
+    return result;
+}
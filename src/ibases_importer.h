@@ -0,0 +1,55 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <unordered_set>
+#include <utility>
+#include <vector>
+
+class History;
+class PersistentStorage;
+
+// One [section] of an ibases.v8i file. Views point into the parsed content
+struct IbasesSection {
+    std::string_view name;      // Text between the brackets
+    std::string_view connect;   // Connect= value, a 1C connection string
+    std::string_view folder;    // Folder= value, "/" for the root
+    std::string_view version;   // Version= value, the platform version the base is pinned to (may be empty)
+    uint64_t hash = 0;          // FNV-1a of the whole section text
+};
+
+// Single pass over ibases.v8i content (UTF-8, optional BOM, CRLF or LF).
+// Sections without Connect= (folders) are counted but not reported.
+// Returns the number of sections
+size_t parseIbases(std::string_view content, const std::function<void(const IbasesSection&)>& onSection);
+
+// Display name of a base: "Folder / Name", or just the name in the root folder
+std::string ibasesDisplayName(const IbasesSection& section);
+
+// What the previous import saw, persisted between runs
+struct IbasesImportState {
+    std::string path;
+    int64_t modified = 0;       // Last write time of the file, in file clock ticks
+    uint64_t size = 0;
+    std::unordered_set<uint64_t> sectionHashes;
+
+    void load(const PersistentStorage& storage);
+    void save(PersistentStorage& storage) const;
+};
+
+inline constexpr const char* ibasesImportStorageKey = "ibasesImport";
+
+struct IbasesImportResult {
+    bool fileChanged = false;   // False when mtime and size matched, nothing was parsed
+    size_t sections = 0;
+    size_t changedSections = 0; // Bases whose section text differs from the last import
+    size_t added = 0;           // New history entries
+    std::vector<std::pair<std::string, std::string>> versions;  // (Connect=, Version=) of the changed sections
+    std::string error;          // Set if the file could not be read
+};
+
+// Merges the bases of an ibases.v8i file into history. Unchanged files are
+// skipped by mtime and size, unchanged sections by hash; state is updated
+IbasesImportResult importIbases(const std::string& path, History& history, IbasesImportState& state);
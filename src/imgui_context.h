@@ -0,0 +1,10 @@
+#pragma once
+
+// Included at the end of imgui.h in every translation unit, see
+// IMGUI_INCLUDE_IMGUI_USER_H in CMakeLists.txt. The current ImGui context is
+// per thread: IM_ALLOC and IM_FREE record into the context of the calling
+// thread, so the font atlas worker, which never sets one, leaves the UI
+// context alone while it builds
+struct ImGuiContext;
+extern thread_local ImGuiContext* run1cImGuiContext;
+#define GImGui run1cImGuiContext
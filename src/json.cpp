@@ -0,0 +1,35 @@
+#include "json.h"
+#include "utf_transcode.h"
+
+void appendJsonString(std::string& out, std::string_view value) {
+    static const char hexDigits[] = "0123456789abcdef";
+
+    out += '"';
+    for (size_t i = 0; i < value.size(); ++i) {
+        char c = value[i];
+        switch (c) {
+            case '"':  out += "\\\""; break;
+            case '\\': out += "\\\\"; break;
+            case '\b': out += "\\b"; break;
+            case '\f': out += "\\f"; break;
+            case '\n': out += "\\n"; break;
+            case '\r': out += "\\r"; break;
+            case '\t': out += "\\t"; break;
+            default:
+                if (static_cast<unsigned char>(c) < 0x20) {
+                    out += "\\u00";
+                    out += hexDigits[(c >> 4) & 0x0F];
+                    out += hexDigits[c & 0x0F];
+                } else if (static_cast<unsigned char>(c) < 0x80) {
+                    out += c;
+                } else if (size_t length = utf8SequenceLength(value, i)) {
+                    out.append(value, i, length);
+                    i += length - 1;
+                } else {
+                    // Paths and errors from the system may be in another code page
+                    out += "\xEF\xBF\xBD";
+                }
+        }
+    }
+    out += '"';
+}
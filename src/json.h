@@ -0,0 +1,9 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+
+// Appends value to out as a quoted JSON string with the required escapes.
+// Bytes that are not valid UTF-8 become U+FFFD, one per byte, so the output
+// is always valid UTF-8 JSON
+void appendJsonString(std::string& out, std::string_view value);
@@ -0,0 +1,361 @@
+#include "launch_latency.h"
+#include "error_handler.h"
+#include "frame_arena.h"
+#include "history.h"
+#include "process_supervisor.h"
+#include "task_runtime.h"
+#include <algorithm>
+#include <cmath>
+#include <cstdio>
+#include <stdexcept>
+
+#ifdef _WIN32
+#include <Windows.h>
+#endif
+
+namespace {
+
+constexpr double firstBoundSeconds = 0.25;
+
+// Share of one core the process tree has to use over a poll interval to count as busy
+constexpr double burstCpuShare = 0.5;
+
+std::string formatDuration(std::chrono::nanoseconds duration) {
+    double seconds = std::chrono::duration<double>(duration).count();
+    char buffer[32];
+    if (seconds < 1.0) {
+        std::snprintf(buffer, sizeof(buffer), "%.0f ms", seconds * 1000.0);
+    } else {
+        std::snprintf(buffer, sizeof(buffer), "%.1f s", seconds);
+    }
+    return buffer;
+}
+
+#ifdef _WIN32
+
+struct WindowSearch {
+    const std::vector<int64_t>* pids;
+    bool found;
+};
+
+BOOL CALLBACK findVisibleWindow(HWND window, LPARAM parameter) {
+    auto* search = reinterpret_cast<WindowSearch*>(parameter);
+    if (!IsWindowVisible(window) || GetWindow(window, GW_OWNER) != nullptr) {
+        return TRUE;
+    }
+    DWORD pid = 0;
+    GetWindowThreadProcessId(window, &pid);
+    if (std::find(search->pids->begin(), search->pids->end(), static_cast<int64_t>(pid)) != search->pids->end()) {
+        search->found = true;
+        return FALSE;
+    }
+    return TRUE;
+}
+
+#endif
+
+} // namespace
+
+LaunchLatencyTracker::LaunchLatencyTracker(TaskRuntime& runtime, std::chrono::milliseconds pollInterval, std::chrono::milliseconds timeout)
+    : runtime(runtime), pollInterval(pollInterval), timeout(timeout) {
+}
+
+LaunchLatencyTracker::~LaunchLatencyTracker() {
+    std::future<void> poller;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+        poller = std::move(pollerDone);
+    }
+    stopSource.cancel();
+    if (poller.valid()) {
+        poller.wait();
+    }
+}
+
+void LaunchLatencyTracker::watch(LaunchTrace trace) {
+    Watch watch;
+    watch.pids.push_back(trace.pid);
+    watch.lastSample = trace.spawned;
+    watch.trace = std::move(trace);
+
+    std::promise<void> finished;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (stopping) {
+            return;
+        }
+        incoming.push_back(std::move(watch));
+        activeWatches++;
+        if (polling) {
+            return;
+        }
+        polling = true;
+        pollerDone = finished.get_future();
+    }
+    runtime.spawn(pollLoop(std::move(finished)));
+}
+
+Task<void> LaunchLatencyTracker::pollLoop(std::promise<void> finished) {
+    std::vector<Watch> active;
+    for (;;) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            while (!incoming.empty()) {
+                active.push_back(std::move(incoming.front()));
+                incoming.pop_front();
+            }
+            if (stopping || active.empty()) {
+                // Launches still starting are not waited for on exit
+                activeWatches = 0;
+                polling = false;
+                idleCondition.notify_all();
+                break;
+            }
+        }
+
+        // Process listings and /proc reads block, so the poll runs on the I/O pool.
+        // One process listing per poll, however many launches are watched
+        co_await runtime.io().schedule();
+        std::vector<ListedProcess> processes = ProcessSupervisor::listProcesses();
+        size_t done = 0;
+        for (auto it = active.begin(); it != active.end();) {
+            bool alive = true;
+            if (poll(*it, processes, alive)) {
+                record(it->trace);
+            } else if (!alive) {
+                ErrorHandler::logInfo("1C for " + it->trace.input + " exited before showing activity, launch time not recorded");
+            } else if (LaunchTrace::Clock::now() - it->trace.spawned > timeout) {
+                ErrorHandler::logInfo("No activity from 1C for " + it->trace.input + " within "
+                    + formatDuration(timeout) + ", launch time not recorded");
+            } else {
+                ++it;
+                continue;
+            }
+            it = active.erase(it);
+            done++;
+        }
+
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            activeWatches -= done;
+            if (activeWatches == 0) {
+                idleCondition.notify_all();
+            }
+        }
+
+        try {
+            co_await runtime.delay(pollInterval, stopSource.token());
+        } catch (const TaskCancelled&) {
+            // The tracker or the runtime is going away
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+    }
+    // The tracker may be gone right after this
+    finished.set_value();
+}
+
+bool LaunchLatencyTracker::poll(Watch& watch, const std::vector<ListedProcess>& processes, bool& alive) {
+    // 1cestart hands over to 1cv8 and exits, so the whole tree is followed, and on
+    // Linux the launch's process group, which 1cv8 keeps once it is reparented
+    for (bool grew = true; grew;) {
+        grew = false;
+        for (const ListedProcess& process : processes) {
+            bool member = process.processGroup == watch.pids.front()
+                || std::find(watch.pids.begin(), watch.pids.end(), process.parentPid) != watch.pids.end();
+            if (member && std::find(watch.pids.begin(), watch.pids.end(), process.pid) == watch.pids.end()) {
+                watch.pids.push_back(process.pid);
+                grew = true;
+            }
+        }
+    }
+
+    uint64_t cpuTimeNs = 0;
+    alive = false;
+    for (int64_t pid : watch.pids) {
+        ProcessStats stats;
+        if (ProcessSupervisor::readProcessStats(pid, stats) && !stats.exited) {
+            alive = true;
+            cpuTimeNs += stats.cpuTimeNs;
+        }
+    }
+    auto now = LaunchTrace::Clock::now();
+
+#ifdef _WIN32
+    WindowSearch search = {&watch.pids, false};
+    EnumWindows(findVisibleWindow, reinterpret_cast<LPARAM>(&search));
+    bool active = alive && search.found;
+#else
+    // Time of an exited process drops out of the sum; that interval counts as idle
+    double wallNs = std::chrono::duration<double, std::nano>(now - watch.lastSample).count();
+    bool active = alive && cpuTimeNs > watch.lastCpuTimeNs && wallNs > 0
+        && static_cast<double>(cpuTimeNs - watch.lastCpuTimeNs) >= wallNs * burstCpuShare;
+#endif
+    watch.lastCpuTimeNs = cpuTimeNs;
+    watch.lastSample = now;
+
+    if (active) {
+        watch.trace.firstActivity = now;
+    }
+    return active;
+}
+
+void LaunchLatencyTracker::record(const LaunchTrace& trace) {
+    std::optional<double> typicalSeconds;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        Base& base = bases[historyKeyHash(trace.input)];
+        if (base.input.empty()) {
+            base.input = trace.input;
+        }
+        if (base.count >= minSamples) {
+            typicalSeconds = quantile(base.buckets, 0.5);
+        }
+        if (base.count >= maxSamples) {
+            base.count = 0;
+            for (uint32_t& count : base.buckets) {
+                count = (count + 1) / 2;
+                base.count += count;
+            }
+        }
+        base.buckets[bucketFor(trace.total())]++;
+        base.count++;
+    }
+
+    double seconds = std::chrono::duration<double>(trace.total()).count();
+    if (typicalSeconds && seconds > 2.0 * *typicalSeconds) {
+        char typical[32];
+        std::snprintf(typical, sizeof(typical), "%.1f s", *typicalSeconds);
+        ErrorHandler::logWarning("Slow launch of " + trace.input + ": " + formatDuration(trace.total())
+            + ", typical " + typical + " (" + formatPhases(trace) + ")");
+    } else {
+        ErrorHandler::logInfo("1C for " + trace.input + " active after " + formatDuration(trace.total()));
+    }
+}
+
+std::optional<LaunchLatencySummary> LaunchLatencyTracker::summary(uint64_t key) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = bases.find(key);
+    if (it == bases.end() || it->second.count < minSamples) {
+        return std::nullopt;
+    }
+    LaunchLatencySummary result;
+    result.count = it->second.count;
+    result.medianSeconds = quantile(it->second.buckets, 0.5);
+    result.p90Seconds = quantile(it->second.buckets, 0.9);
+    return result;
+}
+
+const char* LaunchLatencyTracker::lookupTypical(uint64_t key, FrameArena& arena) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = bases.find(key);
+    if (it == bases.end() || it->second.count < minSamples) {
+        return nullptr;
+    }
+    return arena.format("~%.1f s", quantile(it->second.buckets, 0.5));
+}
+
+void LaunchLatencyTracker::waitIdle() {
+    std::unique_lock<std::mutex> lock(mutex);
+    idleCondition.wait(lock, [this] { return activeWatches == 0; });
+}
+
+std::vector<std::string> LaunchLatencyTracker::serialize() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    std::vector<std::string> lines;
+    for (const auto& [key, base] : bases) {
+        // Only the filled buckets; the input goes last so it may contain '|'
+        std::string line;
+        for (size_t bucket = 0; bucket < bucketCount; ++bucket) {
+            if (base.buckets[bucket] == 0) continue;
+            if (!line.empty()) line += ',';
+            line += std::to_string(bucket) + ":" + std::to_string(base.buckets[bucket]);
+        }
+        lines.push_back(line + "|" + base.input);
+    }
+    return lines;
+}
+
+void LaunchLatencyTracker::deserialize(const std::vector<std::string>& lines) {
+    std::lock_guard<std::mutex> lock(mutex);
+    for (const auto& line : lines) {
+        size_t separator = line.find('|');
+        if (separator == std::string::npos || separator + 1 >= line.size()) {
+            continue; // Skip malformed entries
+        }
+
+        Base base;
+        base.input = line.substr(separator + 1);
+        try {
+            size_t start = 0;
+            while (start < separator) {
+                size_t end = std::min(line.find(',', start), separator);
+                size_t colon = line.find(':', start);
+                if (colon == std::string::npos || colon >= end) {
+                    throw std::invalid_argument("bucket");
+                }
+                size_t bucket = std::stoul(line.substr(start, colon - start));
+                uint32_t count = static_cast<uint32_t>(std::stoul(line.substr(colon + 1, end - colon - 1)));
+                if (bucket >= bucketCount) {
+                    throw std::out_of_range("bucket");
+                }
+                base.buckets[bucket] += count;
+                base.count += count;
+                start = end + 1;
+            }
+        } catch (const std::exception&) {
+            continue;
+        }
+        if (base.count > 0) {
+            bases[historyKeyHash(base.input)] = std::move(base);
+        }
+    }
+}
+
+size_t LaunchLatencyTracker::bucketFor(std::chrono::nanoseconds latency) {
+    double seconds = std::chrono::duration<double>(latency).count();
+    if (seconds <= firstBoundSeconds) {
+        return 0;
+    }
+    double bucket = std::ceil(2.0 * std::log2(seconds / firstBoundSeconds));
+    return std::min(static_cast<size_t>(bucket), bucketCount - 1);
+}
+
+double LaunchLatencyTracker::bucketUpperSeconds(size_t bucket) {
+    return firstBoundSeconds * std::exp2(bucket / 2.0);
+}
+
+double LaunchLatencyTracker::quantile(const std::array<uint32_t, bucketCount>& buckets, double share) {
+    uint64_t total = 0;
+    for (uint32_t count : buckets) {
+        total += count;
+    }
+    if (total == 0) {
+        return 0.0;
+    }
+
+    // Buckets grow geometrically, so the position inside one is interpolated on a log scale
+    double target = share * static_cast<double>(total);
+    uint64_t cumulative = 0;
+    for (size_t bucket = 0; bucket < bucketCount; ++bucket) {
+        if (buckets[bucket] == 0 || static_cast<double>(cumulative + buckets[bucket]) < target) {
+            cumulative += buckets[bucket];
+            continue;
+        }
+        double lower = bucketUpperSeconds(bucket) / std::sqrt(2.0);
+        double upper = bucketUpperSeconds(bucket);
+        double fraction = (target - static_cast<double>(cumulative)) / buckets[bucket];
+        return lower * std::pow(upper / lower, fraction);
+    }
+    return bucketUpperSeconds(bucketCount - 1);
+}
+
+std::string LaunchLatencyTracker::formatPhases(const LaunchTrace& trace) {
+    using std::chrono::duration_cast;
+    using std::chrono::nanoseconds;
+    return "extract " + formatDuration(duration_cast<nanoseconds>(trace.extracted - trace.requested))
+        + ", validate " + formatDuration(duration_cast<nanoseconds>(trace.validated - trace.extracted))
+        + ", start " + formatDuration(duration_cast<nanoseconds>(trace.spawned - trace.validated))
+        + ", first activity " + formatDuration(duration_cast<nanoseconds>(trace.firstActivity - trace.spawned));
+}
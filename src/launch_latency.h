@@ -0,0 +1,134 @@
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <future>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include "cancellation.h"
+#include "task.h"
+
+class FrameArena;
+class TaskRuntime;
+struct ListedProcess;
+
+// Storage key of the per-base latency histograms: "<bucket>:<count>,...|<input>"
+inline constexpr const char* launchLatencyStorageKey = "baseLaunchLatency";
+
+// Timestamps of one launch, from the request to the first sign of 1C being usable
+struct LaunchTrace {
+    using Clock = std::chrono::steady_clock;
+
+    std::string input;
+    bool configMode = false;
+    int64_t pid = 0;                    // Spawned starter
+
+    Clock::time_point requested;        // RUN1C::run entered (the frame Enter was handled in)
+    Clock::time_point extracted;        // Base path extracted, or connection string parsed
+    Clock::time_point validated;        // Path checked on disk (same as extracted for server and web bases)
+    Clock::time_point spawned;          // Starter created, after a Configurator snapshot if one was taken
+    Clock::time_point firstActivity;    // First visible window on Windows, first CPU burst elsewhere
+
+    Clock::duration total() const { return firstActivity - requested; }
+};
+
+// Typical open time of a base, estimated from its histogram
+struct LaunchLatencySummary {
+    uint32_t count = 0;
+    double medianSeconds = 0.0;
+    double p90Seconds = 0.0;
+};
+
+// Per-base histograms of the time from Enter to a usable 1C. Spawned starters
+// are watched until their process tree shows a window (Windows) or burns CPU
+// (elsewhere); launches whose processes exit or stay idle until the timeout
+// are dropped. The polls run as a task on the runtime's I/O pool, started by
+// the first watch and ending with the last one, so no thread waits while no
+// launch is watched. A launch taking more than twice the base's median is
+// logged with its per-phase breakdown.
+// The runtime must outlive the tracker; once it is destroyed, watches are dropped
+class LaunchLatencyTracker {
+public:
+    // Upper bounds grow by sqrt(2) from 0.25 s, the last bucket takes the rest
+    static constexpr size_t bucketCount = 20;
+    // Counts are halved when a base reaches this many, so recent launches weigh more
+    static constexpr uint32_t maxSamples = 200;
+    // Samples a base needs before typical times are shown and outliers are reported
+    static constexpr uint32_t minSamples = 5;
+
+    explicit LaunchLatencyTracker(TaskRuntime& runtime, std::chrono::milliseconds pollInterval = std::chrono::milliseconds(50),
+                                  std::chrono::milliseconds timeout = std::chrono::seconds(120));
+    ~LaunchLatencyTracker();
+
+    LaunchLatencyTracker(const LaunchLatencyTracker&) = delete;
+    LaunchLatencyTracker& operator=(const LaunchLatencyTracker&) = delete;
+
+    // Watches trace.pid and its children for the first activity, then records
+    // the launch. Dropped once the runtime has stopped
+    void watch(LaunchTrace trace);
+
+    // Adds a finished launch to the histogram of its base
+    void record(const LaunchTrace& trace);
+
+    // Null until the base has minSamples launches
+    std::optional<LaunchLatencySummary> summary(uint64_t key) const;
+
+    // "~4.2 s" for the history row, null until the base has minSamples launches
+    const char* lookupTypical(uint64_t key, FrameArena& arena) const;
+
+    // Blocks until every watched launch is recorded or dropped
+    void waitIdle();
+
+    // Persistence, one base per line
+    std::vector<std::string> serialize() const;
+    void deserialize(const std::vector<std::string>& lines);
+
+    static size_t bucketFor(std::chrono::nanoseconds latency);
+    static double bucketUpperSeconds(size_t bucket);
+
+    // Latency below which the given share of samples fall, interpolated within the bucket
+    static double quantile(const std::array<uint32_t, bucketCount>& buckets, double share);
+
+    // "extract 2 ms, validate 1 ms, start 35 ms, first activity 4.1 s"
+    static std::string formatPhases(const LaunchTrace& trace);
+
+private:
+    struct Base {
+        std::string input;
+        std::array<uint32_t, bucketCount> buckets{};
+        uint32_t count = 0;
+    };
+
+    struct Watch {
+        LaunchTrace trace;
+        std::vector<int64_t> pids;      // Starter and every descendant seen so far
+        uint64_t lastCpuTimeNs = 0;
+        LaunchTrace::Clock::time_point lastSample;
+    };
+
+    // Polls until no watch is left or the tracker stops, then sets finished
+    Task<void> pollLoop(std::promise<void> finished);
+    // True once the tree of watch shows activity; alive is cleared when all its processes are gone
+    bool poll(Watch& watch, const std::vector<ListedProcess>& processes, bool& alive);
+
+    TaskRuntime& runtime;
+    std::chrono::milliseconds pollInterval;
+    std::chrono::milliseconds timeout;
+    CancellationSource stopSource;      // Ends the delay between polls on destruction
+
+    mutable std::mutex mutex;
+    std::condition_variable idleCondition;
+    std::deque<Watch> incoming;
+    size_t activeWatches = 0;
+    bool polling = false;               // A poll task is running
+    bool stopping = false;
+    std::future<void> pollerDone;       // Of the last poll task started
+    std::unordered_map<uint64_t, Base> bases;
+};
@@ -0,0 +1,244 @@
+#include "launcher.h"
+#include "base_path.h"
+#include "config.h"
+#include "error_handler.h"
+#include "metrics.h"
+#include "process_spawner.h"
+#include "task_runtime.h"
+#include <filesystem>
+
+std::string RUN1C::getStarterPath() const {
+    return starterPath ? *starterPath : Config::get1CStarterPath();
+}
+
+std::shared_ptr<BaseSnapshot> RUN1C::takeSnapshot(const std::string& basePath) {
+    if (snapshot && !snapshot->isFinished()) {
+        ErrorHandler::logWarning("Previous snapshot is still running, skipping snapshot of: " + basePath);
+        return nullptr;
+    }
+
+    std::string snapshotDirectory = Config::getSnapshotDirectory();
+    ErrorHandler::logInfo("Taking snapshot of " + basePath + " into " + snapshotDirectory);
+    snapshot = std::make_shared<BaseSnapshot>(basePath, snapshotDirectory, Config::getSnapshotRetention());
+    snapshot->start();
+    return snapshot;
+}
+
+void RUN1C::awaitSnapshot(BaseSnapshot& snapshot) {
+    // The copy keeps running in the background if it takes longer than the threshold,
+    // but it is no longer a consistent snapshot once the Configurator opens the base
+    int timeoutMs = Config::getSnapshotWaitTimeoutMs();
+    snapshot.waitFor(std::chrono::milliseconds(timeoutMs));
+    if (snapshot.markBaseOpened()) {
+        ErrorHandler::logWarning("Snapshot still running after " + std::to_string(timeoutMs)
+            + " ms, launching anyway; the copy will be kept as incomplete");
+    } else if (snapshot.getState() == BaseSnapshot::State::Completed) {
+        ErrorHandler::logInfo("Snapshot saved to " + snapshot.getDestination() + " using " + FileCopier::methodName(snapshot.getMethod()));
+    } else {
+        ErrorHandler::logWarning("Snapshot failed: " + snapshot.getError());
+    }
+}
+
+Task<void> RUN1C::launchAfterSnapshot(std::shared_ptr<BaseSnapshot> pending, std::string input, LaunchPlan plan,
+                                      std::string program, std::string starter, LaunchTrace trace) {
+    // Waiting blocks for up to the snapshot timeout, so it runs on the I/O pool
+    co_await runtime->io().schedule();
+    awaitSnapshot(*pending);
+    try {
+        spawn(input, plan, program, starter, true, std::move(trace));
+    } catch (const std::exception& e) {
+        ErrorHandler::showError(ErrorType::LaunchFailed, "Exception during launch: " + std::string(e.what()));
+    }
+}
+
+void RUN1C::waitForSnapshot() {
+    if (snapshot && !snapshot->isFinished()) {
+        ErrorHandler::logInfo("Waiting for snapshot of " + snapshot->getBaseDirectory() + " to finish");
+        while (!snapshot->waitFor(std::chrono::seconds(1))) {
+        }
+    }
+}
+
+std::optional<LaunchPlan> RUN1C::prepare(const std::string& input, bool isConfigMode, std::string* error, LaunchTrace* trace) const {
+    auto fail = [error](const std::string& reason) -> std::optional<LaunchPlan> {
+        if (error) {
+            *error = reason;
+        }
+        return std::nullopt;
+    };
+
+    // Validate input
+    if (input.empty()) {
+        ErrorHandler::logError(ErrorType::InvalidPath, "Empty input provided");
+        return fail("Empty input provided");
+    }
+
+    LaunchPlan plan;
+    ErrorHandler::logInfo("Processing input: " + input);
+
+    if (isConfigMode) {
+        plan.args.push_back("CONFIG");
+    } else {
+        plan.args.push_back("ENTERPRISE");
+    }
+
+    // Server and web bases have nothing on disk to validate
+    ConnectionString connection;
+    if (parseConnectionString(input, connection) && connection.kind != ConnectionKind::File) {
+        plan.kind = connection.kind;
+        plan.basePath = connectionDisplayName(connection);
+        ErrorHandler::logInfo("Parsed " + std::string(connection.kind == ConnectionKind::Server ? "server" : "web") + " base: " + plan.basePath);
+        for (auto& arg : connectionArguments(connection)) {
+            plan.args.push_back(std::move(arg));
+        }
+        if (trace) {
+            trace->extracted = trace->validated = LaunchTrace::Clock::now();
+        }
+        return plan;
+    }
+
+    ErrorHandler::logInfo("Running regex extraction on input");
+
+    std::optional<std::string> extracted;
+    {
+        MetricsTimer timer(LauncherMetrics::get().extraction);
+        extracted = extractBasePath(input);
+    }
+    if (trace) {
+        trace->extracted = LaunchTrace::Clock::now();
+    }
+    if (!extracted) {
+        ErrorHandler::logError(ErrorType::InvalidPath, "Could not extract valid path from input: " + input);
+        return fail("Could not extract valid path from input");
+    }
+
+    std::string path = *extracted;
+    ErrorHandler::logInfo("Extracted path: " + path);
+
+    // Validate extracted path
+    bool exists = false;
+    {
+        MetricsTimer timer(LauncherMetrics::get().validation);
+        exists = ErrorHandler::validatePath(path);
+    }
+    if (trace) {
+        trace->validated = LaunchTrace::Clock::now();
+    }
+    if (!exists) {
+        ErrorHandler::showError(ErrorType::InvalidPath, "Database path does not exist: " + path);
+        return fail("Database path does not exist: " + path);
+    }
+
+    // Check if the path points to a 1Cv8.1cd file (case-insensitive)
+    std::filesystem::path filepath(path);
+    std::string filename = filepath.filename().string();
+
+    if (isDatabaseFileName(filename)) {
+        // Use the parent directory path
+        path = filepath.parent_path().string();
+        ErrorHandler::logInfo("Found " + filename + " file, using parent directory: " + path);
+    }
+
+    plan.basePath = path;
+    plan.args.push_back("/F");
+    plan.args.push_back(path);
+    return plan;
+}
+
+std::string RUN1C::programFor(const std::string& input, const LaunchPlan& plan) const {
+    return programFor(input, plan, getStarterPath());
+}
+
+std::string RUN1C::programFor(const std::string& input, const LaunchPlan& plan, const std::string& starter) const {
+    // Web bases are left to the starter, which picks the client for them
+    if (!platforms || !Config::get(ConfigKeys::directLaunch) || plan.kind == ConnectionKind::Web) {
+        return starter;
+    }
+
+    platforms->refresh();
+    std::string pin = platforms->pinFor(input);
+    auto platform = platforms->resolve(input);
+    if (!platform) {
+        ErrorHandler::logWarning("No installed platform " + (pin.empty() ? std::string("found") : "matches version " + pin)
+            + ", launching through the starter");
+        return starter;
+    }
+    if (!ErrorHandler::validatePath(platform->executable)) {
+        // Removed without changing its root; the next launch scans again
+        ErrorHandler::logWarning("Platform " + platform->version + " is gone, launching through the starter");
+        platforms->invalidate();
+        return starter;
+    }
+    ErrorHandler::logInfo("Using platform " + platform->version + (pin.empty() ? "" : " (pinned " + pin + ")"));
+    return platform->executable;
+}
+
+bool RUN1C::run(std::string input, bool isConfigMode) {
+    LaunchTrace trace;
+    trace.requested = LaunchTrace::Clock::now();
+    try {
+        // Validate starter path exists; with direct launch it is only needed as the fallback.
+        // Resolved once per launch, so a changed starterPath setting applies to the next one
+        std::string starter = getStarterPath();
+        bool direct = platforms && Config::get(ConfigKeys::directLaunch);
+        if (!direct && !ErrorHandler::validate1CPath(starter)) {
+            ErrorHandler::showError(ErrorType::FileNotFound, "1C starter not found at: " + starter);
+            return false;
+        }
+
+        auto plan = prepare(input, isConfigMode, nullptr, &trace);
+        if (!plan) {
+            return false;
+        }
+
+        std::string program = programFor(input, *plan, starter);
+        if (direct && program == starter && !ErrorHandler::validate1CPath(starter)) {
+            ErrorHandler::showError(ErrorType::FileNotFound, "1C starter not found at: " + starter);
+            return false;
+        }
+
+        if (isConfigMode && Config::isSnapshotEnabled() && plan->kind == ConnectionKind::File) {
+            if (auto pending = takeSnapshot(plan->basePath)) {
+                if (runtime) {
+                    runtime->spawn(launchAfterSnapshot(std::move(pending), input, *plan, program, starter, std::move(trace)));
+                    return true;
+                }
+                awaitSnapshot(*pending);
+            }
+        }
+
+        spawn(input, *plan, program, starter, isConfigMode, std::move(trace));
+        return true;
+
+    } catch (const std::exception& e) {
+        ErrorHandler::showError(ErrorType::LaunchFailed, "Exception during launch: " + std::string(e.what()));
+        return false;
+    }
+}
+
+void RUN1C::spawn(const std::string& input, const LaunchPlan& plan, const std::string& program, const std::string& starter,
+                  bool isConfigMode, LaunchTrace trace) {
+    ErrorHandler::logInfo("Launching 1C: " + formatCommandLine(program, plan.args));
+    // 1cestart hands over to 1cv8 and exits, its exit code is only worth a log line
+    std::weak_ptr<ProcessSupervisor> watcher = supervisor;
+    const char* what = program == starter ? "1C starter" : "1C";
+    int64_t pid = ProcessSpawner::instance().spawn(program, plan.args, [watcher, what](const ProcessExit& exit) {
+        if (exit.exitCode != 0) {
+            ErrorHandler::logWarning(std::string(what) + " (pid " + std::to_string(exit.pid) + ") exited with code " + std::to_string(exit.exitCode));
+        }
+        if (auto target = watcher.lock()) {
+            target->markExited(exit.pid, exit.exitCode);
+        }
+    });
+    trace.spawned = LaunchTrace::Clock::now();
+    if (supervisor) {
+        supervisor->track(pid, plan.basePath, plan.args.front());
+    }
+    if (latencyTracker) {
+        trace.input = input;
+        trace.configMode = isConfigMode;
+        trace.pid = pid;
+        latencyTracker->watch(std::move(trace));
+    }
+    LauncherMetrics::get().launches(isConfigMode).add();
+}
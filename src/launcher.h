@@ -0,0 +1,83 @@
+#pragma once
+
+#include <memory>
+#include <optional>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "base_snapshot.h"
+#include "connection_string.h"
+#include "launch_latency.h"
+#include "platform_registry.h"
+#include "process_supervisor.h"
+#include "task.h"
+
+class TaskRuntime;
+
+// What RUN1C would pass to 1cestart for a given input
+struct LaunchPlan {
+    ConnectionKind kind = ConnectionKind::File;
+    std::string basePath;           // Base directory (1Cv8.1CD resolved to its parent), server\ref or URL
+    std::vector<std::string> args;  // Mode followed by the base arguments, unquoted
+};
+
+class RUN1C {
+public:
+    // Follows the starterPath setting, read again for every launch
+    RUN1C() = default;
+    RUN1C(std::string starterPath) : starterPath(std::move(starterPath)) {};
+
+    // Extracts and validates the base path from input without launching anything.
+    // Safe to call from several threads; the failure reason goes to error if given,
+    // the extraction and validation times to trace
+    std::optional<LaunchPlan> prepare(const std::string& input, bool isConfigMode = false, std::string* error = nullptr,
+                                      LaunchTrace* trace = nullptr) const;
+
+    // Prepares and launches 1C, returns false if the input or the starter is invalid.
+    // A Configurator launch behind a snapshot starts once the snapshot had its
+    // time, on the task runtime when one is set
+    bool run(std::string input, bool isConfigMode = false);
+
+    std::string getStarterPath() const;
+
+    // What run() starts for plan: the base's 1cv8 when direct launch is enabled
+    // and an installed platform matches, the starter otherwise
+    std::string programFor(const std::string& input, const LaunchPlan& plan) const;
+
+    // Snapshot taken before the last Configurator launch (nullptr if none)
+    const BaseSnapshot* getSnapshot() const { return snapshot.get(); }
+
+    // Blocks until a running snapshot finishes (used before the process exits)
+    void waitForSnapshot();
+
+    // Launched processes are reported to the supervisor when one is set
+    void setSupervisor(std::shared_ptr<ProcessSupervisor> processSupervisor) { supervisor = std::move(processSupervisor); }
+
+    // Launches are timed until 1C shows activity when a tracker is set
+    void setLatencyTracker(std::shared_ptr<LaunchLatencyTracker> tracker) { latencyTracker = std::move(tracker); }
+
+    // Installed platforms for direct launch (the directLaunch setting)
+    void setPlatformRegistry(std::shared_ptr<PlatformRegistry> registry) { platforms = std::move(registry); }
+
+    // The wait for a snapshot runs there instead of on the calling (UI) thread; null to wait inline
+    void setTaskRuntime(TaskRuntime* taskRuntime) { runtime = taskRuntime; }
+private:
+    // Starts a snapshot of basePath, null if the previous one is still running
+    std::shared_ptr<BaseSnapshot> takeSnapshot(const std::string& basePath);
+    // Gives snapshot up to snapshotWaitTimeoutMs, then records that the base is being opened
+    static void awaitSnapshot(BaseSnapshot& snapshot);
+    Task<void> launchAfterSnapshot(std::shared_ptr<BaseSnapshot> pending, std::string input, LaunchPlan plan,
+                                   std::string program, std::string starter, LaunchTrace trace);
+    // Starts program and reports it to the supervisor and the latency tracker
+    void spawn(const std::string& input, const LaunchPlan& plan, const std::string& program, const std::string& starter,
+               bool isConfigMode, LaunchTrace trace);
+    std::string programFor(const std::string& input, const LaunchPlan& plan, const std::string& starter) const;
+
+    std::optional<std::string> starterPath;     // Null: Config::get1CStarterPath()
+    std::shared_ptr<BaseSnapshot> snapshot;     // Shared with a launch waiting for it
+    TaskRuntime* runtime = nullptr;
+    std::shared_ptr<ProcessSupervisor> supervisor;
+    std::shared_ptr<LaunchLatencyTracker> latencyTracker;
+    std::shared_ptr<PlatformRegistry> platforms;
+};
@@ -0,0 +1,92 @@
+#include "local_socket.h"
+
+#ifndef _WIN32
+
+#include <cerrno>
+#include <cstring>
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+LocalSocketListener::~LocalSocketListener() {
+    close();
+}
+
+LocalSocketListener::Result LocalSocketListener::listen(const std::string& path, std::string* error) {
+    auto fail = [&](const std::string& reason) {
+        if (error) {
+            *error = reason;
+        }
+        close();
+        return Result::Failed;
+    };
+    close();
+
+    sockaddr_un address;
+    std::memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    if (path.empty() || path.size() >= sizeof(address.sun_path)) {
+        return fail("socket path is empty or too long");
+    }
+    std::memcpy(address.sun_path, path.c_str(), path.size() + 1);
+
+    // Held until close(); the kernel drops it if the process dies, so a stale lock never blocks
+    lock = ::open(lockPath(path).c_str(), O_RDWR | O_CREAT | O_CLOEXEC, S_IRUSR | S_IWUSR);
+    if (lock < 0) {
+        return fail(lockPath(path) + ": " + std::strerror(errno));
+    }
+    if (::flock(lock, LOCK_EX | LOCK_NB) != 0) {
+        if (errno != EWOULDBLOCK) {
+            return fail(lockPath(path) + ": " + std::strerror(errno));
+        }
+        close();
+        return Result::Busy;
+    }
+
+    // A launcher without the lock may still serve the path; otherwise the file is left over from a crash
+    int probe = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (probe >= 0) {
+        bool served = ::connect(probe, reinterpret_cast<sockaddr*>(&address), sizeof(address)) == 0;
+        ::close(probe);
+        if (served) {
+            close();
+            return Result::Busy;
+        }
+    }
+    ::unlink(path.c_str());
+
+    // Connecting fails until listen(), so the mode is in place before anyone can get in
+    socket = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (socket < 0) {
+        return fail(std::strerror(errno));
+    }
+    if (::bind(socket, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0) {
+        return fail(std::strerror(errno));
+    }
+    this->path = path;
+    if (::chmod(path.c_str(), S_IRUSR | S_IWUSR) != 0 || ::listen(socket, 16) != 0) {
+        return fail(std::strerror(errno));
+    }
+    return Result::Listening;
+}
+
+void LocalSocketListener::close() {
+    if (socket >= 0) {
+        ::close(socket);
+        socket = -1;
+    }
+    // Only the lock holder may remove the file; the next one would otherwise lose its socket
+    if (!path.empty()) {
+        ::unlink(path.c_str());
+        path.clear();
+    }
+    if (lock >= 0) {
+        ::close(lock);
+        lock = -1;
+    }
+}
+
+#endif
@@ -0,0 +1,42 @@
+#pragma once
+
+#include <string>
+
+#ifndef _WIN32
+
+// A Unix domain socket listening on a path, for one process at a time. An
+// flock on "<path>.lock", held while listening, serializes processes starting
+// up: only the holder probes the path, removes a stale socket file and binds,
+// so two of them never both unlink and bind it. The socket file is made
+// owner-only before listen(), so no other user can connect at any point
+class LocalSocketListener {
+public:
+    enum class Result {
+        Listening,
+        Busy,       // Another process listens on the path or is starting to
+        Failed
+    };
+
+    LocalSocketListener() = default;
+    ~LocalSocketListener();
+
+    LocalSocketListener(const LocalSocketListener&) = delete;
+    LocalSocketListener& operator=(const LocalSocketListener&) = delete;
+
+    // The reason goes to error if given and the result is Failed
+    Result listen(const std::string& path, std::string* error = nullptr);
+    // Removes the socket file, then releases the lock
+    void close();
+
+    bool isListening() const { return socket >= 0; }
+    int fd() const { return socket; }
+
+    static std::string lockPath(const std::string& path) { return path + ".lock"; }
+
+private:
+    std::string path;
+    int socket = -1;
+    int lock = -1;
+};
+
+#endif
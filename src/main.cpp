@@ -12,105 +12,32 @@
 #include <iostream>
 #include <vector>
 #include <algorithm>
-#include <map>
-#include <fstream>
-#include <sstream>
-#include <variant>
 #include <memory>
+#include <ctime>
 #include <filesystem>
-#include <regex>
-#include <algorithm>
 
 #include "utils.h"
 #include "config.h"
+#include "allocation_stats.h"
 #include "error_handler.h"
-
-class RUN1C {
-public:
-    RUN1C() {
-        starterPath = Config::get1CStarterPath();
-    };
-    RUN1C(std::string starterPath) : starterPath(starterPath) {};
-    bool run(std::string input, bool isConfigMode = false);
-private:
-    std::string starterPath;
-};
-
-bool RUN1C::run(std::string input, bool isConfigMode) {
-    try {
-        // Validate input
-        if (input.empty()) {
-            ErrorHandler::logError(ErrorType::InvalidPath, "Empty input provided");
-            return false;
-        }
-
-        // Validate starter path exists
-        if (!ErrorHandler::validate1CPath(starterPath)) {
-            ErrorHandler::showError(ErrorType::FileNotFound, "1C starter not found at: " + starterPath);
-            return false;
-        }
-
-        std::vector<std::string> args;
-        ErrorHandler::logInfo("Processing input: " + input);
-
-        if (isConfigMode) {
-            args.push_back("CONFIG");
-        } else {
-            args.push_back("ENTERPRISE");
-        }
-
-        ErrorHandler::logInfo("Running regex extraction on input");
-
-        // Enhanced regex to better handle full paths with special characters
-        std::regex filepathRegex("([a-zA-Z]:\\\\[^\"]+?)(?=\"|$)", std::regex_constants::ECMAScript);
-        std::smatch m;
-
-        if (std::regex_search(input, m, filepathRegex)) {
-            std::string path = m[0].str();
-            ErrorHandler::logInfo("Extracted path: " + path);
-
-            // Remove any trailing backslashes except for root paths like "C:\"
-            if (path.length() > 3 && path.back() == '\\') {
-                path.pop_back();
-            }
-
-            // Validate extracted path
-            if (!ErrorHandler::validatePath(path)) {
-                ErrorHandler::showError(ErrorType::InvalidPath, "Database path does not exist: " + path);
-                return false;
-            }
-
-            // Check if the path points to a 1Cv8.1cd file (case-insensitive)
-            std::filesystem::path filepath(path);
-            std::string filename = filepath.filename().string();
-            std::string lowercaseFilename = filename;
-            // Convert filename to lowercase for case-insensitive comparison
-            std::transform(lowercaseFilename.begin(), lowercaseFilename.end(), lowercaseFilename.begin(),
-                [](unsigned char c){ return std::tolower(c); });
-
-            if (lowercaseFilename == "1cv8.1cd") {
-                // Use the parent directory path
-                path = filepath.parent_path().string();
-                ErrorHandler::logInfo("Found " + filename + " file, using parent directory: " + path);
-            }
-
-            args.push_back("/F");
-            args.push_back("\"" + path + "\"");
-
-            ErrorHandler::logInfo("Launching 1C with path: " + path);
-            launchProcess(starterPath, args);
-            return true;
-
-        } else {
-            ErrorHandler::logError(ErrorType::InvalidPath, "Could not extract valid path from input: " + input);
-            return false;
-        }
-
-    } catch (const std::exception& e) {
-        ErrorHandler::showError(ErrorType::LaunchFailed, "Exception during launch: " + std::string(e.what()));
-        return false;
-    }
-}
+#include "base_metadata.h"
+#include "base_snapshot.h"
+#include "command_line.h"
+#include "config_watcher.h"
+#include "font_atlas_cache.h"
+#include "history.h"
+#include "ibases_importer.h"
+#include "launch_latency.h"
+#include "launcher.h"
+#include "main_window.h"
+#include "metrics.h"
+#include "metrics_exporter.h"
+#include "persistent_storage.h"
+#include "platform_registry.h"
+#include "process_supervisor.h"
+#include "server_health.h"
+#include "single_instance.h"
+#include "task_runtime.h"
 
 float getScreenDPI(SDL_Window* window) {
     float dpi = -1.0f;
@@ -121,217 +48,50 @@ float getScreenDPI(SDL_Window* window) {
     return dpi;
 }
 
-using PersistentStorage_StoreItem = std::variant<std::string, std::vector<std::string>>;
-
-class PersistentStorage {
-public:
-    PersistentStorage();
-
-    // Loads configuration from file
-    void load();
-
-    // Saves configuration to file
-    void save();
-
-    // Store a string or array value by key
-    void put(const std::string& key, const PersistentStorage_StoreItem& value);
-
-    // Get a string value by key (returns empty string if not found or not a string)
-    std::string getItem(const std::string& key) const;
-
-    // Get a vector<string> by key (returns empty vector if not found or not an array)
-    std::vector<std::string> getArray(const std::string& key) const;
-
-    // Get a modifiable reference to a vector<string> by key (throws if not found or not an array)
-    std::vector<std::string>& getArrayRef(const std::string& key);
-
-    // Check if key exists
-    bool contains(const std::string& key) const;
-
-private:
-    std::string filepath;
-    std::map<std::string, PersistentStorage_StoreItem> store;
-
-    // Helper to parse lines like [type:name] or [type:type:name]
-    std::vector<std::string> parseBracketedLine(const std::string& line) const;
-
-    // Ensure config file exists
-    void createFileIfNotExists(const std::string& path) const;
-};
+int main(int argc, char** argv) {
 
-PersistentStorage::PersistentStorage() {
-    filepath = Config::getStorageFilePath();
-    std::cout << "[config] Using storage path: " << filepath << std::endl;
-
-    // Ensure storage directories and file exist
-    createFileIfNotExists(filepath);
-    std::cout << "[config] Storage initialized successfully" << std::endl;
-}
-
-std::vector<std::string> PersistentStorage::parseBracketedLine(const std::string& line) const {
-    std::vector<std::string> result;
-    if (line.size() < 3 || line.front() != '[' || line.back() != ']')
-        return result;
-
-    std::string inner = line.substr(1, line.size() - 2); // Remove [ and ]
-    std::stringstream ss(inner);
-    std::string part;
-    while (std::getline(ss, part, ':')) {
-        result.push_back(part);
-    }
-
-    return result;
-}
-
-void PersistentStorage::createFileIfNotExists(const std::string& path) const {
-    // Create parent directory if it doesn't exist
-    std::filesystem::path filePath(path);
-    std::filesystem::path parentDir = filePath.parent_path();
-    if (!parentDir.empty() && !std::filesystem::exists(parentDir)) {
-        std::cout << "[config] Creating directory: " << parentDir.string() << std::endl;
-        std::filesystem::create_directories(parentDir);
-    }
-
-    // Create file if it doesn't exist
-    if (!std::filesystem::exists(path)) {
-        std::cout << "[config] Creating storage file: " << path << std::endl;
-        std::ofstream outfile(path, std::ios::app);
-        outfile.close();
-    }
-}
-
-void PersistentStorage::load() {
-
-    std::ifstream infile(filepath);
-    std::vector<std::string> lines;
-
-    {
-        std::string line;
-        while(std::getline(infile, line)) {
-            // Strip leading and trailing whitespace
-            line.erase(0, line.find_first_not_of(" \t\r\n"));
-            line.erase(line.find_last_not_of(" \t\r\n") + 1);
-            if (line.empty()) continue; // Skip empty lines
-            lines.push_back(line);
-        }
-    }
-
-    for (size_t i = 0; i < lines.size(); ++i) {
-
-        const auto& line = lines[i];
-        auto parts = parseBracketedLine(line);
-
-        if (parts.size() == 1) {
-            std::string key = parts[0];
-            if (i + 1 < lines.size()) {
-                const auto& nextLine = lines[i + 1];
-                if (nextLine.front() == '[' || nextLine.back() == ']') {
-                    std::cerr << "[config loading] ERROR: missing value for key: " << key << std::endl;
-                    continue;
-                }
-                std::cout << "[config loading] " << key << " = " << nextLine << std::endl;
-                store.emplace(key, nextLine);
-                i++;
-            } else {
-                std::cerr << "[config loading] ERROR: missing value for key: " << key << std::endl;
-            }
-        } else if (parts.size() == 2 && parts[0] == "array") {
-            std::string key = parts[1];
-            std::vector<std::string> array;
-            while(i + 1 < lines.size()) {
-                const auto& nextLine = lines[i + 1];
-                if (nextLine.front() == '[' || nextLine.back() == ']') {
-                    break;
-                }
-                std::cout << "[config loading] " << key << " << " << nextLine << std::endl;
-                array.push_back(nextLine);
-                i++;
-            }
-            if (array.size() == 0) {
-                std::cerr << "[config loading] ERROR: missing items for array: " << key << std::endl;
-                continue;
-            }
-            store.emplace(key, array);
-        } else {
-            std::cerr << "[config loading] ERROR: wrong file format" << std::endl;
-        }
-
-    }
-
-}
-
-void PersistentStorage::save() {
-    std::cout << "[config saving] persisting storage to disk" << std::endl;
-
-    std::ofstream outfile(filepath, std::ios::trunc);
-    if (!outfile.is_open()) {
-        std::cerr << "[config saving] ERROR: Unable to open file for saving: " << filepath << std::endl;
-        return;
-    }
-
-    for (const auto& [key, value] : store) {
-        if (std::holds_alternative<std::string>(value)) {
-            outfile << "[" << key << "]" << std::endl;
-            outfile << std::get<std::string>(value) << std::endl;
-        } else if (std::holds_alternative<std::vector<std::string>>(value)) {
-            outfile << "[array:" << key << "]" << std::endl;
-            for (const auto& item : std::get<std::vector<std::string>>(value)) {
-                outfile << item << std::endl;
-            }
-        }
-    }
-
-    outfile.close();
-    std::cout << "[config saving] storage saved successfully" << std::endl;
-}
-
-void PersistentStorage::put(const std::string& key, const PersistentStorage_StoreItem& value) {
-    store[key] = value;
-}
-
-std::string PersistentStorage::getItem(const std::string& key) const {
-    auto it = store.find(key);
-    if (it != store.end()) {
-        if (std::holds_alternative<std::string>(it->second)) {
-            std::string value = std::get<std::string>(it->second);
-            return value;
-        }
-    }
-    return "";
-}
+    SetConsoleOutputCP(CP_UTF8);
 
-std::vector<std::string> PersistentStorage::getArray(const std::string& key) const {
-    auto it = store.find(key);
-    if (it != store.end()) {
-        if (std::holds_alternative<std::vector<std::string>>(it->second)) {
-            const auto& vec = std::get<std::vector<std::string>>(it->second);
-            return vec;
+    // Settings file first, so the command line modes use it as well
+    auto logConfigErrors = [](const std::vector<std::string>& errors) {
+        for (const auto& error : errors) {
+            ErrorHandler::logWarning("Config file: " + error);
         }
+    };
+    logConfigErrors(Config::loadFile(Config::getConfigFilePath()));
+
+    // Command line modes return before SDL, OpenGL and fonts are touched
+    CommandLineOptions options = parseCommandLine(argc, argv);
+    switch (options.command) {
+        case CommandLineOptions::Command::Launch:
+            return runLaunchCommand(options);
+        case CommandLineOptions::Command::Resolve:
+            return runResolveCommand(options);
+        case CommandLineOptions::Command::Import:
+            return runImportCommand(options);
+        case CommandLineOptions::Command::Help:
+            printUsage(std::cout);
+            return 0;
+        case CommandLineOptions::Command::Invalid:
+            std::cerr << options.error << std::endl;
+            printUsage(std::cerr);
+            return 2;
+        case CommandLineOptions::Command::Gui:
+            break;
     }
-    return {}; // Return an empty vector if the key is not found or the value is not a vector
-}
 
-std::vector<std::string>& PersistentStorage::getArrayRef(const std::string& key) {
-    auto it = store.find(key);
-    if (it != store.end()) {
-        if (std::holds_alternative<std::vector<std::string>>(it->second)) {
-            return std::get<std::vector<std::string>>(it->second);
-        }
+    // Hand over to a running launcher before paying for SDL, OpenGL and fonts
+    if (Config::isSingleInstanceEnabled() && forwardToInstance(Config::getInstanceEndpoint(), forwardedArguments(options))) {
+        return 0;
     }
-    // If key does not exist, create it with an empty vector
-    store[key] = std::vector<std::string>{};
-    return std::get<std::vector<std::string>>(store[key]);
-}
 
-bool PersistentStorage::contains(const std::string& key) const {
-    return store.find(key) != store.end();
-}
-
-int main(int,char**) {
-
-    SetConsoleOutputCP(CP_UTF8);
     setvbuf(stdout, nullptr, _IOFBF, 1000);
 
+    // Per-monitor DPI, so moving to another display reports its density instead of being bitmap-scaled
+#ifdef SDL_HINT_WINDOWS_DPI_AWARENESS
+    SDL_SetHint(SDL_HINT_WINDOWS_DPI_AWARENESS, "permonitorv2");
+#endif
+
     // Setup SDL
     if (SDL_Init(SDL_INIT_VIDEO | SDL_INIT_TIMER | SDL_INIT_GAMECONTROLLER) != 0) {
         printf("Error: %s\n", SDL_GetError());
@@ -382,6 +142,7 @@ int main(int,char**) {
 
     // Setup Dear ImGui context
     IMGUI_CHECKVERSION();
+    ImGui::SetAllocatorFunctions(AllocationStats::imguiAlloc, AllocationStats::imguiFree); // Counted in the frame stats
     ImGui::CreateContext();
     ImGuiIO& io = ImGui::GetIO(); (void)io;
     io.ConfigFlags |= ImGuiConfigFlags_NavEnableKeyboard;     // Enable Keyboard Controls
@@ -398,44 +159,179 @@ int main(int,char**) {
     float dpi = getScreenDPI(window);
     std::cout << "[DPI] = " << dpi << std::endl;
 
-    const float windowsDefaultDPI = 96.0f;
-    float dpiScale = round(dpi / windowsDefaultDPI * 2.0f) * 0.5f;
+    float dpiScale = dpiScaleFor(dpi);
     std::cout << "[DPI scale] = " << dpiScale << std::endl;
 
     const int baseFontSize = Config::getBaseFontSize();
-    const float fontSize = floorf(baseFontSize * dpiScale);
-    std::cout << "[font size] = " << fontSize << std::endl;
-
-	if (dpi != -1.0f) {
-		ImFontConfig fontCfg;
-        fontCfg.FontBuilderFlags |= ImGuiFreeTypeBuilderFlags::ImGuiFreeTypeBuilderFlags_MonoHinting | ImGuiFreeTypeBuilderFlags_Monochrome; //отключает антиалиасинг и дает строгий алгоритм хинта
-		fontCfg.PixelSnapH = true;
-		fontCfg.RasterizerDensity = dpiScale;
-        ImFont* font = io.Fonts->AddFontFromFileTTF(Config::getFontPath().c_str(), fontSize, &fontCfg, io.Fonts->GetGlyphRangesCyrillic());
-        IM_ASSERT(font != nullptr);
-	}
-
-    ImGui::GetStyle().ScaleAllSizes(dpiScale);
+    std::cout << "[font size] = " << floorf(baseFontSize * dpiScale) << std::endl;
+
+    // Fonts and style follow the density of the display the window is on. Atlases
+    // for a new scale are built in the background; until one is ready the current
+    // one stays, then texture and style are swapped together between frames
+    FontAtlasCache fontAtlases(Config::getFontPath(), baseFontSize);
+    ImFontAtlas* contextAtlas = io.Fonts;
+    const ImGuiStyle baseStyle = ImGui::GetStyle();
+    float fontScale = 0.0f;
+    auto applyFontScale = [&](ImFontAtlas* atlas, float scale) {
+        // The next ImGui_ImplOpenGL3_NewFrame() uploads the new atlas
+        ImGui_ImplOpenGL3_DestroyFontsTexture();
+        io.Fonts = atlas;
+        ImGui::GetStyle() = baseStyle;
+        ImGui::GetStyle().ScaleAllSizes(scale);
+        fontScale = scale;
+    };
+    fontAtlases.request(dpiScale);
+    fontAtlases.waitIdle();
+    applyFontScale(fontAtlases.find(dpiScale), dpiScale);
+
+    // Background tasks; continuations meant for the UI thread run once per frame
+    auto taskRuntime = std::make_unique<TaskRuntime>();
+    taskRuntime->ui().setWakeFunction([]() {
+        SDL_Event wakeEvent = {};
+        wakeEvent.type = SDL_USEREVENT;
+        SDL_PushEvent(&wakeEvent);
+    });
 
     auto run1c = std::make_unique<RUN1C>();
+    auto supervisor = std::make_shared<ProcessSupervisor>();
+    run1c->setSupervisor(supervisor);
+    auto latencyTracker = std::make_shared<LaunchLatencyTracker>(*taskRuntime);
+    run1c->setLatencyTracker(latencyTracker);
+    run1c->setTaskRuntime(taskRuntime.get());
     auto storage = std::make_unique<PersistentStorage>();
     storage->load();
 
+    // Installed platforms for direct launch, cached by root modification time
+    auto platformRegistry = std::make_shared<PlatformRegistry>(PlatformRegistry::defaultRoots(run1c->getStarterPath()));
+    platformRegistry->deserialize(storage->getArray(platformRegistryStorageKey));
+    platformRegistry->deserializePins(storage->getArray(platformPinsStorageKey));
+    run1c->setPlatformRegistry(platformRegistry);
+
     // Our state
-    bool show_demo_window = false;
-    bool showHelpWindow = false;
     ImVec4 clear_color = ImVec4(0.45f, 0.55f, 0.60f, 1.00f);
-    std::string inputBuffer;
-    bool regexError = false;
-    bool isInputFocused = false;
-    bool isSetFocusOnInput = true;
-    bool isSetFocusOnCurrentHistoryItem = false;
-    std::vector<std::string>& history = storage->getArrayRef("basesHistory");
-    std::string* historySelectedItem = nullptr;
+    History history;
+    size_t mergedHistoryEntries = history.load(*storage);
+    if (mergedHistoryEntries > 0) {
+        ErrorHandler::logInfo("Merged " + std::to_string(mergedHistoryEntries) + " duplicate history entries");
+    }
+
+    // Bases added to 1C's own list since the last import; an unchanged file costs one stat
+    IbasesImportState ibasesState;
+    ibasesState.load(*storage);
+    auto importIbasesFile = [&](const std::string& path) {
+        IbasesImportResult result = importIbases(path, history, ibasesState);
+        for (const auto& [input, version] : result.versions) {
+            platformRegistry->setPin(input, version);
+        }
+        if (!result.error.empty()) {
+            ErrorHandler::logWarning("ibases.v8i import failed: " + result.error);
+        } else if (result.fileChanged) {
+            ErrorHandler::logInfo("Imported " + path + ": " + std::to_string(result.changedSections) + " new or changed sections, "
+                + std::to_string(result.added) + " added to history");
+            ibasesState.save(*storage);
+        }
+        return result.fileChanged;
+    };
+    bool ibasesImported = Config::isIbasesImportEnabled() && std::filesystem::exists(Config::getIbasesPath())
+        && importIbasesFile(Config::getIbasesPath());
+
+    // Base facts are gathered in the background, rows show a placeholder until they arrive
+    auto metadataCache = std::make_unique<BaseMetadataCache>();
+    metadataCache->deserialize(storage->getArray("baseMetadataCache"));
+    latencyTracker->deserialize(storage->getArray(launchLatencyStorageKey));
+    for (const HistoryEntry* entry : history.ordered()) {
+        metadataCache->request(entry->input);
+    }
+
+    // Servers of Srvr= bases are probed in the background, the list marks those that do not answer
+    std::unique_ptr<ServerHealthProber> healthProber;
+    if (Config::get(ConfigKeys::serverProbeEnabled)) {
+        healthProber = std::make_unique<ServerHealthProber>(*taskRuntime, std::chrono::milliseconds(Config::get(ConfigKeys::serverProbeTimeoutMs)),
+            std::chrono::seconds(Config::get(ConfigKeys::serverProbeTtlSeconds)));
+        for (const HistoryEntry* entry : history.ordered()) {
+            healthProber->watch(entry->input);
+        }
+    }
+
+    // The checkbox used to be kept in the storage file and overrode the config
+    // file on every start; it is moved into the config file once
+    if (storage->contains("snapshotBeforeConfig")) {
+        if (storage->getItem("snapshotBeforeConfig") == "1") {
+            Config::persist(ConfigKeys::snapshotEnabled, true);
+        }
+        storage->remove("snapshotBeforeConfig");
+    }
+
+    auto saveStorage = [&]() {
+        history.save(*storage);
+        std::vector<std::string> cachedMetadata = metadataCache->serialize();
+        if (!cachedMetadata.empty()) {
+            storage->put("baseMetadataCache", cachedMetadata);
+        }
+        storage->put(platformRegistryStorageKey, platformRegistry->serialize());
+        storage->put(platformPinsStorageKey, platformRegistry->serializePins());
+        std::vector<std::string> launchLatency = latencyTracker->serialize();
+        if (!launchLatency.empty()) {
+            storage->put(launchLatencyStorageKey, launchLatency);
+        }
+        storage->save();
+    };
+    if (ibasesImported || mergedHistoryEntries > 0) {
+        saveStorage();
+    }
+
+    // Later invocations are queued by the listener thread and handled once per frame
+    auto instanceServer = std::make_unique<InstanceServer>(Config::getInstanceEndpoint());
+    if (Config::isSingleInstanceEnabled()) {
+        instanceServer->start([]() {
+            SDL_Event wakeEvent = {};
+            wakeEvent.type = SDL_USEREVENT;
+            SDL_PushEvent(&wakeEvent);
+        });
+    }
+
+    // The first direct launch finds the platforms scanned already
+    if (Config::get(ConfigKeys::directLaunch)) {
+        taskRuntime->spawn([](TaskRuntime& runtime, std::shared_ptr<PlatformRegistry> registry) -> Task<void> {
+            co_await runtime.io().schedule();
+            registry->refresh();
+        }(*taskRuntime, platformRegistry));
+    }
+
+    // Edits to the config file apply without a restart, to readers that
+    // take the value when they need it (starter path, snapshot settings)
+    ConfigWatcher configWatcher(Config::getConfigFilePath(), std::chrono::seconds(1), logConfigErrors);
+
+    // Counters for a local collector, when a metrics file or endpoint is configured
+    MetricsExporter metricsExporter(MetricsRegistry::global(), *taskRuntime, Config::get(ConfigKeys::metricsFile),
+        Config::get(ConfigKeys::metricsEndpoint), std::chrono::milliseconds(Config::get(ConfigKeys::metricsIntervalMs)));
+    metricsExporter.start();
+
+    // Heap use per frame, shown next to the frame rate
+    FrameAllocationStats frameAllocations;
+    FrameMetrics frameMetrics;
+
+    MainWindow mainWindow(history, [&run1c, &healthProber](const std::string& input, bool isConfigMode) {
+        bool launched = run1c->run(input, isConfigMode);
+        if (launched && healthProber) {
+            healthProber->watch(input);
+        }
+        return launched;
+    });
+    mainWindow.setMetadataCache(metadataCache.get());
+    mainWindow.setSupervisor(supervisor.get());
+    mainWindow.setLatencyTracker(latencyTracker.get());
+    mainWindow.setHealthProber(healthProber.get());
+    mainWindow.setLauncher(run1c.get());
+    mainWindow.setFrameStats(&frameAllocations);
+    mainWindow.setSaveFunction(saveStorage);
 
     // Main loop
     bool done = false;
     while (!done) {
+        frameAllocations.beginFrame();
+        frameMetrics.beginFrame();
+
         // Poll and handle events (inputs, window resize, etc.)
         // You can read the io.WantCaptureMouse, io.WantCaptureKeyboard flags to tell if dear imgui wants to use your inputs.
         // - When io.WantCaptureMouse is true, do not dispatch mouse input data to your main application, or clear/overwrite your copy of the mouse data.
@@ -450,139 +346,59 @@ int main(int,char**) {
                 done = true;
             if (event.type == SDL_KEYDOWN && event.key.keysym.sym == SDLK_ESCAPE) // Check for Escape key press
                 done = true;                                                     // Set done flag to true
+            if ((event.type == SDL_WINDOWEVENT && (event.window.event == SDL_WINDOWEVENT_DISPLAY_CHANGED || event.window.event == SDL_WINDOWEVENT_SIZE_CHANGED))
+                || event.type == SDL_DISPLAYEVENT) {
+                float scale = dpiScaleFor(getScreenDPI(window));
+                if (scale != dpiScale) {
+                    std::cout << "[DPI scale] = " << scale << std::endl;
+                    dpiScale = scale;
+                    fontAtlases.request(dpiScale);
+                }
+            }
         }
+        for (const auto& forwarded : instanceServer->takeRequests()) {
+            CommandLineOptions request = parseCommandLine(forwarded);
+            if (request.command == CommandLineOptions::Command::Launch) {
+                mainWindow.launch(request.input, request.configMode);
+            } else if (request.command == CommandLineOptions::Command::Import) {
+                if (importIbasesFile(request.inputFile)) {
+                    mainWindow.historyChanged();
+                    for (const HistoryEntry* entry : history.ordered()) {
+                        if (entry->launchCount == 0 && !metadataCache->lookup(entry->input)) {
+                            metadataCache->request(entry->input);
+                        }
+                        if (healthProber) {
+                            healthProber->watch(entry->input);
+                        }
+                    }
+                    saveStorage();
+                }
+            } else {
+                SDL_RestoreWindow(window);
+                SDL_RaiseWindow(window);
+                mainWindow.focusInput();
+            }
+        }
+        taskRuntime->ui().drain();
         if (SDL_GetWindowFlags(window) & SDL_WINDOW_MINIMIZED) {
+            frameMetrics.beginIdle();
             SDL_Delay(10);
+            frameMetrics.endIdle();
             continue;
         }
 
+        if (fontScale != dpiScale) {
+            if (ImFontAtlas* atlas = fontAtlases.find(dpiScale)) {
+                applyFontScale(atlas, dpiScale);
+            }
+        }
+
         // Start the Dear ImGui frame
         ImGui_ImplOpenGL3_NewFrame();
         ImGui_ImplSDL2_NewFrame();
         ImGui::NewFrame();
 
-        // 1. Show the big demo window (Most of the sample code is in ImGui::ShowDemoWindow()! You can browse its code to learn more about Dear ImGui!).
-        if (show_demo_window)
-            ImGui::ShowDemoWindow(&show_demo_window);
-
-        // 2. Show a simple window that we create ourselves. We use a Begin/End pair to create a named window.
-        {
-            ImGui::SetNextWindowSize(io.DisplaySize);
-            ImGui::SetNextWindowPos(ImVec2(0, 0), ImGuiCond_Always);
-
-            ImGui::Begin("RUN1C_MainWindow", NULL, ImGuiWindowFlags_NoDecoration);
-
-            if (ImGui::Button("Help")) showHelpWindow = !showHelpWindow;
-            ImGui::SameLine();
-            ImGui::Text("Application average %.3f ms/frame (%.1f FPS)", 1000.0f / io.Framerate, io.Framerate);
-
-            ImGui::Checkbox("Demo Window", &show_demo_window);
-
-            ImGui::Separator();
-
-            ImGui::PushStyleColor(ImGuiCol_FrameBg, ImVec4(255,255,255,0));
-            ImGui::SetNextItemWidth(-FLT_MIN); // Make the input field take the full width of the window
-
-            if (isSetFocusOnInput && ImGui::IsWindowFocused(ImGuiFocusedFlags_RootAndChildWindows) && !ImGui::IsAnyItemActive() && !ImGui::IsMouseClicked(0)) {
-                ImGui::SetKeyboardFocusHere(0);
-                isSetFocusOnInput = false;
-            }
-
-            if (ImGui::InputTextWithHint("##input", "1C path...", &inputBuffer, ImGuiInputTextFlags_EnterReturnsTrue, nullptr, nullptr)) {
-                if (ImGui::IsKeyDown(ImGuiKey_ModShift)) {
-                    regexError = !run1c->run(inputBuffer, true);
-                } else {
-                    regexError = !run1c->run(inputBuffer, false);
-                }
-                if (!regexError) {
-                    // Move found item to the top of history
-                    auto it = std::find(history.begin(), history.end(), inputBuffer);
-                    if (it != history.end()) {
-                        std::string found = *it;
-                        history.erase(it);
-                    }
-                    history.push_back(inputBuffer);
-                    storage->save();
-                    historySelectedItem = &history.back();
-
-                    inputBuffer = "";
-                }
-            }
-
-            isInputFocused = ImGui::IsItemActiveAsInputText();
-
-            if (isInputFocused) {
-                if (ImGui::IsKeyPressed(ImGuiKey_UpArrow) || ImGui::IsKeyPressed(ImGuiKey_DownArrow)) {
-                    if (!historySelectedItem) historySelectedItem = &history.back();
-                    isSetFocusOnCurrentHistoryItem = true;
-                }
-            }
-
-            ImGuiID inputID = ImGui::GetItemID();
-
-            if (regexError) {
-                ImGui::Separator();
-                ImGui::TextColored(ImVec4(1.0f, 0.35f, 0.35f, 1.0f), "Wrong input");
-            }
-
-            ImGui::Separator();
-
-            if (ImGui::BeginListBox("##listbox_history", ImVec2(-FLT_MIN, -FLT_MIN))) {
-
-                for (auto it = history.rbegin(); it != history.rend(); it++) {
-
-                    std::string* currentItemRef = &(*it);
-                    ImGui::PushID(currentItemRef);
-
-                    bool isSelected = historySelectedItem == currentItemRef;
-
-                    ImGuiSelectableFlags flags = (historySelectedItem == currentItemRef && !isInputFocused) ? ImGuiSelectableFlags_Highlight : 0;
-
-                    if (isSelected && isSetFocusOnCurrentHistoryItem) {
-                        ImGui::SetKeyboardFocusHere();
-                        isSetFocusOnCurrentHistoryItem = false;
-                    }
-
-                    if (ImGui::Selectable(it->c_str(), isSelected, flags)) {
-                        historySelectedItem = currentItemRef;
-                        inputBuffer = *historySelectedItem;
-                        isSetFocusOnInput = true;
-                    }
-
-                    if (isSelected) {
-                        ImGui::SetItemDefaultFocus();
-                    }
-
-                    ImGui::PopID();
-
-                }
-                ImGui::EndListBox();
-            }
-
-            ImGui::PopStyleColor();
-
-            if (ImGui::GetActiveID() != inputID && ImGui::IsKeyDown(ImGuiKey_F)) {
-                isSetFocusOnInput = true;
-            }
-
-            ImGui::End();
-        }
-
-        if (showHelpWindow) {
-
-            ImGui::SetNextWindowSize(ImVec2(0.0f, 0.0f));
-            ImGui::SetNextWindowPos(ImVec2(io.DisplaySize.x / 2, io.DisplaySize.y / 2), ImGuiCond_Always, ImVec2(0.5f, 0.5f));
-
-            ImGui::Begin("Help##RUN1C_HelpPopupWindow", &showHelpWindow, ImGuiWindowFlags_None);
-
-            if (!ImGui::IsWindowFocused()) showHelpWindow = false;
-
-            ImGui::Text("[f] - focus search bar");
-            ImGui::Text("[up/down arrow] - move to history");
-
-            ImGui::End();
-
-        }
+        mainWindow.draw();
 
         // Rendering
         ImGui::Render();
@@ -590,19 +406,30 @@ int main(int,char**) {
         glClearColor(clear_color.x * clear_color.w, clear_color.y * clear_color.w, clear_color.z * clear_color.w, clear_color.w);
         glClear(GL_COLOR_BUFFER_BIT);
         ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
+        frameMetrics.beginIdle();     // Blocks on vsync
         SDL_GL_SwapWindow(window);
+        frameMetrics.endIdle();
+        frameAllocations.endFrame();
     }
 
-    storage->save();
+    instanceServer->stop();
+    run1c->setTaskRuntime(nullptr);
+    taskRuntime.reset();    // Finishes background work while the window still exists
+    saveStorage();
+    metricsExporter.stop();
 
     // Cleanup
     ImGui_ImplOpenGL3_Shutdown();
     ImGui_ImplSDL2_Shutdown();
+    io.Fonts = contextAtlas;    // The cache owns the others
     ImGui::DestroyContext();
 
     SDL_GL_DeleteContext(gl_context);
     SDL_DestroyWindow(window);
     SDL_Quit();
 
+    // Let a snapshot started before the Configurator finish after the window is gone
+    run1c->waitForSnapshot();
+
     return 0;
 }
@@ -0,0 +1,313 @@
+#include "main_window.h"
+#include "imgui.h"
+#include "imgui_internal.h"
+#include "imgui_stdlib.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <ctime>
+
+#include "allocation_stats.h"
+#include "base_metadata.h"
+#include "base_snapshot.h"
+#include "config.h"
+#include "history.h"
+#include "launch_latency.h"
+#include "launcher.h"
+#include "process_supervisor.h"
+#include "server_health.h"
+
+MainWindow::MainWindow(History& history, LaunchFunction launch)
+    : history(history), launchFunction(std::move(launch)) {
+}
+
+bool MainWindow::launch(const std::string& input, bool isConfigMode) {
+    if (!launchFunction(input, isConfigMode)) {
+        return false;
+    }
+    // Count the launch, the entry moves up by frecency
+    selectedEntry = &history.recordLaunch(input, isConfigMode);
+    if (metadataCache) {
+        metadataCache->request(input);
+    }
+    save();
+    return true;
+}
+
+void MainWindow::save() {
+    if (saveFunction) {
+        saveFunction();
+    }
+}
+
+void MainWindow::draw() {
+    frameArena.reset();
+    ImGuiIO& io = ImGui::GetIO();
+
+    // 1. Show the big demo window (Most of the sample code is in ImGui::ShowDemoWindow()! You can browse its code to learn more about Dear ImGui!).
+    if (showDemoWindow)
+        ImGui::ShowDemoWindow(&showDemoWindow);
+
+    // 2. Show a simple window that we create ourselves. We use a Begin/End pair to create a named window.
+    ImGui::SetNextWindowSize(io.DisplaySize);
+    ImGui::SetNextWindowPos(ImVec2(0, 0), ImGuiCond_Always);
+
+    ImGui::Begin("RUN1C_MainWindow", NULL, ImGuiWindowFlags_NoDecoration);
+
+    if (ImGui::Button("Help")) showHelpWindow = !showHelpWindow;
+    ImGui::SameLine();
+    if (frameStats) {
+        const AllocationCounts& allocations = frameStats->lastFrame();
+        ImGui::Text("Application average %.3f ms/frame (%.1f FPS), %llu allocations (%.1f KB)/frame", 1000.0f / io.Framerate, io.Framerate,
+            static_cast<unsigned long long>(allocations.allocations), allocations.bytes / 1024.0);
+    } else {
+        ImGui::Text("Application average %.3f ms/frame (%.1f FPS)", 1000.0f / io.Framerate, io.Framerate);
+    }
+
+    ImGui::Checkbox("Demo Window", &showDemoWindow);
+    ImGui::SameLine();
+    // Read every frame, so an edit of the config file shows up here
+    bool snapshotBeforeConfig = Config::isSnapshotEnabled();
+    if (ImGui::Checkbox("Snapshot before Configurator", &snapshotBeforeConfig)) {
+        Config::persist(ConfigKeys::snapshotEnabled, snapshotBeforeConfig);
+    }
+
+    if (const BaseSnapshot* snapshot = launcher ? launcher->getSnapshot() : nullptr) {
+        if (snapshot->getState() == BaseSnapshot::State::Running) {
+            uint64_t total = snapshot->getBytesTotal();
+            float fraction = total > 0 ? static_cast<float>(static_cast<double>(snapshot->getBytesCopied()) / total) : 0.0f;
+            char label[64];
+            snprintf(label, sizeof(label), "Snapshot %.0f%% (%.1f / %.1f MB)", fraction * 100.0f,
+                snapshot->getBytesCopied() / 1048576.0, total / 1048576.0);
+            ImGui::ProgressBar(fraction, ImVec2(-FLT_MIN, 0.0f), label);
+        } else if (snapshot->getState() == BaseSnapshot::State::Failed) {
+            ImGui::TextColored(ImVec4(1.0f, 0.35f, 0.35f, 1.0f), "Snapshot failed: %s", snapshot->getError().c_str());
+        } else if (snapshot->getState() == BaseSnapshot::State::Inconsistent) {
+            ImGui::TextColored(ImVec4(1.0f, 0.75f, 0.3f, 1.0f), "Snapshot incomplete, the base was opened during the copy");
+        }
+    }
+
+    if (supervisor) {
+        drawProcesses();
+    }
+
+    ImGui::Separator();
+
+    ImGui::PushStyleColor(ImGuiCol_FrameBg, ImVec4(255,255,255,0));
+    ImGui::SetNextItemWidth(-FLT_MIN); // Make the input field take the full width of the window
+
+    if (isSetFocusOnInput && ImGui::IsWindowFocused(ImGuiFocusedFlags_RootAndChildWindows) && !ImGui::IsAnyItemActive() && !ImGui::IsMouseClicked(0)) {
+        ImGui::SetKeyboardFocusHere(0);
+        isSetFocusOnInput = false;
+    }
+
+    if (ImGui::InputTextWithHint("##input", "1C path...", &inputBuffer, ImGuiInputTextFlags_EnterReturnsTrue, nullptr, nullptr)) {
+        bool isConfigMode = ImGui::IsKeyDown(ImGuiKey_ModShift);
+        inputError = !launch(inputBuffer, isConfigMode);
+        if (!inputError) {
+            inputBuffer = "";
+        }
+    }
+
+    isInputFocused = ImGui::IsItemActiveAsInputText();
+
+    if (isInputFocused) {
+        if (ImGui::IsKeyPressed(ImGuiKey_UpArrow) || ImGui::IsKeyPressed(ImGuiKey_DownArrow)) {
+            if (!selectedEntry && !history.empty()) selectedEntry = &history.at(history.size() - 1);
+            isSetFocusOnCurrentHistoryItem = true;
+        }
+    }
+
+    ImGuiID inputID = ImGui::GetItemID();
+
+    if (inputError) {
+        ImGui::Separator();
+        ImGui::TextColored(ImVec4(1.0f, 0.35f, 0.35f, 1.0f), "Wrong input");
+    }
+
+    ImGui::Separator();
+
+    drawHistory();
+
+    ImGui::PopStyleColor();
+
+    if (ImGui::GetActiveID() != inputID && ImGui::IsKeyDown(ImGuiKey_F)) {
+        isSetFocusOnInput = true;
+    }
+
+    ImGui::End();
+
+    if (showHelpWindow) {
+        drawHelp();
+    }
+}
+
+void MainWindow::drawProcesses() {
+    // Launched processes, sampled in the background so this only reads the latest snapshot
+    ProcessSupervisor::Snapshot processes = supervisor->snapshot();
+    if (processes->empty()) {
+        return;
+    }
+    size_t runningProcesses = std::count_if(processes->begin(), processes->end(), [](const SupervisedProcess& process) {
+        return process.state == SupervisedProcess::State::Running;
+    });
+    char header[64];
+    snprintf(header, sizeof(header), "Processes (%zu running)###processes", runningProcesses);
+    if (!ImGui::CollapsingHeader(header)) {
+        return;
+    }
+
+    ImGuiTableFlags tableFlags = ImGuiTableFlags_ScrollY | ImGuiTableFlags_RowBg | ImGuiTableFlags_BordersInnerV | ImGuiTableFlags_Resizable;
+    float rowHeight = ImGui::GetTextLineHeightWithSpacing();
+    float tableHeight = rowHeight * (std::min<size_t>(processes->size(), 8) + 1.5f);
+    if (ImGui::BeginTable("##processes", 8, tableFlags, ImVec2(-FLT_MIN, tableHeight))) {
+        ImGui::TableSetupScrollFreeze(0, 1);
+        ImGui::TableSetupColumn("PID", ImGuiTableColumnFlags_WidthFixed);
+        ImGui::TableSetupColumn("Mode", ImGuiTableColumnFlags_WidthFixed);
+        ImGui::TableSetupColumn("Base", ImGuiTableColumnFlags_WidthStretch);
+        ImGui::TableSetupColumn("Started", ImGuiTableColumnFlags_WidthFixed);
+        ImGui::TableSetupColumn("State", ImGuiTableColumnFlags_WidthFixed);
+        ImGui::TableSetupColumn("CPU", ImGuiTableColumnFlags_WidthFixed);
+        ImGui::TableSetupColumn("RSS", ImGuiTableColumnFlags_WidthFixed);
+        ImGui::TableSetupColumn("I/O", ImGuiTableColumnFlags_WidthFixed);
+        ImGui::TableHeadersRow();
+
+        // Only visible rows are submitted, hundreds of processes cost the same as eight
+        ImGuiListClipper clipper;
+        clipper.Begin(static_cast<int>(processes->size()));
+        while (clipper.Step()) {
+            for (int row = clipper.DisplayStart; row < clipper.DisplayEnd; ++row) {
+                const SupervisedProcess& process = (*processes)[row];
+                bool running = process.state == SupervisedProcess::State::Running;
+
+                ImGui::TableNextRow();
+                ImGui::TableNextColumn();
+                ImGui::Text("%lld", static_cast<long long>(process.pid));
+                ImGui::TableNextColumn();
+                ImGui::TextUnformatted(process.mode.c_str());
+                ImGui::TableNextColumn();
+                ImGui::TextUnformatted(process.basePath.c_str());
+                ImGui::TableNextColumn();
+                char started[16];
+                std::time_t startTime = static_cast<std::time_t>(process.startTime);
+                std::strftime(started, sizeof(started), "%H:%M:%S", std::localtime(&startTime));
+                ImGui::TextUnformatted(started);
+                ImGui::TableNextColumn();
+                if (running) {
+                    ImGui::TextUnformatted("Running");
+                } else if (process.exitCode >= 0) {
+                    ImGui::TextDisabled("Exited (%d)", process.exitCode);
+                } else {
+                    ImGui::TextDisabled("Exited");
+                }
+                ImGui::TableNextColumn();
+                if (running) ImGui::Text("%.1f%%", process.cpuPercent);
+                ImGui::TableNextColumn();
+                if (running) ImGui::Text("%.1f MB", process.rssBytes / 1048576.0);
+                ImGui::TableNextColumn();
+                ImGui::Text("%.1f / %.1f MB", process.readBytes / 1048576.0, process.writeBytes / 1048576.0);
+            }
+        }
+        ImGui::EndTable();
+    }
+}
+
+void MainWindow::drawHistory() {
+    if (!ImGui::BeginListBox("##listbox_history", ImVec2(-FLT_MIN, -FLT_MIN))) {
+        return;
+    }
+
+    // Imported lists can hold thousands of bases, only visible rows are submitted
+    // Row 0 is the most frecent entry
+    size_t last = history.size() - 1;
+    ImGuiListClipper clipper;
+    clipper.Begin(static_cast<int>(history.size()));
+    if (selectedEntry && isSetFocusOnCurrentHistoryItem) {
+        clipper.IncludeItemByIndex(static_cast<int>(last - history.positionOf(*selectedEntry)));
+    }
+    while (clipper.Step()) {
+        for (int row = clipper.DisplayStart; row < clipper.DisplayEnd; ++row) {
+            const HistoryEntry* entry = &history.at(last - row);
+            ImGui::PushID(entry);
+
+            bool isSelected = selectedEntry == entry;
+
+            ImGuiSelectableFlags flags = (isSelected && !isInputFocused) ? ImGuiSelectableFlags_Highlight : 0;
+
+            if (isSelected && isSetFocusOnCurrentHistoryItem) {
+                ImGui::SetKeyboardFocusHere();
+                isSetFocusOnCurrentHistoryItem = false;
+            }
+
+            float rowRight = ImGui::GetCursorPosX() + ImGui::GetContentRegionAvail().x;
+
+            // Named bases (from ibases.v8i) show the name, the input goes to the tooltip
+            const std::string& label = entry->name.empty() ? entry->input : entry->name;
+            if (ImGui::Selectable(label.c_str(), isSelected, flags | ImGuiSelectableFlags_AllowOverlap)) {
+                selectedEntry = entry;
+                inputBuffer = entry->input;
+                isSetFocusOnInput = true;
+            }
+            if (ImGui::IsItemHovered(ImGuiHoveredFlags_DelayNormal) && (entry->launchCount > 0 || !entry->name.empty())) {
+                ImGui::BeginTooltip();
+                if (!entry->name.empty()) {
+                    ImGui::TextUnformatted(entry->input.c_str());
+                }
+                if (entry->launchCount > 0) {
+                    char lastLaunch[32];
+                    std::time_t lastLaunchTime = static_cast<std::time_t>(entry->lastLaunch);
+                    std::strftime(lastLaunch, sizeof(lastLaunch), "%Y-%m-%d %H:%M", std::localtime(&lastLaunchTime));
+                    ImGui::Text("Launched %u times (%u Enterprise, %u Configurator), last %s",
+                        entry->launchCount, entry->enterpriseCount, entry->configCount, lastLaunch);
+                }
+                if (auto latency = latencyTracker ? latencyTracker->summary(entry->key) : std::nullopt) {
+                    ImGui::Text("Usable after %.1f s typically, %.1f s in 9 of 10 launches", latency->medianSeconds, latency->p90Seconds);
+                }
+                if (auto server = healthProber ? healthProber->health(entry->key) : std::nullopt) {
+                    long long age = std::chrono::duration_cast<std::chrono::seconds>(ServerHealth::Clock::now() - server->checked).count();
+                    if (server->state == ServerReachability::Reachable) {
+                        ImGui::Text("Server %s answered in %lld ms, %lld s ago", server->endpoint.c_str(),
+                            static_cast<long long>(server->connectTime.count()), age);
+                    } else {
+                        ImGui::Text("Server %s unreachable: %s, %lld s ago", server->endpoint.c_str(), server->error.c_str(), age);
+                    }
+                }
+                ImGui::EndTooltip();
+            }
+
+            // Right-aligned server reachability, typical open time and base facts: size, 1CD version, page size, last modified
+            const char* metadataText = metadataCache ? metadataCache->lookupSummary(entry->input, frameArena) : nullptr;
+            if (!metadataText) metadataText = "...";
+            if (const char* typical = latencyTracker ? latencyTracker->lookupTypical(entry->key, frameArena) : nullptr) {
+                metadataText = frameArena.format("%s   %s", typical, metadataText);
+            }
+            if (const char* status = healthProber ? healthProber->lookupStatus(entry->key, frameArena) : nullptr) {
+                metadataText = frameArena.format("%s   %s", status, metadataText);
+            }
+            ImGui::SameLine(rowRight - ImGui::CalcTextSize(metadataText).x);
+            ImGui::TextDisabled("%s", metadataText);
+
+            if (isSelected) {
+                ImGui::SetItemDefaultFocus();
+            }
+
+            ImGui::PopID();
+        }
+    }
+    ImGui::EndListBox();
+}
+
+void MainWindow::drawHelp() {
+    ImGuiIO& io = ImGui::GetIO();
+    ImGui::SetNextWindowSize(ImVec2(0.0f, 0.0f));
+    ImGui::SetNextWindowPos(ImVec2(io.DisplaySize.x / 2, io.DisplaySize.y / 2), ImGuiCond_Always, ImVec2(0.5f, 0.5f));
+
+    ImGui::Begin("Help##RUN1C_HelpPopupWindow", &showHelpWindow, ImGuiWindowFlags_None);
+
+    if (!ImGui::IsWindowFocused()) showHelpWindow = false;
+
+    ImGui::Text("[f] - focus search bar");
+    ImGui::Text("[up/down arrow] - move to history");
+
+    ImGui::End();
+}
@@ -0,0 +1,82 @@
+#pragma once
+
+#include <functional>
+#include <string>
+
+#include "frame_arena.h"
+
+class BaseMetadataCache;
+class FrameAllocationStats;
+class History;
+class LaunchLatencyTracker;
+class ProcessSupervisor;
+class RUN1C;
+class ServerHealthProber;
+struct HistoryEntry;
+
+// The launcher window: search field, history list, process panel and help.
+// Holds the UI state and draws one frame into the current ImGui context, so
+// it runs the same under the SDL/OpenGL backends and on a headless context
+// (UiHarness in tests and run1c_bench)
+class MainWindow {
+public:
+    // Starts 1C for input, false if the input is not a valid base
+    using LaunchFunction = std::function<bool(const std::string& input, bool isConfigMode)>;
+
+    MainWindow(History& history, LaunchFunction launch);
+
+    MainWindow(const MainWindow&) = delete;
+    MainWindow& operator=(const MainWindow&) = delete;
+
+    // Optional parts; the window works without them
+    void setMetadataCache(BaseMetadataCache* cache) { metadataCache = cache; }
+    void setSupervisor(const ProcessSupervisor* processSupervisor) { supervisor = processSupervisor; }
+    void setLatencyTracker(const LaunchLatencyTracker* tracker) { latencyTracker = tracker; }  // Typical open times
+    void setHealthProber(const ServerHealthProber* prober) { healthProber = prober; }  // Server reachability
+    void setLauncher(const RUN1C* snapshotLauncher) { launcher = snapshotLauncher; }  // Progress of its snapshot
+    void setFrameStats(const FrameAllocationStats* stats) { frameStats = stats; }
+    void setSaveFunction(std::function<void()> save) { saveFunction = std::move(save); }
+
+    // Launches input and counts it in history, as Enter in the search field does
+    bool launch(const std::string& input, bool isConfigMode);
+
+    // History entries were added outside the window; drops the selection
+    void historyChanged() { selectedEntry = nullptr; }
+
+    void focusInput() { isSetFocusOnInput = true; }
+
+    // Submits the windows of one frame, between ImGui::NewFrame() and ImGui::Render()
+    void draw();
+
+    const std::string& getInput() const { return inputBuffer; }
+    const HistoryEntry* getSelectedEntry() const { return selectedEntry; }
+    bool hasInputError() const { return inputError; }
+
+private:
+    void drawProcesses();
+    void drawHistory();
+    void drawHelp();
+    void save();
+
+    History& history;
+    LaunchFunction launchFunction;
+    BaseMetadataCache* metadataCache = nullptr;
+    const ProcessSupervisor* supervisor = nullptr;
+    const LaunchLatencyTracker* latencyTracker = nullptr;
+    const ServerHealthProber* healthProber = nullptr;
+    const RUN1C* launcher = nullptr;
+    const FrameAllocationStats* frameStats = nullptr;
+    std::function<void()> saveFunction;
+
+    // Row text lives until the next frame
+    FrameArena frameArena;
+
+    std::string inputBuffer;
+    const HistoryEntry* selectedEntry = nullptr;
+    bool showDemoWindow = false;
+    bool showHelpWindow = false;
+    bool inputError = false;
+    bool isInputFocused = false;
+    bool isSetFocusOnInput = true;
+    bool isSetFocusOnCurrentHistoryItem = false;
+};
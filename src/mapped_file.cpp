@@ -0,0 +1,142 @@
+#include "mapped_file.h"
+#include <utility>
+
+#ifdef _WIN32
+#include <Windows.h>
+#include "utf_transcode.h"
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+MappedFile::~MappedFile() {
+    close();
+}
+
+MappedFile::MappedFile(MappedFile&& other) noexcept {
+    *this = std::move(other);
+}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept {
+    if (this != &other) {
+        close();
+        view = std::exchange(other.view, nullptr);
+        viewSize = std::exchange(other.viewSize, 0);
+        totalSize = std::exchange(other.totalSize, 0);
+#ifdef _WIN32
+        fileHandle = std::exchange(other.fileHandle, nullptr);
+        mappingHandle = std::exchange(other.mappingHandle, nullptr);
+#endif
+    }
+    return *this;
+}
+
+#ifdef _WIN32
+
+bool MappedFile::open(const std::string& path, size_t maxBytes) {
+    close();
+
+    Utf16Buffer<> widePath(path);
+    HANDLE file = CreateFileW(widePath.wide(), GENERIC_READ, FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE,
+        nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        return false;
+    }
+
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(file, &size) || size.QuadPart == 0) {
+        CloseHandle(file);
+        return false;
+    }
+
+    uint64_t length = static_cast<uint64_t>(size.QuadPart);
+    if (maxBytes != 0 && length > maxBytes) {
+        length = maxBytes;
+    }
+
+    // Size the mapping to the view so only the requested prefix is reserved
+    HANDLE mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY,
+        static_cast<DWORD>(length >> 32), static_cast<DWORD>(length & 0xFFFFFFFF), nullptr);
+    if (mapping == nullptr) {
+        CloseHandle(file);
+        return false;
+    }
+
+    void* address = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, static_cast<SIZE_T>(length));
+    if (address == nullptr) {
+        CloseHandle(mapping);
+        CloseHandle(file);
+        return false;
+    }
+
+    fileHandle = file;
+    mappingHandle = mapping;
+    view = static_cast<const uint8_t*>(address);
+    viewSize = static_cast<size_t>(length);
+    totalSize = static_cast<uint64_t>(size.QuadPart);
+    return true;
+}
+
+void MappedFile::close() {
+    if (view != nullptr) {
+        UnmapViewOfFile(view);
+    }
+    if (mappingHandle != nullptr) {
+        CloseHandle(mappingHandle);
+    }
+    if (fileHandle != nullptr) {
+        CloseHandle(fileHandle);
+    }
+    view = nullptr;
+    viewSize = 0;
+    totalSize = 0;
+    fileHandle = nullptr;
+    mappingHandle = nullptr;
+}
+
+#else
+
+bool MappedFile::open(const std::string& path, size_t maxBytes) {
+    close();
+
+    int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+    if (fd < 0) {
+        return false;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size <= 0) {
+        ::close(fd);
+        return false;
+    }
+
+    uint64_t length = static_cast<uint64_t>(st.st_size);
+    if (maxBytes != 0 && length > maxBytes) {
+        length = maxBytes;
+    }
+
+    void* address = mmap(nullptr, static_cast<size_t>(length), PROT_READ, MAP_PRIVATE, fd, 0);
+    // The mapping keeps its own reference to the file
+    ::close(fd);
+    if (address == MAP_FAILED) {
+        return false;
+    }
+
+    view = static_cast<const uint8_t*>(address);
+    viewSize = static_cast<size_t>(length);
+    totalSize = static_cast<uint64_t>(st.st_size);
+    return true;
+}
+
+void MappedFile::close() {
+    if (view != nullptr) {
+        munmap(const_cast<uint8_t*>(view), viewSize);
+    }
+    view = nullptr;
+    viewSize = 0;
+    totalSize = 0;
+}
+
+#endif
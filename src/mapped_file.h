@@ -0,0 +1,38 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// Read-only memory map of (the leading part of) a file
+class MappedFile {
+public:
+    MappedFile() = default;
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+    MappedFile(MappedFile&& other) noexcept;
+    MappedFile& operator=(MappedFile&& other) noexcept;
+
+    // Maps at most maxBytes from the start of the file (0 maps the whole file).
+    // Returns false if the file cannot be opened, is empty or cannot be mapped.
+    bool open(const std::string& path, size_t maxBytes = 0);
+    void close();
+
+    bool isOpen() const { return view != nullptr; }
+    const uint8_t* data() const { return view; }
+    size_t size() const { return viewSize; }
+
+    // Size of the whole file on disk, not only of the mapped view
+    uint64_t fileSize() const { return totalSize; }
+
+private:
+    const uint8_t* view = nullptr;
+    size_t viewSize = 0;
+    uint64_t totalSize = 0;
+#ifdef _WIN32
+    void* fileHandle = nullptr;
+    void* mappingHandle = nullptr;
+#endif
+};
@@ -0,0 +1,288 @@
+#include "metrics.h"
+
+#include <algorithm>
+#include <bit>
+#include <charconv>
+#include <stdexcept>
+#include <unordered_map>
+#include <unordered_set>
+#include <utility>
+
+namespace {
+
+std::atomic<uint64_t> nextRegistryId{1};
+
+// Live registries by id, for threads handing their blocks back on exit.
+// Leaked on purpose: threads may exit after static destructors have run
+struct RegistryTable {
+    std::mutex mutex;
+    std::unordered_map<uint64_t, MetricsRegistry*> registries;
+};
+
+RegistryTable& registryTable() {
+    static RegistryTable* table = new RegistryTable();
+    return *table;
+}
+
+std::string formatNumber(double value) {
+    char buffer[32];
+    auto result = std::to_chars(buffer, buffer + sizeof(buffer), value);
+    return std::string(buffer, result.ptr);
+}
+
+std::string withLabels(const std::string& labels, const std::string& extra = {}) {
+    if (labels.empty() && extra.empty()) {
+        return {};
+    }
+    if (labels.empty() || extra.empty()) {
+        return "{" + labels + extra + "}";
+    }
+    return "{" + labels + "," + extra + "}";
+}
+
+const char* errorLabel(size_t type) {
+    switch (static_cast<ErrorType>(type)) {
+        case ErrorType::FileNotFound: return "file_not_found";
+        case ErrorType::InvalidPath: return "invalid_path";
+        case ErrorType::LaunchFailed: return "launch_failed";
+        case ErrorType::FontLoadFailed: return "font_load_failed";
+        case ErrorType::ConfigurationError: return "configuration_error";
+        case ErrorType::EnvironmentVariableError: return "environment_variable_error";
+        case ErrorType::ProcessCreationFailed: return "process_creation_failed";
+    }
+    return "unknown";
+}
+
+} // namespace
+
+// Blocks this thread holds in each registry it recorded to, handed back when it exits
+struct detail::MetricsThreadCache {
+    std::vector<std::pair<uint64_t, std::atomic<uint64_t>*>> attached;
+
+    ~MetricsThreadCache();
+};
+
+namespace {
+
+thread_local detail::MetricsThreadCache threadCache;
+
+} // namespace
+
+detail::MetricsThreadCache::~MetricsThreadCache() {
+    RegistryTable& table = registryTable();
+    std::lock_guard<std::mutex> lock(table.mutex);
+    for (const auto& [registryId, values] : attached) {
+        auto it = table.registries.find(registryId);
+        if (it != table.registries.end()) {
+            it->second->releaseThread(values);
+        }
+    }
+}
+
+uint64_t Counter::value() const {
+    return registry ? registry->sum(slot) : 0;
+}
+
+void Gauge::set(double value) const {
+    if (registry) {
+        registry->gauges[slot].store(std::bit_cast<uint64_t>(value), std::memory_order_relaxed);
+    }
+}
+
+double Gauge::value() const {
+    return registry ? std::bit_cast<double>(registry->gauges[slot].load(std::memory_order_relaxed)) : 0.0;
+}
+
+uint64_t Histogram::count() const {
+    uint64_t total = 0;
+    for (uint32_t bucket = 0; registry && bucket <= boundsNs.size(); ++bucket) {
+        total += registry->sum(slot + bucket);
+    }
+    return total;
+}
+
+std::chrono::nanoseconds Histogram::sum() const {
+    return std::chrono::nanoseconds(registry ? registry->sum(slot + boundsNs.size() + 1) : 0);
+}
+
+MetricsRegistry::MetricsRegistry() : id(nextRegistryId.fetch_add(1)) {
+    RegistryTable& table = registryTable();
+    std::lock_guard<std::mutex> lock(table.mutex);
+    table.registries[id] = this;
+}
+
+MetricsRegistry::~MetricsRegistry() {
+    RegistryTable& table = registryTable();
+    std::lock_guard<std::mutex> lock(table.mutex);
+    table.registries.erase(id);
+}
+
+MetricsRegistry& MetricsRegistry::global() {
+    static MetricsRegistry* registry = new MetricsRegistry();
+    return *registry;
+}
+
+std::atomic<uint64_t>* MetricsRegistry::attachThread() {
+    detail::MetricsThreadCache& cache = threadCache;
+    auto known = std::find_if(cache.attached.begin(), cache.attached.end(),
+        [this](const auto& entry) { return entry.first == id; });
+    if (known == cache.attached.end()) {
+        ThreadValues* block = nullptr;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (!released.empty()) {
+                block = released.back();
+                released.pop_back();
+            } else {
+                threads.push_back(std::make_unique<ThreadValues>());
+                block = threads.back().get();
+            }
+        }
+        cache.attached.emplace_back(id, block->values.data());
+        known = cache.attached.end() - 1;
+    }
+    detail::metricsThreadSlot = {id, known->second};
+    return known->second;
+}
+
+void MetricsRegistry::releaseThread(std::atomic<uint64_t>* values) {
+    std::lock_guard<std::mutex> lock(mutex);
+    for (const auto& block : threads) {
+        if (block->values.data() == values) {
+            released.push_back(block.get());
+            return;
+        }
+    }
+}
+
+uint32_t MetricsRegistry::add(const std::string& name, const std::string& help, const std::string& labels, Type type, uint32_t slots) {
+    std::lock_guard<std::mutex> lock(mutex);
+    for (const auto& metric : metrics) {
+        if (metric.name == name && metric.labels == labels && metric.type == type) {
+            return metric.slot;
+        }
+    }
+    if (nextSlot + slots > maxSlots) {
+        throw std::length_error("Metrics registry is full, cannot add " + name);
+    }
+    metrics.push_back({name, help, labels, type, nextSlot});
+    nextSlot += slots;
+    return metrics.back().slot;
+}
+
+uint64_t MetricsRegistry::sum(uint32_t slot) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    uint64_t total = 0;
+    for (const auto& block : threads) {
+        total += block->values[slot].load(std::memory_order_relaxed);
+    }
+    return total;
+}
+
+Counter MetricsRegistry::counter(const std::string& name, const std::string& help, const std::string& labels) {
+    return Counter(this, add(name, help, labels, Type::Counter, 1));
+}
+
+Gauge MetricsRegistry::gauge(const std::string& name, const std::string& help, const std::string& labels) {
+    return Gauge(this, add(name, help, labels, Type::Gauge, 1));
+}
+
+Histogram MetricsRegistry::histogram(const std::string& name, const std::string& help, const std::string& labels) {
+    return Histogram(this, add(name, help, labels, Type::Histogram, Histogram::slotCount));
+}
+
+std::string MetricsRegistry::exportText() const {
+    std::vector<Metric> snapshot;
+    std::vector<uint64_t> totals(maxSlots, 0);
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        snapshot = metrics;
+        for (const auto& block : threads) {
+            for (uint32_t slot = 0; slot < nextSlot; ++slot) {
+                totals[slot] += block->values[slot].load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    std::string out;
+    std::unordered_set<std::string> written;
+    for (const auto& first : snapshot) {
+        if (!written.insert(first.name).second) {
+            continue;
+        }
+        const char* type = first.type == Type::Counter ? "counter" : first.type == Type::Gauge ? "gauge" : "histogram";
+        out += "# HELP " + first.name + " " + first.help + "\n";
+        out += "# TYPE " + first.name + " " + type + "\n";
+
+        for (const auto& metric : snapshot) {
+            if (metric.name != first.name) {
+                continue;
+            }
+            if (metric.type == Type::Counter) {
+                out += metric.name + withLabels(metric.labels) + " " + std::to_string(totals[metric.slot]) + "\n";
+            } else if (metric.type == Type::Gauge) {
+                double value = std::bit_cast<double>(gauges[metric.slot].load(std::memory_order_relaxed));
+                out += metric.name + withLabels(metric.labels) + " " + formatNumber(value) + "\n";
+            } else {
+                // Buckets are cumulative in the exposition format
+                uint64_t cumulative = 0;
+                for (size_t bucket = 0; bucket <= Histogram::boundsNs.size(); ++bucket) {
+                    cumulative += totals[metric.slot + bucket];
+                    std::string bound = bucket < Histogram::boundsNs.size()
+                        ? formatNumber(Histogram::boundsNs[bucket] / 1e9) : std::string("+Inf");
+                    out += metric.name + "_bucket" + withLabels(metric.labels, "le=\"" + bound + "\"") + " "
+                        + std::to_string(cumulative) + "\n";
+                }
+                double sumSeconds = totals[metric.slot + Histogram::boundsNs.size() + 1] / 1e9;
+                out += metric.name + "_sum" + withLabels(metric.labels) + " " + formatNumber(sumSeconds) + "\n";
+                out += metric.name + "_count" + withLabels(metric.labels) + " " + std::to_string(cumulative) + "\n";
+            }
+        }
+    }
+    return out;
+}
+
+const LauncherMetrics& LauncherMetrics::get() {
+    static const LauncherMetrics metrics = [] {
+        MetricsRegistry& registry = MetricsRegistry::global();
+        LauncherMetrics result;
+        result.enterpriseLaunches = registry.counter("run1c_launches_total", "1C launches started", "mode=\"enterprise\"");
+        result.configLaunches = registry.counter("run1c_launches_total", "1C launches started", "mode=\"config\"");
+        for (size_t type = 0; type < result.errors.size(); ++type) {
+            result.errors[type] = registry.counter("run1c_errors_total", "Errors reported, by type",
+                std::string("type=\"") + errorLabel(type) + "\"");
+        }
+        result.extraction = registry.histogram("run1c_path_extraction_seconds", "Base path extraction from the input");
+        result.validation = registry.histogram("run1c_path_validation_seconds", "Check of the extracted base path on disk");
+        result.storageSave = registry.histogram("run1c_storage_save_seconds", "History and settings storage writes");
+        result.frame = registry.histogram("run1c_frame_seconds", "Main loop frame time");
+        result.idleRatio = registry.gauge("run1c_frame_idle_ratio", "Share of the last second's frame time spent idle");
+        return result;
+    }();
+    return metrics;
+}
+
+void FrameMetrics::beginFrame() {
+    Clock::time_point now = Clock::now();
+    if (frameStart != Clock::time_point()) {
+        LauncherMetrics::get().frame.observe(now - frameStart);
+    } else {
+        windowStart = now;
+    }
+    frameStart = now;
+
+    Clock::duration window = now - windowStart;
+    if (window >= std::chrono::seconds(1)) {
+        LauncherMetrics::get().idleRatio.set(std::chrono::duration<double>(windowIdle) / std::chrono::duration<double>(window));
+        windowStart = now;
+        windowIdle = {};
+    }
+}
+
+void FrameMetrics::beginIdle() {
+    idleStart = Clock::now();
+}
+
+void FrameMetrics::endIdle() {
+    windowIdle += Clock::now() - idleStart;
+}
@@ -0,0 +1,231 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "error_handler.h"
+
+class MetricsRegistry;
+
+namespace detail {
+
+// The calling thread's value block in the registry it used last. Trivial,
+// so reaching it needs no thread_local initialization check
+struct MetricsThreadSlot {
+    uint64_t registryId = 0;
+    std::atomic<uint64_t>* values = nullptr;
+};
+
+inline thread_local MetricsThreadSlot metricsThreadSlot;
+
+struct MetricsThreadCache;
+
+// Only the owning thread writes a block, so no read-modify-write is needed
+inline void bumpMetric(std::atomic<uint64_t>& value, uint64_t amount) {
+    value.store(value.load(std::memory_order_relaxed) + amount, std::memory_order_relaxed);
+}
+
+} // namespace detail
+
+// Handles are two words: copy them freely, record through them from any
+// thread. A default-constructed handle records nothing
+class Counter {
+public:
+    Counter() = default;
+
+    void add(uint64_t amount = 1) const;
+    uint64_t value() const;
+
+private:
+    friend class MetricsRegistry;
+    Counter(MetricsRegistry* registry, uint32_t slot) : registry(registry), slot(slot) {}
+
+    MetricsRegistry* registry = nullptr;
+    uint32_t slot = 0;
+};
+
+// Last value set, from whichever thread
+class Gauge {
+public:
+    Gauge() = default;
+
+    void set(double value) const;
+    double value() const;
+
+private:
+    friend class MetricsRegistry;
+    Gauge(MetricsRegistry* registry, uint32_t slot) : registry(registry), slot(slot) {}
+
+    MetricsRegistry* registry = nullptr;
+    uint32_t slot = 0;
+};
+
+// Durations in fixed buckets from 10 us to 5 s, exported in seconds
+class Histogram {
+public:
+    static constexpr std::array<int64_t, 12> boundsNs = {
+        10'000, 50'000, 100'000, 500'000,
+        1'000'000, 5'000'000, 10'000'000, 50'000'000,
+        100'000'000, 500'000'000, 1'000'000'000, 5'000'000'000};
+    // One per bound, one over the last bound, then the sum in nanoseconds
+    static constexpr uint32_t slotCount = boundsNs.size() + 2;
+
+    Histogram() = default;
+
+    void observe(std::chrono::nanoseconds duration) const;
+    uint64_t count() const;
+    std::chrono::nanoseconds sum() const;
+
+private:
+    friend class MetricsRegistry;
+    Histogram(MetricsRegistry* registry, uint32_t slot) : registry(registry), slot(slot) {}
+
+    MetricsRegistry* registry = nullptr;
+    uint32_t slot = 0;
+};
+
+// Observes the time from construction to destruction
+class MetricsTimer {
+public:
+    explicit MetricsTimer(const Histogram& histogram)
+        : histogram(histogram), start(std::chrono::steady_clock::now()) {}
+    ~MetricsTimer() { histogram.observe(std::chrono::steady_clock::now() - start); }
+
+    MetricsTimer(const MetricsTimer&) = delete;
+    MetricsTimer& operator=(const MetricsTimer&) = delete;
+
+private:
+    Histogram histogram;
+    std::chrono::steady_clock::time_point start;
+};
+
+// Counters and histograms are sharded per thread: each recording thread gets
+// a block of slots it alone writes with relaxed stores, and export sums the
+// blocks. Blocks of exited threads are reused by new ones, values and all.
+// Registration takes a lock and is meant for startup; recording never does
+class MetricsRegistry {
+public:
+    static constexpr uint32_t maxSlots = 512;
+
+    MetricsRegistry();
+    ~MetricsRegistry();
+
+    MetricsRegistry(const MetricsRegistry&) = delete;
+    MetricsRegistry& operator=(const MetricsRegistry&) = delete;
+
+    // The process-wide registry, never destroyed
+    static MetricsRegistry& global();
+
+    // labels is the inside of the braces, e.g. mode="config", or empty.
+    // Registering a name and labels again returns the same metric.
+    // Throws std::length_error once maxSlots are used up
+    Counter counter(const std::string& name, const std::string& help, const std::string& labels = {});
+    Gauge gauge(const std::string& name, const std::string& help, const std::string& labels = {});
+    Histogram histogram(const std::string& name, const std::string& help, const std::string& labels = {});
+
+    // Prometheus text exposition format, metrics with one name grouped under one HELP and TYPE
+    std::string exportText() const;
+
+private:
+    friend class Counter;
+    friend class Gauge;
+    friend class Histogram;
+    friend struct detail::MetricsThreadCache;
+
+    enum class Type { Counter, Gauge, Histogram };
+
+    struct Metric {
+        std::string name;
+        std::string help;
+        std::string labels;
+        Type type;
+        uint32_t slot;
+    };
+
+    struct ThreadValues {
+        std::array<std::atomic<uint64_t>, maxSlots> values{};
+    };
+
+    std::atomic<uint64_t>* threadValues() {
+        detail::MetricsThreadSlot& current = detail::metricsThreadSlot;
+        if (current.registryId == id) {
+            return current.values;
+        }
+        return attachThread();
+    }
+    std::atomic<uint64_t>* attachThread();
+    void releaseThread(std::atomic<uint64_t>* values);
+
+    uint32_t add(const std::string& name, const std::string& help, const std::string& labels, Type type, uint32_t slots);
+    uint64_t sum(uint32_t slot) const;
+
+    const uint64_t id;
+    mutable std::mutex mutex;
+    std::vector<Metric> metrics;
+    uint32_t nextSlot = 0;
+    std::vector<std::unique_ptr<ThreadValues>> threads;
+    std::vector<ThreadValues*> released;
+    std::array<std::atomic<uint64_t>, maxSlots> gauges{};
+};
+
+inline void Counter::add(uint64_t amount) const {
+    if (registry) {
+        detail::bumpMetric(registry->threadValues()[slot], amount);
+    }
+}
+
+inline void Histogram::observe(std::chrono::nanoseconds duration) const {
+    if (!registry) {
+        return;
+    }
+    int64_t ns = duration.count() > 0 ? duration.count() : 0;
+    // Counting the bounds below ns instead of searching: no mispredicted branches
+    uint32_t bucket = 0;
+    for (int64_t bound : boundsNs) {
+        bucket += ns > bound;
+    }
+    std::atomic<uint64_t>* values = registry->threadValues() + slot;
+    detail::bumpMetric(values[bucket], 1);
+    detail::bumpMetric(values[boundsNs.size() + 1], static_cast<uint64_t>(ns));
+}
+
+// What the launcher records, on the global registry
+struct LauncherMetrics {
+    Counter enterpriseLaunches;
+    Counter configLaunches;
+    std::array<Counter, 7> errors;      // By ErrorType
+    Histogram extraction;               // Base path out of the input
+    Histogram validation;               // The extracted path on disk
+    Histogram storageSave;
+    Histogram frame;                    // Main loop, start to start
+    Gauge idleRatio;                    // Frame time spent waiting on vsync or while minimized
+
+    const Counter& launches(bool configMode) const { return configMode ? configLaunches : enterpriseLaunches; }
+    const Counter& error(ErrorType type) const { return errors[static_cast<size_t>(type)]; }
+
+    static const LauncherMetrics& get();
+};
+
+// Frame time and idle ratio for the main loop. The ratio is published about
+// once a second, over the frames of that second
+class FrameMetrics {
+public:
+    void beginFrame();
+    void beginIdle();
+    void endIdle();
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    Clock::time_point frameStart;
+    Clock::time_point idleStart;
+    Clock::time_point windowStart;
+    Clock::duration windowIdle{};
+};
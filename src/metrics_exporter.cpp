@@ -0,0 +1,248 @@
+#include "metrics_exporter.h"
+#include "error_handler.h"
+#include "metrics.h"
+#include "task_runtime.h"
+
+#include <filesystem>
+#include <fstream>
+
+#ifdef _WIN32
+#include <Windows.h>
+#include "utf_transcode.h"
+#else
+#include <cerrno>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+// A scrape is a few kilobytes; a client that does not take it in this time is dropped
+constexpr int clientWriteTimeoutMs = 1000;
+
+} // namespace
+
+MetricsExporter::MetricsExporter(MetricsRegistry& registry, TaskRuntime& runtime, std::string filePath, std::string endpoint,
+                                 std::chrono::milliseconds interval)
+    : registry(registry), runtime(runtime), filePath(std::move(filePath)), endpoint(std::move(endpoint)), interval(interval) {
+}
+
+MetricsExporter::~MetricsExporter() {
+    stop();
+}
+
+bool MetricsExporter::start() {
+    if (!filePath.empty() && !fileLoopDone.valid()) {
+        stopSource = CancellationSource();
+        std::promise<void> finished;
+        fileLoopDone = finished.get_future();
+        runtime.spawn(fileLoop(std::move(finished)));
+    }
+    return endpoint.empty() || listener.joinable() || startListening();
+}
+
+void MetricsExporter::stop() {
+    if (fileLoopDone.valid()) {
+        stopSource.cancel();
+        fileLoopDone.get();
+        writeFile();
+    }
+    if (listener.joinable()) {
+        stopListening();
+    }
+}
+
+bool MetricsExporter::writeFile() const {
+    std::string text = registry.exportText();
+    std::string temporary = filePath + ".tmp";
+    {
+        std::ofstream out(temporary, std::ios::binary | std::ios::trunc);
+        if (!out.write(text.data(), static_cast<std::streamsize>(text.size()))) {
+            return false;
+        }
+    }
+    std::error_code error;
+    std::filesystem::rename(temporary, filePath, error);
+    return !error;
+}
+
+Task<void> MetricsExporter::fileLoop(std::promise<void> finished) {
+    CancellationToken token = stopSource.token();
+    bool failing = false;
+    try {
+        for (;;) {
+            co_await runtime.io().schedule();
+            bool written = writeFile();
+            if (written == failing) {
+                failing = !written;
+                if (failing) {
+                    ErrorHandler::logWarning("Cannot write metrics to " + filePath);
+                } else {
+                    ErrorHandler::logInfo("Writing metrics to " + filePath + " again");
+                }
+            }
+            // Also ends when the runtime is destroyed; stop() writes the last values then
+            co_await runtime.delay(interval, token);
+        }
+    } catch (const TaskCancelled&) {
+    }
+    finished.set_value();
+}
+
+#ifdef _WIN32
+
+bool MetricsExporter::startListening() {
+    Utf16Buffer<> pipeName(endpoint);
+    HANDLE pipe = CreateNamedPipeW(pipeName.wide(),
+        PIPE_ACCESS_OUTBOUND | FILE_FLAG_OVERLAPPED | FILE_FLAG_FIRST_PIPE_INSTANCE,
+        PIPE_TYPE_BYTE | PIPE_WAIT | PIPE_REJECT_REMOTE_CLIENTS,
+        1, 64 * 1024, 0, 0, nullptr);
+    if (pipe == INVALID_HANDLE_VALUE) {
+        ErrorHandler::logWarning("Cannot create metrics pipe " + endpoint + ": " + ErrorHandler::getLastErrorString());
+        return false;
+    }
+    pipeHandle = pipe;
+    stopEvent = CreateEventW(nullptr, TRUE, FALSE, nullptr);
+    listenerStopping = false;
+    listener = std::thread(&MetricsExporter::listenLoop, this);
+    return true;
+}
+
+void MetricsExporter::stopListening() {
+    listenerStopping = true;
+    SetEvent(static_cast<HANDLE>(stopEvent));
+    listener.join();
+
+    CloseHandle(static_cast<HANDLE>(pipeHandle));
+    CloseHandle(static_cast<HANDLE>(stopEvent));
+    pipeHandle = nullptr;
+    stopEvent = nullptr;
+}
+
+void MetricsExporter::listenLoop() {
+    HANDLE pipe = static_cast<HANDLE>(pipeHandle);
+    HANDLE ioEvent = CreateEventW(nullptr, TRUE, FALSE, nullptr);
+    HANDLE handles[2] = {ioEvent, static_cast<HANDLE>(stopEvent)};
+
+    while (!listenerStopping) {
+        OVERLAPPED overlapped = {};
+        overlapped.hEvent = ioEvent;
+        ResetEvent(ioEvent);
+
+        DWORD unused = 0;
+        if (!ConnectNamedPipe(pipe, &overlapped)) {
+            DWORD error = GetLastError();
+            if (error == ERROR_IO_PENDING) {
+                if (WaitForMultipleObjects(2, handles, FALSE, INFINITE) != WAIT_OBJECT_0) {
+                    CancelIo(pipe);
+                    GetOverlappedResult(pipe, &overlapped, &unused, TRUE);
+                    break;
+                }
+                if (!GetOverlappedResult(pipe, &overlapped, &unused, FALSE)) {
+                    DisconnectNamedPipe(pipe);
+                    continue;
+                }
+            } else if (error != ERROR_PIPE_CONNECTED) {
+                DisconnectNamedPipe(pipe);
+                continue;
+            }
+        }
+
+        std::string text = registry.exportText();
+        OVERLAPPED write = {};
+        write.hEvent = ioEvent;
+        ResetEvent(ioEvent);
+        if (WriteFile(pipe, text.data(), static_cast<DWORD>(text.size()), nullptr, &write) || GetLastError() == ERROR_IO_PENDING) {
+            if (WaitForSingleObject(ioEvent, clientWriteTimeoutMs) == WAIT_OBJECT_0) {
+                FlushFileBuffers(pipe);
+            } else {
+                CancelIo(pipe);
+            }
+            GetOverlappedResult(pipe, &write, &unused, TRUE);
+        }
+        DisconnectNamedPipe(pipe);
+    }
+
+    CloseHandle(ioEvent);
+}
+
+#else
+
+bool MetricsExporter::startListening() {
+    std::string error;
+    switch (socketListener.listen(endpoint, &error)) {
+    case LocalSocketListener::Result::Listening:
+        break;
+    case LocalSocketListener::Result::Busy:
+        ErrorHandler::logWarning("Metrics socket " + endpoint + " is served by another process");
+        return false;
+    case LocalSocketListener::Result::Failed:
+        ErrorHandler::logWarning("Cannot listen on " + endpoint + ": " + error);
+        return false;
+    }
+
+    if (::pipe2(wakePipe, O_CLOEXEC) != 0) {
+        socketListener.close();
+        return false;
+    }
+
+    listenerStopping = false;
+    listener = std::thread(&MetricsExporter::listenLoop, this);
+    return true;
+}
+
+void MetricsExporter::stopListening() {
+    listenerStopping = true;
+    char wake = 0;
+    ssize_t unused = ::write(wakePipe[1], &wake, 1);
+    (void)unused;
+    listener.join();
+
+    socketListener.close();
+    ::close(wakePipe[0]);
+    ::close(wakePipe[1]);
+    wakePipe[0] = wakePipe[1] = -1;
+}
+
+void MetricsExporter::listenLoop() {
+    while (!listenerStopping) {
+        pollfd fds[2] = {{socketListener.fd(), POLLIN, 0}, {wakePipe[0], POLLIN, 0}};
+        if (::poll(fds, 2, -1) < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            break;
+        }
+        if (fds[1].revents != 0) {
+            break;
+        }
+        if ((fds[0].revents & POLLIN) == 0) {
+            continue;
+        }
+
+        int client = ::accept4(socketListener.fd(), nullptr, nullptr, SOCK_CLOEXEC);
+        if (client < 0) {
+            continue;
+        }
+        timeval timeout = {clientWriteTimeoutMs / 1000, (clientWriteTimeoutMs % 1000) * 1000};
+        setsockopt(client, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+
+        std::string text = registry.exportText();
+        size_t sent = 0;
+        while (sent < text.size()) {
+            ssize_t n = ::send(client, text.data() + sent, text.size() - sent, MSG_NOSIGNAL);
+            if (n < 0 && errno == EINTR) {
+                continue;
+            }
+            if (n <= 0) {
+                break;
+            }
+            sent += static_cast<size_t>(n);
+        }
+        ::close(client);
+    }
+}
+
+#endif
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <future>
+#include <string>
+#include <thread>
+
+#include "cancellation.h"
+#include "local_socket.h"
+#include "task.h"
+
+class MetricsRegistry;
+class TaskRuntime;
+
+// Publishes a registry in Prometheus text format for a local collector:
+// rewritten into a file every interval (through a temporary file, so a
+// reader never sees half of it), and/or written to every client connecting
+// to a local endpoint (a Unix domain socket, a named pipe on Windows).
+// Either target may be empty to leave it out. The file is written by a timer
+// task on the runtime's I/O pool; the endpoint is served by one thread of its own
+class MetricsExporter {
+public:
+    MetricsExporter(MetricsRegistry& registry, TaskRuntime& runtime, std::string filePath, std::string endpoint,
+                    std::chrono::milliseconds interval = std::chrono::seconds(10));
+    ~MetricsExporter();
+
+    MetricsExporter(const MetricsExporter&) = delete;
+    MetricsExporter& operator=(const MetricsExporter&) = delete;
+
+    // Returns false if the endpoint cannot be listened on; the file is written regardless
+    bool start();
+    // Writes the file one last time, also after the runtime is gone
+    void stop();
+
+    bool writeFile() const;
+
+private:
+    // Writes the file every interval until stopSource is cancelled, then sets finished
+    Task<void> fileLoop(std::promise<void> finished);
+    void listenLoop();
+    bool startListening();
+    void stopListening();
+
+    MetricsRegistry& registry;
+    TaskRuntime& runtime;
+    std::string filePath;
+    std::string endpoint;
+    std::chrono::milliseconds interval;
+
+    CancellationSource stopSource;
+    std::future<void> fileLoopDone;     // Valid while the file task runs
+
+    std::thread listener;
+    std::atomic<bool> listenerStopping{false};
+#ifdef _WIN32
+    void* pipeHandle = nullptr;
+    void* stopEvent = nullptr;
+#else
+    LocalSocketListener socketListener;
+    int wakePipe[2] = {-1, -1};
+#endif
+};
@@ -0,0 +1,301 @@
+#include "persistent_storage.h"
+#include "config.h"
+#include "metrics.h"
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <iostream>
+
+bool PersistentStorage::verbose = true;
+
+PersistentStorage::PersistentStorage() : PersistentStorage(Config::getStorageFilePath()) {
+}
+
+PersistentStorage::PersistentStorage(const std::string& path) {
+    filepath = path;
+    if (verbose) std::cout << "[config] Using storage path: " << filepath << std::endl;
+
+    // Ensure storage directories and file exist
+    createFileIfNotExists(filepath);
+    if (verbose) std::cout << "[config] Storage initialized successfully" << std::endl;
+}
+
+void PersistentStorage::setVerbose(bool enabled) {
+    verbose = enabled;
+}
+
+std::vector<std::string_view> PersistentStorage::parseBracketedLine(std::string_view line) const {
+    std::vector<std::string_view> result;
+    if (line.size() < 3 || line.front() != '[' || line.back() != ']')
+        return result;
+
+    std::string_view inner = line.substr(1, line.size() - 2); // Remove [ and ]
+    while (!inner.empty()) {
+        size_t colon = inner.find(':');
+        result.push_back(inner.substr(0, colon));
+        if (colon == std::string_view::npos) {
+            break;
+        }
+        inner.remove_prefix(colon + 1);
+    }
+
+    return result;
+}
+
+void PersistentStorage::createFileIfNotExists(const std::string& path) const {
+    // Create parent directory if it doesn't exist
+    std::filesystem::path filePath(path);
+    std::filesystem::path parentDir = filePath.parent_path();
+    if (!parentDir.empty() && !std::filesystem::exists(parentDir)) {
+        if (verbose) std::cout << "[config] Creating directory: " << parentDir.string() << std::endl;
+        std::filesystem::create_directories(parentDir);
+    }
+
+    // Create file if it doesn't exist
+    if (!std::filesystem::exists(path)) {
+        if (verbose) std::cout << "[config] Creating storage file: " << path << std::endl;
+        std::ofstream outfile(path, std::ios::app);
+        outfile.close();
+    }
+}
+
+void PersistentStorage::load() {
+
+    // Read in one piece; lines are views into the buffer until interned
+    std::string content;
+    {
+        std::ifstream infile(filepath, std::ios::binary);
+        std::error_code error;
+        auto length = std::filesystem::file_size(filepath, error);
+        if (infile.is_open() && !error && length > 0) {
+            content.resize(static_cast<size_t>(length));
+            infile.read(content.data(), static_cast<std::streamsize>(content.size()));
+            content.resize(static_cast<size_t>(infile.gcount()));
+        }
+    }
+
+    std::vector<std::string_view> lines;
+    lines.reserve(std::count(content.begin(), content.end(), '\n') + 1);
+    for (size_t begin = 0; begin < content.size();) {
+        size_t end = std::min(content.find('\n', begin), content.size());
+        std::string_view line(content.data() + begin, end - begin);
+        begin = end + 1;
+
+        // Strip leading and trailing whitespace
+        size_t first = line.find_first_not_of(" \t\r\n");
+        if (first == std::string_view::npos) continue; // Skip empty lines
+        lines.push_back(line.substr(first, line.find_last_not_of(" \t\r\n") + 1 - first));
+    }
+
+    arena.reserve(arena.stats().strings + lines.size());
+
+    for (size_t i = 0; i < lines.size(); ++i) {
+
+        std::string_view line = lines[i];
+        auto parts = parseBracketedLine(line);
+
+        if (parts.size() == 1) {
+            std::string key(parts[0]);
+            if (i + 1 < lines.size()) {
+                std::string_view nextLine = lines[i + 1];
+                if (nextLine.front() == '[' || nextLine.back() == ']') {
+                    std::cerr << "[config loading] ERROR: missing value for key: " << key << std::endl;
+                    continue;
+                }
+                if (verbose) std::cout << "[config loading] " << key << " = " << nextLine << std::endl;
+                if (!contains(key)) {
+                    assign(key, Value{arena.intern(nextLine)});
+                }
+                i++;
+            } else {
+                std::cerr << "[config loading] ERROR: missing value for key: " << key << std::endl;
+            }
+        } else if (parts.size() == 2 && parts[0] == "array") {
+            std::string key(parts[1]);
+            std::vector<std::string_view> array;
+            auto next = std::find_if(lines.begin() + i + 1, lines.end(), [](std::string_view item) {
+                return item.front() == '[' || item.back() == ']';
+            });
+            array.reserve(next - (lines.begin() + i + 1));
+            while(i + 1 < lines.size()) {
+                std::string_view nextLine = lines[i + 1];
+                if (nextLine.front() == '[' || nextLine.back() == ']') {
+                    break;
+                }
+                if (verbose) std::cout << "[config loading] " << key << " << " << nextLine << std::endl;
+                array.push_back(arena.intern(nextLine));
+                i++;
+            }
+            if (array.size() == 0) {
+                std::cerr << "[config loading] ERROR: missing items for array: " << key << std::endl;
+                continue;
+            }
+            if (!contains(key)) {
+                assign(key, Value{std::move(array)});
+            }
+        } else {
+            std::cerr << "[config loading] ERROR: wrong file format" << std::endl;
+        }
+
+    }
+
+}
+
+void PersistentStorage::save() {
+    MetricsTimer timer(LauncherMetrics::get().storageSave);
+    if (verbose) std::cout << "[config saving] persisting storage to disk" << std::endl;
+
+    std::ofstream outfile(filepath, std::ios::trunc);
+    if (!outfile.is_open()) {
+        std::cerr << "[config saving] ERROR: Unable to open file for saving: " << filepath << std::endl;
+        return;
+    }
+
+    for (const auto& [key, value] : store) {
+        if (const auto* item = std::get_if<std::string_view>(&value.data)) {
+            outfile << "[" << key << "]\n";
+            outfile << *item << '\n';
+        } else {
+            outfile << "[array:" << key << "]\n";
+            for (std::string_view item : getArrayView(key)) {
+                outfile << item << '\n';
+            }
+        }
+    }
+
+    outfile.close();
+    if (verbose) std::cout << "[config saving] storage saved successfully" << std::endl;
+}
+
+void PersistentStorage::put(const std::string& key, const PersistentStorage_StoreItem& value) {
+    if (const auto* item = std::get_if<std::string>(&value)) {
+        assign(key, Value{arena.intern(*item)});
+        return;
+    }
+    const auto& items = std::get<std::vector<std::string>>(value);
+    std::vector<std::string_view> views;
+    views.reserve(items.size());
+    for (const auto& item : items) {
+        views.push_back(arena.intern(item));
+    }
+    assign(key, Value{std::move(views)});
+}
+
+void PersistentStorage::putArray(const std::string& key, std::span<const std::string_view> values) {
+    std::vector<std::string_view> views;
+    views.reserve(values.size());
+    for (std::string_view item : values) {
+        views.push_back(arena.intern(item));
+    }
+    assign(key, Value{std::move(views)});
+}
+
+std::string PersistentStorage::getItem(const std::string& key) const {
+    return std::string(getItemView(key));
+}
+
+std::vector<std::string> PersistentStorage::getArray(const std::string& key) const {
+    auto views = getArrayView(key);
+    return std::vector<std::string>(views.begin(), views.end()); // Empty if the key is not found or the value is not a vector
+}
+
+std::string_view PersistentStorage::getItemView(std::string_view key) const {
+    auto it = store.find(key);
+    if (it != store.end()) {
+        if (const auto* item = std::get_if<std::string_view>(&it->second.data)) {
+            return *item;
+        }
+    }
+    return {};
+}
+
+StorageArrayView PersistentStorage::getArrayView(std::string_view key) const {
+    auto it = store.find(key);
+    if (it != store.end()) {
+        if (const auto* views = std::get_if<std::vector<std::string_view>>(&it->second.data)) {
+            // Read without touching the value, so concurrent readers are safe
+            if (it->second.owned) {
+                return StorageArrayView(std::span<const std::string>(*it->second.owned));
+            }
+            return StorageArrayView(std::span<const std::string_view>(*views));
+        }
+    }
+    return {};
+}
+
+std::vector<std::string>& PersistentStorage::getArrayRef(const std::string& key) {
+    auto it = store.find(key);
+    if (it == store.end() || !std::holds_alternative<std::vector<std::string_view>>(it->second.data)) {
+        // If key does not exist, create it with an empty vector
+        assign(key, Value{std::vector<std::string_view>{}});
+        it = store.find(key);
+    }
+    Value& value = it->second;
+    if (!value.owned) {
+        auto& views = std::get<std::vector<std::string_view>>(value.data);
+        liveBytes -= byteSize(value);
+        value.owned = std::make_unique<std::vector<std::string>>(views.begin(), views.end());
+        views.clear();
+    }
+    return *value.owned;
+}
+
+bool PersistentStorage::contains(const std::string& key) const {
+    return store.find(key) != store.end();
+}
+
+void PersistentStorage::remove(const std::string& key) {
+    auto it = store.find(key);
+    if (it != store.end()) {
+        liveBytes -= byteSize(it->second);
+        store.erase(it);
+    }
+}
+
+void PersistentStorage::assign(const std::string& key, Value&& value) {
+    liveBytes += byteSize(value);
+    auto it = store.find(key);
+    if (it != store.end()) {
+        liveBytes -= byteSize(it->second);
+        it->second = std::move(value);
+    } else {
+        store.emplace(key, std::move(value));
+    }
+    compactIfNeeded();
+}
+
+void PersistentStorage::compactIfNeeded() {
+    // Interning makes the arena smaller than the values it holds, so it only
+    // outgrows them by keeping strings that were replaced
+    if (arena.stats().usedBytes <= 2 * liveBytes + 64 * 1024) {
+        return;
+    }
+    StringArena fresh;
+    for (auto& [key, value] : store) {
+        if (value.owned) {
+            continue;
+        }
+        if (auto* item = std::get_if<std::string_view>(&value.data)) {
+            *item = fresh.intern(*item);
+        } else {
+            for (auto& item : std::get<std::vector<std::string_view>>(value.data)) {
+                item = fresh.intern(item);
+            }
+        }
+    }
+    arena = std::move(fresh);
+}
+
+size_t PersistentStorage::byteSize(const Value& value) {
+    if (value.owned) {
+        return 0;
+    }
+    if (const auto* item = std::get_if<std::string_view>(&value.data)) {
+        return item->size();
+    }
+    size_t size = 0;
+    for (std::string_view item : std::get<std::vector<std::string_view>>(value.data)) {
+        size += item.size();
+    }
+    return size;
+}
@@ -0,0 +1,132 @@
+#pragma once
+
+#include "string_arena.h"
+#include <cstddef>
+#include <iterator>
+#include <map>
+#include <memory>
+#include <span>
+#include <string>
+#include <string_view>
+#include <variant>
+#include <vector>
+
+using PersistentStorage_StoreItem = std::variant<std::string, std::vector<std::string>>;
+
+// Read-only view of a stored array: string views into the arena, or the
+// strings handed out by getArrayRef(), read in place either way
+class StorageArrayView {
+public:
+    class Iterator {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = std::string_view;
+        using difference_type = std::ptrdiff_t;
+        using pointer = void;
+        using reference = std::string_view;
+
+        Iterator() = default;
+        Iterator(const std::string_view* views, const std::string* strings, size_t index)
+            : views(views), strings(strings), index(index) {}
+
+        std::string_view operator*() const { return views ? views[index] : std::string_view(strings[index]); }
+        Iterator& operator++() { ++index; return *this; }
+        Iterator operator++(int) { Iterator previous = *this; ++index; return previous; }
+        bool operator==(const Iterator& other) const { return index == other.index; }
+
+    private:
+        const std::string_view* views = nullptr;
+        const std::string* strings = nullptr;
+        size_t index = 0;
+    };
+
+    StorageArrayView() = default;
+    explicit StorageArrayView(std::span<const std::string_view> views) : views(views.data()), count(views.size()) {}
+    explicit StorageArrayView(std::span<const std::string> strings) : strings(strings.data()), count(strings.size()) {}
+
+    size_t size() const { return count; }
+    bool empty() const { return count == 0; }
+    std::string_view operator[](size_t index) const { return views ? views[index] : std::string_view(strings[index]); }
+
+    Iterator begin() const { return Iterator(views, strings, 0); }
+    Iterator end() const { return Iterator(views, strings, count); }
+
+private:
+    const std::string_view* views = nullptr;
+    const std::string* strings = nullptr;
+    size_t count = 0;
+};
+
+// Strings are kept interned in a StringArena: loading a file costs a few
+// chunk allocations rather than one per line, and the view accessors read
+// values without copying them
+class PersistentStorage {
+public:
+    // Uses Config::getStorageFilePath()
+    PersistentStorage();
+    explicit PersistentStorage(const std::string& path);
+
+    // Progress messages on stdout (errors are always reported)
+    static void setVerbose(bool enabled);
+
+    // Loads configuration from file
+    void load();
+
+    // Saves configuration to file
+    void save();
+
+    // Store a string or array value by key
+    void put(const std::string& key, const PersistentStorage_StoreItem& value);
+
+    // Store an array from views; they only need to live for the call
+    void putArray(const std::string& key, std::span<const std::string_view> values);
+
+    // Get a string value by key (returns empty string if not found or not a string)
+    std::string getItem(const std::string& key) const;
+
+    // Get a vector<string> by key (returns empty vector if not found or not an array)
+    std::vector<std::string> getArray(const std::string& key) const;
+
+    // Views of the stored values (empty if not found or of the other type).
+    // Valid until the next non-const call
+    std::string_view getItemView(std::string_view key) const;
+    StorageArrayView getArrayView(std::string_view key) const;
+
+    // Get a modifiable reference to a vector<string> by key (throws if not found or not an array)
+    std::vector<std::string>& getArrayRef(const std::string& key);
+
+    // Check if key exists
+    bool contains(const std::string& key) const;
+
+    // Drops key and its value; nothing happens if it does not exist
+    void remove(const std::string& key);
+
+    StringArena::Stats arenaStats() const { return arena.stats(); }
+
+private:
+    static bool verbose;
+
+    struct Value {
+        // Views into arena; once getArrayRef() has handed the array out, owned holds it instead
+        std::variant<std::string_view, std::vector<std::string_view>> data;
+        std::unique_ptr<std::vector<std::string>> owned = nullptr;
+    };
+
+    std::string filepath;
+    StringArena arena;
+    std::map<std::string, Value, std::less<>> store;
+    size_t liveBytes = 0;   // Arena bytes the current values refer to, repeats counted
+
+    void assign(const std::string& key, Value&& value);
+
+    // Re-interns the current values into a fresh arena once replaced values dominate it
+    void compactIfNeeded();
+
+    static size_t byteSize(const Value& value);
+
+    // Helper to parse lines like [type:name] or [type:type:name]
+    std::vector<std::string_view> parseBracketedLine(std::string_view line) const;
+
+    // Ensure config file exists
+    void createFileIfNotExists(const std::string& path) const;
+};
@@ -0,0 +1,325 @@
+#include "platform_registry.h"
+#include "history.h"
+#include "utils.h"
+#include <algorithm>
+#include <atomic>
+#include <filesystem>
+#include <thread>
+
+namespace {
+
+// Probing is a couple of stats per version; more threads only help on slow or scanned disks
+constexpr size_t maxProbeThreads = 8;
+
+int64_t modificationTime(const std::string& path) {
+    std::error_code ec;
+    auto time = std::filesystem::last_write_time(path, ec);
+    if (ec) {
+        return 0;
+    }
+    return static_cast<int64_t>(time.time_since_epoch().count());
+}
+
+// Numeric components of a version, stops at the first non-digit
+std::vector<uint32_t> versionParts(std::string_view version) {
+    std::vector<uint32_t> parts;
+    uint32_t value = 0;
+    bool inNumber = false;
+    for (char c : version) {
+        if (c >= '0' && c <= '9') {
+            value = value * 10 + static_cast<uint32_t>(c - '0');
+            inNumber = true;
+        } else if (c == '.' && inNumber) {
+            parts.push_back(value);
+            value = 0;
+            inNumber = false;
+        } else {
+            break;
+        }
+    }
+    if (inNumber) {
+        parts.push_back(value);
+    }
+    return parts;
+}
+
+struct Candidate {
+    size_t root;
+    std::string version;
+    std::string directory;
+    std::string executable;     // Filled by the probe
+};
+
+} // namespace
+
+PlatformRegistry::PlatformRegistry(std::vector<std::string> rootPaths) {
+    for (auto& path : rootPaths) {
+        Root root;
+        root.path = std::move(path);
+        roots.push_back(std::move(root));
+    }
+}
+
+std::vector<std::string> PlatformRegistry::defaultRoots(const std::string& starterPath) {
+    // <root>\common\1cestart.exe, the versions are siblings of "common"
+    std::filesystem::path root = std::filesystem::path(starterPath).parent_path().parent_path();
+    std::vector<std::string> result = {root.string()};
+#ifdef _WIN32
+    // A 32-bit platform installs under the other Program Files
+    try {
+        std::filesystem::path x86 = std::filesystem::path(getEnvironmentVariable("ProgramFiles(x86)")) / "1cv8";
+        if (x86 != root) {
+            result.push_back(x86.string());
+        }
+    } catch (const std::exception&) {
+    }
+#else
+    // The Linux packages add an architecture level: /opt/1cv8/x86_64/<version>
+    result.push_back((root / "x86_64").string());
+#endif
+    return result;
+}
+
+size_t PlatformRegistry::refresh() {
+    struct Known {
+        std::string path;
+        int64_t modified;
+        bool scanned;
+    };
+    std::vector<Known> known;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (const auto& root : roots) {
+            known.push_back({root.path, root.modified, root.scanned});
+        }
+    }
+
+    // Unchanged roots cost one stat; changed ones are listed for version directories
+    std::vector<int64_t> modified(known.size());
+    std::vector<bool> changed(known.size(), false);
+    std::vector<Candidate> candidates;
+    for (size_t i = 0; i < known.size(); ++i) {
+        modified[i] = modificationTime(known[i].path);
+        if (known[i].scanned && modified[i] == known[i].modified) {
+            continue;
+        }
+        changed[i] = true;
+        std::error_code ec;
+        for (const auto& item : std::filesystem::directory_iterator(known[i].path, ec)) {
+            std::string name = item.path().filename().string();
+            if (isVersionName(name)) {
+                candidates.push_back({i, name, item.path().string(), {}});
+            }
+        }
+    }
+    size_t rescanned = static_cast<size_t>(std::count(changed.begin(), changed.end(), true));
+    if (rescanned == 0) {
+        return 0;
+    }
+
+    std::atomic<size_t> next{0};
+    auto probe = [&]() {
+        for (size_t i = next.fetch_add(1); i < candidates.size(); i = next.fetch_add(1)) {
+            candidates[i].executable = findExecutable(candidates[i].directory);
+        }
+    };
+    size_t threadCount = std::min({candidates.size(), maxProbeThreads, size_t(std::max(1u, std::thread::hardware_concurrency()))});
+    std::vector<std::thread> threads;
+    for (size_t i = 1; i < threadCount; ++i) {
+        threads.emplace_back(probe);
+    }
+    probe();
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    for (size_t i = 0; i < roots.size() && i < known.size(); ++i) {
+        if (!changed[i]) {
+            continue;
+        }
+        roots[i].modified = modified[i];
+        roots[i].scanned = true;
+        roots[i].installs.clear();
+    }
+    for (auto& candidate : candidates) {
+        if (!candidate.executable.empty()) {
+            roots[candidate.root].installs.push_back({std::move(candidate.version), std::move(candidate.executable)});
+        }
+    }
+    rebuildSorted();
+    return rescanned;
+}
+
+void PlatformRegistry::invalidate() {
+    std::lock_guard<std::mutex> lock(mutex);
+    for (auto& root : roots) {
+        root.scanned = false;
+        root.installs.clear();
+    }
+    sorted.clear();
+}
+
+void PlatformRegistry::rebuildSorted() {
+    sorted.clear();
+    for (const auto& root : roots) {
+        sorted.insert(sorted.end(), root.installs.begin(), root.installs.end());
+    }
+    // Stable: the same version under two roots goes to the root listed first
+    std::stable_sort(sorted.begin(), sorted.end(), [](const PlatformInstall& left, const PlatformInstall& right) {
+        return compareVersions(left.version, right.version) > 0;
+    });
+}
+
+std::vector<PlatformInstall> PlatformRegistry::platforms() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return sorted;
+}
+
+std::optional<PlatformInstall> PlatformRegistry::select(std::string_view prefix) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    for (const auto& install : sorted) {
+        if (matchesPrefix(install.version, prefix)) {
+            return install;
+        }
+    }
+    return std::nullopt;
+}
+
+void PlatformRegistry::setPin(const std::string& input, const std::string& version) {
+    std::lock_guard<std::mutex> lock(mutex);
+    uint64_t key = historyKeyHash(input);
+    if (version.empty()) {
+        pins.erase(key);
+    } else {
+        pins[key] = {input, version};
+    }
+}
+
+std::string PlatformRegistry::pinFor(const std::string& input) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = pins.find(historyKeyHash(input));
+    return it != pins.end() ? it->second.second : std::string();
+}
+
+std::optional<PlatformInstall> PlatformRegistry::resolve(const std::string& input) const {
+    return select(pinFor(input));
+}
+
+std::vector<std::string> PlatformRegistry::serialize() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    std::vector<std::string> lines;
+    for (const auto& root : roots) {
+        if (!root.scanned) continue;
+        lines.push_back("root|" + std::to_string(root.modified) + "|" + root.path);
+        for (const auto& install : root.installs) {
+            lines.push_back("exe|" + install.version + "|" + install.executable);
+        }
+    }
+    return lines;
+}
+
+void PlatformRegistry::deserialize(const std::vector<std::string>& lines) {
+    std::lock_guard<std::mutex> lock(mutex);
+    Root* current = nullptr;
+    for (const auto& line : lines) {
+        size_t first = line.find('|');
+        size_t second = first == std::string::npos ? std::string::npos : line.find('|', first + 1);
+        if (second == std::string::npos || second + 1 >= line.size()) {
+            continue; // Skip malformed entries
+        }
+        std::string kind = line.substr(0, first);
+        std::string field = line.substr(first + 1, second - first - 1);
+        std::string path = line.substr(second + 1);
+
+        if (kind == "root") {
+            // Only roots this registry was made for; their cache is checked against the disk on refresh
+            auto it = std::find_if(roots.begin(), roots.end(), [&path](const Root& root) { return root.path == path; });
+            current = nullptr;
+            if (it != roots.end()) {
+                try {
+                    it->modified = std::stoll(field);
+                    it->scanned = true;
+                    it->installs.clear();
+                    current = &*it;
+                } catch (const std::exception&) {
+                }
+            }
+        } else if (kind == "exe" && current && isVersionName(field)) {
+            current->installs.push_back({field, path});
+        }
+    }
+    rebuildSorted();
+}
+
+std::vector<std::string> PlatformRegistry::serializePins() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    std::vector<std::string> lines;
+    for (const auto& [key, pin] : pins) {
+        // Input goes last so it may contain '|'
+        lines.push_back(pin.second + "|" + pin.first);
+    }
+    std::sort(lines.begin(), lines.end());
+    return lines;
+}
+
+void PlatformRegistry::deserializePins(const std::vector<std::string>& lines) {
+    std::lock_guard<std::mutex> lock(mutex);
+    for (const auto& line : lines) {
+        size_t separator = line.find('|');
+        if (separator == std::string::npos || separator == 0 || separator + 1 >= line.size()) {
+            continue;
+        }
+        std::string input = line.substr(separator + 1);
+        pins[historyKeyHash(input)] = {input, line.substr(0, separator)};
+    }
+}
+
+int PlatformRegistry::compareVersions(std::string_view left, std::string_view right) {
+    std::vector<uint32_t> leftParts = versionParts(left);
+    std::vector<uint32_t> rightParts = versionParts(right);
+    for (size_t i = 0; i < std::max(leftParts.size(), rightParts.size()); ++i) {
+        uint32_t a = i < leftParts.size() ? leftParts[i] : 0;
+        uint32_t b = i < rightParts.size() ? rightParts[i] : 0;
+        if (a != b) {
+            return a < b ? -1 : 1;
+        }
+    }
+    return 0;
+}
+
+bool PlatformRegistry::isVersionName(std::string_view name) {
+    if (name.empty() || name.front() == '.' || name.back() == '.' || name.find('.') == std::string_view::npos) {
+        return false;
+    }
+    for (size_t i = 0; i < name.size(); ++i) {
+        bool digit = name[i] >= '0' && name[i] <= '9';
+        if (!digit && (name[i] != '.' || name[i - 1] == '.')) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool PlatformRegistry::matchesPrefix(std::string_view version, std::string_view prefix) {
+    std::vector<uint32_t> versionComponents = versionParts(version);
+    std::vector<uint32_t> prefixComponents = versionParts(prefix);
+    return prefixComponents.size() <= versionComponents.size()
+        && std::equal(prefixComponents.begin(), prefixComponents.end(), versionComponents.begin());
+}
+
+std::string PlatformRegistry::findExecutable(const std::string& versionDirectory) {
+#ifdef _WIN32
+    const char* candidates[] = {"bin\\1cv8.exe"};
+#else
+    const char* candidates[] = {"bin/1cv8", "1cv8"};
+#endif
+    for (const char* candidate : candidates) {
+        std::filesystem::path path = std::filesystem::path(versionDirectory) / candidate;
+        std::error_code ec;
+        if (std::filesystem::is_regular_file(path, ec)) {
+            return path.string();
+        }
+    }
+    return {};
+}
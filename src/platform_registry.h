@@ -0,0 +1,83 @@
+#pragma once
+
+#include <cstdint>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <vector>
+
+// Storage keys of the scan cache ("root|<mtime>|<dir>" followed by its
+// "exe|<version>|<executable>" lines) and of the per-base pins ("<version>|<input>")
+inline constexpr const char* platformRegistryStorageKey = "platformRegistry";
+inline constexpr const char* platformPinsStorageKey = "basePlatformPins";
+
+// One installed 1C:Enterprise platform version
+struct PlatformInstall {
+    std::string version;        // Directory name, e.g. 8.3.24.1342
+    std::string executable;     // 1cv8 of that version
+};
+
+// Installed platforms found in 1cv8\<version>\bin (<version>/1cv8 in the Linux
+// packages), so a base can be opened by its 1cv8 directly instead of through
+// 1cestart, which starts one more process and scans the same directories on
+// every launch. A root is only listed again when its modification time
+// changes, which installing or removing a version does; the version
+// directories of changed roots are probed in parallel.
+class PlatformRegistry {
+public:
+    explicit PlatformRegistry(std::vector<std::string> roots);
+
+    // Directories holding one subdirectory per version, next to the starter's "common"
+    static std::vector<std::string> defaultRoots(const std::string& starterPath);
+
+    // Stats the roots and rescans those that changed; returns how many were rescanned
+    size_t refresh();
+
+    // Forgets everything found so far, e.g. after a cached executable has gone
+    void invalidate();
+
+    // Newest version first
+    std::vector<PlatformInstall> platforms() const;
+
+    // Newest install whose version starts with the components of prefix ("8.3", "8.3.24"),
+    // the newest of all for an empty prefix
+    std::optional<PlatformInstall> select(std::string_view prefix = {}) const;
+
+    // Version pin of a base, as in the Version= line of ibases.v8i. An empty version removes it
+    void setPin(const std::string& input, const std::string& version);
+    std::string pinFor(const std::string& input) const;
+
+    // The platform a base opens with: its pin, or the newest install. Null when the pin matches none
+    std::optional<PlatformInstall> resolve(const std::string& input) const;
+
+    // Persistence, one entry per line
+    std::vector<std::string> serialize() const;
+    void deserialize(const std::vector<std::string>& lines);
+    std::vector<std::string> serializePins() const;
+    void deserializePins(const std::vector<std::string>& lines);
+
+    // Component-wise numeric comparison, "8.3.9" < "8.3.10"
+    static int compareVersions(std::string_view left, std::string_view right);
+    static bool isVersionName(std::string_view name);
+    static bool matchesPrefix(std::string_view version, std::string_view prefix);
+
+    // 1cv8 inside a version directory, empty if there is none
+    static std::string findExecutable(const std::string& versionDirectory);
+
+private:
+    void rebuildSorted();
+
+    struct Root {
+        std::string path;
+        int64_t modified = 0;       // File clock ticks (may be negative), 0 while the root is missing
+        bool scanned = false;
+        std::vector<PlatformInstall> installs;
+    };
+
+    mutable std::mutex mutex;
+    std::vector<Root> roots;
+    std::vector<PlatformInstall> sorted;    // Of all roots, newest first
+    std::unordered_map<uint64_t, std::pair<std::string, std::string>> pins;    // historyKeyHash -> (input, version)
+};
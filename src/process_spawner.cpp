@@ -0,0 +1,512 @@
+#include "process_spawner.h"
+#include <filesystem>
+#include <stdexcept>
+
+#ifdef _WIN32
+#include <Windows.h>
+#include "error_handler.h"
+#include "utf_transcode.h"
+#else
+#include <atomic>
+#include <cerrno>
+#include <csignal>
+#include <cstring>
+#include <spawn.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/syscall.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+extern char** environ;
+#endif
+
+std::string quoteWindowsArgument(const std::string& arg) {
+    if (!arg.empty() && arg.find_first_of(" \t\n\v\"") == std::string::npos) {
+        return arg;
+    }
+
+    // Backslashes are literal unless they precede a quote, so only those
+    // runs (and the run before the closing quote) are doubled
+    std::string quoted = "\"";
+    for (auto it = arg.begin();; ++it) {
+        size_t backslashes = 0;
+        while (it != arg.end() && *it == '\\') {
+            ++it;
+            ++backslashes;
+        }
+
+        if (it == arg.end()) {
+            quoted.append(backslashes * 2, '\\');
+            break;
+        } else if (*it == '"') {
+            quoted.append(backslashes * 2 + 1, '\\');
+            quoted += '"';
+        } else {
+            quoted.append(backslashes, '\\');
+            quoted += *it;
+        }
+    }
+    quoted += '"';
+    return quoted;
+}
+
+std::string buildWindowsCommandLine(const std::string& program, const std::vector<std::string>& args) {
+    std::string commandLine = quoteWindowsArgument(program);
+    for (const auto& arg : args) {
+        commandLine += ' ';
+        commandLine += quoteWindowsArgument(arg);
+    }
+    return commandLine;
+}
+
+std::string quotePosixArgument(const std::string& arg) {
+    static const char* safeCharacters = "abcdefghijklmnopqrstuvwxyzABCDEFGHIJKLMNOPQRSTUVWXYZ0123456789_@%+=:,./-";
+    if (!arg.empty() && arg.find_first_not_of(safeCharacters) == std::string::npos) {
+        return arg;
+    }
+
+    std::string quoted = "'";
+    for (char c : arg) {
+        if (c == '\'') {
+            quoted += "'\\''";
+        } else {
+            quoted += c;
+        }
+    }
+    quoted += '\'';
+    return quoted;
+}
+
+std::string formatCommandLine(const std::string& program, const std::vector<std::string>& args) {
+#ifdef _WIN32
+    return buildWindowsCommandLine(program, args);
+#else
+    std::string commandLine = quotePosixArgument(program);
+    for (const auto& arg : args) {
+        commandLine += ' ';
+        commandLine += quotePosixArgument(arg);
+    }
+    return commandLine;
+#endif
+}
+
+ProcessSpawner& ProcessSpawner::instance() {
+    static ProcessSpawner spawner;
+    return spawner;
+}
+
+size_t ProcessSpawner::runningCount() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return children.size();
+}
+
+bool ProcessSpawner::waitAll(std::chrono::milliseconds timeout) {
+    std::unique_lock<std::mutex> lock(mutex);
+    return exitCondition.wait_for(lock, timeout, [this] { return children.empty(); });
+}
+
+void ProcessSpawner::reportExit(int64_t pid, int exitCode) {
+    ExitCallback onExit;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = children.find(pid);
+        if (it == children.end()) {
+            return;
+        }
+        onExit = std::move(it->second.onExit);
+    }
+
+    if (onExit) {
+        onExit(ProcessExit{pid, exitCode});
+    }
+
+    // Removed only after the callback, so waitAll also covers exit handling
+    std::lock_guard<std::mutex> lock(mutex);
+    children.erase(pid);
+    exitCondition.notify_all();
+}
+
+#ifdef _WIN32
+
+ProcessSpawner::ProcessSpawner() {
+    wakeEvent = CreateEventW(nullptr, FALSE, FALSE, nullptr);
+    monitor = std::thread(&ProcessSpawner::monitorLoop, this);
+}
+
+ProcessSpawner::~ProcessSpawner() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wakeMonitor();
+    monitor.join();
+
+    // Children outlive the launcher, only our handles go away
+    for (auto& [pid, child] : children) {
+        CloseHandle(static_cast<HANDLE>(child.processHandle));
+    }
+    CloseHandle(static_cast<HANDLE>(wakeEvent));
+}
+
+const char* ProcessSpawner::backendName() const {
+    return "CreateProcessW + WaitForMultipleObjects";
+}
+
+void ProcessSpawner::wakeMonitor() {
+    SetEvent(static_cast<HANDLE>(wakeEvent));
+}
+
+int64_t ProcessSpawner::spawn(const std::string& program, const std::vector<std::string>& args,
+                              ExitCallback onExit, const std::string& workingDirectory) {
+    if (program.empty()) {
+        throw std::runtime_error("Program path cannot be empty");
+    }
+    if (!std::filesystem::exists(program)) {
+        throw std::runtime_error("Program not found: " + program);
+    }
+
+    // Converted on the stack; CreateProcessW may modify the command line buffer
+    Utf16Buffer<> appName(program);
+    Utf16Buffer<1024> commandLine(buildWindowsCommandLine(program, args));
+    std::string directory = workingDirectory.empty() ? std::filesystem::path(program).parent_path().string() : workingDirectory;
+    Utf16Buffer<> workingDir(directory);
+
+    STARTUPINFOW si = {};
+    si.cb = sizeof(si);
+    PROCESS_INFORMATION pi = {};
+
+    BOOL result = CreateProcessW(
+        appName.wide(),            // Application name
+        commandLine.wide(),        // Command line
+        NULL,                      // Process security attributes
+        NULL,                      // Thread security attributes
+        FALSE,                     // Inherit handles
+        0,                         // Creation flags
+        NULL,                      // Environment
+        workingDir.empty() ? NULL : workingDir.wide(), // Current directory
+        &si,                       // Startup info
+        &pi                        // Process information
+    );
+    if (!result) {
+        throw std::runtime_error("CreateProcess failed: " + ErrorHandler::getLastErrorString());
+    }
+    CloseHandle(pi.hThread);
+
+    int64_t pid = pi.dwProcessId;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        Child child;
+        child.onExit = std::move(onExit);
+        child.processHandle = pi.hProcess;
+        children.emplace(pid, std::move(child));
+    }
+    wakeMonitor();
+    return pid;
+}
+
+void ProcessSpawner::monitorLoop() {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (!stopping) {
+        // One wait covers up to 63 children, the rest are picked up as those exit
+        std::vector<HANDLE> handles = {static_cast<HANDLE>(wakeEvent)};
+        std::vector<int64_t> pids = {0};
+        for (const auto& [pid, child] : children) {
+            if (handles.size() == MAXIMUM_WAIT_OBJECTS) {
+                break;
+            }
+            if (child.processHandle) {
+                handles.push_back(static_cast<HANDLE>(child.processHandle));
+                pids.push_back(pid);
+            }
+        }
+
+        lock.unlock();
+        DWORD result = WaitForMultipleObjects(static_cast<DWORD>(handles.size()), handles.data(), FALSE, INFINITE);
+        lock.lock();
+
+        if (result == WAIT_FAILED) {
+            break;
+        }
+        size_t index = result - WAIT_OBJECT_0;
+        if (index == 0 || index >= handles.size()) {
+            continue;
+        }
+
+        DWORD exitCode = 0;
+        GetExitCodeProcess(handles[index], &exitCode);
+        CloseHandle(handles[index]);
+        children[pids[index]].processHandle = nullptr;
+
+        lock.unlock();
+        reportExit(pids[index], static_cast<int>(exitCode));
+        lock.lock();
+    }
+}
+
+#else
+
+namespace {
+
+int openPidfd(pid_t pid) {
+#ifdef SYS_pidfd_open
+    return static_cast<int>(::syscall(SYS_pidfd_open, pid, 0));
+#else
+    errno = ENOSYS;
+    return -1;
+#endif
+}
+
+int decodeWaitStatus(int status) {
+    if (WIFEXITED(status)) {
+        return WEXITSTATUS(status);
+    }
+    if (WIFSIGNALED(status)) {
+        return 128 + WTERMSIG(status);
+    }
+    return -1;
+}
+
+int waitForChild(pid_t pid) {
+    int status = 0;
+    while (::waitpid(pid, &status, 0) < 0) {
+        if (errno != EINTR) {
+            return -1;
+        }
+    }
+    return decodeWaitStatus(status);
+}
+
+// The monitor's eventfd while the SIGCHLD handler is installed
+std::atomic<int> childSignalFd{-1};
+struct sigaction previousChildAction = {};
+
+void childSignalHandler(int signal, siginfo_t* info, void* context) {
+    int savedErrno = errno;
+    int fd = childSignalFd.load();
+    if (fd >= 0) {
+        uint64_t one = 1;
+        ssize_t unused = ::write(fd, &one, sizeof(one));
+        (void)unused;
+    }
+    // Whoever handled SIGCHLD before still gets it
+    if ((previousChildAction.sa_flags & SA_SIGINFO) != 0) {
+        if (previousChildAction.sa_sigaction != nullptr) {
+            previousChildAction.sa_sigaction(signal, info, context);
+        }
+    } else if (previousChildAction.sa_handler != SIG_DFL && previousChildAction.sa_handler != SIG_IGN) {
+        previousChildAction.sa_handler(signal);
+    }
+    errno = savedErrno;
+}
+
+} // namespace
+
+ProcessSpawner::ProcessSpawner() {
+    epollFd = ::epoll_create1(EPOLL_CLOEXEC);
+    wakeFd = ::eventfd(0, EFD_CLOEXEC | EFD_NONBLOCK);
+    epoll_event event = {};
+    event.events = EPOLLIN;
+    event.data.u64 = 0;
+    if (epollFd < 0 || wakeFd < 0 || ::epoll_ctl(epollFd, EPOLL_CTL_ADD, wakeFd, &event) != 0) {
+        return;
+    }
+
+    // pidfd_open needs Linux 5.3, children on older kernels are watched through SIGCHLD
+    int probe = openPidfd(::getpid());
+    if (probe >= 0) {
+        ::close(probe);
+        pidfdSupported = true;
+    }
+    monitor = std::thread(&ProcessSpawner::monitorLoop, this);
+}
+
+ProcessSpawner::~ProcessSpawner() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    if (monitor.joinable()) {
+        wakeMonitor();
+        monitor.join();
+    }
+    if (childSignalInstalled) {
+        ::sigaction(SIGCHLD, &previousChildAction, nullptr);
+        childSignalFd = -1;
+    }
+
+    for (auto& [pid, child] : children) {
+        if (child.pidfd >= 0) {
+            ::close(child.pidfd);
+        }
+    }
+    if (epollFd >= 0) {
+        ::close(epollFd);
+    }
+    if (wakeFd >= 0) {
+        ::close(wakeFd);
+    }
+}
+
+const char* ProcessSpawner::backendName() const {
+    return pidfdSupported ? "posix_spawn + pidfd/epoll" : "posix_spawn + SIGCHLD/waitpid";
+}
+
+void ProcessSpawner::wakeMonitor() {
+    uint64_t one = 1;
+    ssize_t unused = ::write(wakeFd, &one, sizeof(one));
+    (void)unused;
+}
+
+int64_t ProcessSpawner::spawn(const std::string& program, const std::vector<std::string>& args,
+                              ExitCallback onExit, const std::string& workingDirectory) {
+    if (program.empty()) {
+        throw std::runtime_error("Program path cannot be empty");
+    }
+    if (!std::filesystem::exists(program)) {
+        throw std::runtime_error("Program not found: " + program);
+    }
+    if (!monitor.joinable()) {
+        throw std::runtime_error("Cannot watch child processes: epoll or eventfd is unavailable");
+    }
+
+    std::vector<char*> argv;
+    argv.push_back(const_cast<char*>(program.c_str()));
+    for (const auto& arg : args) {
+        argv.push_back(const_cast<char*>(arg.c_str()));
+    }
+    argv.push_back(nullptr);
+
+    posix_spawn_file_actions_t actions;
+    posix_spawn_file_actions_init(&actions);
+#if defined(__GLIBC__) && (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 29))
+    std::string directory = workingDirectory.empty() ? std::filesystem::path(program).parent_path().string() : workingDirectory;
+    if (!directory.empty()) {
+        posix_spawn_file_actions_addchdir_np(&actions, directory.c_str());
+    }
+#endif
+
+    // The child starts with an empty signal mask and default SIGPIPE handling, as the
+    // leader of its own process group: 1cv8 stays in it after 1cestart exits, which is
+    // how ProcessSupervisor finds it, and Ctrl+C in the launcher's terminal spares it
+    posix_spawnattr_t attributes;
+    posix_spawnattr_init(&attributes);
+    sigset_t signals;
+    sigemptyset(&signals);
+    posix_spawnattr_setsigmask(&attributes, &signals);
+    sigaddset(&signals, SIGPIPE);
+    posix_spawnattr_setsigdefault(&attributes, &signals);
+    posix_spawnattr_setpgroup(&attributes, 0);
+    posix_spawnattr_setflags(&attributes, POSIX_SPAWN_SETSIGMASK | POSIX_SPAWN_SETSIGDEF | POSIX_SPAWN_SETPGROUP);
+
+    pid_t pid = 0;
+    int error = ::posix_spawn(&pid, program.c_str(), &actions, &attributes, argv.data(), environ);
+    posix_spawn_file_actions_destroy(&actions);
+    posix_spawnattr_destroy(&attributes);
+    if (error != 0) {
+        throw std::runtime_error("posix_spawn failed for " + program + ": " + std::strerror(error));
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        Child& child = children[pid];
+        child.onExit = std::move(onExit);
+
+        // A pidfd becomes readable once the child exits, even if that already happened
+        if (pidfdSupported) {
+            child.pidfd = openPidfd(pid);
+            epoll_event event = {};
+            event.events = EPOLLIN;
+            event.data.u64 = static_cast<uint64_t>(pid);
+            if (child.pidfd >= 0 && ::epoll_ctl(epollFd, EPOLL_CTL_ADD, child.pidfd, &event) == 0) {
+                return pid;
+            }
+            if (child.pidfd >= 0) {
+                ::close(child.pidfd);
+                child.pidfd = -1;
+            }
+        }
+
+        if (!childSignalInstalled) {
+            struct sigaction action = {};
+            action.sa_sigaction = childSignalHandler;
+            action.sa_flags = SA_SIGINFO | SA_RESTART | SA_NOCLDSTOP;
+            sigemptyset(&action.sa_mask);
+            childSignalFd = wakeFd;
+            childSignalInstalled = ::sigaction(SIGCHLD, &action, &previousChildAction) == 0;
+        }
+    }
+    // The child may have exited before the handler was installed, so the monitor checks once now
+    wakeMonitor();
+    return pid;
+}
+
+void ProcessSpawner::monitorLoop() {
+    epoll_event events[16];
+    while (true) {
+        int count = ::epoll_wait(epollFd, events, 16, -1);
+        if (count < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            return;
+        }
+
+        for (int i = 0; i < count; ++i) {
+            if (events[i].data.u64 == 0) {
+                uint64_t value = 0;
+                ssize_t unused = ::read(wakeFd, &value, sizeof(value));
+                (void)unused;
+                {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    if (stopping) {
+                        return;
+                    }
+                }
+                reapExited();
+                continue;
+            }
+
+            // The child has exited, so reaping it does not block
+            pid_t pid = static_cast<pid_t>(events[i].data.u64);
+            int exitCode = waitForChild(pid);
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                auto it = children.find(pid);
+                if (it != children.end() && it->second.pidfd >= 0) {
+                    ::close(it->second.pidfd);
+                    it->second.pidfd = -1;
+                    it->second.reaped = true;
+                }
+            }
+            reportExit(pid, exitCode);
+        }
+    }
+}
+
+void ProcessSpawner::reapExited() {
+    std::vector<std::pair<int64_t, int>> exits;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (auto& [pid, child] : children) {
+            if (child.pidfd >= 0 || child.reaped) {
+                continue;
+            }
+            int status = 0;
+            pid_t result;
+            do {
+                result = ::waitpid(static_cast<pid_t>(pid), &status, WNOHANG);
+            } while (result < 0 && errno == EINTR);
+            if (result == 0) {
+                continue;
+            }
+            child.reaped = true;
+            exits.emplace_back(pid, result > 0 ? decodeWaitStatus(status) : -1);
+        }
+    }
+    for (const auto& [pid, exitCode] : exits) {
+        reportExit(pid, exitCode);
+    }
+}
+
+#endif
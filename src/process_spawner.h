@@ -0,0 +1,94 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Quotes one argument so CommandLineToArgvW and the MSVC runtime parse it back unchanged
+std::string quoteWindowsArgument(const std::string& arg);
+
+// Program followed by the quoted arguments, exactly as passed to CreateProcessW
+std::string buildWindowsCommandLine(const std::string& program, const std::vector<std::string>& args);
+
+// POSIX shell quoting, used for display only (posix_spawn takes argv as is)
+std::string quotePosixArgument(const std::string& arg);
+
+// Command line for logs and --dry-run in the quoting of the current platform
+std::string formatCommandLine(const std::string& program, const std::vector<std::string>& args);
+
+struct ProcessExit {
+    int64_t pid = 0;
+    int exitCode = 0;   // 128 + signal number when a POSIX child was killed by a signal
+};
+
+// Starts child processes without blocking on them and reports their exit
+// from a single monitor thread. Windows uses CreateProcessW and waits on the
+// process handles; elsewhere children are started with posix_spawn (no copy
+// of the parent's address space) and watched through pidfd + epoll. Where
+// pidfd_open is not available, a SIGCHLD handler wakes the same thread, which
+// reaps the children with waitpid(WNOHANG).
+class ProcessSpawner {
+public:
+    using ExitCallback = std::function<void(const ProcessExit&)>;
+
+    static ProcessSpawner& instance();
+
+    ProcessSpawner(const ProcessSpawner&) = delete;
+    ProcessSpawner& operator=(const ProcessSpawner&) = delete;
+
+    // Starts program in workingDirectory (the program's directory when empty) and
+    // returns its pid. onExit runs on the monitor thread. Throws std::runtime_error
+    int64_t spawn(const std::string& program, const std::vector<std::string>& args,
+                  ExitCallback onExit = nullptr, const std::string& workingDirectory = "");
+
+    // Children spawned here that have not exited yet
+    size_t runningCount() const;
+
+    // Blocks until every spawned child has exited, false on timeout
+    bool waitAll(std::chrono::milliseconds timeout);
+
+    // Exit notification mechanism in use, for logs and benchmarks
+    const char* backendName() const;
+
+private:
+    struct Child {
+        ExitCallback onExit;
+#ifdef _WIN32
+        void* processHandle = nullptr;
+#else
+        int pidfd = -1;
+        bool reaped = false;    // Exit status collected, the callback may still be running
+#endif
+    };
+
+    ProcessSpawner();
+    ~ProcessSpawner();
+
+    void monitorLoop();
+    void wakeMonitor();
+    void reportExit(int64_t pid, int exitCode);
+#ifndef _WIN32
+    // Reaps the children without a pidfd that have exited; monitor thread
+    void reapExited();
+#endif
+
+    mutable std::mutex mutex;
+    std::condition_variable exitCondition;
+    std::map<int64_t, Child> children;
+    std::thread monitor;
+    bool stopping = false;
+#ifdef _WIN32
+    void* wakeEvent = nullptr;
+#else
+    int epollFd = -1;
+    int wakeFd = -1;
+    bool pidfdSupported = false;
+    bool childSignalInstalled = false;  // Some child is watched through SIGCHLD
+#endif
+};
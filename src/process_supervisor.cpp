@@ -0,0 +1,404 @@
+#include "process_supervisor.h"
+#include <algorithm>
+#include <ctime>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+
+#ifdef _WIN32
+#include <Windows.h>
+#include <psapi.h>
+#include <tlhelp32.h>
+#else
+#include <unistd.h>
+#endif
+
+ProcessSupervisor::ProcessSupervisor(std::chrono::milliseconds interval, std::chrono::milliseconds grace)
+    : interval(interval), grace(grace), published(std::make_shared<const std::vector<SupervisedProcess>>()) {
+    sampler = std::thread(&ProcessSupervisor::samplerLoop, this);
+}
+
+ProcessSupervisor::~ProcessSupervisor() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wakeCondition.notify_all();
+    sampler.join();
+}
+
+void ProcessSupervisor::track(int64_t pid, const std::string& basePath, const std::string& mode) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        Entry& entry = entries[pid];
+        entry = Entry();
+        entry.process.pid = pid;
+        entry.process.basePath = basePath;
+        entry.process.mode = mode;
+        entry.process.startTime = static_cast<int64_t>(std::time(nullptr));
+        entry.order = nextOrder++;
+        // A starter hands over to its child within moments of being started
+        adoptUntil = std::chrono::steady_clock::now() + grace;
+
+        auto early = earlyExits.find(pid);
+        if (early != earlyExits.end()) {
+            markEntryExited(entry);
+            entry.process.exitCode = early->second;
+            earlyExits.erase(early);
+        }
+    }
+    publish();
+}
+
+void ProcessSupervisor::markExited(int64_t pid, int exitCode) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = entries.find(pid);
+        if (it == entries.end()) {
+            // Short-lived processes can exit before the launcher gets to track them
+            earlyExits[pid] = exitCode;
+            return;
+        }
+        markEntryExited(it->second);
+        it->second.process.exitCode = exitCode;
+    }
+    publish();
+}
+
+bool ProcessSupervisor::adopts(const Entry& entry, std::chrono::steady_clock::time_point now) const {
+    return entry.process.state == SupervisedProcess::State::Running || now - entry.exitedAt < grace;
+}
+
+void ProcessSupervisor::markEntryExited(Entry& entry) {
+    if (entry.process.state == SupervisedProcess::State::Exited) {
+        return;
+    }
+    entry.process.state = SupervisedProcess::State::Exited;
+    entry.process.cpuPercent = 0.0;
+    entry.exitedAt = std::chrono::steady_clock::now();
+    adoptUntil = std::max(adoptUntil, entry.exitedAt + grace);
+}
+
+ProcessSupervisor::Snapshot ProcessSupervisor::snapshot() const {
+    std::lock_guard<std::mutex> lock(publishMutex);
+    return published;
+}
+
+size_t ProcessSupervisor::runningCount() const {
+    Snapshot current = snapshot();
+    return static_cast<size_t>(std::count_if(current->begin(), current->end(), [](const SupervisedProcess& process) {
+        return process.state == SupervisedProcess::State::Running;
+    }));
+}
+
+void ProcessSupervisor::samplerLoop() {
+    std::unique_lock<std::mutex> lock(mutex);
+    while (!stopping) {
+        if (wakeCondition.wait_for(lock, interval, [this] { return stopping; })) {
+            break;
+        }
+        // A starter that just exited may still get its 1cv8 adopted
+        auto now = std::chrono::steady_clock::now();
+        bool anyAdopting = std::any_of(entries.begin(), entries.end(), [this, now](const auto& item) {
+            return adopts(item.second, now);
+        });
+        if (!anyAdopting) {
+            continue;
+        }
+
+        lock.unlock();
+        sampleNow();
+        lock.lock();
+    }
+}
+
+void ProcessSupervisor::sampleNow() {
+    std::vector<int64_t> running;
+    auto listTime = std::chrono::steady_clock::now();
+    bool adopting = false;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (const auto& [pid, entry] : entries) {
+            if (entry.process.state == SupervisedProcess::State::Running) {
+                running.push_back(pid);
+            }
+        }
+        adopting = listTime < adoptUntil;
+    }
+    if (running.empty() && !adopting) {
+        return;
+    }
+
+    // 1cestart exits right after starting 1cv8, so children of tracked processes are tracked
+    // too: members of a tracked launch's process group, or children of a tracked parent.
+    // Outside the grace period the adopted processes are sampled by pid like the rest
+    std::vector<ListedProcess> processes;
+    if (adopting) {
+        processes = listProcesses();
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (const ListedProcess& listedProcess : processes) {
+            if (entries.count(listedProcess.pid) != 0) {
+                continue;
+            }
+            auto parent = entries.find(listedProcess.parentPid);
+            if (parent == entries.end() || !adopts(parent->second, listTime)) {
+                parent = listedProcess.processGroup != 0 ? entries.find(listedProcess.processGroup) : entries.end();
+                if (parent == entries.end() || parent->second.process.parentPid != 0) {
+                    continue;
+                }
+            }
+            Entry child;
+            child.process.pid = listedProcess.pid;
+            child.process.parentPid = parent->first;
+            child.process.basePath = parent->second.process.basePath;
+            child.process.mode = parent->second.process.mode;
+            child.process.startTime = static_cast<int64_t>(std::time(nullptr));
+            child.order = nextOrder++;
+            entries.emplace(listedProcess.pid, std::move(child));
+            running.push_back(listedProcess.pid);
+        }
+    }
+
+    // OS reads happen without the lock
+    std::vector<std::pair<bool, ProcessStats>> stats(running.size());
+    for (size_t i = 0; i < running.size(); ++i) {
+        stats[i].first = readProcessStats(running[i], stats[i].second);
+    }
+    auto now = std::chrono::steady_clock::now();
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (size_t i = 0; i < running.size(); ++i) {
+            auto it = entries.find(running[i]);
+            if (it == entries.end() || it->second.process.state != SupervisedProcess::State::Running) {
+                continue;
+            }
+            Entry& entry = it->second;
+            const ProcessStats& sample = stats[i].second;
+            if (!stats[i].first || sample.exited) {
+                markEntryExited(entry);
+                continue;
+            }
+
+            if (entry.sampled && sample.cpuTimeNs >= entry.lastCpuTimeNs) {
+                double wallNs = static_cast<double>(std::chrono::duration_cast<std::chrono::nanoseconds>(now - entry.lastSampleTime).count());
+                entry.process.cpuPercent = wallNs > 0 ? (sample.cpuTimeNs - entry.lastCpuTimeNs) * 100.0 / wallNs : 0.0;
+            }
+            entry.process.rssBytes = sample.rssBytes;
+            entry.process.readBytes = sample.readBytes;
+            entry.process.writeBytes = sample.writeBytes;
+            entry.lastCpuTimeNs = sample.cpuTimeNs;
+            entry.lastSampleTime = now;
+            entry.sampled = true;
+        }
+
+        // Keep only the newest finished entries
+        std::vector<std::pair<uint64_t, int64_t>> finished;
+        for (const auto& [pid, entry] : entries) {
+            if (entry.process.state != SupervisedProcess::State::Running) {
+                finished.emplace_back(entry.order, pid);
+            }
+        }
+        if (finished.size() > finishedRetention) {
+            std::sort(finished.begin(), finished.end());
+            for (size_t i = 0; i < finished.size() - finishedRetention; ++i) {
+                entries.erase(finished[i].second);
+            }
+        }
+    }
+    publish();
+}
+
+void ProcessSupervisor::publish() {
+    auto processes = std::make_shared<std::vector<SupervisedProcess>>();
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        std::vector<const Entry*> ordered;
+        ordered.reserve(entries.size());
+        for (const auto& [pid, entry] : entries) {
+            ordered.push_back(&entry);
+        }
+        // Running first, newest first within each group
+        std::sort(ordered.begin(), ordered.end(), [](const Entry* a, const Entry* b) {
+            bool aRunning = a->process.state == SupervisedProcess::State::Running;
+            bool bRunning = b->process.state == SupervisedProcess::State::Running;
+            if (aRunning != bRunning) {
+                return aRunning;
+            }
+            return a->order > b->order;
+        });
+        processes->reserve(ordered.size());
+        for (const Entry* entry : ordered) {
+            processes->push_back(entry->process);
+        }
+    }
+
+    std::lock_guard<std::mutex> lock(publishMutex);
+    published = std::move(processes);
+}
+
+bool ProcessSupervisor::parseProcStat(const std::string& content, ProcessStats& out, long pageSize, long ticksPerSecond) {
+    // The command name is in parentheses and may itself contain spaces and ')'
+    size_t nameEnd = content.rfind(')');
+    if (nameEnd == std::string::npos || ticksPerSecond <= 0) {
+        return false;
+    }
+
+    std::istringstream fields(content.substr(nameEnd + 1));
+    char state = 0;
+    int64_t parentPid = 0;
+    int64_t processGroup = 0;
+    fields >> state >> parentPid >> processGroup;
+
+    // Skip session .. cmajflt to reach utime and stime (fields 14 and 15)
+    std::string skipped;
+    for (int i = 0; i < 8; ++i) {
+        fields >> skipped;
+    }
+    uint64_t userTicks = 0;
+    uint64_t systemTicks = 0;
+    fields >> userTicks >> systemTicks;
+
+    // cutime .. vsize, then rss (field 24) in pages
+    for (int i = 0; i < 8; ++i) {
+        fields >> skipped;
+    }
+    int64_t rssPages = 0;
+    fields >> rssPages;
+    if (fields.fail()) {
+        return false;
+    }
+
+    out.parentPid = parentPid;
+    out.processGroup = processGroup;
+    out.cpuTimeNs = (userTicks + systemTicks) * (1000000000ull / static_cast<uint64_t>(ticksPerSecond));
+    out.rssBytes = rssPages > 0 ? static_cast<uint64_t>(rssPages) * static_cast<uint64_t>(pageSize) : 0;
+    out.exited = state == 'Z' || state == 'X';
+    return true;
+}
+
+bool ProcessSupervisor::parseProcIo(const std::string& content, ProcessStats& out) {
+    std::istringstream lines(content);
+    std::string key;
+    uint64_t value = 0;
+    bool found = false;
+    while (lines >> key >> value) {
+        if (key == "read_bytes:") {
+            out.readBytes = value;
+            found = true;
+        } else if (key == "write_bytes:") {
+            out.writeBytes = value;
+            found = true;
+        }
+    }
+    return found;
+}
+
+#ifdef _WIN32
+
+namespace {
+
+uint64_t fileTimeTo100ns(const FILETIME& time) {
+    return (static_cast<uint64_t>(time.dwHighDateTime) << 32) | time.dwLowDateTime;
+}
+
+} // namespace
+
+bool ProcessSupervisor::readProcessStats(int64_t pid, ProcessStats& out) {
+    HANDLE process = OpenProcess(PROCESS_QUERY_LIMITED_INFORMATION, FALSE, static_cast<DWORD>(pid));
+    if (process == nullptr) {
+        return false;
+    }
+
+    FILETIME creationTime, exitTime, kernelTime, userTime;
+    if (GetProcessTimes(process, &creationTime, &exitTime, &kernelTime, &userTime)) {
+        out.cpuTimeNs = (fileTimeTo100ns(kernelTime) + fileTimeTo100ns(userTime)) * 100;
+    }
+
+    PROCESS_MEMORY_COUNTERS memory = {};
+    if (GetProcessMemoryInfo(process, &memory, sizeof(memory))) {
+        out.rssBytes = memory.WorkingSetSize;
+    }
+
+    IO_COUNTERS io = {};
+    if (GetProcessIoCounters(process, &io)) {
+        out.readBytes = io.ReadTransferCount;
+        out.writeBytes = io.WriteTransferCount;
+    }
+
+    DWORD exitCode = 0;
+    out.exited = GetExitCodeProcess(process, &exitCode) && exitCode != STILL_ACTIVE;
+    CloseHandle(process);
+    return true;
+}
+
+std::vector<ListedProcess> ProcessSupervisor::listProcesses() {
+    std::vector<ListedProcess> processes;
+    HANDLE snapshot = CreateToolhelp32Snapshot(TH32CS_SNAPPROCESS, 0);
+    if (snapshot == INVALID_HANDLE_VALUE) {
+        return processes;
+    }
+
+    PROCESSENTRY32W entry = {};
+    entry.dwSize = sizeof(entry);
+    for (BOOL ok = Process32FirstW(snapshot, &entry); ok; ok = Process32NextW(snapshot, &entry)) {
+        processes.push_back({entry.th32ProcessID, entry.th32ParentProcessID, 0});
+    }
+    CloseHandle(snapshot);
+    return processes;
+}
+
+#else
+
+namespace {
+
+bool readSmallFile(const std::string& path, std::string& content) {
+    std::ifstream file(path);
+    if (!file.is_open()) {
+        return false;
+    }
+    std::ostringstream buffer;
+    buffer << file.rdbuf();
+    content = buffer.str();
+    return true;
+}
+
+} // namespace
+
+bool ProcessSupervisor::readProcessStats(int64_t pid, ProcessStats& out) {
+    static const long pageSize = sysconf(_SC_PAGESIZE);
+    static const long ticksPerSecond = sysconf(_SC_CLK_TCK);
+
+    std::string directory = "/proc/" + std::to_string(pid);
+    std::string content;
+    if (!readSmallFile(directory + "/stat", content) || !parseProcStat(content, out, pageSize, ticksPerSecond)) {
+        return false;
+    }
+
+    // Only readable for our own processes, counters stay at zero otherwise
+    if (readSmallFile(directory + "/io", content)) {
+        parseProcIo(content, out);
+    }
+    return true;
+}
+
+std::vector<ListedProcess> ProcessSupervisor::listProcesses() {
+    std::vector<ListedProcess> processes;
+    std::error_code ec;
+    for (const auto& item : std::filesystem::directory_iterator("/proc", ec)) {
+        const std::string name = item.path().filename().string();
+        if (name.empty() || name.find_first_not_of("0123456789") != std::string::npos) {
+            continue;
+        }
+        std::string content;
+        ProcessStats stats;
+        if (readSmallFile(item.path().string() + "/stat", content) && parseProcStat(content, stats)) {
+            processes.push_back({std::stoll(name), stats.parentPid, stats.processGroup});
+        }
+    }
+    return processes;
+}
+
+#endif
@@ -0,0 +1,129 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+// Raw counters read from the OS for one process
+struct ProcessStats {
+    int64_t parentPid = 0;
+    int64_t processGroup = 0;   // Linux only
+    uint64_t cpuTimeNs = 0;     // User + kernel time
+    uint64_t rssBytes = 0;      // Resident set / working set
+    uint64_t readBytes = 0;
+    uint64_t writeBytes = 0;
+    bool exited = false;        // Zombie on Linux, exit code set on Windows
+};
+
+// One process of the system list
+struct ListedProcess {
+    int64_t pid = 0;
+    int64_t parentPid = 0;
+    int64_t processGroup = 0;   // 0 on Windows
+};
+
+// A 1C process started by the launcher, or a child of one (1cestart hands over to 1cv8)
+struct SupervisedProcess {
+    enum class State {
+        Running,
+        Exited      // exitCode is -1 when the process vanished without a notification
+    };
+
+    int64_t pid = 0;
+    int64_t parentPid = 0;      // Tracked parent (or group leader) for adopted children, 0 otherwise
+    std::string basePath;
+    std::string mode;           // ENTERPRISE or CONFIG
+    int64_t startTime = 0;      // Seconds since the Unix epoch
+    State state = State::Running;
+    int exitCode = -1;
+
+    // From the latest sample
+    double cpuPercent = 0.0;    // Of one core
+    uint64_t rssBytes = 0;
+    uint64_t readBytes = 0;
+    uint64_t writeBytes = 0;
+};
+
+// Tracks launched 1C processes and samples their CPU, memory and I/O on a
+// low-frequency background thread. Readers get an immutable snapshot, so the
+// UI never waits for sampling regardless of how many processes are tracked.
+// Children of tracked processes are adopted: by process group on Linux, where
+// ProcessSpawner starts every launch as its own group and 1cv8 keeps it after
+// 1cestart exits and it is reparented, and by parent pid, which Windows keeps
+// pointing at the exited starter, for adoptionGrace after the parent exits.
+// Finding children takes a walk over every process of the system, so it is
+// only done for adoptionGrace after a process is tracked or a tracked one
+// exits; the rest of the time only the tracked processes are read.
+class ProcessSupervisor {
+public:
+    using Snapshot = std::shared_ptr<const std::vector<SupervisedProcess>>;
+
+    // Finished entries kept for display, oldest are dropped first
+    static constexpr size_t finishedRetention = 32;
+    // How long an exited process still adopts its children, and how long the
+    // system process list is walked after a process is tracked or exits
+    static constexpr std::chrono::seconds adoptionGrace{10};
+
+    explicit ProcessSupervisor(std::chrono::milliseconds interval = std::chrono::seconds(1),
+                               std::chrono::milliseconds grace = adoptionGrace);
+    ~ProcessSupervisor();
+
+    ProcessSupervisor(const ProcessSupervisor&) = delete;
+    ProcessSupervisor& operator=(const ProcessSupervisor&) = delete;
+
+    void track(int64_t pid, const std::string& basePath, const std::string& mode);
+    void markExited(int64_t pid, int exitCode);
+
+    // Latest published state, running processes first. Never blocks on sampling
+    Snapshot snapshot() const;
+    size_t runningCount() const;
+
+    // Samples immediately on the calling thread (tests and benchmarks)
+    void sampleNow();
+
+    // Platform readers: /proc on Linux, process APIs on Windows
+    static bool readProcessStats(int64_t pid, ProcessStats& out);
+    static bool parseProcStat(const std::string& content, ProcessStats& out, long pageSize = 4096, long ticksPerSecond = 100);
+    static bool parseProcIo(const std::string& content, ProcessStats& out);
+
+    // Every process on the system, used to adopt children
+    static std::vector<ListedProcess> listProcesses();
+
+private:
+    struct Entry {
+        SupervisedProcess process;
+        uint64_t lastCpuTimeNs = 0;
+        std::chrono::steady_clock::time_point lastSampleTime;
+        bool sampled = false;
+        uint64_t order = 0;     // Tracking order, used for display and retention
+        std::chrono::steady_clock::time_point exitedAt;
+    };
+
+    void samplerLoop();
+    // Running, or exited within the grace period; mutex held
+    bool adopts(const Entry& entry, std::chrono::steady_clock::time_point now) const;
+    // Also keeps the process list walked for the grace period; mutex held
+    void markEntryExited(Entry& entry);
+    void publish();
+
+    std::chrono::milliseconds interval;
+    std::chrono::milliseconds grace;
+    mutable std::mutex mutex;
+    std::condition_variable wakeCondition;
+    std::map<int64_t, Entry> entries;
+    std::map<int64_t, int> earlyExits;  // Exit reported before track() was called
+    uint64_t nextOrder = 0;
+    std::chrono::steady_clock::time_point adoptUntil;  // Children are looked for until then
+    bool stopping = false;
+    std::thread sampler;
+
+    mutable std::mutex publishMutex;
+    Snapshot published;
+};
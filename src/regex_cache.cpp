@@ -0,0 +1,63 @@
+#include "regex_cache.h"
+
+RegexCache::RegexCache(size_t capacity) : maxEntries(capacity == 0 ? 1 : capacity) {}
+
+std::string RegexCache::makeKey(const std::string& pattern, Flags flags) {
+    return std::to_string(static_cast<unsigned>(flags)) + ':' + pattern;
+}
+
+RegexCache::Handle RegexCache::get(const std::string& pattern, Flags flags) {
+    std::string key = makeKey(pattern, flags);
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        auto it = index.find(key);
+        if (it != index.end()) {
+            entries.splice(entries.begin(), entries, it->second);
+            counters.hits++;
+            return it->second->regex;
+        }
+        counters.misses++;
+    }
+
+    // Compiling takes far longer than a lookup, so other threads are not held up.
+    // Two threads missing on the same pattern both compile it, the first insert wins
+    Handle compiled = std::make_shared<const std::regex>(pattern, flags);
+
+    std::lock_guard<std::mutex> lock(mutex);
+    auto it = index.find(key);
+    if (it != index.end()) {
+        entries.splice(entries.begin(), entries, it->second);
+        return it->second->regex;
+    }
+    entries.push_front(Entry{key, compiled});
+    index.emplace(std::move(key), entries.begin());
+    if (entries.size() > maxEntries) {
+        index.erase(entries.back().key);
+        entries.pop_back();
+        counters.evictions++;
+    }
+    return compiled;
+}
+
+RegexCache::Stats RegexCache::stats() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    Stats result = counters;
+    result.size = entries.size();
+    return result;
+}
+
+void RegexCache::clear() {
+    std::lock_guard<std::mutex> lock(mutex);
+    entries.clear();
+    index.clear();
+    counters = Stats();
+}
+
+RegexCache& RegexCache::global() {
+    static RegexCache cache;
+    return cache;
+}
+
+void replaceWithRegex(std::string& str, const std::regex& regex, const std::string& to) {
+    str = std::regex_replace(str, regex, to);
+}
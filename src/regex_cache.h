@@ -0,0 +1,54 @@
+#pragma once
+
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <regex>
+#include <string>
+#include <unordered_map>
+
+// Bounded LRU cache of compiled regular expressions, keyed by pattern text and
+// syntax flags. Thread-safe; returned handles stay valid after eviction
+class RegexCache {
+public:
+    using Flags = std::regex_constants::syntax_option_type;
+    using Handle = std::shared_ptr<const std::regex>;
+
+    struct Stats {
+        uint64_t hits = 0;
+        uint64_t misses = 0;
+        uint64_t evictions = 0;
+        size_t size = 0;
+    };
+
+    explicit RegexCache(size_t capacity = 64);
+
+    // Compiled pattern, from the cache or compiled now (outside the lock).
+    // Throws std::regex_error for an invalid pattern, which is not cached
+    Handle get(const std::string& pattern, Flags flags = std::regex_constants::ECMAScript);
+
+    Stats stats() const;
+    size_t capacity() const { return maxEntries; }
+    void clear();
+
+    // Cache behind replaceWithRegex
+    static RegexCache& global();
+
+private:
+    struct Entry {
+        std::string key;
+        Handle regex;
+    };
+
+    static std::string makeKey(const std::string& pattern, Flags flags);
+
+    size_t maxEntries;
+    mutable std::mutex mutex;
+    std::list<Entry> entries;       // Most recently used first
+    std::unordered_map<std::string, std::list<Entry>::iterator> index;
+    Stats counters;
+};
+
+// replaceWithRegex for callers that keep a compiled pattern
+void replaceWithRegex(std::string& str, const std::regex& regex, const std::string& to);
@@ -0,0 +1,680 @@
+#include "server_health.h"
+#include "connection_string.h"
+#include "error_handler.h"
+#include "frame_arena.h"
+#include "history.h"
+#include "task_runtime.h"
+#include <algorithm>
+#include <cstring>
+#include <memory>
+#include <system_error>
+
+#ifdef _WIN32
+#include <winsock2.h>
+#include <ws2tcpip.h>
+#else
+#include <cerrno>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+// A host with v4 and v6 addresses is tried on both, not on every address of a round-robin name
+constexpr size_t maxAddressesPerEndpoint = 4;
+
+#ifdef _WIN32
+using SocketHandle = SOCKET;
+const SocketHandle invalidSocket = INVALID_SOCKET;
+
+void closeSocket(SocketHandle socket) { ::closesocket(socket); }
+int lastSocketError() { return ::WSAGetLastError(); }
+bool connectPending(int error) { return error == WSAEWOULDBLOCK; }
+#else
+using SocketHandle = int;
+const SocketHandle invalidSocket = -1;
+
+void closeSocket(SocketHandle socket) { ::close(socket); }
+int lastSocketError() { return errno; }
+bool connectPending(int error) { return error == EINPROGRESS; }
+#endif
+
+SocketHandle openNonBlocking(int family) {
+#ifdef _WIN32
+    SOCKET socket = ::socket(family, SOCK_STREAM, IPPROTO_TCP);
+    u_long nonBlocking = 1;
+    if (socket != INVALID_SOCKET && ::ioctlsocket(socket, FIONBIO, &nonBlocking) != 0) {
+        ::closesocket(socket);
+        return INVALID_SOCKET;
+    }
+    return socket;
+#else
+    return ::socket(family, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, IPPROTO_TCP);
+#endif
+}
+
+int pendingError(SocketHandle socket) {
+    int error = 0;
+    socklen_t length = sizeof(error);
+    if (::getsockopt(socket, SOL_SOCKET, SO_ERROR, reinterpret_cast<char*>(&error), &length) != 0) {
+        return lastSocketError();
+    }
+    return error;
+}
+
+std::string socketErrorText(int error) {
+    std::string text = std::system_category().message(error);
+    while (!text.empty() && (text.back() == '\n' || text.back() == '\r' || text.back() == '.')) {
+        text.pop_back();
+    }
+    return text;
+}
+
+std::string toLower(std::string_view text) {
+    std::string result(text);
+    std::transform(result.begin(), result.end(), result.begin(), [](unsigned char c) {
+        return c >= 'A' && c <= 'Z' ? static_cast<char>(c - 'A' + 'a') : static_cast<char>(c);
+    });
+    return result;
+}
+
+struct Resolved {
+    std::vector<std::pair<sockaddr_storage, socklen_t>> addresses;
+    std::string error;
+};
+
+void copyAddresses(const addrinfo* list, Resolved& resolved) {
+    for (const addrinfo* info = list; info && resolved.addresses.size() < maxAddressesPerEndpoint; info = info->ai_next) {
+        sockaddr_storage address = {};
+        std::memcpy(&address, info->ai_addr, std::min(sizeof(address), static_cast<size_t>(info->ai_addrlen)));
+        resolved.addresses.emplace_back(address, static_cast<socklen_t>(info->ai_addrlen));
+    }
+}
+
+addrinfo streamHints(int flags) {
+    addrinfo hints = {};
+    hints.ai_family = AF_UNSPEC;
+    hints.ai_socktype = SOCK_STREAM;
+    hints.ai_protocol = IPPROTO_TCP;
+    hints.ai_flags = flags;
+    return hints;
+}
+
+// Literal addresses need no lookup; false if host is a name
+bool resolveNumeric(const ServerEndpoint& endpoint, Resolved& resolved) {
+    addrinfo hints = streamHints(AI_NUMERICHOST | AI_NUMERICSERV);
+    addrinfo* list = nullptr;
+    if (::getaddrinfo(endpoint.host.c_str(), std::to_string(endpoint.port).c_str(), &hints, &list) != 0) {
+        return false;
+    }
+    copyAddresses(list, resolved);
+    ::freeaddrinfo(list);
+    return true;
+}
+
+std::string notAnswered(const char* what, std::chrono::milliseconds timeout) {
+    return std::string(what) + " within " + std::to_string(timeout.count()) + " ms";
+}
+
+#ifndef _WIN32
+
+// An asynchronous lookup; getaddrinfo_a writes into it until it completes
+struct Lookup {
+    gaicb request = {};
+    addrinfo hints = streamHints(AI_NUMERICSERV);
+    std::string host;
+    std::string service;
+};
+
+// Lookups that could not be cancelled at their deadline, freed once the resolver is done with them
+std::mutex abandonedMutex;
+std::vector<Lookup*> abandonedLookups;
+
+void reapAbandonedLookups() {
+    std::lock_guard<std::mutex> lock(abandonedMutex);
+    abandonedLookups.erase(std::remove_if(abandonedLookups.begin(), abandonedLookups.end(), [](Lookup* lookup) {
+        if (::gai_error(&lookup->request) == EAI_INPROGRESS) {
+            return false;
+        }
+        if (lookup->request.ar_result) {
+            ::freeaddrinfo(lookup->request.ar_result);
+        }
+        delete lookup;
+        return true;
+    }), abandonedLookups.end());
+}
+
+#endif
+
+// Names are looked up concurrently (getaddrinfo_a on Linux), unresolved ones fail at the deadline
+std::vector<Resolved> resolveAll(const std::vector<ServerEndpoint>& endpoints, std::chrono::milliseconds timeout) {
+    std::vector<Resolved> resolved(endpoints.size());
+    std::vector<size_t> names;
+    for (size_t i = 0; i < endpoints.size(); ++i) {
+        if (!resolveNumeric(endpoints[i], resolved[i])) {
+            names.push_back(i);
+        }
+    }
+    if (names.empty()) {
+        return resolved;
+    }
+    auto deadline = std::chrono::steady_clock::now() + timeout;
+
+#ifdef _WIN32
+    // The system resolver is used as is here; it caches and has its own retry limits
+    for (size_t i : names) {
+        if (std::chrono::steady_clock::now() >= deadline) {
+            resolved[i].error = notAnswered("Name not resolved", timeout);
+            continue;
+        }
+        addrinfo hints = streamHints(AI_NUMERICSERV);
+        addrinfo* list = nullptr;
+        int status = ::getaddrinfo(endpoints[i].host.c_str(), std::to_string(endpoints[i].port).c_str(), &hints, &list);
+        if (status != 0) {
+            resolved[i].error = "Cannot resolve " + endpoints[i].host + ": " + socketErrorText(status);
+            continue;
+        }
+        copyAddresses(list, resolved[i]);
+        ::freeaddrinfo(list);
+    }
+#else
+    reapAbandonedLookups();
+    std::vector<std::unique_ptr<Lookup>> lookups;
+    std::vector<gaicb*> requests;
+    for (size_t i : names) {
+        auto lookup = std::make_unique<Lookup>();
+        lookup->host = endpoints[i].host;
+        lookup->service = std::to_string(endpoints[i].port);
+        lookup->request.ar_name = lookup->host.c_str();
+        lookup->request.ar_service = lookup->service.c_str();
+        lookup->request.ar_request = &lookup->hints;
+        requests.push_back(&lookup->request);
+        lookups.push_back(std::move(lookup));
+    }
+    // On failure some lookups may have been queued anyway; each reports its own state below
+    bool started = ::getaddrinfo_a(GAI_NOWAIT, requests.data(), static_cast<int>(requests.size()), nullptr) == 0;
+
+    while (started) {
+        std::vector<const gaicb*> pending;
+        for (gaicb* request : requests) {
+            if (::gai_error(request) == EAI_INPROGRESS) {
+                pending.push_back(request);
+            }
+        }
+        auto remaining = std::chrono::duration_cast<std::chrono::nanoseconds>(deadline - std::chrono::steady_clock::now());
+        if (pending.empty() || remaining.count() <= 0) {
+            break;
+        }
+        timespec wait = {static_cast<time_t>(remaining.count() / 1000000000), static_cast<long>(remaining.count() % 1000000000)};
+        ::gai_suspend(pending.data(), static_cast<int>(pending.size()), &wait);
+    }
+
+    for (size_t n = 0; n < names.size(); ++n) {
+        Resolved& result = resolved[names[n]];
+        gaicb& request = lookups[n]->request;
+        if (::gai_error(&request) == EAI_INPROGRESS) {
+            ::gai_cancel(&request);
+        }
+        int status = ::gai_error(&request);
+        if (status == EAI_INPROGRESS) {
+            result.error = notAnswered("Name not resolved", timeout);
+            std::lock_guard<std::mutex> lock(abandonedMutex);
+            abandonedLookups.push_back(lookups[n].release());
+            continue;
+        }
+        if (status == 0) {
+            copyAddresses(request.ar_result, result);
+            ::freeaddrinfo(request.ar_result);
+        } else if (status == EAI_CANCELED) {
+            result.error = notAnswered("Name not resolved", timeout);
+        } else {
+            result.error = "Cannot resolve " + lookups[n]->host + ": " + ::gai_strerror(status);
+        }
+    }
+#endif
+    return resolved;
+}
+
+// Sockets with a connect in progress, reported once they connect or fail
+class ConnectPoller {
+public:
+    ConnectPoller() {
+#ifndef _WIN32
+        epollFd = ::epoll_create1(EPOLL_CLOEXEC);
+#endif
+    }
+
+    ~ConnectPoller() {
+#ifndef _WIN32
+        if (epollFd >= 0) {
+            ::close(epollFd);
+        }
+#endif
+    }
+
+    ConnectPoller(const ConnectPoller&) = delete;
+    ConnectPoller& operator=(const ConnectPoller&) = delete;
+
+    bool add(SocketHandle socket, size_t id) {
+#ifdef _WIN32
+        WSAPOLLFD entry = {};
+        entry.fd = socket;
+        entry.events = POLLWRNORM;
+        entries.push_back(entry);
+        ids.push_back(id);
+        return true;
+#else
+        epoll_event event = {};
+        event.events = EPOLLOUT;
+        event.data.u64 = id;
+        return epollFd >= 0 && ::epoll_ctl(epollFd, EPOLL_CTL_ADD, socket, &event) == 0;
+#endif
+    }
+
+    // Before the socket is closed
+    void remove(SocketHandle socket) {
+#ifdef _WIN32
+        for (size_t i = 0; i < entries.size(); ++i) {
+            if (entries[i].fd == socket) {
+                entries.erase(entries.begin() + i);
+                ids.erase(ids.begin() + i);
+                break;
+            }
+        }
+#else
+        ::epoll_ctl(epollFd, EPOLL_CTL_DEL, socket, nullptr);
+#endif
+    }
+
+    // Ids of the sockets that finished within timeout
+    std::vector<size_t> wait(std::chrono::milliseconds timeout) {
+        std::vector<size_t> ready;
+#ifdef _WIN32
+        if (::WSAPoll(entries.data(), static_cast<ULONG>(entries.size()), static_cast<INT>(timeout.count())) > 0) {
+            for (size_t i = 0; i < entries.size(); ++i) {
+                if (entries[i].revents != 0) {
+                    ready.push_back(ids[i]);
+                }
+            }
+        }
+#else
+        epoll_event events[64];
+        int count = ::epoll_wait(epollFd, events, 64, static_cast<int>(timeout.count()));
+        for (int i = 0; i < count; ++i) {
+            ready.push_back(static_cast<size_t>(events[i].data.u64));
+        }
+#endif
+        return ready;
+    }
+
+private:
+#ifdef _WIN32
+    std::vector<WSAPOLLFD> entries;
+    std::vector<size_t> ids;
+#else
+    int epollFd = -1;
+#endif
+};
+
+} // namespace
+
+std::string ServerEndpoint::name() const {
+    std::string lower = toLower(host);
+    if (lower.find(':') != std::string::npos) {
+        return "[" + lower + "]:" + std::to_string(port);
+    }
+    return lower + ":" + std::to_string(port);
+}
+
+ServerHealthProber::ServerHealthProber(TaskRuntime& runtime, std::chrono::milliseconds timeout, std::chrono::milliseconds ttl)
+    : runtime(runtime), timeout(timeout), ttl(ttl) {
+#ifdef _WIN32
+    WSADATA data;
+    ::WSAStartup(MAKEWORD(2, 2), &data);
+#endif
+}
+
+ServerHealthProber::~ServerHealthProber() {
+    std::future<void> rounds;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+        rounds = std::move(roundsDone);
+    }
+    stopSource.cancel();
+    if (rounds.valid()) {
+        rounds.wait();
+    }
+#ifdef _WIN32
+    ::WSACleanup();
+#endif
+}
+
+std::vector<ServerEndpoint> ServerHealthProber::parseEndpoints(std::string_view server) {
+    std::vector<ServerEndpoint> result;
+    size_t start = 0;
+    while (start <= server.size()) {
+        size_t end = server.find_first_of(",;", start);
+        std::string_view item = server.substr(start, end == std::string_view::npos ? std::string_view::npos : end - start);
+        start = end == std::string_view::npos ? server.size() + 1 : end + 1;
+
+        while (!item.empty() && (item.front() == ' ' || item.front() == '\t')) item.remove_prefix(1);
+        while (!item.empty() && (item.back() == ' ' || item.back() == '\t')) item.remove_suffix(1);
+        if (item.size() > 6 && toLower(item.substr(0, 6)) == "tcp://") {
+            item.remove_prefix(6);
+        }
+
+        ServerEndpoint endpoint;
+        endpoint.port = defaultPort;
+        std::string_view port;
+        if (!item.empty() && item.front() == '[') {
+            size_t close = item.find(']');
+            if (close == std::string_view::npos) continue;
+            endpoint.host = std::string(item.substr(1, close - 1));
+            if (close + 1 < item.size()) {
+                if (item[close + 1] != ':') continue;
+                port = item.substr(close + 2);
+            }
+        } else {
+            size_t colon = item.find(':');
+            // A bare IPv6 address has several colons and no port
+            if (colon != std::string_view::npos && item.find(':', colon + 1) == std::string_view::npos) {
+                endpoint.host = std::string(item.substr(0, colon));
+                port = item.substr(colon + 1);
+            } else {
+                endpoint.host = std::string(item);
+            }
+        }
+        if (!port.empty()) {
+            uint32_t value = 0;
+            bool valid = port.size() <= 5;
+            for (char c : port) {
+                valid = valid && c >= '0' && c <= '9';
+                value = value * 10 + static_cast<uint32_t>(c - '0');
+            }
+            if (!valid || value == 0 || value > 65535) continue;
+            endpoint.port = static_cast<uint16_t>(value);
+        }
+        if (!endpoint.host.empty()) {
+            result.push_back(std::move(endpoint));
+        }
+    }
+    return result;
+}
+
+bool ServerHealthProber::watch(const std::string& input) {
+    ConnectionString connection;
+    if (!parseConnectionString(input, connection) || connection.kind != ConnectionKind::Server) {
+        return false;
+    }
+    std::vector<ServerEndpoint> addresses = parseEndpoints(connection.server.str());
+    if (addresses.empty()) {
+        return false;
+    }
+
+    std::vector<std::string> names;
+    bool added = false;
+    std::promise<void> finished;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        for (auto& address : addresses) {
+            std::string name = address.name();
+            if (endpoints.find(name) == endpoints.end()) {
+                endpoints[name].address = std::move(address);
+                added = true;
+            }
+            names.push_back(std::move(name));
+        }
+        bases[historyKeyHash(input)] = std::move(names);
+        if (!added || stopping) {
+            return true;
+        }
+        if (running) {
+            // A task waiting for the next TTL probes the new endpoint right away
+            wakeSource.cancel();
+            return true;
+        }
+        running = true;
+        roundsDone = finished.get_future();
+    }
+    runtime.spawn(roundLoop(std::move(finished)));
+    return true;
+}
+
+const std::pair<const std::string, ServerHealthProber::Endpoint>* ServerHealthProber::bestEndpoint(uint64_t key) const {
+    auto base = bases.find(key);
+    if (base == bases.end()) {
+        return nullptr;
+    }
+
+    // Reachable through any endpoint, the fastest one; otherwise unreachable once all were probed
+    const std::pair<const std::string, Endpoint>* best = nullptr;
+    for (const auto& name : base->second) {
+        const auto& item = *endpoints.find(name);
+        const Endpoint& endpoint = item.second;
+        if (endpoint.state == ServerReachability::Unknown) {
+            if (!best || best->second.state == ServerReachability::Unreachable) {
+                best = &item;
+            }
+            continue;
+        }
+        bool better = !best
+            || (endpoint.state == ServerReachability::Reachable
+                && (best->second.state != ServerReachability::Reachable || endpoint.connectTime < best->second.connectTime));
+        if (better) {
+            best = &item;
+        }
+    }
+    return best && best->second.state != ServerReachability::Unknown ? best : nullptr;
+}
+
+std::optional<ServerHealth> ServerHealthProber::health(uint64_t key) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    const auto* best = bestEndpoint(key);
+    if (!best) {
+        return std::nullopt;
+    }
+    const Endpoint& endpoint = best->second;
+    return ServerHealth{endpoint.state, best->first, endpoint.connectTime, endpoint.error, endpoint.checked};
+}
+
+const char* ServerHealthProber::lookupStatus(uint64_t key, FrameArena& arena) const {
+    std::lock_guard<std::mutex> lock(mutex);
+    const auto* best = bestEndpoint(key);
+    if (!best) {
+        return nullptr;
+    }
+    if (best->second.state == ServerReachability::Unreachable) {
+        return "offline";
+    }
+    return arena.format("online %lld ms", static_cast<long long>(best->second.connectTime.count()));
+}
+
+void ServerHealthProber::waitIdle() {
+    std::unique_lock<std::mutex> lock(mutex);
+    idleCondition.wait(lock, [this] {
+        return stopping || (probing == 0 && std::none_of(endpoints.begin(), endpoints.end(), [](const auto& item) {
+            return item.second.state == ServerReachability::Unknown;
+        }));
+    });
+}
+
+bool ServerHealthProber::due(const Endpoint& endpoint, ServerHealth::Clock::time_point now) const {
+    return !endpoint.probing && (endpoint.state == ServerReachability::Unknown || now - endpoint.checked >= ttl);
+}
+
+Task<void> ServerHealthProber::roundLoop(std::promise<void> finished) {
+    for (;;) {
+        std::vector<std::string> names;
+        std::vector<ServerEndpoint> round;
+        std::chrono::milliseconds wait{0};
+        CancellationToken wake;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (stopping) {
+                // Endpoints still waiting are not probed on exit
+                probing = 0;
+                running = false;
+                idleCondition.notify_all();
+                break;
+            }
+            auto now = ServerHealth::Clock::now();
+            auto nextDue = ServerHealth::Clock::time_point::max();
+            for (auto& [name, endpoint] : endpoints) {
+                if (due(endpoint, now) && round.size() < maxProbesPerRound) {
+                    endpoint.probing = true;
+                    names.push_back(name);
+                    round.push_back(endpoint.address);
+                } else if (!endpoint.probing && endpoint.state != ServerReachability::Unknown) {
+                    nextDue = std::min(nextDue, endpoint.checked + ttl);
+                }
+            }
+            if (round.empty()) {
+                if (nextDue == ServerHealth::Clock::time_point::max()) {
+                    // Nothing to probe again; the next watch() starts a new task
+                    running = false;
+                    break;
+                }
+                wait = std::chrono::ceil<std::chrono::milliseconds>(nextDue - now);
+                wakeSource = CancellationSource(stopSource.token());
+                wake = wakeSource.token();
+            } else {
+                probing += round.size();
+            }
+        }
+
+        if (round.empty()) {
+            try {
+                co_await runtime.delay(wait, wake);
+            } catch (const TaskCancelled&) {
+                // Not woken by watch() or the destructor: the runtime is going away
+                if (!wake.isCancelled()) {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    stopping = true;
+                }
+            }
+            continue;
+        }
+
+        // Resolving and connecting block up to the timeouts, so rounds run on the I/O pool
+        co_await runtime.io().schedule();
+        std::vector<ProbeResult> results = probeRound(round);
+
+        std::vector<std::string> wentDown;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            auto now = ServerHealth::Clock::now();
+            for (size_t i = 0; i < names.size(); ++i) {
+                Endpoint& endpoint = endpoints.at(names[i]);
+                ServerReachability state = results[i].reachable ? ServerReachability::Reachable : ServerReachability::Unreachable;
+                if (state == ServerReachability::Unreachable && endpoint.state != ServerReachability::Unreachable) {
+                    wentDown.push_back("Server " + names[i] + " is unreachable: " + results[i].error);
+                }
+                endpoint.state = state;
+                endpoint.connectTime = results[i].connectTime;
+                endpoint.error = std::move(results[i].error);
+                endpoint.checked = now;
+                endpoint.probing = false;
+            }
+            probing -= round.size();
+            idleCondition.notify_all();
+        }
+        for (const auto& message : wentDown) {
+            ErrorHandler::logInfo(message);
+        }
+    }
+    // The prober may be gone right after this
+    finished.set_value();
+}
+
+std::vector<ServerHealthProber::ProbeResult> ServerHealthProber::probeRound(const std::vector<ServerEndpoint>& round) {
+    std::vector<ProbeResult> results(round.size());
+    std::vector<Resolved> resolved = resolveAll(round, timeout);
+
+    struct Attempt {
+        size_t endpoint;
+        SocketHandle socket;
+        ServerHealth::Clock::time_point started;
+    };
+    std::vector<Attempt> attempts;
+    ConnectPoller poller;
+    size_t open = 0;
+
+    auto finish = [&](Attempt& attempt, int error) {
+        ProbeResult& result = results[attempt.endpoint];
+        if (error == 0 && !result.reachable) {
+            result.reachable = true;
+            result.error.clear();
+            result.connectTime = std::chrono::duration_cast<std::chrono::milliseconds>(ServerHealth::Clock::now() - attempt.started);
+        } else if (error != 0) {
+            result.error = socketErrorText(error);
+        }
+        poller.remove(attempt.socket);
+        closeSocket(attempt.socket);
+        attempt.socket = invalidSocket;
+        open--;
+        // Once one address answered, the endpoint's other attempts are not needed
+        if (result.reachable) {
+            for (auto& other : attempts) {
+                if (other.endpoint == attempt.endpoint && other.socket != invalidSocket) {
+                    poller.remove(other.socket);
+                    closeSocket(other.socket);
+                    other.socket = invalidSocket;
+                    open--;
+                }
+            }
+        }
+    };
+
+    attempts.reserve(round.size() * maxAddressesPerEndpoint);
+    for (size_t i = 0; i < round.size(); ++i) {
+        results[i].error = resolved[i].error;
+        if (resolved[i].addresses.empty() && results[i].error.empty()) {
+            results[i].error = "No address for " + round[i].host;
+        }
+        for (const auto& [address, length] : resolved[i].addresses) {
+            if (results[i].reachable) break;
+            SocketHandle socket = openNonBlocking(address.ss_family);
+            if (socket == invalidSocket) {
+                results[i].error = socketErrorText(lastSocketError());
+                continue;
+            }
+            attempts.push_back({i, socket, ServerHealth::Clock::now()});
+            open++;
+            if (::connect(socket, reinterpret_cast<const sockaddr*>(&address), length) == 0) {
+                finish(attempts.back(), 0);
+            } else {
+                int error = lastSocketError();
+                if (!connectPending(error) || !poller.add(socket, attempts.size() - 1)) {
+                    finish(attempts.back(), error);
+                }
+            }
+        }
+    }
+
+    auto deadline = ServerHealth::Clock::now() + timeout;
+    while (open > 0) {
+        auto remaining = std::chrono::ceil<std::chrono::milliseconds>(deadline - ServerHealth::Clock::now());
+        if (remaining.count() <= 0) {
+            break;
+        }
+        for (size_t id : poller.wait(remaining)) {
+            if (attempts[id].socket != invalidSocket) {
+                finish(attempts[id], pendingError(attempts[id].socket));
+            }
+        }
+    }
+
+    for (auto& attempt : attempts) {
+        if (attempt.socket != invalidSocket) {
+            closeSocket(attempt.socket);
+            if (!results[attempt.endpoint].reachable) {
+                results[attempt.endpoint].error = notAnswered("No answer", timeout);
+            }
+        }
+    }
+    return results;
+}
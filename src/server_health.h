@@ -0,0 +1,125 @@
+#pragma once
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <future>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "cancellation.h"
+#include "task.h"
+
+class FrameArena;
+class TaskRuntime;
+
+// One cluster manager address of a Srvr= value
+struct ServerEndpoint {
+    std::string host;
+    uint16_t port = 0;
+
+    // "host:port", the host in lower case; IPv6 addresses in brackets
+    std::string name() const;
+};
+
+enum class ServerReachability {
+    Unknown,        // Not probed yet
+    Reachable,
+    Unreachable
+};
+
+// Last probe result of a server base (of the best of its endpoints)
+struct ServerHealth {
+    using Clock = std::chrono::steady_clock;
+
+    ServerReachability state = ServerReachability::Unknown;
+    std::string endpoint;                   // The endpoint that answered, or the last that failed
+    std::chrono::milliseconds connectTime{0};
+    std::string error;                      // Why the endpoint is unreachable
+    Clock::time_point checked;
+};
+
+// Reachability of the servers behind Srvr= bases, so a base on a cluster
+// that is down is marked in the list instead of costing a minute in the 1C
+// client. Watched endpoints are resolved and TCP-connected in probe rounds,
+// run by one task on the runtime's I/O pool: all due probes of a round run at
+// once on non-blocking sockets (epoll on Linux, WSAPoll on Windows), each
+// under a resolve and a connect timeout. Between rounds the task waits on a
+// runtime timer for the next TTL to expire. Results are cached per endpoint,
+// so bases of one cluster share a probe; one older than the TTL stays shown
+// until it is probed again.
+class ServerHealthProber {
+public:
+    // Default port of the cluster manager (rmngr)
+    static constexpr uint16_t defaultPort = 1541;
+    // Sockets a round opens at most; further endpoints wait for the next round
+    static constexpr size_t maxProbesPerRound = 256;
+
+    explicit ServerHealthProber(TaskRuntime& runtime,
+                                std::chrono::milliseconds timeout = std::chrono::seconds(2),
+                                std::chrono::milliseconds ttl = std::chrono::seconds(60));
+    ~ServerHealthProber();
+
+    ServerHealthProber(const ServerHealthProber&) = delete;
+    ServerHealthProber& operator=(const ServerHealthProber&) = delete;
+
+    // Endpoints of a Srvr= value: "host", "host:port", "tcp://host:port", "[::1]:1541",
+    // several separated by ',' or ';'. Empty if there is no host
+    static std::vector<ServerEndpoint> parseEndpoints(std::string_view server);
+
+    // Keeps the server of input probed; other kinds of bases are ignored. Returns false for those
+    bool watch(const std::string& input);
+
+    // Null while the base is not watched or was not probed yet
+    std::optional<ServerHealth> health(uint64_t key) const;
+
+    // "offline" or "online 3 ms" for the history row, null while unknown
+    const char* lookupStatus(uint64_t key, FrameArena& arena) const;
+
+    // Blocks until no endpoint waits for its first result or is being probed
+    void waitIdle();
+
+private:
+    struct Endpoint {
+        ServerEndpoint address;
+        ServerReachability state = ServerReachability::Unknown;
+        std::chrono::milliseconds connectTime{0};
+        std::string error;
+        ServerHealth::Clock::time_point checked;
+        bool probing = false;
+    };
+
+    struct ProbeResult {
+        bool reachable = false;
+        std::chrono::milliseconds connectTime{0};
+        std::string error;
+    };
+
+    // Probes due endpoints round after round until the prober or the runtime stops, then sets finished
+    Task<void> roundLoop(std::promise<void> finished);
+    // Resolves and connects to every endpoint at once, under the timeouts
+    std::vector<ProbeResult> probeRound(const std::vector<ServerEndpoint>& endpoints);
+    bool due(const Endpoint& endpoint, ServerHealth::Clock::time_point now) const;
+    // Endpoint deciding the health of a base, null while that is unknown; mutex held
+    const std::pair<const std::string, Endpoint>* bestEndpoint(uint64_t key) const;
+
+    TaskRuntime& runtime;
+    std::chrono::milliseconds timeout;
+    std::chrono::milliseconds ttl;
+    CancellationSource stopSource;      // Ends the wait between rounds on destruction
+
+    mutable std::mutex mutex;
+    std::condition_variable idleCondition;
+    CancellationSource wakeSource;      // Of the current wait between rounds; cancelled when an endpoint is added
+    bool running = false;               // The round task is running
+    bool stopping = false;
+    size_t probing = 0;
+    std::unordered_map<std::string, Endpoint> endpoints;                // By ServerEndpoint::name()
+    std::unordered_map<uint64_t, std::vector<std::string>> bases;       // historyKeyHash -> endpoint names
+    std::future<void> roundsDone;       // Of the round task
+};
@@ -0,0 +1,426 @@
+#include "single_instance.h"
+#include "error_handler.h"
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+
+#ifdef _WIN32
+#include <Windows.h>
+#include "utf_transcode.h"
+#else
+#include <cerrno>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+// Forwarded arguments are a few short strings, anything larger is not ours
+constexpr uint32_t maxPayloadSize = 1024 * 1024;
+constexpr char acknowledgement = 'K';
+constexpr int serverReadTimeoutMs = 1000;
+
+void appendU32(std::string& out, uint32_t value) {
+    for (int i = 0; i < 4; ++i) {
+        out += static_cast<char>((value >> (8 * i)) & 0xFF);
+    }
+}
+
+uint32_t readU32(const char* data) {
+    uint32_t value = 0;
+    for (int i = 0; i < 4; ++i) {
+        value |= static_cast<uint32_t>(static_cast<unsigned char>(data[i])) << (8 * i);
+    }
+    return value;
+}
+
+} // namespace
+
+std::string encodeInstanceMessage(const std::vector<std::string>& args) {
+    std::string payload;
+    appendU32(payload, static_cast<uint32_t>(args.size()));
+    for (const auto& arg : args) {
+        appendU32(payload, static_cast<uint32_t>(arg.size()));
+        payload += arg;
+    }
+
+    std::string message;
+    appendU32(message, static_cast<uint32_t>(payload.size()));
+    return message + payload;
+}
+
+bool decodeInstanceMessage(const std::string& payload, std::vector<std::string>& args) {
+    args.clear();
+    if (payload.size() < 4) {
+        return false;
+    }
+
+    uint32_t count = readU32(payload.data());
+    size_t offset = 4;
+    for (uint32_t i = 0; i < count; ++i) {
+        if (payload.size() - offset < 4) {
+            return false;
+        }
+        uint32_t length = readU32(payload.data() + offset);
+        offset += 4;
+        if (payload.size() - offset < length) {
+            return false;
+        }
+        args.emplace_back(payload, offset, length);
+        offset += length;
+    }
+    return offset == payload.size();
+}
+
+InstanceServer::InstanceServer(std::string endpoint) : endpoint(std::move(endpoint)) {
+}
+
+InstanceServer::~InstanceServer() {
+    stop();
+}
+
+std::vector<std::vector<std::string>> InstanceServer::takeRequests() {
+    std::lock_guard<std::mutex> lock(mutex);
+    std::vector<std::vector<std::string>> taken(std::make_move_iterator(requests.begin()), std::make_move_iterator(requests.end()));
+    requests.clear();
+    return taken;
+}
+
+void InstanceServer::queueRequest(std::vector<std::string> args) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        requests.push_back(std::move(args));
+    }
+    if (notify) {
+        notify();
+    }
+}
+
+#ifdef _WIN32
+
+namespace {
+
+// Overlapped transfer on a pipe opened for overlapped I/O, gives up after timeoutMs
+bool transferOverlapped(HANDLE pipe, HANDLE event, bool write, char* data, DWORD size, int timeoutMs) {
+    DWORD done = 0;
+    while (done < size) {
+        OVERLAPPED overlapped = {};
+        overlapped.hEvent = event;
+        ResetEvent(event);
+
+        DWORD transferred = 0;
+        BOOL ok = write ? WriteFile(pipe, data + done, size - done, nullptr, &overlapped)
+                        : ReadFile(pipe, data + done, size - done, nullptr, &overlapped);
+        if (!ok && GetLastError() != ERROR_IO_PENDING) {
+            return false;
+        }
+        if (WaitForSingleObject(event, static_cast<DWORD>(timeoutMs)) != WAIT_OBJECT_0) {
+            CancelIo(pipe);
+            GetOverlappedResult(pipe, &overlapped, &transferred, TRUE);
+            return false;
+        }
+        if (!GetOverlappedResult(pipe, &overlapped, &transferred, FALSE) || transferred == 0) {
+            return false;
+        }
+        done += transferred;
+    }
+    return true;
+}
+
+} // namespace
+
+bool InstanceServer::start(Notify notify) {
+    if (isListening()) {
+        return true;
+    }
+
+    // Only one process can create the first instance of a pipe name
+    Utf16Buffer<> pipeName(endpoint);
+    HANDLE pipe = CreateNamedPipeW(pipeName.wide(),
+        PIPE_ACCESS_DUPLEX | FILE_FLAG_OVERLAPPED | FILE_FLAG_FIRST_PIPE_INSTANCE,
+        PIPE_TYPE_BYTE | PIPE_READMODE_BYTE | PIPE_WAIT | PIPE_REJECT_REMOTE_CLIENTS,
+        1, 4096, 4096, 0, nullptr);
+    if (pipe == INVALID_HANDLE_VALUE) {
+        if (GetLastError() != ERROR_ACCESS_DENIED) {
+            ErrorHandler::logWarning("Cannot create instance pipe " + endpoint + ": " + ErrorHandler::getLastErrorString());
+        }
+        return false;
+    }
+
+    pipeHandle = pipe;
+    stopEvent = CreateEventW(nullptr, TRUE, FALSE, nullptr);
+    this->notify = std::move(notify);
+    stopping = false;
+    listener = std::thread(&InstanceServer::listenLoop, this);
+    return true;
+}
+
+void InstanceServer::stop() {
+    if (!isListening()) {
+        return;
+    }
+    stopping = true;
+    SetEvent(static_cast<HANDLE>(stopEvent));
+    listener.join();
+
+    CloseHandle(static_cast<HANDLE>(pipeHandle));
+    CloseHandle(static_cast<HANDLE>(stopEvent));
+    pipeHandle = nullptr;
+    stopEvent = nullptr;
+}
+
+void InstanceServer::listenLoop() {
+    HANDLE pipe = static_cast<HANDLE>(pipeHandle);
+    HANDLE ioEvent = CreateEventW(nullptr, TRUE, FALSE, nullptr);
+
+    while (!stopping) {
+        OVERLAPPED overlapped = {};
+        overlapped.hEvent = ioEvent;
+        ResetEvent(ioEvent);
+
+        if (!ConnectNamedPipe(pipe, &overlapped)) {
+            DWORD error = GetLastError();
+            if (error == ERROR_IO_PENDING) {
+                HANDLE handles[2] = {ioEvent, static_cast<HANDLE>(stopEvent)};
+                if (WaitForMultipleObjects(2, handles, FALSE, INFINITE) != WAIT_OBJECT_0) {
+                    CancelIo(pipe);
+                    break;
+                }
+                DWORD unused = 0;
+                if (!GetOverlappedResult(pipe, &overlapped, &unused, FALSE)) {
+                    DisconnectNamedPipe(pipe);
+                    continue;
+                }
+            } else if (error != ERROR_PIPE_CONNECTED) {
+                DisconnectNamedPipe(pipe);
+                continue;
+            }
+        }
+
+        char header[4];
+        if (transferOverlapped(pipe, ioEvent, false, header, sizeof(header), serverReadTimeoutMs)) {
+            // The size comes from the client: checked before anything is allocated for it
+            uint32_t size = readU32(header);
+            std::vector<std::string> args;
+            if (size <= maxPayloadSize) {
+                std::string payload(size, '\0');
+                if (transferOverlapped(pipe, ioEvent, false, payload.data(), size, serverReadTimeoutMs)
+                    && decodeInstanceMessage(payload, args)) {
+                    queueRequest(std::move(args));
+                    char ack = acknowledgement;
+                    transferOverlapped(pipe, ioEvent, true, &ack, 1, serverReadTimeoutMs);
+                    FlushFileBuffers(pipe);
+                }
+            }
+        }
+        DisconnectNamedPipe(pipe);
+    }
+
+    CloseHandle(ioEvent);
+}
+
+bool forwardToInstance(const std::string& endpoint, const std::vector<std::string>& args, int timeoutMs) {
+    Utf16Buffer<> pipeName(endpoint);
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeoutMs);
+
+    HANDLE pipe = INVALID_HANDLE_VALUE;
+    while (true) {
+        pipe = CreateFileW(pipeName.wide(), GENERIC_READ | GENERIC_WRITE, 0, nullptr, OPEN_EXISTING, FILE_FLAG_OVERLAPPED, nullptr);
+        if (pipe != INVALID_HANDLE_VALUE) {
+            break;
+        }
+        // The server has a single pipe instance, wait while it serves another client
+        auto remaining = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - std::chrono::steady_clock::now()).count();
+        if (GetLastError() != ERROR_PIPE_BUSY || remaining <= 0
+            || !WaitNamedPipeW(pipeName.wide(), static_cast<DWORD>(remaining))) {
+            return false;
+        }
+    }
+
+    // Overlapped, so an instance that hangs costs timeoutMs instead of blocking the client for good
+    HANDLE ioEvent = CreateEventW(nullptr, TRUE, FALSE, nullptr);
+    std::string message = encodeInstanceMessage(args);
+    char ack = 0;
+    bool ok = ioEvent != nullptr
+        && transferOverlapped(pipe, ioEvent, true, message.data(), static_cast<DWORD>(message.size()), timeoutMs)
+        && transferOverlapped(pipe, ioEvent, false, &ack, 1, timeoutMs)
+        && ack == acknowledgement;
+    if (ioEvent != nullptr) {
+        CloseHandle(ioEvent);
+    }
+    CloseHandle(pipe);
+    return ok;
+}
+
+#else
+
+namespace {
+
+bool makeSocketAddress(const std::string& endpoint, sockaddr_un& address) {
+    std::memset(&address, 0, sizeof(address));
+    address.sun_family = AF_UNIX;
+    if (endpoint.empty() || endpoint.size() >= sizeof(address.sun_path)) {
+        return false;
+    }
+    std::memcpy(address.sun_path, endpoint.c_str(), endpoint.size() + 1);
+    return true;
+}
+
+void setSocketTimeout(int socket, int timeoutMs) {
+    timeval timeout;
+    timeout.tv_sec = timeoutMs / 1000;
+    timeout.tv_usec = (timeoutMs % 1000) * 1000;
+    setsockopt(socket, SOL_SOCKET, SO_RCVTIMEO, &timeout, sizeof(timeout));
+    setsockopt(socket, SOL_SOCKET, SO_SNDTIMEO, &timeout, sizeof(timeout));
+}
+
+bool readAll(int socket, char* data, size_t size) {
+    while (size > 0) {
+        ssize_t n = ::recv(socket, data, size, 0);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            return false;
+        }
+        data += n;
+        size -= static_cast<size_t>(n);
+    }
+    return true;
+}
+
+bool writeAll(int socket, const char* data, size_t size) {
+    while (size > 0) {
+        ssize_t n = ::send(socket, data, size, MSG_NOSIGNAL);
+        if (n < 0 && errno == EINTR) {
+            continue;
+        }
+        if (n <= 0) {
+            return false;
+        }
+        data += n;
+        size -= static_cast<size_t>(n);
+    }
+    return true;
+}
+
+int connectSocket(const std::string& endpoint) {
+    sockaddr_un address;
+    if (!makeSocketAddress(endpoint, address)) {
+        return -1;
+    }
+    int socket = ::socket(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (socket < 0) {
+        return -1;
+    }
+    if (::connect(socket, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0) {
+        ::close(socket);
+        return -1;
+    }
+    return socket;
+}
+
+} // namespace
+
+bool InstanceServer::start(Notify notify) {
+    if (isListening()) {
+        return true;
+    }
+
+    // Busy when another instance owns the endpoint, or is starting up at the same time
+    std::string error;
+    LocalSocketListener::Result result = socketListener.listen(endpoint, &error);
+    if (result == LocalSocketListener::Result::Failed) {
+        ErrorHandler::logWarning("Cannot listen on " + endpoint + ": " + error);
+    }
+    if (result != LocalSocketListener::Result::Listening) {
+        return false;
+    }
+
+    if (::pipe2(wakePipe, O_CLOEXEC) != 0) {
+        socketListener.close();
+        return false;
+    }
+
+    this->notify = std::move(notify);
+    stopping = false;
+    listener = std::thread(&InstanceServer::listenLoop, this);
+    return true;
+}
+
+void InstanceServer::stop() {
+    if (!isListening()) {
+        return;
+    }
+    stopping = true;
+    char wake = 0;
+    ssize_t unused = ::write(wakePipe[1], &wake, 1);
+    (void)unused;
+    listener.join();
+
+    socketListener.close();
+    ::close(wakePipe[0]);
+    ::close(wakePipe[1]);
+    wakePipe[0] = wakePipe[1] = -1;
+}
+
+void InstanceServer::listenLoop() {
+    while (!stopping) {
+        pollfd fds[2] = {{socketListener.fd(), POLLIN, 0}, {wakePipe[0], POLLIN, 0}};
+        if (::poll(fds, 2, -1) < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            break;
+        }
+        if (fds[1].revents != 0) {
+            break;
+        }
+        if ((fds[0].revents & POLLIN) == 0) {
+            continue;
+        }
+
+        int client = ::accept4(socketListener.fd(), nullptr, nullptr, SOCK_CLOEXEC);
+        if (client < 0) {
+            continue;
+        }
+        setSocketTimeout(client, serverReadTimeoutMs);
+
+        // A starting listener probes with an empty connection, which simply reads EOF here
+        char header[4];
+        if (readAll(client, header, sizeof(header))) {
+            // The size comes from the client: checked before anything is allocated for it
+            uint32_t size = readU32(header);
+            std::vector<std::string> args;
+            if (size <= maxPayloadSize) {
+                std::string payload(size, '\0');
+                if (readAll(client, payload.data(), size) && decodeInstanceMessage(payload, args)) {
+                    queueRequest(std::move(args));
+                    writeAll(client, &acknowledgement, 1);
+                }
+            }
+        }
+        ::close(client);
+    }
+}
+
+bool forwardToInstance(const std::string& endpoint, const std::vector<std::string>& args, int timeoutMs) {
+    int socket = connectSocket(endpoint);
+    if (socket < 0) {
+        return false;
+    }
+    setSocketTimeout(socket, timeoutMs);
+
+    std::string message = encodeInstanceMessage(args);
+    char ack = 0;
+    bool ok = writeAll(socket, message.data(), message.size())
+        && readAll(socket, &ack, 1)
+        && ack == acknowledgement;
+    ::close(socket);
+    return ok;
+}
+
+#endif
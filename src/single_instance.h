@@ -0,0 +1,63 @@
+#pragma once
+
+#include <atomic>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "local_socket.h"
+
+// Lets the running launcher take over later invocations. The first instance
+// listens on a local endpoint (a named pipe on Windows, a Unix domain socket
+// elsewhere, see LocalSocketListener); later ones forward their arguments to
+// it and exit.
+class InstanceServer {
+public:
+    // Called on the listener thread after a request is queued (e.g. to wake the UI)
+    using Notify = std::function<void()>;
+
+    explicit InstanceServer(std::string endpoint);
+    ~InstanceServer();
+
+    InstanceServer(const InstanceServer&) = delete;
+    InstanceServer& operator=(const InstanceServer&) = delete;
+
+    // Starts listening. Returns false if another instance already owns the endpoint
+    bool start(Notify notify = nullptr);
+    void stop();
+    bool isListening() const { return listener.joinable(); }
+
+    // Argument lists forwarded since the last call, oldest first
+    std::vector<std::vector<std::string>> takeRequests();
+
+    const std::string& getEndpoint() const { return endpoint; }
+
+private:
+    void listenLoop();
+    void queueRequest(std::vector<std::string> args);
+
+    std::string endpoint;
+    Notify notify;
+    std::thread listener;
+    std::mutex mutex;
+    std::deque<std::vector<std::string>> requests;
+    std::atomic<bool> stopping{false};
+#ifdef _WIN32
+    void* pipeHandle = nullptr;
+    void* stopEvent = nullptr;
+#else
+    LocalSocketListener socketListener;
+    int wakePipe[2] = {-1, -1};
+#endif
+};
+
+// Sends args to the instance listening on endpoint and waits for it to acknowledge.
+// Returns false if no instance is listening or it does not answer within timeoutMs
+bool forwardToInstance(const std::string& endpoint, const std::vector<std::string>& args, int timeoutMs = 2000);
+
+// Wire format: u32 payload size, then u32 length and bytes per argument (little-endian)
+std::string encodeInstanceMessage(const std::vector<std::string>& args);
+bool decodeInstanceMessage(const std::string& payload, std::vector<std::string>& args);
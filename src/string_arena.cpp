@@ -0,0 +1,103 @@
+#include "string_arena.h"
+#include <cstring>
+#include <functional>
+#include <stdexcept>
+
+StringArena::StringArena(size_t chunkSize) : chunkSize(chunkSize) {
+}
+
+std::string_view StringArena::intern(std::string_view text) {
+    counters.requests++;
+    if (text.empty()) {
+        return {};
+    }
+    if (text.size() > UINT32_MAX) {
+        throw std::length_error("StringArena: string too long");
+    }
+
+    // Kept below 3/4 full so probe sequences stay short
+    if ((counters.strings + 1) * 4 > slots.size() * 3) {
+        rehash(slots.empty() ? 1024 : slots.size() * 2);
+    }
+
+    uint32_t hash = static_cast<uint32_t>(std::hash<std::string_view>{}(text));
+    size_t mask = slots.size() - 1;
+    size_t i = hash & mask;
+    while (slots[i].data) {
+        const Slot& slot = slots[i];
+        if (slot.hash == hash && slot.size == text.size() && std::memcmp(slot.data, text.data(), text.size()) == 0) {
+            return {slot.data, slot.size};
+        }
+        i = (i + 1) & mask;
+    }
+
+    char* copy = allocate(text.size());
+    std::memcpy(copy, text.data(), text.size());
+    slots[i] = {copy, static_cast<uint32_t>(text.size()), hash};
+    counters.strings++;
+    counters.usedBytes += text.size();
+    return {copy, text.size()};
+}
+
+void StringArena::reserve(size_t strings) {
+    size_t capacity = slots.empty() ? 1024 : slots.size();
+    while (strings * 4 > capacity * 3) {
+        capacity *= 2;
+    }
+    if (capacity != slots.size()) {
+        rehash(capacity);
+    }
+}
+
+void StringArena::clear() {
+    chunks.clear();
+    cursor = nullptr;
+    remaining = 0;
+    chunkBytes = 0;
+    slots = std::vector<Slot>();
+    counters = Stats();
+}
+
+StringArena::Stats StringArena::stats() const {
+    Stats result = counters;
+    result.reservedBytes = chunkBytes + slots.capacity() * sizeof(Slot);
+    result.chunks = chunks.size();
+    return result;
+}
+
+char* StringArena::allocate(size_t size) {
+    if (size <= remaining) {
+        char* result = cursor;
+        cursor += size;
+        remaining -= size;
+        return result;
+    }
+
+    // Large strings get a chunk of their own so the current one is not abandoned
+    if (size > chunkSize / 4) {
+        chunks.emplace_back(new char[size]);
+        chunkBytes += size;
+        return chunks.back().get();
+    }
+
+    chunks.emplace_back(new char[chunkSize]);
+    chunkBytes += chunkSize;
+    cursor = chunks.back().get() + size;
+    remaining = chunkSize - size;
+    return chunks.back().get();
+}
+
+void StringArena::rehash(size_t capacity) {
+    std::vector<Slot> old(capacity);
+    old.swap(slots);
+    size_t mask = capacity - 1;
+    for (const Slot& slot : old) {
+        if (slot.data) {
+            size_t i = slot.hash & mask;
+            while (slots[i].data) {
+                i = (i + 1) & mask;
+            }
+            slots[i] = slot;
+        }
+    }
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string_view>
+#include <vector>
+
+// Interning string pool. Each distinct string is copied once into large
+// chunks and handed out as a string_view; interning it again returns the
+// same view. Views stay valid until clear() or destruction, moving the
+// arena keeps them valid
+class StringArena {
+public:
+    struct Stats {
+        size_t strings = 0;         // Distinct strings stored
+        size_t requests = 0;        // intern() calls, repeats included
+        size_t usedBytes = 0;       // String bytes stored
+        size_t reservedBytes = 0;   // Chunks and lookup table
+        size_t chunks = 0;
+    };
+
+    explicit StringArena(size_t chunkSize = 64 * 1024);
+
+    StringArena(StringArena&&) noexcept = default;
+    StringArena& operator=(StringArena&&) noexcept = default;
+
+    std::string_view intern(std::string_view text);
+
+    // Sizes the lookup table for this many distinct strings up front
+    void reserve(size_t strings);
+
+    void clear();
+    Stats stats() const;
+
+private:
+    struct Slot {
+        const char* data = nullptr;
+        uint32_t size = 0;
+        uint32_t hash = 0;
+    };
+
+    char* allocate(size_t size);
+    void rehash(size_t capacity);
+
+    size_t chunkSize;
+    std::vector<std::unique_ptr<char[]>> chunks;
+    char* cursor = nullptr;
+    size_t remaining = 0;
+    size_t chunkBytes = 0;
+
+    // Open addressing, power-of-two capacity; null data marks a free slot
+    std::vector<Slot> slots;
+    Stats counters;
+};
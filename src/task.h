@@ -0,0 +1,178 @@
+#pragma once
+
+#include <condition_variable>
+#include <coroutine>
+#include <exception>
+#include <mutex>
+#include <optional>
+#include <type_traits>
+#include <utility>
+
+// Coroutine producing a T, started lazily: it runs when awaited, handed to
+// TaskRuntime::spawn or to blockingWait, and resumes its awaiter on whatever
+// thread it finishes. Exceptions reach the awaiter.
+//
+//   Task<BaseMetadata> inspect(TaskRuntime& runtime, std::string path) {
+//       co_await runtime.io().schedule();     // off the UI thread
+//       BaseMetadata metadata = BaseInspector::inspect(path);
+//       co_await runtime.ui().schedule();     // back for the next frame
+//       co_return metadata;
+//   }
+template <typename T = void>
+class Task;
+
+namespace detail {
+
+struct TaskPromiseBase {
+    std::coroutine_handle<> continuation;
+    std::exception_ptr exception;
+
+    struct FinalAwaiter {
+        bool await_ready() const noexcept { return false; }
+        template <typename Promise>
+        std::coroutine_handle<> await_suspend(std::coroutine_handle<Promise> handle) noexcept {
+            // Symmetric transfer, so long await chains do not grow the stack
+            std::coroutine_handle<> next = handle.promise().continuation;
+            return next ? next : std::noop_coroutine();
+        }
+        void await_resume() const noexcept {}
+    };
+
+    std::suspend_always initial_suspend() const noexcept { return {}; }
+    FinalAwaiter final_suspend() const noexcept { return {}; }
+    void unhandled_exception() noexcept { exception = std::current_exception(); }
+};
+
+template <typename T>
+struct TaskPromise : TaskPromiseBase {
+    std::optional<T> value;
+
+    Task<T> get_return_object() noexcept;
+
+    template <typename U>
+    void return_value(U&& result) {
+        value.emplace(std::forward<U>(result));
+    }
+
+    T takeResult() {
+        if (exception) {
+            std::rethrow_exception(exception);
+        }
+        return std::move(*value);
+    }
+};
+
+template <>
+struct TaskPromise<void> : TaskPromiseBase {
+    Task<void> get_return_object() noexcept;
+    void return_void() const noexcept {}
+
+    void takeResult() const {
+        if (exception) {
+            std::rethrow_exception(exception);
+        }
+    }
+};
+
+// Started right away and frees itself at the end; drives tasks nobody awaits
+struct DetachedTask {
+    struct promise_type {
+        DetachedTask get_return_object() const noexcept { return {}; }
+        std::suspend_never initial_suspend() const noexcept { return {}; }
+        std::suspend_never final_suspend() const noexcept { return {}; }
+        void return_void() const noexcept {}
+        void unhandled_exception() const noexcept { std::terminate(); }
+    };
+};
+
+} // namespace detail
+
+template <typename T>
+class [[nodiscard]] Task {
+public:
+    using promise_type = detail::TaskPromise<T>;
+    using Handle = std::coroutine_handle<promise_type>;
+
+    Task() = default;
+    explicit Task(Handle handle) : handle(handle) {}
+    Task(Task&& other) noexcept : handle(std::exchange(other.handle, {})) {}
+    Task& operator=(Task&& other) noexcept {
+        if (this != &other) {
+            if (handle) handle.destroy();
+            handle = std::exchange(other.handle, {});
+        }
+        return *this;
+    }
+    ~Task() {
+        if (handle) handle.destroy();
+    }
+
+    Task(const Task&) = delete;
+    Task& operator=(const Task&) = delete;
+
+    bool isValid() const { return static_cast<bool>(handle); }
+
+    // Starts the task; the awaiter continues once it has finished
+    auto operator co_await() const noexcept {
+        struct Awaiter {
+            Handle handle;
+            bool await_ready() const noexcept { return handle.done(); }
+            std::coroutine_handle<> await_suspend(std::coroutine_handle<> awaiting) noexcept {
+                handle.promise().continuation = awaiting;
+                return handle;
+            }
+            T await_resume() { return handle.promise().takeResult(); }
+        };
+        return Awaiter{handle};
+    }
+
+private:
+    Handle handle;
+};
+
+template <typename T>
+Task<T> detail::TaskPromise<T>::get_return_object() noexcept {
+    return Task<T>(std::coroutine_handle<TaskPromise<T>>::from_promise(*this));
+}
+
+inline Task<void> detail::TaskPromise<void>::get_return_object() noexcept {
+    return Task<void>(std::coroutine_handle<TaskPromise<void>>::from_promise(*this));
+}
+
+// Runs task and blocks the calling thread until it has finished, for tests,
+// command line modes and shutdown. Never call it on the thread that has to
+// resume the task (the UI thread for a task waiting on UiExecutor)
+template <typename T>
+T blockingWait(Task<T> task) {
+    std::mutex mutex;
+    std::condition_variable finished;
+    bool done = false;
+    std::exception_ptr exception;
+    std::conditional_t<std::is_void_v<T>, bool, std::optional<T>> result{};
+
+    auto run = [&]() -> detail::DetachedTask {
+        try {
+            if constexpr (std::is_void_v<T>) {
+                co_await task;
+            } else {
+                result.emplace(co_await task);
+            }
+        } catch (...) {
+            exception = std::current_exception();
+        }
+        // Notified under the lock: the waiter may return and destroy all of this right after
+        std::lock_guard<std::mutex> lock(mutex);
+        done = true;
+        finished.notify_all();
+    };
+    run();
+
+    std::unique_lock<std::mutex> lock(mutex);
+    finished.wait(lock, [&] { return done; });
+    if (exception) {
+        std::rethrow_exception(exception);
+    }
+    if constexpr (!std::is_void_v<T>) {
+        return std::move(*result);
+    }
+}
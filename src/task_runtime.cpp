@@ -0,0 +1,168 @@
+#include "task_runtime.h"
+#include "error_handler.h"
+
+#include <atomic>
+#include <condition_variable>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <thread>
+
+// One thread sleeping until the earliest deadline. Callbacks run on it and
+// must be short; they get expired = false when the queue stops before the deadline
+class TimerQueue {
+public:
+    using Clock = std::chrono::steady_clock;
+    using Callback = std::function<void(bool expired)>;
+
+    TimerQueue() : thread(&TimerQueue::run, this) {
+    }
+
+    ~TimerQueue() {
+        stop();
+    }
+
+    void add(Clock::time_point deadline, Callback callback) {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (!stopping) {
+                timers.emplace(deadline, std::move(callback));
+                wakeCondition.notify_one();
+                return;
+            }
+        }
+        callback(false);
+    }
+
+    // Runs the pending callbacks with expired = false and joins the thread
+    void stop() {
+        std::multimap<Clock::time_point, Callback> pending;
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            if (stopping) {
+                return;
+            }
+            stopping = true;
+        }
+        wakeCondition.notify_one();
+        thread.join();
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            pending.swap(timers);
+        }
+        for (auto& [deadline, callback] : pending) {
+            callback(false);
+        }
+    }
+
+private:
+    void run() {
+        std::unique_lock<std::mutex> lock(mutex);
+        while (!stopping) {
+            if (timers.empty()) {
+                wakeCondition.wait(lock);
+                continue;
+            }
+            auto next = timers.begin();
+            if (next->first > Clock::now()) {
+                wakeCondition.wait_until(lock, next->first);
+                continue;
+            }
+            Callback callback = std::move(next->second);
+            timers.erase(next);
+            lock.unlock();
+            callback(true);
+            lock.lock();
+        }
+    }
+
+    std::mutex mutex;
+    std::condition_variable wakeCondition;
+    std::multimap<Clock::time_point, Callback> timers;
+    bool stopping = false;
+    std::thread thread;     // Last, started once the rest is initialized
+};
+
+// Shared by the awaiting coroutine, its timer and its cancellation callback.
+// The first of timer and cancellation decides the outcome; of that one and
+// await_suspend, whichever finishes second resumes the coroutine
+struct TaskRuntime::DelayState {
+    std::coroutine_handle<> handle;
+    ThreadPool* executor = nullptr;
+    std::atomic<bool> finished{false};
+    std::atomic<bool> handedOver{false};
+    bool cancelled = false;
+    CancellationRegistration registration;
+
+    void finish(bool expired) {
+        if (finished.exchange(true, std::memory_order_acq_rel)) {
+            return;
+        }
+        cancelled = !expired;
+        if (handedOver.exchange(true, std::memory_order_acq_rel)) {
+            executor->post(handle);
+        }
+    }
+};
+
+namespace {
+
+detail::DetachedTask runDetached(Task<void> task) {
+    try {
+        co_await task;
+    } catch (const TaskCancelled&) {
+    } catch (const std::exception& e) {
+        ErrorHandler::logWarning("Background task failed: " + std::string(e.what()));
+    }
+}
+
+} // namespace
+
+TaskRuntime::TaskRuntime(unsigned cpuThreads, unsigned ioThreads)
+    : cpuPool(cpuThreads), ioPool(ioThreads), timers(std::make_unique<TimerQueue>()) {
+}
+
+TaskRuntime::~TaskRuntime() {
+    timers->stop();
+    do {
+        cpuPool.waitIdle();
+        ioPool.waitIdle();
+    } while (uiExecutor.drain() > 0 || !cpuPool.isIdle() || !ioPool.isIdle());
+}
+
+void TaskRuntime::DelayAwaiter::await_suspend(std::coroutine_handle<> handle) {
+    state = std::make_shared<DelayState>();
+    state->handle = handle;
+    state->executor = &runtime.cpuPool;
+
+    std::shared_ptr<DelayState> shared = state;
+    state->registration = token.onCancel([shared] { shared->finish(false); });
+    runtime.timers->add(TimerQueue::Clock::now() + duration, [shared](bool expired) { shared->finish(expired); });
+
+    // If timer or cancellation came first, they left the resume to this side
+    if (state->handedOver.exchange(true, std::memory_order_acq_rel)) {
+        runtime.cpuPool.post(handle);
+    }
+}
+
+void TaskRuntime::DelayAwaiter::await_resume() {
+    if (!state) {
+        throw TaskCancelled();  // Cancelled before it started
+    }
+    state->registration.reset();
+    if (state->cancelled) {
+        throw TaskCancelled();
+    }
+}
+
+void TaskRuntime::cancelAfter(const CancellationSource& source, std::chrono::milliseconds duration) {
+    timers->add(TimerQueue::Clock::now() + duration, [target = source](bool expired) mutable {
+        if (expired) {
+            target.cancel();
+        }
+    });
+}
+
+void TaskRuntime::spawn(Task<void> task) {
+    runDetached(std::move(task));
+}
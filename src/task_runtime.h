@@ -0,0 +1,65 @@
+#pragma once
+
+#include <chrono>
+#include <coroutine>
+#include <memory>
+
+#include "cancellation.h"
+#include "task.h"
+#include "thread_pool.h"
+
+class TimerQueue;
+
+// Executors for launcher background work: a work-stealing pool for CPU work,
+// a second pool for blocking I/O (stat, file reads, network probes) with a
+// size limit of its own so slow disks cannot occupy the CPU workers, and the
+// UI executor the main loop drains once per frame. Timers give delays and
+// timeouts; cancellation is cooperative through CancellationToken.
+class TaskRuntime {
+public:
+    // cpuThreads 0 means one per hardware thread
+    explicit TaskRuntime(unsigned cpuThreads = 0, unsigned ioThreads = 8);
+
+    // Timers still pending are cancelled, then queued work (UI continuations
+    // included, on the calling thread) runs until all executors are idle
+    ~TaskRuntime();
+
+    TaskRuntime(const TaskRuntime&) = delete;
+    TaskRuntime& operator=(const TaskRuntime&) = delete;
+
+    ThreadPool& cpu() { return cpuPool; }
+    ThreadPool& io() { return ioPool; }
+    UiExecutor& ui() { return uiExecutor; }
+
+    // co_await runtime.delay(...) continues on the CPU pool after duration, or
+    // throws TaskCancelled as soon as token is cancelled
+    auto delay(std::chrono::milliseconds duration, CancellationToken token = {}) {
+        return DelayAwaiter{*this, duration, std::move(token), nullptr};
+    }
+
+    // Cancels source once duration has passed, a timeout for whatever watches its token
+    void cancelAfter(const CancellationSource& source, std::chrono::milliseconds duration);
+
+    // Starts task on the calling thread and lets it run to the end unobserved.
+    // Failures other than TaskCancelled are logged
+    void spawn(Task<void> task);
+
+private:
+    struct DelayState;
+
+    struct DelayAwaiter {
+        TaskRuntime& runtime;
+        std::chrono::milliseconds duration;
+        CancellationToken token;
+        std::shared_ptr<DelayState> state;
+
+        bool await_ready() const { return token.isCancelled(); }
+        void await_suspend(std::coroutine_handle<> handle);
+        void await_resume();
+    };
+
+    UiExecutor uiExecutor;
+    ThreadPool cpuPool;
+    ThreadPool ioPool;
+    std::unique_ptr<TimerQueue> timers;
+};
@@ -0,0 +1,159 @@
+#include "thread_pool.h"
+
+#include <algorithm>
+
+namespace {
+
+// The pool and worker index of the calling thread, if it is a worker
+thread_local ThreadPool* currentPool = nullptr;
+thread_local size_t currentWorker = 0;
+
+} // namespace
+
+ThreadPool::ThreadPool(unsigned threadCount) {
+    if (threadCount == 0) {
+        threadCount = std::max(1u, std::thread::hardware_concurrency());
+    }
+    for (unsigned i = 0; i < threadCount; ++i) {
+        workers.push_back(std::make_unique<Worker>());
+    }
+    for (unsigned i = 0; i < threadCount; ++i) {
+        threads.emplace_back(&ThreadPool::workerLoop, this, i);
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    wakeCondition.notify_all();
+    for (auto& thread : threads) {
+        thread.join();
+    }
+}
+
+void ThreadPool::post(std::coroutine_handle<> handle) {
+    outstanding.fetch_add(1, std::memory_order_relaxed);
+    if (currentPool == this) {
+        Worker& worker = *workers[currentWorker];
+        std::lock_guard<std::mutex> lock(worker.mutex);
+        worker.queue.push_back(handle);
+    } else {
+        std::lock_guard<std::mutex> lock(mutex);
+        shared.push_back(handle);
+    }
+
+    // Pairs with the sleeping count a worker raises before checking queued, so
+    // either the worker sees this entry or this sees the sleeping worker
+    queued.fetch_add(1, std::memory_order_seq_cst);
+    if (sleeping.load(std::memory_order_seq_cst) > 0) {
+        std::lock_guard<std::mutex> lock(mutex);
+        wakeCondition.notify_one();
+    }
+}
+
+void ThreadPool::waitIdle() {
+    std::unique_lock<std::mutex> lock(mutex);
+    idleCondition.wait(lock, [this] { return outstanding.load(std::memory_order_acquire) == 0; });
+}
+
+bool ThreadPool::take(size_t index, std::coroutine_handle<>& handle) {
+    {
+        Worker& own = *workers[index];
+        std::lock_guard<std::mutex> lock(own.mutex);
+        if (!own.queue.empty()) {
+            handle = own.queue.back();
+            own.queue.pop_back();
+            queued.fetch_sub(1, std::memory_order_relaxed);
+            return true;
+        }
+    }
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        if (!shared.empty()) {
+            handle = shared.front();
+            shared.pop_front();
+            queued.fetch_sub(1, std::memory_order_relaxed);
+            return true;
+        }
+    }
+    for (size_t offset = 1; offset < workers.size(); ++offset) {
+        Worker& victim = *workers[(index + offset) % workers.size()];
+        std::lock_guard<std::mutex> lock(victim.mutex);
+        if (!victim.queue.empty()) {
+            handle = victim.queue.front();
+            victim.queue.pop_front();
+            queued.fetch_sub(1, std::memory_order_relaxed);
+            stolen.fetch_add(1, std::memory_order_relaxed);
+            return true;
+        }
+    }
+    return false;
+}
+
+void ThreadPool::workerLoop(size_t index) {
+    currentPool = this;
+    currentWorker = index;
+
+    while (true) {
+        std::coroutine_handle<> handle;
+        if (take(index, handle)) {
+            handle.resume();
+            if (outstanding.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+                std::lock_guard<std::mutex> lock(mutex);
+                idleCondition.notify_all();
+            }
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(mutex);
+        sleeping.fetch_add(1, std::memory_order_seq_cst);
+        wakeCondition.wait(lock, [this] { return stopping || queued.load(std::memory_order_seq_cst) > 0; });
+        sleeping.fetch_sub(1, std::memory_order_relaxed);
+        if (stopping && queued.load(std::memory_order_seq_cst) == 0) {
+            return;
+        }
+    }
+}
+
+UiExecutor::~UiExecutor() {
+    while (drain() > 0) {
+    }
+}
+
+void UiExecutor::setWakeFunction(std::function<void()> wake) {
+    std::lock_guard<std::mutex> lock(mutex);
+    wakeFunction = std::move(wake);
+}
+
+void UiExecutor::post(std::coroutine_handle<> handle) {
+    std::function<void()> wake;
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        queue.push_back(handle);
+        wake = wakeFunction;
+    }
+    if (wake) {
+        wake();
+    }
+}
+
+size_t UiExecutor::drain() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        running.swap(queue);
+    }
+    // Both vectors keep their capacity, so steady draining does not allocate
+    size_t count = running.size();
+    for (std::coroutine_handle<> handle : running) {
+        handle.resume();
+    }
+    running.clear();
+    return count;
+}
+
+size_t UiExecutor::pending() const {
+    std::lock_guard<std::mutex> lock(mutex);
+    return queue.size();
+}
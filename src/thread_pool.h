@@ -0,0 +1,104 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <coroutine>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Somewhere to resume coroutines
+class Executor {
+public:
+    virtual ~Executor() = default;
+
+    // Resumes handle on one of the executor's threads
+    virtual void post(std::coroutine_handle<> handle) = 0;
+
+    // co_await executor.schedule() continues the awaiting coroutine there
+    auto schedule() {
+        struct Awaiter {
+            Executor& executor;
+            bool await_ready() const noexcept { return false; }
+            void await_suspend(std::coroutine_handle<> handle) { executor.post(handle); }
+            void await_resume() const noexcept {}
+        };
+        return Awaiter{*this};
+    }
+};
+
+// Fixed set of worker threads, each with a deque of its own. Work posted from
+// a worker goes to its deque and is taken newest first, keeping a coroutine
+// chain on one warm core; idle workers steal the oldest entries from the
+// others. Posts from other threads go to a shared queue.
+class ThreadPool : public Executor {
+public:
+    // 0 threads means one per hardware thread
+    explicit ThreadPool(unsigned threadCount = 0);
+
+    // Runs everything queued, including work it posts, then joins the workers
+    ~ThreadPool() override;
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    void post(std::coroutine_handle<> handle) override;
+
+    // Blocks until nothing is queued or running
+    void waitIdle();
+    bool isIdle() const { return outstanding.load(std::memory_order_acquire) == 0; }
+
+    unsigned getThreadCount() const { return static_cast<unsigned>(threads.size()); }
+    // Entries taken from another worker's deque so far
+    uint64_t getStolenCount() const { return stolen.load(std::memory_order_relaxed); }
+
+private:
+    struct Worker {
+        std::mutex mutex;
+        std::deque<std::coroutine_handle<>> queue;
+    };
+
+    void workerLoop(size_t index);
+    bool take(size_t index, std::coroutine_handle<>& handle);
+
+    std::vector<std::unique_ptr<Worker>> workers;
+    std::vector<std::thread> threads;
+
+    std::mutex mutex;                       // Shared queue, sleeping and idle waits
+    std::condition_variable wakeCondition;
+    std::condition_variable idleCondition;
+    std::deque<std::coroutine_handle<>> shared;
+    std::atomic<size_t> queued{0};          // Posted and not taken yet
+    std::atomic<size_t> outstanding{0};     // Posted and not finished yet
+    std::atomic<size_t> sleeping{0};
+    std::atomic<uint64_t> stolen{0};
+    bool stopping = false;
+};
+
+// Continuations that must run on the UI thread. The main loop calls drain()
+// once per frame; the wake function lets a post interrupt a blocking event wait
+class UiExecutor : public Executor {
+public:
+    // Runs whatever is still queued
+    ~UiExecutor() override;
+
+    void setWakeFunction(std::function<void()> wake);
+
+    void post(std::coroutine_handle<> handle) override;
+
+    // Resumes everything queued before the call, returns how many. Work posted
+    // while draining waits for the next call, so a frame cannot be starved
+    size_t drain();
+    size_t pending() const;
+
+private:
+    mutable std::mutex mutex;
+    std::vector<std::coroutine_handle<>> queue;
+    std::vector<std::coroutine_handle<>> running;
+    std::function<void()> wakeFunction;
+};
@@ -0,0 +1,304 @@
+#include "ui_harness.h"
+#include "allocation_stats.h"
+#include "main_window.h"
+#include "imgui.h"
+#include "imgui_internal.h"
+
+#include <algorithm>
+#include <charconv>
+#include <fstream>
+#include <iterator>
+#include <sstream>
+#include <utility>
+
+#ifdef _WIN32
+#include <Windows.h>
+#else
+#include <time.h>
+#endif
+
+namespace {
+
+int64_t threadCpuNs() {
+#ifdef _WIN32
+    FILETIME creationTime, exitTime, kernelTime, userTime;
+    if (!GetThreadTimes(GetCurrentThread(), &creationTime, &exitTime, &kernelTime, &userTime)) {
+        return 0;
+    }
+    auto to100ns = [](const FILETIME& time) {
+        return (static_cast<int64_t>(time.dwHighDateTime) << 32) | time.dwLowDateTime;
+    };
+    return (to100ns(kernelTime) + to100ns(userTime)) * 100;
+#else
+    timespec time = {};
+    clock_gettime(CLOCK_THREAD_CPUTIME_ID, &time);
+    return static_cast<int64_t>(time.tv_sec) * 1000000000 + time.tv_nsec;
+#endif
+}
+
+struct KeyName {
+    const char* name;
+    ImGuiKey key;
+};
+
+const KeyName keyNames[] = {
+    {"Enter", ImGuiKey_Enter}, {"Escape", ImGuiKey_Escape}, {"Tab", ImGuiKey_Tab},
+    {"Backspace", ImGuiKey_Backspace}, {"Delete", ImGuiKey_Delete}, {"Space", ImGuiKey_Space},
+    {"Up", ImGuiKey_UpArrow}, {"Down", ImGuiKey_DownArrow}, {"Left", ImGuiKey_LeftArrow}, {"Right", ImGuiKey_RightArrow},
+    {"Home", ImGuiKey_Home}, {"End", ImGuiKey_End}, {"PageUp", ImGuiKey_PageUp}, {"PageDown", ImGuiKey_PageDown},
+};
+
+// "Shift+Enter", "Ctrl+A", "F"; a single letter or digit is that key
+bool parseKey(std::string_view text, int& key, int& modifiers) {
+    modifiers = 0;
+    while (true) {
+        if (text.substr(0, 6) == "Shift+") {
+            modifiers |= ImGuiMod_Shift;
+            text.remove_prefix(6);
+        } else if (text.substr(0, 5) == "Ctrl+") {
+            modifiers |= ImGuiMod_Ctrl;
+            text.remove_prefix(5);
+        } else {
+            break;
+        }
+    }
+    if (text.size() == 1 && text[0] >= 'A' && text[0] <= 'Z') {
+        key = ImGuiKey_A + (text[0] - 'A');
+        return true;
+    }
+    if (text.size() == 1 && text[0] >= '0' && text[0] <= '9') {
+        key = ImGuiKey_0 + (text[0] - '0');
+        return true;
+    }
+    for (const KeyName& keyName : keyNames) {
+        if (text == keyName.name) {
+            key = keyName.key;
+            return true;
+        }
+    }
+    return false;
+}
+
+// Splits "word rest of line" at the first space
+std::pair<std::string_view, std::string_view> splitWord(std::string_view line) {
+    size_t space = line.find(' ');
+    if (space == std::string_view::npos) {
+        return {line, {}};
+    }
+    return {line.substr(0, space), line.substr(space + 1)};
+}
+
+void addModifierEvents(ImGuiIO& io, int modifiers, bool down) {
+    if (modifiers & ImGuiMod_Shift) io.AddKeyEvent(ImGuiMod_Shift, down);
+    if (modifiers & ImGuiMod_Ctrl) io.AddKeyEvent(ImGuiMod_Ctrl, down);
+}
+
+} // namespace
+
+std::optional<InputScript> InputScript::parse(std::string_view text, std::string* error) {
+    InputScript script;
+    int lineNumber = 0;
+    auto fail = [&](const std::string& reason) {
+        if (error) *error = "line " + std::to_string(lineNumber) + ": " + reason;
+        return std::nullopt;
+    };
+
+    while (!text.empty()) {
+        size_t end = text.find('\n');
+        std::string_view line = text.substr(0, end);
+        text.remove_prefix(end == std::string_view::npos ? text.size() : end + 1);
+        lineNumber++;
+        if (!line.empty() && line.back() == '\r') line.remove_suffix(1);
+        if (line.empty() || line[0] == '#') continue;
+
+        InputStep step;
+        step.line = lineNumber;
+        auto [command, argument] = splitWord(line);
+        if (command == "type") {
+            step.action = InputStep::Action::Type;
+            step.text = argument;
+        } else if (command == "key") {
+            step.action = InputStep::Action::Key;
+            if (!parseKey(argument, step.key, step.modifiers)) {
+                return fail("unknown key '" + std::string(argument) + "'");
+            }
+        } else if (command == "frames") {
+            step.action = InputStep::Action::Frames;
+            auto [ptr, ec] = std::from_chars(argument.data(), argument.data() + argument.size(), step.frames);
+            if (ec != std::errc() || ptr != argument.data() + argument.size() || step.frames < 0) {
+                return fail("bad frame count '" + std::string(argument) + "'");
+            }
+        } else if (command == "expect") {
+            step.action = InputStep::Action::Expect;
+            auto [what, value] = splitWord(argument);
+            step.text = value;
+            if (what == "input") {
+                step.check = InputStep::Check::Input;
+            } else if (what == "launch") {
+                step.check = InputStep::Check::Launch;
+            } else if (what == "config") {
+                step.check = InputStep::Check::Config;
+            } else if (what == "launches") {
+                step.check = InputStep::Check::Launches;
+            } else if (what == "selected") {
+                step.check = InputStep::Check::Selected;
+            } else if (what == "error" && (value == "yes" || value == "no")) {
+                step.check = InputStep::Check::Error;
+            } else {
+                return fail("unknown expectation '" + std::string(argument) + "'");
+            }
+        } else {
+            return fail("unknown step '" + std::string(command) + "'");
+        }
+        script.steps.push_back(std::move(step));
+    }
+    return script;
+}
+
+std::optional<InputScript> InputScript::load(const std::string& path, std::string* error) {
+    std::ifstream file(path, std::ios::binary);
+    if (!file) {
+        if (error) *error = "cannot open " + path;
+        return std::nullopt;
+    }
+    std::string text((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    return parse(text, error);
+}
+
+int64_t UiHarness::ReplayResult::totalCpuNs() const {
+    int64_t total = 0;
+    for (int64_t ns : frameCpuNs) total += ns;
+    return total;
+}
+
+int64_t UiHarness::ReplayResult::percentileCpuNs(double p) const {
+    if (frameCpuNs.empty()) {
+        return 0;
+    }
+    std::vector<int64_t> sorted = frameCpuNs;
+    size_t index = std::min(sorted.size() - 1, static_cast<size_t>(p * (sorted.size() - 1) + 0.5));
+    std::nth_element(sorted.begin(), sorted.begin() + index, sorted.end());
+    return sorted[index];
+}
+
+UiHarness::UiHarness(float width, float height) {
+    window = std::make_unique<MainWindow>(history, [this](const std::string& input, bool isConfigMode) {
+        if (input.find_first_not_of(" \t") == std::string::npos) {
+            return false;
+        }
+        launches.push_back({input, isConfigMode});
+        return true;
+    });
+
+    ImGui::SetAllocatorFunctions(AllocationStats::imguiAlloc, AllocationStats::imguiFree);
+    context = ImGui::CreateContext();
+    ImGui::SetCurrentContext(context);
+    ImGuiIO& io = ImGui::GetIO();
+    io.IniFilename = nullptr;
+    io.LogFilename = nullptr;
+    io.DisplaySize = ImVec2(width, height);
+    io.DeltaTime = 1.0f / 60.0f;
+    io.ConfigFlags |= ImGuiConfigFlags_NavEnableKeyboard;   // As main() sets it up
+
+    // The atlas has to exist for NewFrame(); without a renderer it is only kept in memory
+    unsigned char* pixels = nullptr;
+    int atlasWidth = 0;
+    int atlasHeight = 0;
+    io.Fonts->GetTexDataAsRGBA32(&pixels, &atlasWidth, &atlasHeight);
+}
+
+UiHarness::~UiHarness() {
+    ImGui::DestroyContext(context);
+}
+
+void UiHarness::fillHistory(size_t count) {
+    std::vector<HistoryImport> imports;
+    imports.reserve(count);
+    for (size_t i = 0; i < count; ++i) {
+        imports.push_back({"File=\"C:\\Bases\\Base" + std::to_string(i) + "\";", "Base " + std::to_string(i)});
+    }
+    history.importEntries(imports);
+    window->historyChanged();
+}
+
+int64_t UiHarness::frame() {
+    ImGui::SetCurrentContext(context);
+    int64_t start = threadCpuNs();
+    ImGui::NewFrame();
+    window->draw();
+    ImGui::Render();
+    return threadCpuNs() - start;
+}
+
+void UiHarness::settle(ReplayResult& result) {
+    // Trickled events (key down and up, characters after keys) take a frame each
+    result.frameCpuNs.push_back(frame());
+    for (int i = 0; i < 64 && !context->InputEventsQueue.empty(); ++i) {
+        result.frameCpuNs.push_back(frame());
+    }
+}
+
+UiHarness::ReplayResult UiHarness::replay(const InputScript& script) {
+    ReplayResult result;
+    ImGui::SetCurrentContext(context);
+    ImGuiIO& io = ImGui::GetIO();
+
+    for (const InputStep& step : script.getSteps()) {
+        switch (step.action) {
+            case InputStep::Action::Type:
+                io.AddInputCharactersUTF8(step.text.c_str());
+                settle(result);
+                break;
+            case InputStep::Action::Key:
+                addModifierEvents(io, step.modifiers, true);
+                io.AddKeyEvent(static_cast<ImGuiKey>(step.key), true);
+                settle(result);
+                io.AddKeyEvent(static_cast<ImGuiKey>(step.key), false);
+                addModifierEvents(io, step.modifiers, false);
+                settle(result);
+                break;
+            case InputStep::Action::Frames:
+                for (int i = 0; i < step.frames; ++i) {
+                    result.frameCpuNs.push_back(frame());
+                }
+                break;
+            case InputStep::Action::Expect:
+                check(step, result);
+                break;
+        }
+    }
+    return result;
+}
+
+void UiHarness::check(const InputStep& step, ReplayResult& result) const {
+    std::string actual;
+    switch (step.check) {
+        case InputStep::Check::Input:
+            actual = window->getInput();
+            break;
+        case InputStep::Check::Launch:
+        case InputStep::Check::Config:
+            if (launches.empty()) {
+                actual = "(no launch)";
+            } else if (launches.back().isConfigMode != (step.check == InputStep::Check::Config)) {
+                actual = (launches.back().isConfigMode ? "config " : "launch ") + launches.back().input;
+            } else {
+                actual = launches.back().input;
+            }
+            break;
+        case InputStep::Check::Launches:
+            actual = std::to_string(launches.size());
+            break;
+        case InputStep::Check::Selected:
+            actual = window->getSelectedEntry() ? window->getSelectedEntry()->input : "";
+            break;
+        case InputStep::Check::Error:
+            actual = window->hasInputError() ? "yes" : "no";
+            break;
+    }
+    if (actual != step.text) {
+        std::ostringstream failure;
+        failure << "line " << step.line << ": expected '" << step.text << "', got '" << actual << "'";
+        result.failures.push_back(failure.str());
+    }
+}
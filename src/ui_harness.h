@@ -0,0 +1,101 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "history.h"
+
+class MainWindow;
+struct ImGuiContext;
+
+// Recorded input for the main window, one step per line:
+//
+//   # comment
+//   type File="C:\Bases\Trade";     characters into the focused widget
+//   key Down                        press and release: Enter, Shift+Enter, Up, F, ...
+//   frames 5                        idle frames
+//   expect input File="C:\Bases\Trade";
+//   expect launch <input>           last launch, Enterprise mode
+//   expect config <input>           last launch, Configurator
+//   expect launches 2
+//   expect selected <input>         selected history entry, nothing after it for none
+//   expect error yes|no             "Wrong input" shown
+struct InputStep {
+    enum class Action { Type, Key, Frames, Expect };
+    enum class Check { Input, Launch, Config, Launches, Selected, Error };
+
+    Action action = Action::Frames;
+    Check check = Check::Input;
+    int key = 0;            // ImGuiKey
+    int modifiers = 0;      // ImGuiMod_ flags held with the key
+    int frames = 0;
+    std::string text;       // Typed characters or the expected value
+    int line = 0;
+};
+
+class InputScript {
+public:
+    // Returns std::nullopt with the line and reason in error on a malformed script
+    static std::optional<InputScript> parse(std::string_view text, std::string* error = nullptr);
+    static std::optional<InputScript> load(const std::string& path, std::string* error = nullptr);
+
+    const std::vector<InputStep>& getSteps() const { return steps; }
+
+private:
+    std::vector<InputStep> steps;
+};
+
+// MainWindow on an ImGui context of its own, with no platform or renderer
+// backend: frames are built and rendered to draw lists that nobody draws.
+// Launches are recorded instead of started, everything but empty input is
+// accepted. Runs without a display or GPU, frame for frame the same each time
+class UiHarness {
+public:
+    struct Launch {
+        std::string input;
+        bool isConfigMode = false;
+    };
+
+    struct ReplayResult {
+        std::vector<int64_t> frameCpuNs;    // Thread CPU time of each frame, in scheduler ticks on Windows
+        std::vector<std::string> failures;  // "line N: ..." for every unmet expectation
+
+        int64_t totalCpuNs() const;
+        // p in [0, 1], e.g. 0.99
+        int64_t percentileCpuNs(double p) const;
+    };
+
+    explicit UiHarness(float width = 1280.0f, float height = 720.0f);
+    ~UiHarness();
+
+    UiHarness(const UiHarness&) = delete;
+    UiHarness& operator=(const UiHarness&) = delete;
+
+    // Adds count never-launched bases, File="C:\Bases\Base<i>"; named "Base <i>",
+    // with Base0 at the top of the list whatever the count
+    void fillHistory(size_t count);
+
+    History& getHistory() { return history; }
+    MainWindow& getWindow() { return *window; }
+    const std::vector<Launch>& getLaunches() const { return launches; }
+
+    // One frame without new input, returns its thread CPU time
+    int64_t frame();
+
+    ReplayResult replay(const InputScript& script);
+
+private:
+    // Runs frames until ImGui has consumed the queued input events
+    void settle(ReplayResult& result);
+    void check(const InputStep& step, ReplayResult& result) const;
+
+    History history;
+    std::vector<Launch> launches;
+    std::unique_ptr<MainWindow> window;
+    ImGuiContext* context = nullptr;
+};
@@ -0,0 +1,301 @@
+#include "utf_transcode.h"
+#include <bit>
+#include <cstring>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define RUN1C_TRANSCODE_SSE2
+#include <emmintrin.h>
+#endif
+
+namespace {
+
+const char16_t replacementCharacter = 0xFFFD;
+
+bool isContinuation(unsigned char byte) {
+    return (byte & 0xC0) == 0x80;
+}
+
+// Decodes the code point at input[i]. Returns its length in bytes, 0 if invalid
+inline size_t decodeUtf8(std::string_view input, size_t i, char32_t& codePoint) {
+    const unsigned char* bytes = reinterpret_cast<const unsigned char*>(input.data()) + i;
+    size_t available = input.size() - i;
+    unsigned char lead = bytes[0];
+
+    if (lead < 0x80) {
+        codePoint = lead;
+        return 1;
+    }
+    if (lead >= 0xC2 && lead <= 0xDF) {
+        if (available < 2 || !isContinuation(bytes[1])) {
+            return 0;
+        }
+        codePoint = (char32_t(lead & 0x1F) << 6) | (bytes[1] & 0x3F);
+        return 2;
+    }
+    if (lead >= 0xE0 && lead <= 0xEF) {
+        // E0 excludes overlong forms, ED excludes UTF-16 surrogates
+        unsigned char low = lead == 0xE0 ? 0xA0 : 0x80;
+        unsigned char high = lead == 0xED ? 0x9F : 0xBF;
+        if (available < 3 || bytes[1] < low || bytes[1] > high || !isContinuation(bytes[2])) {
+            return 0;
+        }
+        codePoint = (char32_t(lead & 0x0F) << 12) | (char32_t(bytes[1] & 0x3F) << 6) | (bytes[2] & 0x3F);
+        return 3;
+    }
+    if (lead >= 0xF0 && lead <= 0xF4) {
+        // F0 excludes overlong forms, F4 code points above U+10FFFF
+        unsigned char low = lead == 0xF0 ? 0x90 : 0x80;
+        unsigned char high = lead == 0xF4 ? 0x8F : 0xBF;
+        if (available < 4 || bytes[1] < low || bytes[1] > high || !isContinuation(bytes[2]) || !isContinuation(bytes[3])) {
+            return 0;
+        }
+        codePoint = (char32_t(lead & 0x07) << 18) | (char32_t(bytes[1] & 0x3F) << 12) | (char32_t(bytes[2] & 0x3F) << 6) | (bytes[3] & 0x3F);
+        return 4;
+    }
+    return 0;
+}
+
+// Converts one code point, the scalar path of utf8ToUtf16. False stops the conversion
+inline bool utf8ToUtf16Step(std::string_view input, char16_t* output, size_t capacity, TranscodeResult& result) {
+    char32_t codePoint = 0;
+    size_t length = decodeUtf8(input, result.read, codePoint);
+    if (length == 0) {
+        result.status = TranscodeStatus::InvalidInput;
+        return false;
+    }
+    size_t units = codePoint >= 0x10000 ? 2 : 1;
+    if (capacity - result.written < units) {
+        result.status = TranscodeStatus::BufferTooSmall;
+        return false;
+    }
+    if (units == 1) {
+        output[result.written] = static_cast<char16_t>(codePoint);
+    } else {
+        codePoint -= 0x10000;
+        output[result.written] = static_cast<char16_t>(0xD800 + (codePoint >> 10));
+        output[result.written + 1] = static_cast<char16_t>(0xDC00 + (codePoint & 0x3FF));
+    }
+    result.read += length;
+    result.written += units;
+    return true;
+}
+
+// Converts one code point, the scalar path of utf16ToUtf8. False stops the conversion
+inline bool utf16ToUtf8Step(std::u16string_view input, char* output, size_t capacity, TranscodeResult& result) {
+    char32_t codePoint = input[result.read];
+    size_t length = 1;
+    if (codePoint >= 0xD800 && codePoint <= 0xDFFF) {
+        char32_t low = result.read + 1 < input.size() ? input[result.read + 1] : 0;
+        if (codePoint > 0xDBFF || low < 0xDC00 || low > 0xDFFF) {
+            result.status = TranscodeStatus::InvalidInput;
+            return false;
+        }
+        codePoint = 0x10000 + ((codePoint - 0xD800) << 10) + (low - 0xDC00);
+        length = 2;
+    }
+
+    size_t bytes = codePoint < 0x80 ? 1 : codePoint < 0x800 ? 2 : codePoint < 0x10000 ? 3 : 4;
+    if (capacity - result.written < bytes) {
+        result.status = TranscodeStatus::BufferTooSmall;
+        return false;
+    }
+    char* out = output + result.written;
+    switch (bytes) {
+    case 1:
+        out[0] = static_cast<char>(codePoint);
+        break;
+    case 2:
+        out[0] = static_cast<char>(0xC0 | (codePoint >> 6));
+        out[1] = static_cast<char>(0x80 | (codePoint & 0x3F));
+        break;
+    case 3:
+        out[0] = static_cast<char>(0xE0 | (codePoint >> 12));
+        out[1] = static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F));
+        out[2] = static_cast<char>(0x80 | (codePoint & 0x3F));
+        break;
+    default:
+        out[0] = static_cast<char>(0xF0 | (codePoint >> 18));
+        out[1] = static_cast<char>(0x80 | ((codePoint >> 12) & 0x3F));
+        out[2] = static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F));
+        out[3] = static_cast<char>(0x80 | (codePoint & 0x3F));
+        break;
+    }
+    result.read += length;
+    result.written += bytes;
+    return true;
+}
+
+#ifdef RUN1C_TRANSCODE_SSE2
+
+// 16 input bytes per block. Returns the number of bytes converted: 16 for
+// ASCII or eight two-byte sequences, otherwise the ASCII prefix (may be 0)
+size_t utf8ToUtf16Block(const char* input, char16_t* output, size_t& written) {
+    __m128i bytes = _mm_loadu_si128(reinterpret_cast<const __m128i*>(input));
+    int nonAscii = _mm_movemask_epi8(bytes);
+    __m128i zero = _mm_setzero_si128();
+    if (nonAscii == 0) {
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(output), _mm_unpacklo_epi8(bytes, zero));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(output + 8), _mm_unpackhi_epi8(bytes, zero));
+        written = 16;
+        return 16;
+    }
+
+    // As little-endian 16-bit lanes each two-byte sequence is 10xxxxxx'110yyyyy,
+    // with yyyyy above 00001 (C0 and C1 would be overlong)
+    __m128i shape = _mm_cmpeq_epi16(_mm_and_si128(bytes, _mm_set1_epi16(static_cast<short>(0xC0E0))), _mm_set1_epi16(static_cast<short>(0x80C0)));
+    __m128i overlong = _mm_cmpeq_epi16(_mm_and_si128(bytes, _mm_set1_epi16(0x001E)), zero);
+    if (_mm_movemask_epi8(shape) == 0xFFFF && _mm_movemask_epi8(overlong) == 0) {
+        __m128i high = _mm_slli_epi16(_mm_and_si128(bytes, _mm_set1_epi16(0x001F)), 6);
+        __m128i low = _mm_and_si128(_mm_srli_epi16(bytes, 8), _mm_set1_epi16(0x003F));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(output), _mm_or_si128(high, low));
+        written = 8;
+        return 16;
+    }
+
+    // Leading ASCII bytes, the rest of the stored lanes is overwritten later
+    size_t ascii = static_cast<size_t>(std::countr_zero(static_cast<unsigned>(nonAscii)));
+    if (ascii != 0) {
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(output), _mm_unpacklo_epi8(bytes, zero));
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(output + 8), _mm_unpackhi_epi8(bytes, zero));
+    }
+    written = ascii;
+    return ascii;
+}
+
+// 8 input units per block, converted if all are ASCII or all need two bytes,
+// otherwise the ASCII prefix (may be 0). Returns the number of units converted
+size_t utf16ToUtf8Block(const char16_t* input, char* output, size_t& written) {
+    __m128i units = _mm_loadu_si128(reinterpret_cast<const __m128i*>(input));
+    __m128i zero = _mm_setzero_si128();
+    int ascii = _mm_movemask_epi8(_mm_cmpeq_epi16(_mm_and_si128(units, _mm_set1_epi16(static_cast<short>(0xFF80))), zero));
+    if (ascii == 0xFFFF) {
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(output), _mm_packus_epi16(units, units));
+        written = 8;
+        return 8;
+    }
+
+    int belowU800 = _mm_movemask_epi8(_mm_cmpeq_epi16(_mm_and_si128(units, _mm_set1_epi16(static_cast<short>(0xF800))), zero));
+    if (belowU800 == 0xFFFF && ascii == 0) {
+        // 110yyyyy then 10xxxxxx, stored as one little-endian 16-bit lane per unit
+        __m128i lead = _mm_or_si128(_mm_srli_epi16(units, 6), _mm_set1_epi16(0x00C0));
+        __m128i trail = _mm_slli_epi16(_mm_or_si128(_mm_and_si128(units, _mm_set1_epi16(0x003F)), _mm_set1_epi16(0x0080)), 8);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(output), _mm_or_si128(lead, trail));
+        written = 16;
+        return 8;
+    }
+
+    size_t prefix = static_cast<size_t>(std::countr_one(static_cast<unsigned>(ascii))) / 2;
+    if (prefix != 0) {
+        _mm_storel_epi64(reinterpret_cast<__m128i*>(output), _mm_packus_epi16(units, units));
+    }
+    written = prefix;
+    return prefix;
+}
+
+#endif
+
+} // namespace
+
+TranscodeResult utf8ToUtf16Scalar(std::string_view input, char16_t* output, size_t capacity) {
+    TranscodeResult result;
+    while (result.read < input.size() && utf8ToUtf16Step(input, output, capacity, result)) {
+    }
+    return result;
+}
+
+TranscodeResult utf16ToUtf8Scalar(std::u16string_view input, char* output, size_t capacity) {
+    TranscodeResult result;
+    while (result.read < input.size() && utf16ToUtf8Step(input, output, capacity, result)) {
+    }
+    return result;
+}
+
+TranscodeResult utf8ToUtf16(std::string_view input, char16_t* output, size_t capacity) {
+    TranscodeResult result;
+    size_t nextBlock = 0;   // After a mixed block the rest of it is converted one code point at a time
+    while (result.read < input.size()) {
+#ifdef RUN1C_TRANSCODE_SSE2
+        if (result.read >= nextBlock && input.size() - result.read >= 16 && capacity - result.written >= 16) {
+            size_t written = 0;
+            size_t read = utf8ToUtf16Block(input.data() + result.read, output + result.written, written);
+            nextBlock = result.read + 16;
+            result.read += read;
+            result.written += written;
+            if (read == 16) {
+                continue;
+            }
+        }
+#endif
+        if (!utf8ToUtf16Step(input, output, capacity, result)) {
+            break;
+        }
+    }
+    return result;
+}
+
+TranscodeResult utf16ToUtf8(std::u16string_view input, char* output, size_t capacity) {
+    TranscodeResult result;
+    size_t nextBlock = 0;
+    while (result.read < input.size()) {
+#ifdef RUN1C_TRANSCODE_SSE2
+        if (result.read >= nextBlock && input.size() - result.read >= 8 && capacity - result.written >= 16) {
+            size_t written = 0;
+            size_t read = utf16ToUtf8Block(input.data() + result.read, output + result.written, written);
+            nextBlock = result.read + 8;
+            result.read += read;
+            result.written += written;
+            if (read == 8) {
+                continue;
+            }
+        }
+#endif
+        if (!utf16ToUtf8Step(input, output, capacity, result)) {
+            break;
+        }
+    }
+    return result;
+}
+
+size_t utf8ToUtf16Replacing(std::string_view input, char16_t* output, size_t capacity) {
+    size_t written = 0;
+    while (!input.empty()) {
+        TranscodeResult result = utf8ToUtf16(input, output + written, capacity - written);
+        written += result.written;
+        if (result.status != TranscodeStatus::InvalidInput) {
+            break;
+        }
+        // One replacement per invalid byte keeps the output within utf16Capacity
+        output[written++] = replacementCharacter;
+        input.remove_prefix(result.read + 1);
+    }
+    return written;
+}
+
+size_t utf8SequenceLength(std::string_view input, size_t offset) {
+    char32_t codePoint = 0;
+    return decodeUtf8(input, offset, codePoint);
+}
+
+std::u16string toUtf16(std::string_view input) {
+    std::u16string result(utf16Capacity(input.size()), u'\0');
+    result.resize(utf8ToUtf16Replacing(input, result.data(), result.size()));
+    return result;
+}
+
+std::string toUtf8(std::u16string_view input) {
+    std::string result(utf8Capacity(input.size()), '\0');
+    size_t written = 0;
+    while (!input.empty()) {
+        TranscodeResult converted = utf16ToUtf8(input, result.data() + written, result.size() - written);
+        written += converted.written;
+        if (converted.status != TranscodeStatus::InvalidInput) {
+            break;
+        }
+        // An unpaired surrogate is one unit, its replacement three bytes
+        std::memcpy(result.data() + written, "\xEF\xBF\xBD", 3);
+        written += 3;
+        input.remove_prefix(converted.read + 1);
+    }
+    result.resize(written);
+    return result;
+}
@@ -0,0 +1,87 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <string>
+#include <string_view>
+
+// Validated UTF-8 <-> UTF-16 conversion into caller-provided buffers, with
+// SSE2 fast paths for ASCII and two-byte (Cyrillic) runs. Invalid input is
+// reported, never passed through: overlong forms, surrogates encoded in
+// UTF-8, code points above U+10FFFF, truncated sequences and unpaired
+// UTF-16 surrogates
+
+enum class TranscodeStatus {
+    Ok,
+    InvalidInput,       // read is the offset of the offending sequence
+    BufferTooSmall      // read is where conversion stopped, output is valid up to written
+};
+
+struct TranscodeResult {
+    TranscodeStatus status = TranscodeStatus::Ok;
+    size_t read = 0;        // Input code units consumed
+    size_t written = 0;     // Output code units written
+
+    bool ok() const { return status == TranscodeStatus::Ok; }
+};
+
+// Output sizes that always suffice: UTF-16 never needs more units than the
+// UTF-8 has bytes, UTF-8 needs at most three bytes per UTF-16 unit
+constexpr size_t utf16Capacity(size_t utf8Length) { return utf8Length; }
+constexpr size_t utf8Capacity(size_t utf16Length) { return utf16Length * 3; }
+
+TranscodeResult utf8ToUtf16(std::string_view input, char16_t* output, size_t capacity);
+TranscodeResult utf16ToUtf8(std::u16string_view input, char* output, size_t capacity);
+
+// One code point at a time, the reference the fast paths are tested against
+TranscodeResult utf8ToUtf16Scalar(std::string_view input, char16_t* output, size_t capacity);
+TranscodeResult utf16ToUtf8Scalar(std::u16string_view input, char* output, size_t capacity);
+
+// Invalid bytes become U+FFFD, as in MultiByteToWideChar; capacity must be at
+// least utf16Capacity(input.size()). Returns the number of units written
+size_t utf8ToUtf16Replacing(std::string_view input, char16_t* output, size_t capacity);
+
+// Length in bytes of the valid UTF-8 sequence at input[offset], 0 if it is invalid
+size_t utf8SequenceLength(std::string_view input, size_t offset);
+
+// Allocating versions, replacing invalid sequences with U+FFFD
+std::u16string toUtf16(std::string_view input);
+std::string toUtf8(std::u16string_view input);
+
+// Null-terminated UTF-16 copy of a UTF-8 string for wide Windows APIs.
+// Kept on the stack up to N units (MAX_PATH by default), longer strings
+// go to the heap
+template <size_t N = 260>
+class Utf16Buffer {
+public:
+    explicit Utf16Buffer(std::string_view utf8) {
+        size_t capacity = utf16Capacity(utf8.size()) + 1;
+        char16_t* buffer = local;
+        if (capacity > N) {
+            heap = std::make_unique<char16_t[]>(capacity);
+            buffer = heap.get();
+        }
+        length = utf8ToUtf16Replacing(utf8, buffer, capacity - 1);
+        buffer[length] = u'\0';
+        text = buffer;
+    }
+
+    Utf16Buffer(const Utf16Buffer&) = delete;
+    Utf16Buffer& operator=(const Utf16Buffer&) = delete;
+
+    char16_t* data() { return text; }
+    const char16_t* data() const { return text; }
+    size_t size() const { return length; }
+    bool empty() const { return length == 0; }
+
+#ifdef _WIN32
+    wchar_t* wide() { return reinterpret_cast<wchar_t*>(text); }
+    const wchar_t* wide() const { return reinterpret_cast<const wchar_t*>(text); }
+#endif
+
+private:
+    char16_t local[N];
+    std::unique_ptr<char16_t[]> heap;
+    char16_t* text = nullptr;
+    size_t length = 0;
+};
@@ -1,10 +1,17 @@
 #include "utils.h"
+#include "regex_cache.h"
+#include "utf_transcode.h"
+#include <algorithm>
+#include <bit>
+#include <cstdlib>
 #include <filesystem>
 #include <iostream>
 #include <regex>
 #include <fstream>
+#include <stdexcept>
 
 std::string getEnvironmentVariable(const std::string& varName) {
+#ifdef _WIN32
     // Determine the size of the buffer required
     DWORD bufferSize = GetEnvironmentVariableA(varName.c_str(), nullptr, 0);
     if (bufferSize == 0) {
@@ -22,125 +29,152 @@ std::string getEnvironmentVariable(const std::string& varName) {
 
     // Convert the buffer to a std::string and return it
     return std::string(buffer.data());
+#else
+    const char* value = std::getenv(varName.c_str());
+    if (value == nullptr) {
+        throw std::runtime_error("Environment variable is not set: " + varName);
+    }
+    return std::string(value);
+#endif
 }
 
 void replaceWithRegex(std::string& str, const std::string& from, const std::string& to) {
-    std::regex regex(from);
-    str = std::regex_replace(str, regex, to);
+    replaceWithRegex(str, *RegexCache::global().get(from), to);
 }
 
 void replaceSubstring(std::string& str, const std::string& from, const std::string& to) {
-    size_t startPos = 0;
-    while ((startPos = str.find(from, startPos)) != std::string::npos) {
-        str.replace(startPos, from.length(), to);
-        startPos += to.length(); // Advance startPos to avoid replacing the newly inserted substring
+    if (from.empty()) {
+        return;
     }
+    str = SubstringReplacer({{from, to}}).replace(str);
 }
 
-std::wstring stringToWString(const std::string& str) {
-    int size_needed = MultiByteToWideChar(CP_UTF8, 0, str.c_str(), -1, NULL, 0);
-    std::wstring wstr(size_needed, 0);
-    MultiByteToWideChar(CP_UTF8, 0, str.c_str(), -1, &wstr[0], size_needed);
-    wstr.resize(size_needed - 1); // Remove the extra null terminator
-    return wstr;
-}
+SubstringReplacer::SubstringReplacer(const std::vector<std::pair<std::string, std::string>>& replacements) {
+    // Byte classes keep the table at (states x distinct pattern bytes)
+    for (const auto& [from, to] : replacements) {
+        if (from.empty()) {
+            throw std::invalid_argument("Replacement pattern cannot be empty");
+        }
+        for (unsigned char c : from) {
+            if (byteClass[c] == 0) {
+                byteClass[c] = static_cast<uint8_t>(classCount++);
+            }
+        }
+    }
 
-void launchProcess(std::string program, const std::vector<std::string>& args) {
-    // Validate program path
-    if (program.empty()) {
-        throw std::runtime_error("Program path cannot be empty");
+    // Trie; a repeated pattern keeps its first replacement
+    transitions.assign(classCount, noState);
+    patternAt.push_back(noState);
+    for (const auto& replacement : replacements) {
+        uint32_t state = 0;
+        for (unsigned char c : replacement.first) {
+            uint32_t& next = transitions[state * classCount + byteClass[c]];
+            if (next == noState) {
+                next = static_cast<uint32_t>(patternAt.size());
+                transitions.resize(transitions.size() + classCount, noState);
+                patternAt.push_back(noState);
+            }
+            state = transitions[state * classCount + byteClass[c]];
+        }
+        if (patternAt[state] == noState) {
+            patternAt[state] = static_cast<uint32_t>(patterns.size());
+            patterns.push_back(replacement);
+        }
     }
 
-    // Check if program exists
-    if (!std::filesystem::exists(program)) {
-        throw std::runtime_error("Program not found: " + program);
+    longestPattern = 0;
+    shortestPattern = SIZE_MAX;
+    for (const auto& [from, to] : patterns) {
+        longestPattern = std::max(longestPattern, from.size());
+        shortestPattern = std::min(shortestPattern, from.size());
+        largestGrowth = std::max(largestGrowth, to.size() > from.size() ? to.size() - from.size() : 0);
     }
 
-    std::wstring appName = stringToWString(program);
-    std::wstring commandLine = appName; // Start with the program name
-
-    // Build command line with proper escaping
-    for (const auto& arg : args) {
-        commandLine += L" ";
-        std::wstring warg = stringToWString(arg);
-        
-        // Escape arguments that contain spaces
-        if (warg.find(L' ') != std::wstring::npos && 
-            warg.front() != L'"' && warg.back() != L'"') {
-            commandLine += L"\"" + warg + L"\"";
+    // Breadth-first failure links, folded into the table so scanning is one lookup per byte
+    std::vector<uint32_t> failure(patternAt.size(), 0);
+    outputLink.assign(patternAt.size(), noState);
+    std::vector<uint32_t> queue;
+    queue.reserve(patternAt.size());
+    for (size_t c = 0; c < classCount; ++c) {
+        uint32_t& next = transitions[c];
+        if (next == noState) {
+            next = 0;
         } else {
-            commandLine += warg;
+            queue.push_back(next);
         }
     }
-
-    STARTUPINFOW si;
-    PROCESS_INFORMATION pi;
-
-    ZeroMemory(&si, sizeof(si));
-    si.cb = sizeof(si);
-    ZeroMemory(&pi, sizeof(pi));
-
-    // Set working directory to program's directory
-    std::filesystem::path programPath(program);
-    std::wstring workingDir = stringToWString(programPath.parent_path().string());
-
-    BOOL result = CreateProcessW(
-        appName.c_str(),           // Application name
-        &commandLine[0],           // Command line
-        NULL,                      // Process security attributes
-        NULL,                      // Thread security attributes
-        FALSE,                     // Inherit handles
-        0,                         // Creation flags
-        NULL,                      // Environment
-        workingDir.empty() ? NULL : workingDir.c_str(), // Current directory
-        &si,                       // Startup info
-        &pi                        // Process information
-    );
-
-    if (!result) {
-        DWORD errorCode = GetLastError();
-        std::string errorMsg = "CreateProcess failed with error " + std::to_string(errorCode);
-        
-        // Get detailed error message
-        LPSTR messageBuffer = nullptr;
-        FormatMessageA(
-            FORMAT_MESSAGE_ALLOCATE_BUFFER | FORMAT_MESSAGE_FROM_SYSTEM | FORMAT_MESSAGE_IGNORE_INSERTS,
-            nullptr,
-            errorCode,
-            MAKELANGID(LANG_NEUTRAL, SUBLANG_DEFAULT),
-            (LPSTR)&messageBuffer,
-            0,
-            nullptr
-        );
-        
-        if (messageBuffer) {
-            errorMsg += ": " + std::string(messageBuffer);
-            LocalFree(messageBuffer);
+    for (size_t head = 0; head < queue.size(); ++head) {
+        uint32_t state = queue[head];
+        for (size_t c = 0; c < classCount; ++c) {
+            uint32_t& next = transitions[state * classCount + c];
+            uint32_t fallback = transitions[failure[state] * classCount + c];
+            if (next == noState) {
+                next = fallback;
+                continue;
+            }
+            failure[next] = fallback;
+            outputLink[next] = patternAt[fallback] != noState ? fallback : outputLink[fallback];
+            queue.push_back(next);
         }
-        
-        throw std::runtime_error(errorMsg);
     }
+}
 
-    // Wait for process to complete with timeout (30 seconds)
-    DWORD waitResult = WaitForSingleObject(pi.hProcess, 30000);
-    
-    if (waitResult == WAIT_TIMEOUT) {
-        std::cerr << "Warning: Process is taking longer than expected to start" << std::endl;
-    } else if (waitResult == WAIT_FAILED) {
-        std::cerr << "Warning: Failed to wait for process: " << GetLastError() << std::endl;
+std::string SubstringReplacer::replace(std::string_view text) const {
+    std::string result;
+    if (patterns.empty()) {
+        result.assign(text);
+        return result;
     }
-
-    // Get exit code
-    DWORD exitCode;
-    if (GetExitCodeProcess(pi.hProcess, &exitCode)) {
-        if (exitCode != 0 && exitCode != STILL_ACTIVE) {
-            std::cerr << "Warning: Process exited with code: " << exitCode << std::endl;
+    result.reserve(text.size() + text.size() / shortestPattern * largestGrowth);
+
+    // Best match per start position, for the last longestPattern positions
+    // (ring of a power of two). A position is decided once no longer match
+    // can still end after it
+    std::vector<uint32_t> best(std::bit_ceil(longestPattern), noState);
+    size_t ringMask = best.size() - 1;
+    size_t decided = 0;         // Next start position to decide
+    size_t copiedUntil = 0;     // Text before this is in result or replaced
+
+    auto decide = [&](size_t start) {
+        uint32_t& pattern = best[start & ringMask];
+        if (pattern != noState && start >= copiedUntil) {
+            result.append(text.substr(copiedUntil, start - copiedUntil));
+            result.append(patterns[pattern].second);
+            copiedUntil = start + patterns[pattern].first.size();
+        }
+        pattern = noState;
+    };
+
+    uint32_t state = 0;
+    for (size_t end = 0; end < text.size(); ++end) {
+        state = transitions[state * classCount + byteClass[static_cast<unsigned char>(text[end])]];
+        for (uint32_t match = patternAt[state] != noState ? state : outputLink[state]; match != noState; match = outputLink[match]) {
+            uint32_t pattern = patternAt[match];
+            size_t start = end + 1 - patterns[pattern].first.size();
+            uint32_t& slot = best[start & ringMask];
+            if (slot == noState || patterns[slot].first.size() < patterns[pattern].first.size()) {
+                slot = pattern;
+            }
+        }
+        for (; decided + longestPattern <= end + 1; ++decided) {
+            decide(decided);
         }
     }
+    for (; decided < text.size(); ++decided) {
+        decide(decided);
+    }
+    result.append(text.substr(copiedUntil));
+    return result;
+}
 
-    CloseHandle(pi.hProcess);
-    CloseHandle(pi.hThread);
+#ifdef _WIN32
+std::wstring stringToWString(const std::string& str) {
+    static_assert(sizeof(wchar_t) == sizeof(char16_t), "UTF-16 wchar_t expected");
+    std::wstring wstr(utf16Capacity(str.size()), L'\0');
+    wstr.resize(utf8ToUtf16Replacing(str, reinterpret_cast<char16_t*>(wstr.data()), wstr.size()));
+    return wstr;
 }
+#endif
 
 void createFileIfNotExists(const std::string& path) {
     std::ifstream infile(path);
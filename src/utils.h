@@ -1,13 +1,46 @@
 #pragma once
 
+#include <array>
+#include <cstdint>
 #include <string>
+#include <string_view>
+#include <utility>
 #include <vector>
 
+#ifdef _WIN32
 #include <Windows.h>
+#endif
 
 std::string getEnvironmentVariable(const std::string& varName);
+// Compiled patterns are reused through RegexCache::global()
 void replaceWithRegex(std::string& str, const std::string& from, const std::string& to);
 void replaceSubstring(std::string& str, const std::string& from, const std::string& to);
+
+// Replaces several substrings in a single pass (Aho-Corasick automaton built
+// once). Scanning left to right, the longest pattern starting at a position
+// wins and replaced text is not matched again, as with replaceSubstring.
+// Throws std::invalid_argument for an empty pattern
+class SubstringReplacer {
+public:
+    explicit SubstringReplacer(const std::vector<std::pair<std::string, std::string>>& replacements);
+
+    // Output is allocated once, sized for the worst case
+    std::string replace(std::string_view text) const;
+
+private:
+    static constexpr uint32_t noState = UINT32_MAX;
+
+    std::array<uint8_t, 256> byteClass{};    // Bytes not in any pattern share class 0
+    size_t classCount = 1;
+    std::vector<uint32_t> transitions;      // state * classCount + class, complete DFA
+    std::vector<uint32_t> patternAt;        // Pattern ending exactly at the state, or noState
+    std::vector<uint32_t> outputLink;       // Nearest proper suffix state that ends a pattern
+    std::vector<std::pair<std::string, std::string>> patterns;
+    size_t longestPattern = 0;
+    size_t shortestPattern = 0;
+    size_t largestGrowth = 0;               // Max of to.size() - from.size()
+};
+#ifdef _WIN32
 std::wstring stringToWString(const std::string& str);
-void launchProcess(std::string program, const std::vector<std::string>& args);
+#endif
 void createFileIfNotExists(const std::string& path);
\ No newline at end of file
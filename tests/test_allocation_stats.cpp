@@ -0,0 +1,75 @@
+#include <gtest/gtest.h>
+#include "allocation_stats.h"
+#include "imgui.h"
+#include "main_window.h"
+#include "ui_harness.h"
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+class AllocationStatsTest : public ::testing::Test {
+};
+
+TEST_F(AllocationStatsTest, CountsOperatorNewTest) {
+    AllocationCounts processStart = AllocationStats::process();
+    AllocationCounts threadStart = AllocationStats::thread();
+
+    auto buffer = std::make_unique<char[]>(1000);
+    std::vector<int> numbers(250);
+
+    AllocationCounts threadUsed = AllocationStats::thread() - threadStart;
+    EXPECT_EQ(threadUsed.allocations, 2u);
+    EXPECT_EQ(threadUsed.bytes, 2000u);
+    EXPECT_GE((AllocationStats::process() - processStart).allocations, 2u);
+
+    // Other threads keep counts of their own
+    uint64_t workerAllocations = 0;
+    std::thread worker([&workerAllocations] {
+        AllocationCounts workerStart = AllocationStats::thread();
+        std::string text(100, 'x');
+        workerAllocations = (AllocationStats::thread() - workerStart).allocations;
+    });
+    threadStart = AllocationStats::thread();
+    worker.join();
+    EXPECT_EQ((AllocationStats::thread() - threadStart).allocations, 0u);
+    EXPECT_EQ(workerAllocations, 1u);
+}
+
+TEST_F(AllocationStatsTest, FrameStatsTest) {
+    FrameAllocationStats frames;
+    frames.beginFrame();
+    std::string text(100, 'x');
+    frames.endFrame();
+    EXPECT_EQ(frames.lastFrame().allocations, 1u);
+    EXPECT_EQ(frames.quietFrames(), 0u);
+
+    frames.beginFrame();
+    frames.endFrame();
+    frames.beginFrame();
+    frames.endFrame();
+    EXPECT_EQ(frames.lastFrame().allocations, 0u);
+    EXPECT_EQ(frames.quietFrames(), 2u);
+}
+
+// The real main window on a headless context with a thousand bases in
+// history: once warmed up an idle frame must not touch the heap
+TEST_F(AllocationStatsTest, IdleFrameDoesNotAllocateTest) {
+    AllocationCounts imguiStart = AllocationStats::imgui();
+    UiHarness harness;
+    harness.fillHistory(1000);
+    FrameAllocationStats frameAllocations;
+    harness.getWindow().setFrameStats(&frameAllocations);
+    for (int i = 0; i < 10; ++i) {
+        harness.frame();
+    }
+    EXPECT_GT((AllocationStats::imgui() - imguiStart).allocations, 0u);
+
+    for (int i = 0; i < 100; ++i) {
+        frameAllocations.beginFrame();
+        harness.frame();
+        frameAllocations.endFrame();
+    }
+    EXPECT_EQ(frameAllocations.quietFrames(), 100u) << frameAllocations.lastFrame().allocations << " allocations in the last frame";
+    EXPECT_GT(ImGui::GetDrawData()->TotalVtxCount, 0);
+}
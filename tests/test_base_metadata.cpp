@@ -0,0 +1,153 @@
+#include <gtest/gtest.h>
+#include "base_metadata.h"
+#include "base_path.h"
+#include "frame_arena.h"
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+
+class BaseMetadataTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        baseDir = std::filesystem::absolute("test_base_metadata");
+        std::filesystem::create_directories(baseDir);
+        databaseFile = (baseDir / "1Cv8.1CD").string();
+    }
+
+    void TearDown() override {
+        std::filesystem::remove_all(baseDir);
+    }
+
+    // Writes a 1CD root header followed by padding
+    void writeHeader(uint8_t v1, uint8_t v2, uint8_t v3, uint8_t v4, uint32_t pages, uint32_t pageSize, size_t totalSize = 8192) {
+        std::vector<uint8_t> data(totalSize, 0);
+        std::memcpy(data.data(), "1CDBMSV8", 8);
+        data[8] = v1; data[9] = v2; data[10] = v3; data[11] = v4;
+        for (int i = 0; i < 4; ++i) {
+            data[12 + i] = static_cast<uint8_t>(pages >> (8 * i));
+            data[20 + i] = static_cast<uint8_t>(pageSize >> (8 * i));
+        }
+        std::ofstream file(databaseFile, std::ios::binary | std::ios::trunc);
+        file.write(reinterpret_cast<const char*>(data.data()), static_cast<std::streamsize>(data.size()));
+    }
+
+    std::filesystem::path baseDir;
+    std::string databaseFile;
+};
+
+TEST_F(BaseMetadataTest, ExtractBasePathTest) {
+    EXPECT_EQ(extractBasePath("File=\"C:\\Bases\\Trade\";"), "C:\\Bases\\Trade");
+    EXPECT_EQ(extractBasePath("C:\\Bases\\Trade\\"), "C:\\Bases\\Trade");
+    EXPECT_EQ(extractBasePath("c:/bases/trade/"), "c:/bases/trade");
+    EXPECT_FALSE(extractBasePath("https://host/base").has_value());
+    EXPECT_FALSE(extractBasePath("Srvr=\"host\";Ref=\"base\";").has_value());
+#ifndef _WIN32
+    EXPECT_EQ(extractBasePath("File=\"/home/user/Bases/Trade/\";"), "/home/user/Bases/Trade");
+    EXPECT_FALSE(extractBasePath("ws=\"http://host/base\";").has_value());
+#endif
+}
+
+TEST_F(BaseMetadataTest, CanonicalBasePathTest) {
+    EXPECT_EQ(canonicalBasePath("C:\\Bases\\Trade"), "c:\\bases\\trade");
+    EXPECT_EQ(canonicalBasePath("c:/bases//Trade\\\\"), "c:\\bases\\trade");
+    EXPECT_EQ(canonicalBasePath("C:\\Bases\\Trade\\1Cv8.1CD"), "c:\\bases\\trade");
+    EXPECT_EQ(canonicalBasePath("C:\\1cv8.1cd"), "c:\\");
+    EXPECT_EQ(canonicalBasePath("\\\\Server\\Share\\\\Торговля\\"), "\\\\server\\share\\торговля");
+    EXPECT_EQ(canonicalBasePath("//home/User/Base"), "/home/User/Base");
+    EXPECT_EQ(canonicalBasePath("/home/user//Bases/Trade/1Cv8.1CD"), "/home/user/Bases/Trade");
+    EXPECT_EQ(canonicalBasePath("/"), "/");
+}
+
+TEST_F(BaseMetadataTest, FoldCaseTest) {
+    EXPECT_EQ(foldCase("ABC xyz"), "abc xyz");
+    EXPECT_EQ(foldCase("АБВГДЕЁЖЗИЙКЛМНОПРСТУФХЦЧШЩЪЫЬЭЮЯ"), "абвгдеёжзийклмнопрстуфхцчшщъыьэюя");
+    EXPECT_EQ(foldCase("Торговля №1"), "торговля №1");
+}
+
+TEST_F(BaseMetadataTest, IsDatabaseFileNameTest) {
+    EXPECT_TRUE(isDatabaseFileName("1Cv8.1CD"));
+    EXPECT_TRUE(isDatabaseFileName("1cv8.1cd"));
+    EXPECT_FALSE(isDatabaseFileName("1Cv8.1CL"));
+    EXPECT_FALSE(isDatabaseFileName(""));
+}
+
+TEST_F(BaseMetadataTest, ParseModernHeaderTest) {
+    writeHeader(8, 3, 8, 0, 1234, 16384);
+    BaseMetadata metadata = BaseInspector::inspect(baseDir.string());
+    EXPECT_TRUE(metadata.valid) << metadata.error;
+    EXPECT_EQ(metadata.formatVersion, "8.3.8.0");
+    EXPECT_EQ(metadata.pageSize, 16384u);
+    EXPECT_EQ(metadata.pageCount, 1234u);
+    EXPECT_EQ(metadata.fileSize, 8192u);
+    EXPECT_GT(metadata.lastModified, 0);
+    EXPECT_FALSE(metadata.summary.empty());
+}
+
+TEST_F(BaseMetadataTest, ParseLegacyHeaderTest) {
+    // Before 8.3.8 the page size field does not exist and pages are always 4 KB
+    writeHeader(8, 2, 14, 0, 10, 0xDEADBEEF);
+    BaseMetadata metadata = BaseInspector::inspect(databaseFile);
+    EXPECT_TRUE(metadata.valid) << metadata.error;
+    EXPECT_EQ(metadata.formatVersion, "8.2.14.0");
+    EXPECT_EQ(metadata.pageSize, BaseInspector::legacyPageSize);
+}
+
+TEST_F(BaseMetadataTest, RejectInvalidHeaderTest) {
+    writeHeader(8, 3, 8, 0, 1, 1000);
+    EXPECT_FALSE(BaseInspector::inspect(baseDir.string()).valid);
+
+    std::ofstream(databaseFile, std::ios::trunc) << "not a database";
+    EXPECT_FALSE(BaseInspector::inspect(baseDir.string()).valid);
+
+    std::filesystem::remove(databaseFile);
+    BaseMetadata missing = BaseInspector::inspect(baseDir.string());
+    EXPECT_FALSE(missing.valid);
+    EXPECT_FALSE(missing.error.empty());
+}
+
+TEST_F(BaseMetadataTest, CacheHitsOnUnchangedFileTest) {
+    writeHeader(8, 3, 8, 0, 42, 8192);
+    std::string input = "File=\"" + baseDir.string() + "\";";
+
+    BaseMetadataCache cache(2);
+    cache.request(input);
+    cache.waitIdle();
+
+    auto first = cache.lookup(input);
+    ASSERT_TRUE(first.has_value());
+    EXPECT_TRUE(first->valid) << first->error;
+    EXPECT_EQ(cache.missCount(), 1u);
+
+    FrameArena arena;
+    EXPECT_STREQ(cache.lookupSummary(input, arena), first->summary.c_str());
+    EXPECT_EQ(cache.lookupSummary("File=\"C:\\Missing\";", arena), nullptr);
+
+    cache.request(input);
+    cache.waitIdle();
+    EXPECT_EQ(cache.hitCount(), 1u);
+    EXPECT_EQ(cache.missCount(), 1u);
+}
+
+TEST_F(BaseMetadataTest, CacheSerializationRoundTripTest) {
+    writeHeader(8, 3, 8, 0, 42, 8192);
+    std::string input = baseDir.string();
+
+    std::vector<std::string> lines;
+    {
+        BaseMetadataCache cache(1);
+        cache.request(input);
+        cache.waitIdle();
+        lines = cache.serialize();
+    }
+    ASSERT_EQ(lines.size(), 1u);
+
+    // A restored cache answers without reading the header again
+    BaseMetadataCache restored(1);
+    restored.deserialize(lines);
+    restored.deserialize({"garbage", "1|2|3"});
+    restored.request(input);
+    restored.waitIdle();
+    EXPECT_EQ(restored.hitCount(), 1u);
+    EXPECT_EQ(restored.missCount(), 0u);
+    EXPECT_EQ(restored.lookup(input)->pageCount, 42u);
+}
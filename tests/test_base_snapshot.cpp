@@ -0,0 +1,140 @@
+#include <gtest/gtest.h>
+#include "base_snapshot.h"
+#include "file_copier.h"
+#include <filesystem>
+#include <fstream>
+#include <thread>
+
+class BaseSnapshotTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        root = std::filesystem::absolute("test_base_snapshot");
+        std::filesystem::remove_all(root);
+        baseDir = root / "Trade";
+        snapshotDir = root / "snapshots";
+        std::filesystem::create_directories(baseDir / "ExtCompT");
+
+        writeFile(baseDir / "1Cv8.1CD", 3 * 1024 * 1024 + 17);
+        writeFile(baseDir / "ExtCompT" / "component.dat", 1000);
+    }
+
+    void TearDown() override {
+        std::filesystem::remove_all(root);
+    }
+
+    static void writeFile(const std::filesystem::path& path, size_t size) {
+        std::string data(size, '\0');
+        for (size_t i = 0; i < size; ++i) {
+            data[i] = static_cast<char>(i * 31 % 251);
+        }
+        std::ofstream file(path, std::ios::binary | std::ios::trunc);
+        file.write(data.data(), static_cast<std::streamsize>(data.size()));
+    }
+
+    static std::string readFile(const std::filesystem::path& path) {
+        std::ifstream file(path, std::ios::binary);
+        return std::string(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+    }
+
+    std::filesystem::path root;
+    std::filesystem::path baseDir;
+    std::filesystem::path snapshotDir;
+};
+
+TEST_F(BaseSnapshotTest, CopyFileTest) {
+    std::filesystem::path source = baseDir / "1Cv8.1CD";
+    std::filesystem::path target = root / "copy.1CD";
+
+    CopyProgress progress;
+    FileCopier::copyFile(source.string(), target.string(), &progress);
+
+    EXPECT_EQ(readFile(target), readFile(source));
+    EXPECT_EQ(progress.bytesCopied.load(), std::filesystem::file_size(source));
+    EXPECT_EQ(std::filesystem::last_write_time(target), std::filesystem::last_write_time(source));
+}
+
+TEST_F(BaseSnapshotTest, BufferedCopyTest) {
+    std::filesystem::path source = baseDir / "1Cv8.1CD";
+    std::filesystem::path target = root / "buffered.1CD";
+
+    EXPECT_TRUE(FileCopier::copyFileWith(FileCopier::Method::Buffered, source.string(), target.string()));
+    EXPECT_EQ(readFile(target), readFile(source));
+}
+
+TEST_F(BaseSnapshotTest, CopyMissingFileThrowsTest) {
+    EXPECT_THROW(FileCopier::copyFile((root / "missing").string(), (root / "target").string()), std::runtime_error);
+}
+
+TEST_F(BaseSnapshotTest, CancelledCopyThrowsTest) {
+    CopyProgress progress;
+    progress.cancelled = true;
+    EXPECT_THROW(FileCopier::copyFile((baseDir / "1Cv8.1CD").string(), (root / "target").string(), &progress), std::runtime_error);
+}
+
+TEST_F(BaseSnapshotTest, SnapshotCopiesWholeDirectoryTest) {
+    BaseSnapshot snapshot(baseDir.string(), snapshotDir.string(), 3);
+    snapshot.start();
+    ASSERT_TRUE(snapshot.waitFor(std::chrono::seconds(30)));
+    ASSERT_EQ(snapshot.getState(), BaseSnapshot::State::Completed) << snapshot.getError();
+
+    std::filesystem::path destination = snapshot.getDestination();
+    EXPECT_EQ(destination.filename().string().rfind(BaseSnapshot::snapshotPrefix(baseDir.string()), 0), 0u);
+    EXPECT_EQ(readFile(destination / "1Cv8.1CD"), readFile(baseDir / "1Cv8.1CD"));
+    EXPECT_EQ(readFile(destination / "ExtCompT" / "component.dat"), readFile(baseDir / "ExtCompT" / "component.dat"));
+    EXPECT_EQ(snapshot.getBytesCopied(), snapshot.getBytesTotal());
+}
+
+TEST_F(BaseSnapshotTest, SnapshotOfMissingBaseFailsTest) {
+    BaseSnapshot snapshot((root / "Missing").string(), snapshotDir.string(), 3);
+    snapshot.start();
+    ASSERT_TRUE(snapshot.waitFor(std::chrono::seconds(30)));
+    EXPECT_EQ(snapshot.getState(), BaseSnapshot::State::Failed);
+    EXPECT_FALSE(snapshot.getError().empty());
+    EXPECT_TRUE(snapshot.getDestination().empty());
+}
+
+TEST_F(BaseSnapshotTest, OpenedDuringCopyStaysPartialTest) {
+    std::string prefix = BaseSnapshot::snapshotPrefix(baseDir.string());
+    std::filesystem::create_directories(snapshotDir / (prefix + "20250101_100000"));
+
+    // The Configurator opens the base before the copy is done
+    BaseSnapshot snapshot(baseDir.string(), snapshotDir.string(), 1);
+    EXPECT_TRUE(snapshot.markBaseOpened());
+    snapshot.start();
+    ASSERT_TRUE(snapshot.waitFor(std::chrono::seconds(30)));
+    ASSERT_EQ(snapshot.getState(), BaseSnapshot::State::Inconsistent) << snapshot.getError();
+    EXPECT_FALSE(snapshot.getError().empty());
+
+    // Kept for inspection as .partial, and the consistent snapshot is not pushed out for it
+    std::filesystem::path destination = snapshot.getDestination();
+    EXPECT_EQ(destination.extension(), ".partial");
+    EXPECT_EQ(readFile(destination / "1Cv8.1CD"), readFile(baseDir / "1Cv8.1CD"));
+    EXPECT_TRUE(std::filesystem::exists(snapshotDir / (prefix + "20250101_100000")));
+    EXPECT_TRUE(BaseSnapshot::applyRetention(snapshotDir.string(), baseDir.string(), 1).empty());
+}
+
+TEST_F(BaseSnapshotTest, OpenedAfterCopyStaysCompleteTest) {
+    BaseSnapshot snapshot(baseDir.string(), snapshotDir.string(), 3);
+    snapshot.start();
+    ASSERT_TRUE(snapshot.waitFor(std::chrono::seconds(30)));
+    EXPECT_FALSE(snapshot.markBaseOpened());
+    EXPECT_EQ(snapshot.getState(), BaseSnapshot::State::Completed);
+}
+
+TEST_F(BaseSnapshotTest, RetentionKeepsNewestTest) {
+    std::string prefix = BaseSnapshot::snapshotPrefix(baseDir.string());
+    for (const char* stamp : {"20250101_100000", "20250102_100000", "20250103_100000", "20250104_100000"}) {
+        std::filesystem::create_directories(snapshotDir / (prefix + stamp));
+    }
+    // Partial copies and other bases are never touched
+    std::filesystem::create_directories(snapshotDir / (prefix + "20240101_100000.partial"));
+    std::filesystem::create_directories(snapshotDir / "Other_00000000_20200101_100000");
+
+    auto removed = BaseSnapshot::applyRetention(snapshotDir.string(), baseDir.string(), 2);
+    EXPECT_EQ(removed.size(), 2u);
+    EXPECT_FALSE(std::filesystem::exists(snapshotDir / (prefix + "20250101_100000")));
+    EXPECT_FALSE(std::filesystem::exists(snapshotDir / (prefix + "20250102_100000")));
+    EXPECT_TRUE(std::filesystem::exists(snapshotDir / (prefix + "20250104_100000")));
+    EXPECT_TRUE(std::filesystem::exists(snapshotDir / (prefix + "20240101_100000.partial")));
+    EXPECT_TRUE(std::filesystem::exists(snapshotDir / "Other_00000000_20200101_100000"));
+}
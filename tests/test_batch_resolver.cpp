@@ -0,0 +1,127 @@
+#include <gtest/gtest.h>
+#include "batch_resolver.h"
+#include "error_handler.h"
+#include "json.h"
+#include "utf_transcode.h"
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+
+class BatchResolverTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        ErrorHandler::setLogLevel(LogLevel::None);
+        baseDir = std::filesystem::absolute("test_batch_resolver");
+        std::filesystem::create_directories(baseDir);
+    }
+
+    void TearDown() override {
+        std::filesystem::remove_all(baseDir);
+        ErrorHandler::setLogLevel(LogLevel::Info);
+    }
+
+    static std::vector<std::string> splitLines(const std::string& text) {
+        std::vector<std::string> lines;
+        std::istringstream in(text);
+        for (std::string line; std::getline(in, line);) {
+            lines.push_back(line);
+        }
+        return lines;
+    }
+
+    std::filesystem::path baseDir;
+    RUN1C launcher{""};
+};
+
+TEST_F(BatchResolverTest, JsonStringEscapingTest) {
+    std::string out;
+    appendJsonString(out, "C:\\Bases\\\"Trade\"\n\x01");
+    EXPECT_EQ(out, "\"C:\\\\Bases\\\\\\\"Trade\\\"\\n\\u0001\"");
+}
+
+TEST_F(BatchResolverTest, JsonStringInvalidUtf8Test) {
+    // Valid Cyrillic and a four-byte sequence pass through
+    std::string out;
+    appendJsonString(out, "\xD0\x91\xD0\xB0\xD0\xB7\xD0\xB0 \xF0\x9F\x93\x81");
+    EXPECT_EQ(out, "\"\xD0\x91\xD0\xB0\xD0\xB7\xD0\xB0 \xF0\x9F\x93\x81\"");
+
+    // A Windows-1251 path, a truncated sequence, an overlong form and an encoded surrogate
+    out.clear();
+    appendJsonString(out, "C:\\\xC1\xE0\xE7\xE0|\xD0|\xC0\xAF|\xED\xA0\x80");
+    std::string replacement = "\xEF\xBF\xBD";
+    EXPECT_EQ(out, "\"C:\\\\" + replacement + replacement + replacement + replacement + "|" + replacement + "|"
+        + replacement + replacement + "|" + replacement + replacement + replacement + "\"");
+    EXPECT_TRUE(utf8ToUtf16(out, std::u16string(out.size(), u'\0').data(), out.size()).ok());
+}
+
+TEST_F(BatchResolverTest, InvalidInputTest) {
+    BatchResolver resolver(launcher, {});
+    bool valid = true;
+    std::string line = resolver.resolve(3, "not a base", valid);
+    EXPECT_FALSE(valid);
+    EXPECT_NE(line.find("\"index\":3"), std::string::npos);
+    EXPECT_NE(line.find("\"valid\":false"), std::string::npos);
+    EXPECT_NE(line.find("\"error\":"), std::string::npos);
+}
+
+TEST_F(BatchResolverTest, ValidBaseTest) {
+    std::ofstream(baseDir / "1Cv8.1CD") << "not a 1CD header";
+
+    BatchResolver resolver(launcher, {});
+    bool valid = false;
+    std::string line = resolver.resolve(0, "File=\"" + baseDir.string() + "\";", valid);
+    EXPECT_TRUE(valid);
+    EXPECT_NE(line.find("\"mode\":\"ENTERPRISE\""), std::string::npos);
+    EXPECT_NE(line.find("\"metadata\":null"), std::string::npos);
+}
+
+TEST_F(BatchResolverTest, OrderedOutputTest) {
+    std::string input;
+    for (int i = 0; i < 500; ++i) {
+        input += (i % 10 == 0 ? std::string() : "missing " + std::to_string(i)) + "\n";
+    }
+
+    BatchResolver::Options options;
+    options.threads = 4;
+    options.maxInFlight = 8;
+    options.ordered = true;
+
+    std::istringstream in(input);
+    std::ostringstream out;
+    BatchResolver::Summary summary = BatchResolver(launcher, options).run(in, out);
+
+    // Blank lines are counted in the index but produce no output
+    EXPECT_EQ(summary.total, 450u);
+    EXPECT_EQ(summary.invalid, 450u);
+
+    std::vector<std::string> lines = splitLines(out.str());
+    ASSERT_EQ(lines.size(), 450u);
+    size_t expected = 1;
+    for (const auto& line : lines) {
+        if (expected % 10 == 0) {
+            ++expected;
+        }
+        EXPECT_EQ(line.rfind("{\"index\":" + std::to_string(expected) + ",", 0), 0u) << line;
+        ++expected;
+    }
+}
+
+TEST_F(BatchResolverTest, UnorderedOutputTest) {
+    std::string input;
+    for (int i = 0; i < 200; ++i) {
+        input += "missing " + std::to_string(i) + "\r\n";
+    }
+
+    BatchResolver::Options options;
+    options.threads = 8;
+    options.maxInFlight = 1;
+
+    std::istringstream in(input);
+    std::ostringstream out;
+    BatchResolver::Summary summary = BatchResolver(launcher, options).run(in, out);
+
+    EXPECT_EQ(summary.total, 200u);
+    EXPECT_EQ(splitLines(out.str()).size(), 200u);
+    EXPECT_EQ(out.str().find('\r'), std::string::npos);
+}
@@ -0,0 +1,130 @@
+#include <gtest/gtest.h>
+#include "cancellation.h"
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+
+class CancellationTest : public ::testing::Test {
+};
+
+TEST_F(CancellationTest, CallbacksRunOnceTest) {
+    CancellationSource source;
+    CancellationToken token = source.token();
+    EXPECT_TRUE(token.canBeCancelled());
+    EXPECT_FALSE(token.isCancelled());
+
+    int calls = 0;
+    CancellationRegistration registration = token.onCancel([&calls] { ++calls; });
+    source.cancel();
+    source.cancel();
+    EXPECT_EQ(calls, 1);
+    EXPECT_TRUE(token.isCancelled());
+    EXPECT_THROW(token.throwIfCancelled(), TaskCancelled);
+
+    // Registered after the fact: runs right away
+    CancellationRegistration late = token.onCancel([&calls] { ++calls; });
+    EXPECT_EQ(calls, 2);
+}
+
+TEST_F(CancellationTest, ResetUnregistersTest) {
+    CancellationSource source;
+    int calls = 0;
+    CancellationRegistration registration = source.token().onCancel([&calls] { ++calls; });
+    registration.reset();
+    source.cancel();
+    EXPECT_EQ(calls, 0);
+
+    // Nobody can cancel a default token
+    CancellationToken none;
+    EXPECT_FALSE(none.canBeCancelled());
+    EXPECT_NO_THROW(none.throwIfCancelled());
+    CancellationRegistration ignored = none.onCancel([&calls] { ++calls; });
+    EXPECT_EQ(calls, 0);
+}
+
+TEST_F(CancellationTest, ParentCancelsChildTest) {
+    CancellationSource parent;
+    CancellationSource child(parent.token());
+    CancellationSource unrelated;
+
+    child.cancel();
+    EXPECT_FALSE(parent.isCancelled());
+
+    CancellationSource second(parent.token());
+    parent.cancel();
+    EXPECT_TRUE(second.isCancelled());
+    EXPECT_FALSE(unrelated.isCancelled());
+
+    // Linked to a parent cancelled already
+    CancellationSource late(parent.token());
+    EXPECT_TRUE(late.isCancelled());
+}
+
+TEST_F(CancellationTest, ChildOutlivedByParentTest) {
+    CancellationSource parent;
+    for (int i = 0; i < 100; ++i) {
+        CancellationSource child(parent.token());
+    }
+    parent.cancel();
+    EXPECT_TRUE(parent.isCancelled());
+}
+
+// Registration, unregistration and cancellation racing on several threads:
+// every callback runs at most once, and never after reset() has returned
+TEST_F(CancellationTest, ConcurrentRegisterAndCancelTest) {
+    for (int round = 0; round < 200; ++round) {
+        CancellationSource source;
+        CancellationToken token = source.token();
+        std::atomic<bool> go{false};
+        std::atomic<int> ran{0};
+        std::atomic<int> afterReset{0};
+
+        std::vector<std::thread> threads;
+        for (int t = 0; t < 4; ++t) {
+            threads.emplace_back([&] {
+                while (!go.load()) {
+                }
+                for (int i = 0; i < 20; ++i) {
+                    auto unregistered = std::make_shared<std::atomic<bool>>(false);
+                    CancellationRegistration registration = token.onCancel([&ran, &afterReset, unregistered] {
+                        if (unregistered->load()) {
+                            afterReset.fetch_add(1);
+                        }
+                        ran.fetch_add(1);
+                    });
+                    if (i % 2 == 0) {
+                        registration.reset();
+                        unregistered->store(true);
+                    }
+                }
+            });
+        }
+        threads.emplace_back([&] {
+            while (!go.load()) {
+            }
+            source.cancel();
+        });
+
+        go.store(true);
+        for (auto& thread : threads) {
+            thread.join();
+        }
+        EXPECT_LE(ran.load(), 80);
+        EXPECT_EQ(afterReset.load(), 0);
+        EXPECT_TRUE(token.isCancelled());
+    }
+}
+
+// A registration may reset itself from inside its own callback
+TEST_F(CancellationTest, ResetInsideCallbackTest) {
+    CancellationSource source;
+    CancellationRegistration registration;
+    bool ran = false;
+    registration = source.token().onCancel([&] {
+        ran = true;
+        registration.reset();
+    });
+    source.cancel();
+    EXPECT_TRUE(ran);
+}
@@ -0,0 +1,101 @@
+#include <gtest/gtest.h>
+#include "command_line.h"
+#include "config.h"
+#include <filesystem>
+#include <sstream>
+
+class CommandLineTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        Config::setStorageFilePath("test_command_line_storage.ini");
+        // Launches must not be handed to a launcher the developer has open
+        Config::setSingleInstanceEnabled(false);
+    }
+
+    void TearDown() override {
+        Config::clearOverrides();
+        std::filesystem::remove("test_command_line_storage.ini");
+    }
+};
+
+TEST_F(CommandLineTest, NoArgumentsStartsGuiTest) {
+    CommandLineOptions options = parseCommandLine({});
+    EXPECT_EQ(options.command, CommandLineOptions::Command::Gui);
+}
+
+TEST_F(CommandLineTest, LaunchTest) {
+    CommandLineOptions options = parseCommandLine({"--launch", "File=\"C:\\Bases\\Trade\";"});
+    EXPECT_EQ(options.command, CommandLineOptions::Command::Launch);
+    EXPECT_EQ(options.input, "File=\"C:\\Bases\\Trade\";");
+    EXPECT_FALSE(options.configMode);
+    EXPECT_FALSE(options.dryRun);
+}
+
+TEST_F(CommandLineTest, LaunchConfigModeTest) {
+    // Flags are accepted before and after the input
+    CommandLineOptions before = parseCommandLine({"--config", "--launch", "C:\\Bases\\Trade"});
+    CommandLineOptions after = parseCommandLine({"--launch", "C:\\Bases\\Trade", "--config", "--dry-run"});
+    EXPECT_EQ(before.command, CommandLineOptions::Command::Launch);
+    EXPECT_TRUE(before.configMode);
+    EXPECT_EQ(after.command, CommandLineOptions::Command::Launch);
+    EXPECT_TRUE(after.configMode);
+    EXPECT_TRUE(after.dryRun);
+}
+
+TEST_F(CommandLineTest, InvalidArgumentsTest) {
+    EXPECT_EQ(parseCommandLine({"--launch"}).command, CommandLineOptions::Command::Invalid);
+    EXPECT_EQ(parseCommandLine({"--unknown"}).command, CommandLineOptions::Command::Invalid);
+    EXPECT_EQ(parseCommandLine({"--config"}).command, CommandLineOptions::Command::Invalid);
+    EXPECT_FALSE(parseCommandLine({"--launch"}).error.empty());
+}
+
+TEST_F(CommandLineTest, ResolveTest) {
+    CommandLineOptions options = parseCommandLine({"--resolve", "--input", "bases.txt", "--ordered", "--threads", "4"});
+    EXPECT_EQ(options.command, CommandLineOptions::Command::Resolve);
+    EXPECT_EQ(options.inputFile, "bases.txt");
+    EXPECT_TRUE(options.ordered);
+    EXPECT_EQ(options.threads, 4u);
+
+    EXPECT_EQ(parseCommandLine({"--resolve", "--threads", "0"}).command, CommandLineOptions::Command::Invalid);
+    EXPECT_EQ(parseCommandLine({"--resolve", "--dry-run"}).command, CommandLineOptions::Command::Invalid);
+    EXPECT_EQ(parseCommandLine({"--ordered"}).command, CommandLineOptions::Command::Invalid);
+}
+
+TEST_F(CommandLineTest, ResolveMissingInputFileTest) {
+    CommandLineOptions options = parseCommandLine({"--resolve", "--input", "missing_inputs.txt"});
+    EXPECT_EQ(runResolveCommand(options), 1);
+}
+
+TEST_F(CommandLineTest, ImportIbasesTest) {
+    CommandLineOptions options = parseCommandLine({"--import-ibases"});
+    EXPECT_EQ(options.command, CommandLineOptions::Command::Import);
+    EXPECT_TRUE(options.inputFile.empty());
+
+    options = parseCommandLine({"--import-ibases", "shared.v8i"});
+    EXPECT_EQ(options.command, CommandLineOptions::Command::Import);
+    EXPECT_EQ(options.inputFile, "shared.v8i");
+
+    EXPECT_EQ(parseCommandLine({"--import-ibases", "--config"}).command, CommandLineOptions::Command::Invalid);
+    EXPECT_EQ(parseCommandLine({"--import-ibases", "--dry-run"}).command, CommandLineOptions::Command::Invalid);
+}
+
+TEST_F(CommandLineTest, ForwardedArgumentsTest) {
+    EXPECT_TRUE(forwardedArguments(parseCommandLine({})).empty());
+    EXPECT_EQ(forwardedArguments(parseCommandLine({"--launch", "C:\\Bases\\Trade", "--config"})),
+        (std::vector<std::string>{"--launch", "C:\\Bases\\Trade", "--config"}));
+}
+
+TEST_F(CommandLineTest, HelpTest) {
+    EXPECT_EQ(parseCommandLine({"--help"}).command, CommandLineOptions::Command::Help);
+    std::ostringstream out;
+    printUsage(out);
+    EXPECT_NE(out.str().find("--launch"), std::string::npos);
+}
+
+TEST_F(CommandLineTest, LaunchInvalidInputFailsTest) {
+    CommandLineOptions options = parseCommandLine({"--launch", "not a base", "--dry-run"});
+    EXPECT_EQ(runLaunchCommand(options), 1);
+
+    options = parseCommandLine({"--launch", "C:\\Missing\\Base"});
+    EXPECT_EQ(runLaunchCommand(options), 1);
+}
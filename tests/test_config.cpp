@@ -1,17 +1,15 @@
 #include <gtest/gtest.h>
 #include "config.h"
+#include "launcher.h"
 #include <filesystem>
 #include <fstream>
+#include <iterator>
 
 class ConfigTest : public ::testing::Test {
 protected:
     void SetUp() override {
-        // Save original values
-        originalFontPath = Config::getFontPath();
-        original1CStarterPath = Config::get1CStarterPath();
-        originalBaseFontSize = Config::getBaseFontSize();
-        originalStoragePath = Config::getStorageFilePath();
-        
+        Config::clearOverrides();
+
         // Create test files
         testFontPath = "test_font.ttf";
         std::ofstream fontFile(testFontPath);
@@ -23,12 +21,9 @@ protected:
     }
 
     void TearDown() override {
-        // Reset to original values
-        if (!originalFontPath.empty()) Config::setCustomFontPath(originalFontPath);
-        if (!original1CStarterPath.empty()) Config::setCustom1CStarterPath(original1CStarterPath);
-        Config::setBaseFontSize(originalBaseFontSize);
-        if (!originalStoragePath.empty()) Config::setStorageFilePath(originalStoragePath);
-        
+        // Drop what the test set
+        Config::clearOverrides();
+
         // Remove test files
         if (std::filesystem::exists(testFontPath)) {
             std::filesystem::remove(testFontPath);
@@ -38,10 +33,6 @@ protected:
         }
     }
 
-    std::string originalFontPath;
-    std::string original1CStarterPath;
-    int originalBaseFontSize;
-    std::string originalStoragePath;
     std::string testFontPath;
     std::string test1CStarterPath;
 };
@@ -66,9 +57,13 @@ TEST_F(ConfigTest, CustomFontPathTest) {
 TEST_F(ConfigTest, Default1CStarterPathTest) {
     std::string defaultPath = Config::getDefault1CStarterPath();
     EXPECT_FALSE(defaultPath.empty());
-    // Default path should contain 1cv8 and 1cestart.exe
+    // Default path should contain 1cv8 and the starter (1cestart.exe on Windows)
     EXPECT_NE(defaultPath.find("1cv8"), std::string::npos);
+#ifdef _WIN32
     EXPECT_NE(defaultPath.find("1cestart.exe"), std::string::npos);
+#else
+    EXPECT_NE(defaultPath.find("1cestart"), std::string::npos);
+#endif
 }
 
 TEST_F(ConfigTest, Custom1CStarterPathTest) {
@@ -79,6 +74,12 @@ TEST_F(ConfigTest, Custom1CStarterPathTest) {
     Config::setCustom1CStarterPath("non_existent_1cestart.exe");
     // Should fall back to default
     EXPECT_NE(Config::get1CStarterPath(), "non_existent_1cestart.exe");
+
+    // A launcher without an explicit starter follows the setting
+    RUN1C launcher;
+    Config::setCustom1CStarterPath(test1CStarterPath);
+    EXPECT_EQ(launcher.getStarterPath(), test1CStarterPath);
+    EXPECT_EQ(RUN1C("").getStarterPath(), "");
 }
 
 TEST_F(ConfigTest, BaseFontSizeTest) {
@@ -131,4 +132,110 @@ TEST_F(ConfigTest, Is1CStarterValidTest) {
     
     // Test with non-existent file
     EXPECT_FALSE(Config::is1CStarterValid("non_existent_file.exe"));
-}
\ No newline at end of file
+}
+
+TEST_F(ConfigTest, TypedKeysTest) {
+    EXPECT_EQ(Config::get(ConfigKeys::baseFontSize), Config::getBaseFontSize());
+    EXPECT_TRUE(Config::set(ConfigKeys::baseFontSize, 20));
+    EXPECT_EQ(Config::current().baseFontSize, 20);
+
+    // Rejected values and values that change nothing leave the published snapshot in place
+    const ConfigSnapshot& before = Config::current();
+    EXPECT_FALSE(Config::set(ConfigKeys::baseFontSize, 100));
+    EXPECT_FALSE(Config::set(ConfigKeys::snapshotDirectory, std::string()));
+    EXPECT_TRUE(Config::set(ConfigKeys::baseFontSize, 20));
+    EXPECT_EQ(&Config::current(), &before);
+
+    // A replaced snapshot is retired, not freed: references to it stay readable
+    EXPECT_TRUE(Config::set(ConfigKeys::baseFontSize, 22));
+    EXPECT_NE(&Config::current(), &before);
+    EXPECT_EQ(before.baseFontSize, 20);
+    EXPECT_EQ(Config::current().version, before.version + 1);
+}
+
+TEST_F(ConfigTest, ConfigFileTest) {
+    const std::string configPath = "test_run1c_config.ini";
+    {
+        std::ofstream file(configPath);
+        file << "# Comment\n"
+             << "snapshotRetention = 7\n"
+             << "ibasesPath=/srv/1c/ibases.v8i\n"
+             << "baseFontSize = huge\n"
+             << "unknownKey = 1\n"
+             << "no separator\n";
+    }
+    const ConfigSnapshot& defaults = Config::current();
+    std::vector<std::string> errors = Config::loadFile(configPath);
+    EXPECT_EQ(errors.size(), 3u);
+
+    const ConfigSnapshot& loaded = Config::current();
+    EXPECT_GT(loaded.version, defaults.version);
+    EXPECT_EQ(loaded.snapshotRetention, 7u);
+    EXPECT_EQ(Config::getIbasesPath(), "/srv/1c/ibases.v8i");
+    EXPECT_EQ(loaded.baseFontSize, defaults.baseFontSize);
+
+    // Earlier snapshots are never changed or freed
+    EXPECT_NE(defaults.snapshotRetention, 7u);
+
+    // Reloading the unchanged file publishes nothing
+    EXPECT_EQ(Config::loadFile(configPath).size(), 3u);
+    EXPECT_EQ(&Config::current(), &loaded);
+
+    // Runtime overrides win over the file
+    Config::setSnapshotRetention(5);
+    EXPECT_EQ(Config::getSnapshotRetention(), 5u);
+    Config::clearOverrides();
+    EXPECT_EQ(Config::getSnapshotRetention(), 7u);
+
+    // Without the file its values go back to the defaults
+    std::filesystem::remove(configPath);
+    EXPECT_TRUE(Config::loadFile(configPath).empty());
+    EXPECT_EQ(Config::getIbasesPath(), Config::getDefaultIbasesPath());
+}
+
+TEST_F(ConfigTest, PersistTest) {
+    const std::string configPath = "test_run1c_persist.ini";
+    {
+        std::ofstream file(configPath, std::ios::binary);
+        file << "# Comment\r\n"
+             << "snapshotEnabled = false\r\n"
+             << "snapshotRetention = 4\r\n";
+    }
+    Config::setSnapshotEnabled(false);
+
+    // The key's line is replaced and the runtime override dropped
+    EXPECT_TRUE(Config::persist(ConfigKeys::snapshotEnabled, true, configPath));
+    EXPECT_TRUE(Config::isSnapshotEnabled());
+    EXPECT_EQ(Config::getSnapshotRetention(), 4u);
+    EXPECT_TRUE(Config::persist(ConfigKeys::snapshotWaitTimeoutMs, 500, configPath));
+    EXPECT_FALSE(Config::persist(ConfigKeys::snapshotWaitTimeoutMs, -1, configPath));
+    {
+        std::ifstream file(configPath, std::ios::binary);
+        std::string text((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+        EXPECT_EQ(text, "# Comment\r\nsnapshotEnabled = true\r\nsnapshotRetention = 4\r\nsnapshotWaitTimeoutMs = 500\n");
+    }
+
+    // Later edits of the file apply, nothing overrides them
+    {
+        std::ofstream file(configPath);
+        file << "snapshotEnabled = false\n";
+    }
+    EXPECT_TRUE(Config::loadFile(configPath).empty());
+    EXPECT_FALSE(Config::isSnapshotEnabled());
+
+    // A BOM before the replaced first line stays
+    {
+        std::ofstream file(configPath, std::ios::binary);
+        file << "\xEF\xBB\xBFsnapshotEnabled = false\n";
+    }
+    EXPECT_TRUE(Config::persist(ConfigKeys::snapshotEnabled, true, configPath));
+    EXPECT_TRUE(Config::isSnapshotEnabled());
+    {
+        std::ifstream file(configPath, std::ios::binary);
+        std::string text((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+        EXPECT_EQ(text, "\xEF\xBB\xBFsnapshotEnabled = true\n");
+    }
+
+    std::filesystem::remove(configPath);
+    EXPECT_TRUE(Config::loadFile(configPath).empty());
+}
@@ -0,0 +1,84 @@
+#include <gtest/gtest.h>
+#include "config.h"
+#include "config_watcher.h"
+#include <atomic>
+#include <filesystem>
+#include <fstream>
+#include <thread>
+
+class ConfigWatcherTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        configPath = (std::filesystem::temp_directory_path() / "run1c_test_config_watcher.ini").string();
+        std::filesystem::remove(configPath);
+        Config::loadFile(configPath);
+    }
+
+    void TearDown() override {
+        std::filesystem::remove(configPath);
+        Config::loadFile(configPath);
+    }
+
+    // Also moves the modification time forward, coarse clocks may not
+    void writeConfig(const std::string& content) {
+        auto previous = std::filesystem::exists(configPath) ? std::filesystem::last_write_time(configPath)
+                                                            : std::filesystem::file_time_type::clock::now();
+        {
+            std::ofstream file(configPath, std::ios::trunc);
+            file << content;
+        }
+        std::filesystem::last_write_time(configPath, previous + std::chrono::seconds(++edits));
+    }
+
+    std::string configPath;
+    int edits = 0;
+};
+
+TEST_F(ConfigWatcherTest, PollReloadsChangedFileTest) {
+    std::vector<std::string> reported;
+    ConfigWatcher watcher(configPath, std::chrono::hours(1), [&reported](const std::vector<std::string>& errors) {
+        reported = errors;
+    });
+    EXPECT_FALSE(watcher.poll());
+
+    writeConfig("ibasesPath = /srv/one.v8i\n");
+    EXPECT_TRUE(watcher.poll());
+    EXPECT_EQ(Config::getIbasesPath(), "/srv/one.v8i");
+    EXPECT_FALSE(watcher.poll());
+    EXPECT_TRUE(reported.empty());
+
+    writeConfig("ibasesPath = /srv/two.v8i\nsnapshotRetention = -1\n");
+    EXPECT_TRUE(watcher.poll());
+    EXPECT_EQ(Config::getIbasesPath(), "/srv/two.v8i");
+    EXPECT_EQ(reported.size(), 1u);
+
+    std::filesystem::remove(configPath);
+    EXPECT_TRUE(watcher.poll());
+    EXPECT_EQ(Config::getIbasesPath(), Config::getDefaultIbasesPath());
+}
+
+TEST_F(ConfigWatcherTest, BackgroundReloadTest) {
+    ConfigWatcher watcher(configPath, std::chrono::milliseconds(10));
+
+    // Readers keep going while snapshots are replaced under them
+    std::atomic<bool> stop{false};
+    std::atomic<uint64_t> reads{0};
+    std::thread reader([&] {
+        while (!stop.load()) {
+            const ConfigSnapshot& snapshot = Config::current();
+            EXPECT_FALSE(snapshot.ibasesPath.empty());
+            reads++;
+        }
+    });
+
+    writeConfig("ibasesPath = /srv/background.v8i\n");
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (Config::getIbasesPath() != "/srv/background.v8i" && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(5));
+    }
+    stop = true;
+    reader.join();
+
+    EXPECT_EQ(Config::getIbasesPath(), "/srv/background.v8i");
+    EXPECT_GT(reads.load(), 0u);
+}
@@ -0,0 +1,187 @@
+#include <gtest/gtest.h>
+#include "connection_string.h"
+#include "base_path.h"
+#include "error_handler.h"
+#include "launcher.h"
+#include <random>
+
+namespace {
+
+// Valid and broken inputs the fuzz test mutates
+const std::vector<std::string> seedCorpus = {
+    "File=\"C:\\Bases\\Trade\";",
+    "Connect=File=\"C:\\Bases\\Trade\";",
+    "Srvr=\"app01:1541\";Ref=\"trade\";",
+    "Srvr=\"app01,app02\";Ref=\"Торговля\";Usr=\"Иванов\";",
+    "ws=\"https://host/base\";",
+    "File=\"\\\\server\\share\\Bases\\Trade\";",
+    "File=\"C:\\Bases\\Say \"\"hi\"\"\";",
+    "Файл=\"C:\\Базы\";File=C:\\Bases\\Plain",
+    "  file = \"C:\\Bases\\Trade\" ; ; Usr=admin",
+    "File=\"C:\\Bases\\Unterminated;",
+    "C:\\Bases\\Trade",
+    "\"C:\\Bases\\Trade\"",
+    "=value;",
+    "",
+};
+
+// Bytes that matter to the grammar, plus both halves of a Cyrillic letter
+const std::string mutationAlphabet = "\";= \t\\aFS\xD0\xA4";
+
+bool viewInside(std::string_view view, const std::string& input) {
+    return view.empty() || (view.data() >= input.data() && view.data() + view.size() <= input.data() + input.size());
+}
+
+} // namespace
+
+class ConnectionStringTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        ErrorHandler::setLogLevel(LogLevel::None);
+    }
+
+    void TearDown() override {
+        ErrorHandler::setLogLevel(LogLevel::Info);
+    }
+};
+
+TEST_F(ConnectionStringTest, TokenizerFieldsTest) {
+    std::string input = "Srvr = \"app01\" ;Ref=trade ;;Пользователь=\"a;b=c\";Pwd=\"say \"\"hi\"\"\"";
+    ConnectionStringTokenizer tokenizer(input);
+    ConnectionField field;
+
+    ASSERT_TRUE(tokenizer.next(field));
+    EXPECT_EQ(field.key, "Srvr");
+    EXPECT_EQ(field.value.text, "app01");
+    ASSERT_TRUE(tokenizer.next(field));
+    EXPECT_EQ(field.key, "Ref");
+    EXPECT_EQ(field.value.text, "trade");
+    ASSERT_TRUE(tokenizer.next(field));
+    EXPECT_EQ(field.key, "Пользователь");
+    EXPECT_EQ(field.value.text, "a;b=c");
+    ASSERT_TRUE(tokenizer.next(field));
+    EXPECT_EQ(field.key, "Pwd");
+    EXPECT_TRUE(field.value.escaped);
+    EXPECT_EQ(field.value.str(), "say \"hi\"");
+    EXPECT_FALSE(tokenizer.next(field));
+    EXPECT_FALSE(tokenizer.failed());
+}
+
+TEST_F(ConnectionStringTest, TokenizerErrorsTest) {
+    for (const char* input : {"File=\"C:\\Bases", "File=\"C:\\Bases\" x;", "C:\\Bases\\Trade", "=C:\\Bases", "File=C:\\\"Bases\""}) {
+        ConnectionStringTokenizer tokenizer(input);
+        ConnectionField field;
+        while (tokenizer.next(field)) {
+        }
+        EXPECT_TRUE(tokenizer.failed()) << input;
+    }
+}
+
+TEST_F(ConnectionStringTest, ParseKindsTest) {
+    ConnectionString connection;
+    ASSERT_TRUE(parseConnectionString("Connect=File=\"C:\\Bases\\Trade\";", connection));
+    EXPECT_EQ(connection.kind, ConnectionKind::File);
+    EXPECT_EQ(connectionArguments(connection), (std::vector<std::string>{"/F", "C:\\Bases\\Trade"}));
+
+    ASSERT_TRUE(parseConnectionString("SRVR=\"app01:1541\";REF=\"Торговля\";Usr=\"admin\";", connection));
+    EXPECT_EQ(connection.kind, ConnectionKind::Server);
+    EXPECT_EQ(connectionArguments(connection), (std::vector<std::string>{"/S", "app01:1541\\Торговля"}));
+    EXPECT_EQ(connectionDisplayName(connection), "app01:1541\\Торговля");
+
+    ASSERT_TRUE(parseConnectionString("ws=\"https://host/trade\";", connection));
+    EXPECT_EQ(connection.kind, ConnectionKind::Web);
+    EXPECT_EQ(connectionArguments(connection), (std::vector<std::string>{"/WS", "https://host/trade"}));
+
+    // A server without a base, or no base at all
+    EXPECT_FALSE(parseConnectionString("Srvr=\"app01\";", connection));
+    EXPECT_FALSE(parseConnectionString("Usr=\"admin\";", connection));
+    EXPECT_FALSE(parseConnectionString("C:\\Bases\\Trade", connection));
+    EXPECT_EQ(connection.kind, ConnectionKind::None);
+}
+
+TEST_F(ConnectionStringTest, ExtractFileBasePathTest) {
+    EXPECT_EQ(extractBasePath("File=\"\\\\server\\share\\Trade\\\";"), "\\\\server\\share\\Trade");
+    EXPECT_EQ(extractBasePath("\\\\server\\share\\Trade"), "\\\\server\\share\\Trade");
+    EXPECT_EQ(extractBasePath("File=\"C:\\Bases\\A;B\";"), "C:\\Bases\\A;B");
+    EXPECT_EQ(extractBasePath("File=\"C:\\\";"), "C:\\");
+    EXPECT_FALSE(extractBasePath("Srvr=\"C:\\Bases\";Ref=\"x\";").has_value());
+}
+
+TEST_F(ConnectionStringTest, PrepareServerAndWebBasesTest) {
+    RUN1C launcher("1cestart.exe");
+
+    auto server = launcher.prepare("Srvr=\"app01\";Ref=\"trade\";", true);
+    ASSERT_TRUE(server.has_value());
+    EXPECT_EQ(server->kind, ConnectionKind::Server);
+    EXPECT_EQ(server->basePath, "app01\\trade");
+    EXPECT_EQ(server->args, (std::vector<std::string>{"CONFIG", "/S", "app01\\trade"}));
+
+    auto web = launcher.prepare("ws=\"http://host/trade\";");
+    ASSERT_TRUE(web.has_value());
+    EXPECT_EQ(web->kind, ConnectionKind::Web);
+    EXPECT_EQ(web->args, (std::vector<std::string>{"ENTERPRISE", "/WS", "http://host/trade"}));
+}
+
+TEST_F(ConnectionStringTest, QuotedValueRoundTripFuzzTest) {
+    std::mt19937 random(1234);
+    const std::string valueAlphabet = "\";= \\abc\xD0\x91";
+
+    for (int round = 0; round < 2000; ++round) {
+        std::string value;
+        int length = random() % 12;
+        for (int i = 0; i < length; ++i) {
+            value += valueAlphabet[random() % valueAlphabet.size()];
+        }
+
+        // Quote the way 1C writes it, with an unknown field before and after
+        std::string quoted;
+        for (char c : value) {
+            quoted += c;
+            if (c == '"') quoted += '"';
+        }
+        std::string input = "Usr=\"x\";Srvr=\"" + quoted + "\";Ref=\"base\";Pwd=;";
+
+        ConnectionString connection;
+        ASSERT_EQ(parseConnectionString(input, connection), !value.empty()) << input;
+        if (!value.empty()) {
+            EXPECT_EQ(connection.server.str(), value) << input;
+            EXPECT_EQ(connection.ref.str(), "base");
+        }
+    }
+}
+
+TEST_F(ConnectionStringTest, MutatedCorpusFuzzTest) {
+    std::mt19937 random(42);
+    size_t parsed = 0;
+
+    for (int round = 0; round < 20000; ++round) {
+        std::string input = seedCorpus[random() % seedCorpus.size()];
+        int mutations = 1 + random() % 4;
+        for (int i = 0; i < mutations; ++i) {
+            size_t at = input.empty() ? 0 : random() % (input.size() + 1);
+            char c = mutationAlphabet[random() % mutationAlphabet.size()];
+            switch (random() % 3) {
+            case 0: input.insert(input.begin() + at, c); break;
+            case 1: if (at < input.size()) input.erase(at, 1); break;
+            default: if (at < input.size()) input[at] = c; break;
+            }
+        }
+
+        // Every view stays inside the input, whatever the outcome
+        ConnectionString connection;
+        bool ok = parseConnectionString(input, connection);
+        EXPECT_TRUE(viewInside(connection.file.text, input)) << input;
+        EXPECT_TRUE(viewInside(connection.server.text, input)) << input;
+        EXPECT_TRUE(viewInside(connection.ref.text, input)) << input;
+        EXPECT_TRUE(viewInside(connection.webUrl.text, input)) << input;
+        EXPECT_EQ(ok, connection.kind != ConnectionKind::None) << input;
+        if (ok) {
+            ++parsed;
+            EXPECT_FALSE(connectionArguments(connection).empty());
+        }
+        extractBasePath(input);
+    }
+
+    // The mutations keep a fair share of inputs valid
+    EXPECT_GT(parsed, 1000u);
+}
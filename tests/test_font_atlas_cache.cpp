@@ -0,0 +1,88 @@
+#include <gtest/gtest.h>
+#include "font_atlas_cache.h"
+#include "imgui.h"
+#include "imgui_internal.h"
+#include <memory>
+#include <thread>
+
+class FontAtlasCacheTest : public ::testing::Test {
+};
+
+TEST_F(FontAtlasCacheTest, DpiScaleTest) {
+    EXPECT_EQ(dpiScaleFor(96.0f), 1.0f);
+    EXPECT_EQ(dpiScaleFor(120.0f), 1.5f);
+    EXPECT_EQ(dpiScaleFor(144.0f), 1.5f);
+    EXPECT_EQ(dpiScaleFor(192.0f), 2.0f);
+    EXPECT_EQ(dpiScaleFor(20.0f), 0.5f);
+
+    // SDL_GetDisplayDPI failed
+    EXPECT_EQ(dpiScaleFor(-1.0f), 1.0f);
+    EXPECT_EQ(dpiScaleFor(0.0f), 1.0f);
+}
+
+// Off the main thread and without an ImGui context, as the worker builds them
+TEST_F(FontAtlasCacheTest, BuildWithoutContextTest) {
+    std::unique_ptr<ImFontAtlas> atlas;
+    std::thread builder([&atlas] {
+        atlas = FontAtlasCache::build("missing_font.ttf", 16, 1.5f);
+    });
+    builder.join();
+
+    ASSERT_NE(atlas, nullptr);
+    EXPECT_TRUE(atlas->IsBuilt());
+    ASSERT_EQ(atlas->Fonts.Size, 1);
+    EXPECT_EQ(atlas->Fonts[0]->FontSize, 24.0f);
+    EXPECT_NE(atlas->TexPixelsRGBA32, nullptr);
+}
+
+// The render thread keeps drawing while the worker builds: the worker's
+// allocations must not go through the UI context
+TEST_F(FontAtlasCacheTest, WorkerLeavesUiContextAloneTest) {
+    ImGuiContext* context = ImGui::CreateContext();
+    int allocations = context->DebugAllocInfo.TotalAllocCount;
+    {
+        FontAtlasCache cache("missing_font.ttf", 16);
+        cache.request(1.5f);
+        cache.waitIdle();
+        ASSERT_NE(cache.find(1.5f), nullptr);
+        EXPECT_EQ(context->DebugAllocInfo.TotalAllocCount, allocations);
+    }
+
+    ImGuiContext* seenByOtherThread = context;
+    std::thread([&seenByOtherThread] { seenByOtherThread = ImGui::GetCurrentContext(); }).join();
+    EXPECT_EQ(seenByOtherThread, nullptr);
+    EXPECT_EQ(ImGui::GetCurrentContext(), context);
+    ImGui::DestroyContext(context);
+}
+
+TEST_F(FontAtlasCacheTest, RecentScalesAreKeptTest) {
+    FontAtlasCache cache("missing_font.ttf", 16, 2);
+    EXPECT_EQ(cache.find(1.0f), nullptr);
+
+    cache.request(1.0f);
+    cache.waitIdle();
+    ImFontAtlas* normal = cache.find(1.0f);
+    ASSERT_NE(normal, nullptr);
+    EXPECT_EQ(normal->Fonts[0]->FontSize, 16.0f);
+
+    // Built ones are not built again
+    cache.request(1.0f);
+    cache.waitIdle();
+    EXPECT_EQ(cache.find(1.0f), normal);
+
+    cache.request(2.0f);
+    cache.waitIdle();
+    ImFontAtlas* large = cache.find(2.0f);
+    ASSERT_NE(large, nullptr);
+    EXPECT_EQ(large->Fonts[0]->FontSize, 32.0f);
+    EXPECT_EQ(cache.find(1.0f), normal);
+
+    // A third scale evicts the least recently used one once it is taken
+    cache.request(1.5f);
+    cache.waitIdle();
+    EXPECT_EQ(cache.size(), 3u);
+    EXPECT_NE(cache.find(1.5f), nullptr);
+    EXPECT_EQ(cache.size(), 2u);
+    EXPECT_EQ(cache.find(2.0f), nullptr);
+    EXPECT_EQ(cache.find(1.0f), normal);
+}
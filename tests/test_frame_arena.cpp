@@ -0,0 +1,47 @@
+#include <gtest/gtest.h>
+#include "allocation_stats.h"
+#include "frame_arena.h"
+#include <string>
+
+class FrameArenaTest : public ::testing::Test {
+};
+
+TEST_F(FrameArenaTest, CopyAndFormatTest) {
+    FrameArena arena(64);
+    const char* copied = arena.copy("File=\"C:\\Bases\\Trade\";");
+    const char* formatted = arena.format("%s %d%%", "Snapshot", 42);
+    const char* empty = arena.copy("");
+
+    EXPECT_STREQ(copied, "File=\"C:\\Bases\\Trade\";");
+    EXPECT_STREQ(formatted, "Snapshot 42%");
+    EXPECT_STREQ(empty, "");
+
+    // Longer than a chunk, gets one of its own; earlier strings stay intact
+    std::string longText(200, 'x');
+    EXPECT_STREQ(arena.format("%s", longText.c_str()), longText.c_str());
+    EXPECT_STREQ(copied, "File=\"C:\\Bases\\Trade\";");
+    EXPECT_EQ(arena.usedBytes(), 23u + 13u + 1u + 201u);
+}
+
+TEST_F(FrameArenaTest, SteadyFramesDoNotAllocateTest) {
+    FrameArena arena(256);
+    auto frame = [&arena] {
+        arena.reset();
+        for (int row = 0; row < 100; ++row) {
+            arena.format("%d.%d MB, 8.3.%d", row, row % 10, row);
+        }
+    };
+
+    // The first frame spills over several chunks, the reset merges them
+    frame();
+    size_t reserved = arena.reservedBytes();
+    EXPECT_GT(reserved, 256u);
+    frame();
+
+    AllocationCounts start = AllocationStats::thread();
+    for (int i = 0; i < 10; ++i) {
+        frame();
+    }
+    EXPECT_EQ((AllocationStats::thread() - start).allocations, 0u);
+    EXPECT_EQ(arena.reservedBytes(), reserved);
+}
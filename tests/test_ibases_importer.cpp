@@ -0,0 +1,179 @@
+#include <gtest/gtest.h>
+#include "ibases_importer.h"
+#include "history.h"
+#include "persistent_storage.h"
+#include <filesystem>
+#include <fstream>
+
+namespace {
+
+// As written by 1cestart: BOM, CRLF, folder sections without Connect=
+const char* sampleIbases =
+    "\xEF\xBB\xBF[Торговля]\r\n"
+    "Connect=File=\"C:\\Bases\\Trade\";\r\n"
+    "ID=2f1c2a4e-0000-0000-0000-000000000001\r\n"
+    "OrderInList=16384\r\n"
+    "Folder=/Отдел продаж\r\n"
+    "External=0\r\n"
+    "Version=8.3.24\r\n"
+    "\r\n"
+    "[Отдел продаж]\r\n"
+    "Folder=/\r\n"
+    "OrderInTree=16384\r\n"
+    "\r\n"
+    "[Бухгалтерия]\r\n"
+    "Connect=Srvr=\"app01\";Ref=\"accounting\";\r\n"
+    "Folder=/\r\n";
+
+} // namespace
+
+class IbasesImporterTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        PersistentStorage::setVerbose(false);
+        workDir = std::filesystem::absolute("test_ibases_importer");
+        std::filesystem::create_directories(workDir);
+        ibasesPath = (workDir / "ibases.v8i").string();
+    }
+
+    void TearDown() override {
+        std::filesystem::remove_all(workDir);
+        PersistentStorage::setVerbose(true);
+    }
+
+    void writeIbases(const std::string& content) {
+        std::ofstream file(ibasesPath, std::ios::binary | std::ios::trunc);
+        file << content;
+    }
+
+    std::filesystem::path workDir;
+    std::string ibasesPath;
+};
+
+TEST_F(IbasesImporterTest, ParseSectionsTest) {
+    std::vector<IbasesSection> sections;
+    size_t count = parseIbases(sampleIbases, [&sections](const IbasesSection& section) { sections.push_back(section); });
+
+    EXPECT_EQ(count, 3u);
+    ASSERT_EQ(sections.size(), 2u);
+    EXPECT_EQ(sections[0].name, "Торговля");
+    EXPECT_EQ(sections[0].connect, "File=\"C:\\Bases\\Trade\";");
+    EXPECT_EQ(sections[0].folder, "/Отдел продаж");
+    EXPECT_EQ(sections[0].version, "8.3.24");
+    EXPECT_EQ(ibasesDisplayName(sections[0]), "Отдел продаж / Торговля");
+    EXPECT_EQ(sections[1].connect, "Srvr=\"app01\";Ref=\"accounting\";");
+    EXPECT_TRUE(sections[1].version.empty());
+    EXPECT_EQ(ibasesDisplayName(sections[1]), "Бухгалтерия");
+    EXPECT_NE(sections[0].hash, sections[1].hash);
+}
+
+TEST_F(IbasesImporterTest, SectionHashIgnoresLineEndingsTest) {
+    std::string crlf = "[A]\r\nConnect=File=\"C:\\A\";\r\n";
+    std::string lf = "[A]\nConnect=File=\"C:\\A\";";
+    std::string changed = "[A]\nConnect=File=\"C:\\B\";";
+
+    uint64_t hashes[3] = {};
+    int index = 0;
+    for (const std::string* content : {&crlf, &lf, &changed}) {
+        parseIbases(*content, [&](const IbasesSection& section) { hashes[index] = section.hash; });
+        ++index;
+    }
+    EXPECT_EQ(hashes[0], hashes[1]);
+    EXPECT_NE(hashes[1], hashes[2]);
+}
+
+TEST_F(IbasesImporterTest, ImportMergesIntoHistoryTest) {
+    writeIbases(sampleIbases);
+
+    History history;
+    history.recordLaunch("C:\\Bases\\Trade", false, 1760000000);
+
+    IbasesImportState state;
+    IbasesImportResult result = importIbases(ibasesPath, history, state);
+    EXPECT_TRUE(result.error.empty());
+    EXPECT_TRUE(result.fileChanged);
+    EXPECT_EQ(result.sections, 3u);
+    EXPECT_EQ(result.changedSections, 2u);
+
+    // Version pins of the changed sections, empty where the base has none
+    ASSERT_EQ(result.versions.size(), 2u);
+    EXPECT_EQ(result.versions[0].first, "File=\"C:\\Bases\\Trade\";");
+    EXPECT_EQ(result.versions[0].second, "8.3.24");
+    EXPECT_EQ(result.versions[1].second, "");
+
+    // The launched base is the same as the imported File= entry and only takes its name
+    EXPECT_EQ(result.added, 1u);
+    ASSERT_EQ(history.size(), 2u);
+    EXPECT_EQ(history.at(history.size() - 1).input, "C:\\Bases\\Trade");
+    EXPECT_EQ(history.at(history.size() - 1).name, "Отдел продаж / Торговля");
+    EXPECT_EQ(history.at(0).name, "Бухгалтерия");
+    EXPECT_EQ(history.at(0).launchCount, 0u);
+}
+
+TEST_F(IbasesImporterTest, ReimportOnlyChangedSectionsTest) {
+    writeIbases(sampleIbases);
+    History history;
+    IbasesImportState state;
+    importIbases(ibasesPath, history, state);
+
+    // Same mtime and size: nothing is parsed
+    IbasesImportResult unchanged = importIbases(ibasesPath, history, state);
+    EXPECT_FALSE(unchanged.fileChanged);
+
+    // A new section appended: only it is imported
+    writeIbases(std::string(sampleIbases) + "[Склад]\r\nConnect=ws=\"https://host/stock\";\r\nFolder=/\r\n");
+    std::filesystem::last_write_time(ibasesPath, std::filesystem::last_write_time(ibasesPath) + std::chrono::seconds(5));
+    IbasesImportResult appended = importIbases(ibasesPath, history, state);
+    EXPECT_TRUE(appended.fileChanged);
+    EXPECT_EQ(appended.sections, 4u);
+    EXPECT_EQ(appended.changedSections, 1u);
+    EXPECT_EQ(appended.added, 1u);
+    EXPECT_EQ(history.size(), 3u);
+
+    // A renamed base is re-imported and keeps a single history entry
+    std::string renamed = sampleIbases;
+    renamed.replace(renamed.find("[Бухгалтерия]"), std::string("[Бухгалтерия]").size(), "[Бухгалтерия 3.0]");
+    writeIbases(renamed);
+    std::filesystem::last_write_time(ibasesPath, std::filesystem::last_write_time(ibasesPath) + std::chrono::seconds(10));
+    IbasesImportResult changed = importIbases(ibasesPath, history, state);
+    EXPECT_EQ(changed.changedSections, 1u);
+    EXPECT_EQ(changed.added, 0u);
+    EXPECT_EQ(history.size(), 3u);
+    EXPECT_EQ(history.find("Srvr=\"app01\";Ref=\"accounting\";")->name, "Бухгалтерия 3.0");
+}
+
+TEST_F(IbasesImporterTest, StatePersistsTest) {
+    writeIbases(sampleIbases);
+    std::string storagePath = (workDir / "storage.ini").string();
+    {
+        PersistentStorage storage(storagePath);
+        History history;
+        IbasesImportState state;
+        importIbases(ibasesPath, history, state);
+        history.save(storage);
+        state.save(storage);
+        storage.save();
+    }
+
+    PersistentStorage storage(storagePath);
+    storage.load();
+    History history;
+    history.load(storage);
+    IbasesImportState state;
+    state.load(storage);
+    EXPECT_EQ(state.path, ibasesPath);
+    EXPECT_EQ(state.sectionHashes.size(), 2u);
+    ASSERT_EQ(history.size(), 2u);
+    EXPECT_EQ(history.find("File=\"C:\\Bases\\Trade\";")->name, "Отдел продаж / Торговля");
+
+    // Restarting against the same file imports nothing
+    EXPECT_FALSE(importIbases(ibasesPath, history, state).fileChanged);
+}
+
+TEST_F(IbasesImporterTest, MissingFileTest) {
+    History history;
+    IbasesImportState state;
+    IbasesImportResult result = importIbases((workDir / "missing.v8i").string(), history, state);
+    EXPECT_FALSE(result.error.empty());
+    EXPECT_TRUE(history.empty());
+}
@@ -0,0 +1,213 @@
+#include <gtest/gtest.h>
+#include "launch_latency.h"
+#include "error_handler.h"
+#include "frame_arena.h"
+#include "history.h"
+#include "launcher.h"
+#include "process_spawner.h"
+#include "task_runtime.h"
+#include <cmath>
+#include <filesystem>
+#include <memory>
+#include <thread>
+
+#ifndef _WIN32
+#include <csignal>
+#include <cstdlib>
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+using namespace std::chrono_literals;
+
+class LaunchLatencyTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        ErrorHandler::setLogLevel(LogLevel::Warning);
+    }
+
+    void TearDown() override {
+        ErrorHandler::setLogLevel(LogLevel::Info);
+    }
+
+    // A launch of input whose phases take the given times
+    static LaunchTrace makeTrace(const std::string& input, std::chrono::milliseconds firstActivity,
+                                 std::chrono::milliseconds extract = 2ms, std::chrono::milliseconds validate = 1ms,
+                                 std::chrono::milliseconds start = 30ms) {
+        LaunchTrace trace;
+        trace.input = input;
+        trace.requested = LaunchTrace::Clock::now();
+        trace.extracted = trace.requested + extract;
+        trace.validated = trace.extracted + validate;
+        trace.spawned = trace.validated + start;
+        trace.firstActivity = trace.spawned + firstActivity;
+        return trace;
+    }
+
+    TaskRuntime runtime{1, 2};
+};
+
+TEST_F(LaunchLatencyTest, BucketsTest) {
+    EXPECT_EQ(LaunchLatencyTracker::bucketFor(100ms), 0u);
+    EXPECT_EQ(LaunchLatencyTracker::bucketFor(250ms), 0u);
+    EXPECT_EQ(LaunchLatencyTracker::bucketFor(300ms), 1u);
+    EXPECT_EQ(LaunchLatencyTracker::bucketFor(500ms), 2u);     // On a bound: counted in that bucket
+    EXPECT_EQ(LaunchLatencyTracker::bucketFor(1s), 4u);
+    EXPECT_EQ(LaunchLatencyTracker::bucketFor(1200ms), 5u);
+    EXPECT_EQ(LaunchLatencyTracker::bucketFor(1h), LaunchLatencyTracker::bucketCount - 1);
+    EXPECT_DOUBLE_EQ(LaunchLatencyTracker::bucketUpperSeconds(4), 1.0);
+    EXPECT_DOUBLE_EQ(LaunchLatencyTracker::bucketUpperSeconds(8), 4.0);
+}
+
+TEST_F(LaunchLatencyTest, QuantileTest) {
+    std::array<uint32_t, LaunchLatencyTracker::bucketCount> buckets{};
+    EXPECT_EQ(LaunchLatencyTracker::quantile(buckets, 0.5), 0.0);
+
+    // Everything in (2.83 s, 4 s]: the median is half-way on a log scale
+    buckets[8] = 10;
+    EXPECT_NEAR(LaunchLatencyTracker::quantile(buckets, 0.5), 4.0 / std::pow(2.0, 0.25), 1e-9);
+    EXPECT_NEAR(LaunchLatencyTracker::quantile(buckets, 1.0), 4.0, 1e-9);
+
+    // One slow launch in ten does not move the median
+    buckets[8] = 9;
+    buckets[14] = 1;
+    EXPECT_LT(LaunchLatencyTracker::quantile(buckets, 0.5), 4.0);
+    EXPECT_GT(LaunchLatencyTracker::quantile(buckets, 0.95), 8.0);
+}
+
+TEST_F(LaunchLatencyTest, SummaryNeedsSamplesTest) {
+    LaunchLatencyTracker tracker(runtime);
+    uint64_t key = historyKeyHash("C:\\Bases\\Trade");
+    FrameArena arena;
+
+    for (uint32_t i = 1; i < LaunchLatencyTracker::minSamples; ++i) {
+        tracker.record(makeTrace("C:\\Bases\\Trade", 3500ms));
+    }
+    EXPECT_FALSE(tracker.summary(key).has_value());
+    EXPECT_EQ(tracker.lookupTypical(key, arena), nullptr);
+
+    // Written differently, still the same base
+    tracker.record(makeTrace("c:\\bases\\trade\\", 3500ms));
+    auto summary = tracker.summary(key);
+    ASSERT_TRUE(summary.has_value());
+    EXPECT_EQ(summary->count, LaunchLatencyTracker::minSamples);
+    EXPECT_GT(summary->medianSeconds, 2.83);
+    EXPECT_LE(summary->medianSeconds, 4.0);
+    EXPECT_STREQ(tracker.lookupTypical(key, arena), "~3.4 s");
+    EXPECT_FALSE(tracker.summary(historyKeyHash("C:\\Bases\\Other")).has_value());
+}
+
+TEST_F(LaunchLatencyTest, OutlierLoggedWithPhasesTest) {
+    LaunchLatencyTracker tracker(runtime);
+    for (uint32_t i = 0; i < LaunchLatencyTracker::minSamples; ++i) {
+        tracker.record(makeTrace("C:\\Bases\\Trade", 2s));
+    }
+
+    testing::internal::CaptureStderr();
+    tracker.record(makeTrace("C:\\Bases\\Trade", 2500ms));
+    EXPECT_EQ(testing::internal::GetCapturedStderr(), "");
+
+    testing::internal::CaptureStderr();
+    tracker.record(makeTrace("C:\\Bases\\Trade", 9s, 4ms, 120ms, 1500ms));
+    std::string log = testing::internal::GetCapturedStderr();
+    EXPECT_NE(log.find("Slow launch of C:\\Bases\\Trade: 10.6 s, typical 2.4 s"), std::string::npos) << log;
+    EXPECT_NE(log.find("extract 4 ms, validate 120 ms, start 1.5 s, first activity 9.0 s"), std::string::npos) << log;
+}
+
+TEST_F(LaunchLatencyTest, OldSamplesFadeTest) {
+    LaunchLatencyTracker tracker(runtime);
+    uint64_t key = historyKeyHash("srvr=\"app\";ref=\"trade\";");
+    for (uint32_t i = 0; i < LaunchLatencyTracker::maxSamples; ++i) {
+        tracker.record(makeTrace("Srvr=\"app\";Ref=\"trade\";", 10s));
+    }
+    ErrorHandler::setLogLevel(LogLevel::None);
+    for (uint32_t i = 0; i < LaunchLatencyTracker::maxSamples; ++i) {
+        tracker.record(makeTrace("Srvr=\"app\";Ref=\"trade\";", 1s));
+    }
+
+    // Halved at every maxSamples, so the recent fast launches win
+    auto summary = tracker.summary(key);
+    ASSERT_TRUE(summary.has_value());
+    EXPECT_LE(summary->count, LaunchLatencyTracker::maxSamples);
+    EXPECT_LT(summary->medianSeconds, 1.5);
+}
+
+TEST_F(LaunchLatencyTest, SerializeRoundTripTest) {
+    LaunchLatencyTracker tracker(runtime);
+    for (auto latency : {800ms, 900ms, 1100ms, 1300ms, 7000ms}) {
+        tracker.record(makeTrace("ws=\"http://host/base|1\";", latency));
+    }
+    std::vector<std::string> lines = tracker.serialize();
+    ASSERT_EQ(lines.size(), 1u);
+    EXPECT_EQ(lines[0], "4:2,5:2,10:1|ws=\"http://host/base|1\";");
+
+    LaunchLatencyTracker restored(runtime);
+    restored.deserialize({lines[0], "garbage", "4:x|C:\\Bad", "99:1|C:\\Bad", "|C:\\Empty", "4:1|"});
+    EXPECT_EQ(restored.serialize(), lines);
+
+    uint64_t key = historyKeyHash("ws=\"http://host/base|1\";");
+    ASSERT_TRUE(restored.summary(key).has_value());
+    EXPECT_DOUBLE_EQ(restored.summary(key)->medianSeconds, tracker.summary(key)->medianSeconds);
+}
+
+#ifndef _WIN32
+
+TEST_F(LaunchLatencyTest, LauncherTracksFirstActivityTest) {
+    std::filesystem::path basePath = std::filesystem::absolute("test_launch_latency");
+    std::filesystem::create_directories(basePath);
+    std::string input = "File=\"" + basePath.string() + "\";";
+
+    auto tracker = std::make_shared<LaunchLatencyTracker>(runtime, 20ms, 10s);
+    RUN1C launcher(RUN1C_TEST_FIXTURES_DIR "/1cestart");
+    launcher.setLatencyTracker(tracker);
+
+    for (uint32_t i = 1; i < LaunchLatencyTracker::minSamples; ++i) {
+        tracker->record(makeTrace(input, 100ms));
+    }
+    EXPECT_FALSE(tracker->summary(historyKeyHash(input)).has_value());
+
+    // Busy starter: recorded once it burns CPU. It spins for most of a second,
+    // so a poll lands in the burst even when the machine is loaded
+    setenv("RUN1C_FAKE_STARTER_SPIN", "300000", 1);
+    ASSERT_TRUE(launcher.run(input, false));
+    tracker->waitIdle();
+    unsetenv("RUN1C_FAKE_STARTER_SPIN");
+    auto summary = tracker->summary(historyKeyHash(input));
+    ASSERT_TRUE(summary.has_value());
+    EXPECT_EQ(summary->count, LaunchLatencyTracker::minSamples);
+    EXPECT_LT(summary->medianSeconds, 2.0);
+
+    // Starter that exits at once: nothing to record
+    ASSERT_TRUE(launcher.run(input, false));
+    tracker->waitIdle();
+    EXPECT_EQ(tracker->summary(historyKeyHash(input))->count, LaunchLatencyTracker::minSamples);
+
+    ASSERT_TRUE(ProcessSpawner::instance().waitAll(std::chrono::seconds(10)));
+    std::filesystem::remove_all(basePath);
+}
+
+// Destroying the tracker ends the poll task without waiting for the watch to time out
+TEST_F(LaunchLatencyTest, StopWhileWatchingTest) {
+    pid_t idle = fork();
+    if (idle == 0) {
+        pause();
+        _exit(0);
+    }
+    ASSERT_GT(idle, 0);
+
+    auto start = std::chrono::steady_clock::now();
+    {
+        LaunchLatencyTracker tracker(runtime, 20ms, 60s);
+        LaunchTrace trace = makeTrace("C:\\Bases\\Idle", 0ms);
+        trace.pid = idle;
+        tracker.watch(trace);
+        std::this_thread::sleep_for(100ms);
+        EXPECT_FALSE(tracker.summary(historyKeyHash(trace.input)).has_value());
+    }
+    EXPECT_LT(std::chrono::steady_clock::now() - start, 5s);
+
+    kill(idle, SIGKILL);
+    waitpid(idle, nullptr, 0);
+}
+
+#endif
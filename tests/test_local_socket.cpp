@@ -0,0 +1,89 @@
+#include <gtest/gtest.h>
+#include "local_socket.h"
+#include <cstring>
+#include <filesystem>
+#include <string>
+
+#ifndef _WIN32
+
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+class LocalSocketTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        path = (std::filesystem::temp_directory_path() / ("run1c-local-" + std::to_string(getpid()) + ".sock")).string();
+        std::filesystem::remove(path);
+    }
+
+    void TearDown() override {
+        std::filesystem::remove(path);
+        std::filesystem::remove(LocalSocketListener::lockPath(path));
+    }
+
+    // A socket file left behind by a process that died while listening
+    void leaveStaleSocket() {
+        sockaddr_un address = {};
+        address.sun_family = AF_UNIX;
+        std::memcpy(address.sun_path, path.c_str(), path.size() + 1);
+        int socket = ::socket(AF_UNIX, SOCK_STREAM, 0);
+        ASSERT_EQ(::bind(socket, reinterpret_cast<sockaddr*>(&address), sizeof(address)), 0);
+        ::close(socket);
+    }
+
+    std::string path;
+};
+
+TEST_F(LocalSocketTest, ListensOwnerOnlyTest) {
+    LocalSocketListener listener;
+    ASSERT_EQ(listener.listen(path), LocalSocketListener::Result::Listening);
+    EXPECT_TRUE(listener.isListening());
+
+    struct stat status = {};
+    ASSERT_EQ(::stat(path.c_str(), &status), 0);
+    EXPECT_TRUE(S_ISSOCK(status.st_mode));
+    EXPECT_EQ(status.st_mode & 0777, static_cast<mode_t>(S_IRUSR | S_IWUSR));
+
+    // The socket file goes with the listener
+    listener.close();
+    EXPECT_FALSE(std::filesystem::exists(path));
+    EXPECT_FALSE(listener.isListening());
+}
+
+TEST_F(LocalSocketTest, StaleSocketReplacedTest) {
+    leaveStaleSocket();
+    LocalSocketListener listener;
+    EXPECT_EQ(listener.listen(path), LocalSocketListener::Result::Listening);
+}
+
+TEST_F(LocalSocketTest, LockHolderOwnsPathTest) {
+    LocalSocketListener first;
+    ASSERT_EQ(first.listen(path), LocalSocketListener::Result::Listening);
+    LocalSocketListener second;
+    EXPECT_EQ(second.listen(path), LocalSocketListener::Result::Busy);
+    EXPECT_TRUE(std::filesystem::exists(path));
+    first.close();
+
+    // A process starting up holds the lock before binding: its stale file is not touched by others
+    leaveStaleSocket();
+    int lock = ::open(LocalSocketListener::lockPath(path).c_str(), O_RDWR | O_CREAT, 0600);
+    ASSERT_EQ(::flock(lock, LOCK_EX), 0);
+    EXPECT_EQ(second.listen(path), LocalSocketListener::Result::Busy);
+    EXPECT_TRUE(std::filesystem::exists(path));
+    ::close(lock);
+    EXPECT_EQ(second.listen(path), LocalSocketListener::Result::Listening);
+}
+
+TEST_F(LocalSocketTest, PathTooLongTest) {
+    LocalSocketListener listener;
+    std::string error;
+    EXPECT_EQ(listener.listen(std::string(200, 'x'), &error), LocalSocketListener::Result::Failed);
+    EXPECT_FALSE(error.empty());
+    EXPECT_FALSE(listener.isListening());
+}
+
+#endif
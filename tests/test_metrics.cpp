@@ -0,0 +1,216 @@
+#include <gtest/gtest.h>
+#include "metrics.h"
+#include "metrics_exporter.h"
+#include "task_runtime.h"
+#include <chrono>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+#ifndef _WIN32
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+using namespace std::chrono_literals;
+
+class MetricsTest : public ::testing::Test {
+protected:
+    static bool contains(const std::string& text, const std::string& line) {
+        return text.find(line + "\n") != std::string::npos;
+    }
+
+    static std::string readFile(const std::filesystem::path& path) {
+        std::ifstream in(path);
+        std::stringstream content;
+        content << in.rdbuf();
+        return content.str();
+    }
+
+    TaskRuntime runtime{1, 1};
+};
+
+TEST_F(MetricsTest, CounterSumsThreadsTest) {
+    MetricsRegistry registry;
+    Counter counter = registry.counter("test_events_total", "Events");
+    counter.add();
+    counter.add(4);
+
+    // Threads that exit keep their counts, and their blocks go to the next threads
+    for (int round = 0; round < 3; ++round) {
+        std::vector<std::thread> threads;
+        for (int t = 0; t < 4; ++t) {
+            threads.emplace_back([counter] {
+                for (int i = 0; i < 1000; ++i) {
+                    counter.add();
+                }
+            });
+        }
+        for (auto& thread : threads) {
+            thread.join();
+        }
+    }
+    EXPECT_EQ(counter.value(), 12005u);
+
+    // A default handle records nothing
+    Counter none;
+    none.add();
+    EXPECT_EQ(none.value(), 0u);
+}
+
+TEST_F(MetricsTest, RegistrationIsIdempotentTest) {
+    MetricsRegistry registry;
+    Counter first = registry.counter("test_launches_total", "Launches", "mode=\"config\"");
+    Counter again = registry.counter("test_launches_total", "Launches", "mode=\"config\"");
+    Counter other = registry.counter("test_launches_total", "Launches", "mode=\"enterprise\"");
+    first.add();
+    again.add();
+    other.add();
+    EXPECT_EQ(first.value(), 2u);
+    EXPECT_EQ(other.value(), 1u);
+}
+
+TEST_F(MetricsTest, RegistryFullThrowsTest) {
+    MetricsRegistry registry;
+    for (uint32_t i = 0; i + Histogram::slotCount <= MetricsRegistry::maxSlots; i += Histogram::slotCount) {
+        registry.histogram("test_h" + std::to_string(i), "Filler");
+    }
+    EXPECT_THROW(registry.histogram("test_overflow", "Over"), std::length_error);
+}
+
+TEST_F(MetricsTest, HistogramBucketsTest) {
+    MetricsRegistry registry;
+    Histogram histogram = registry.histogram("test_duration_seconds", "Durations");
+    histogram.observe(5us);
+    histogram.observe(10us);      // On a bound: counted in that bucket
+    histogram.observe(2ms);
+    histogram.observe(30s);
+    histogram.observe(-1ms);      // Clock went backwards: zero
+
+    EXPECT_EQ(histogram.count(), 5u);
+    EXPECT_EQ(histogram.sum(), 5us + 10us + 2ms + 30s);
+
+    std::string text = registry.exportText();
+    EXPECT_TRUE(contains(text, "# TYPE test_duration_seconds histogram"));
+    EXPECT_TRUE(contains(text, "test_duration_seconds_bucket{le=\"1e-05\"} 3"));
+    EXPECT_TRUE(contains(text, "test_duration_seconds_bucket{le=\"0.001\"} 3"));
+    EXPECT_TRUE(contains(text, "test_duration_seconds_bucket{le=\"0.005\"} 4"));
+    EXPECT_TRUE(contains(text, "test_duration_seconds_bucket{le=\"5\"} 4"));
+    EXPECT_TRUE(contains(text, "test_duration_seconds_bucket{le=\"+Inf\"} 5"));
+    EXPECT_TRUE(contains(text, "test_duration_seconds_sum 30.002015"));
+    EXPECT_TRUE(contains(text, "test_duration_seconds_count 5"));
+}
+
+TEST_F(MetricsTest, ExportFormatTest) {
+    MetricsRegistry registry;
+    Counter config = registry.counter("test_launches_total", "Launches by mode", "mode=\"config\"");
+    Gauge ratio = registry.gauge("test_idle_ratio", "Idle share");
+    Counter enterprise = registry.counter("test_launches_total", "Launches by mode", "mode=\"enterprise\"");
+    Histogram labelled = registry.histogram("test_save_seconds", "Saves", "kind=\"full\"");
+    config.add(2);
+    enterprise.add(7);
+    ratio.set(0.25);
+    labelled.observe(1ms);
+
+    std::string text = registry.exportText();
+    EXPECT_EQ(ratio.value(), 0.25);
+
+    // Labels of one name are grouped under a single HELP and TYPE
+    std::string expected =
+        "# HELP test_launches_total Launches by mode\n"
+        "# TYPE test_launches_total counter\n"
+        "test_launches_total{mode=\"config\"} 2\n"
+        "test_launches_total{mode=\"enterprise\"} 7\n"
+        "# HELP test_idle_ratio Idle share\n"
+        "# TYPE test_idle_ratio gauge\n"
+        "test_idle_ratio 0.25\n";
+    EXPECT_EQ(text.substr(0, expected.size()), expected);
+    EXPECT_TRUE(contains(text, "test_save_seconds_bucket{kind=\"full\",le=\"0.001\"} 1"));
+    EXPECT_TRUE(contains(text, "test_save_seconds_count{kind=\"full\"} 1"));
+}
+
+TEST_F(MetricsTest, LauncherMetricsTest) {
+    const LauncherMetrics& metrics = LauncherMetrics::get();
+    uint64_t before = metrics.error(ErrorType::InvalidPath).value();
+    ErrorHandler::setLogLevel(LogLevel::None);
+    ErrorHandler::logError(ErrorType::InvalidPath, "counted while hidden");
+    ErrorHandler::setLogLevel(LogLevel::Info);
+    EXPECT_EQ(metrics.error(ErrorType::InvalidPath).value(), before + 1);
+
+    std::string text = MetricsRegistry::global().exportText();
+    EXPECT_NE(text.find("run1c_launches_total{mode=\"enterprise\"}"), std::string::npos);
+    EXPECT_NE(text.find("run1c_errors_total{type=\"invalid_path\"}"), std::string::npos);
+    EXPECT_NE(text.find("# TYPE run1c_frame_seconds histogram"), std::string::npos);
+    EXPECT_NE(text.find("# TYPE run1c_frame_idle_ratio gauge"), std::string::npos);
+}
+
+TEST_F(MetricsTest, ExporterWritesFileTest) {
+    std::filesystem::path path = std::filesystem::temp_directory_path() / "run1c_test_metrics.prom";
+    std::filesystem::remove(path);
+
+    MetricsRegistry registry;
+    Counter counter = registry.counter("test_written_total", "Written");
+    counter.add(3);
+    {
+        MetricsExporter exporter(registry, runtime, path.string(), "", 50ms);
+        EXPECT_TRUE(exporter.start());
+        for (int attempt = 0; attempt < 100 && !std::filesystem::exists(path); ++attempt) {
+            std::this_thread::sleep_for(10ms);
+        }
+        ASSERT_TRUE(std::filesystem::exists(path));
+
+        // Rewritten every interval by the runtime's timer
+        counter.add(1);
+        for (int attempt = 0; attempt < 100 && !contains(readFile(path), "test_written_total 4"); ++attempt) {
+            std::this_thread::sleep_for(10ms);
+        }
+        EXPECT_TRUE(contains(readFile(path), "test_written_total 4"));
+        counter.add(1);
+    }
+
+    // Stopping writes the last values
+    EXPECT_TRUE(contains(readFile(path), "test_written_total 5"));
+    EXPECT_FALSE(std::filesystem::exists(path.string() + ".tmp"));
+    std::filesystem::remove(path);
+}
+
+#ifndef _WIN32
+TEST_F(MetricsTest, ExporterServesSocketTest) {
+    std::string endpoint = (std::filesystem::temp_directory_path() / "run1c_test_metrics.sock").string();
+    MetricsRegistry registry;
+    registry.counter("test_scraped_total", "Scraped").add(9);
+
+    MetricsExporter exporter(registry, runtime, "", endpoint);
+    ASSERT_TRUE(exporter.start());
+
+    // Two scrapes in a row, each read to EOF
+    for (int scrape = 0; scrape < 2; ++scrape) {
+        int client = ::socket(AF_UNIX, SOCK_STREAM, 0);
+        sockaddr_un address = {};
+        address.sun_family = AF_UNIX;
+        std::strncpy(address.sun_path, endpoint.c_str(), sizeof(address.sun_path) - 1);
+        ASSERT_EQ(::connect(client, reinterpret_cast<sockaddr*>(&address), sizeof(address)), 0);
+
+        std::string text;
+        char buffer[4096];
+        ssize_t n = 0;
+        while ((n = ::recv(client, buffer, sizeof(buffer), 0)) > 0) {
+            text.append(buffer, static_cast<size_t>(n));
+        }
+        ::close(client);
+        EXPECT_TRUE(contains(text, "test_scraped_total 9"));
+    }
+
+    // A second exporter does not take the endpoint over
+    MetricsExporter second(registry, runtime, "", endpoint);
+    EXPECT_FALSE(second.start());
+
+    exporter.stop();
+    EXPECT_FALSE(std::filesystem::exists(endpoint));
+    std::filesystem::remove(LocalSocketListener::lockPath(endpoint));
+}
+#endif
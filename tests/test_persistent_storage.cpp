@@ -0,0 +1,392 @@
+#include <gtest/gtest.h>
+#include "persistent_storage.h"
+#include "history.h"
+#include <algorithm>
+#include <filesystem>
+#include <fstream>
+#include <thread>
+
+class PersistentStorageTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        PersistentStorage::setVerbose(false);
+        storagePath = "test_persistent_storage.ini";
+        std::filesystem::remove(storagePath);
+    }
+
+    void TearDown() override {
+        std::filesystem::remove(storagePath);
+        PersistentStorage::setVerbose(true);
+    }
+
+    std::string storagePath;
+};
+
+TEST_F(PersistentStorageTest, CreatesFileTest) {
+    PersistentStorage storage(storagePath);
+    EXPECT_TRUE(std::filesystem::exists(storagePath));
+}
+
+TEST_F(PersistentStorageTest, SaveLoadRoundTripTest) {
+    {
+        PersistentStorage storage(storagePath);
+        storage.put("fontSize", std::string("18"));
+        storage.put(historyStorageKey, std::vector<std::string>{"C:\\Bases\\A", "C:\\Bases\\B"});
+        storage.save();
+    }
+
+    PersistentStorage storage(storagePath);
+    storage.load();
+    EXPECT_EQ(storage.getItem("fontSize"), "18");
+    EXPECT_EQ(storage.getArray(historyStorageKey), (std::vector<std::string>{"C:\\Bases\\A", "C:\\Bases\\B"}));
+    EXPECT_TRUE(storage.contains("fontSize"));
+    EXPECT_FALSE(storage.contains("missing"));
+    EXPECT_EQ(storage.getItem("missing"), "");
+
+    storage.remove("fontSize");
+    storage.remove("missing");
+    EXPECT_FALSE(storage.contains("fontSize"));
+}
+
+TEST_F(PersistentStorageTest, GetArrayRefCreatesArrayTest) {
+    PersistentStorage storage(storagePath);
+    std::vector<std::string>& history = storage.getArrayRef(historyStorageKey);
+    EXPECT_TRUE(history.empty());
+    history.push_back("C:\\Bases\\A");
+    EXPECT_EQ(storage.getArray(historyStorageKey).size(), 1u);
+}
+
+TEST_F(PersistentStorageTest, ViewAccessorsTest) {
+    {
+        PersistentStorage storage(storagePath);
+        storage.put("theme", std::string("dark"));
+        storage.put(historyStorageKey, std::vector<std::string>{"C:\\Bases\\A", "C:\\Bases\\B", "C:\\Bases\\A"});
+        storage.save();
+    }
+
+    PersistentStorage storage(storagePath);
+    storage.load();
+    EXPECT_EQ(storage.getItemView("theme"), "dark");
+    auto history = storage.getArrayView(historyStorageKey);
+    ASSERT_EQ(history.size(), 3u);
+    EXPECT_EQ(history[1], "C:\\Bases\\B");
+
+    // Equal strings are stored once
+    EXPECT_EQ(history[0].data(), history[2].data());
+    EXPECT_EQ(storage.arenaStats().strings, 3u);
+
+    // Wrong type or missing key gives an empty view
+    EXPECT_TRUE(storage.getItemView(historyStorageKey).empty());
+    EXPECT_TRUE(storage.getArrayView("theme").empty());
+    EXPECT_TRUE(storage.getArrayView("missing").empty());
+
+    // Changes made through getArrayRef() show in the views and are saved
+    storage.getArrayRef(historyStorageKey).push_back("C:\\Bases\\C");
+    ASSERT_EQ(storage.getArrayView(historyStorageKey).size(), 4u);
+    EXPECT_EQ(storage.getArrayView(historyStorageKey)[3], "C:\\Bases\\C");
+    storage.save();
+
+    PersistentStorage reloaded(storagePath);
+    reloaded.load();
+    EXPECT_EQ(reloaded.getArray(historyStorageKey).back(), "C:\\Bases\\C");
+}
+
+TEST_F(PersistentStorageTest, OwnedArrayReadInPlaceTest) {
+    PersistentStorage storage(storagePath);
+    std::vector<std::string>& owned = storage.getArrayRef(historyStorageKey);
+    for (int i = 0; i < 1000; ++i) {
+        owned.push_back("C:\\Bases\\" + std::to_string(i));
+    }
+
+    // The view reads the strings handed out, nothing is copied into the value
+    const PersistentStorage& reader = storage;
+    auto view = reader.getArrayView(historyStorageKey);
+    ASSERT_EQ(view.size(), 1000u);
+    EXPECT_EQ(view[999].data(), owned[999].data());
+    EXPECT_TRUE(std::equal(view.begin(), view.end(), owned.begin(), owned.end()));
+
+    // So const readers on several threads do not race on it
+    std::vector<std::thread> readers;
+    std::vector<size_t> counts(4);
+    for (size_t t = 0; t < counts.size(); ++t) {
+        readers.emplace_back([&reader, &counts, t] {
+            for (int round = 0; round < 100; ++round) {
+                for (std::string_view line : reader.getArrayView(historyStorageKey)) {
+                    counts[t] += line.size();
+                }
+            }
+        });
+    }
+    for (auto& thread : readers) {
+        thread.join();
+    }
+    EXPECT_EQ(counts[0], counts[3]);
+    EXPECT_GT(counts[0], 0u);
+}
+
+TEST_F(PersistentStorageTest, ReplacedValuesAreCompactedTest) {
+    PersistentStorage storage(storagePath);
+    std::vector<std::string_view> views;
+    std::vector<std::string> lines(1000);
+    for (int round = 0; round < 50; ++round) {
+        views.clear();
+        for (size_t i = 0; i < lines.size(); ++i) {
+            lines[i] = "round " + std::to_string(round) + " line " + std::to_string(i);
+            views.push_back(lines[i]);
+        }
+        storage.putArray(historyStorageKey, views);
+    }
+
+    // Only the last round is live; older rounds do not pile up
+    size_t liveBytes = 0;
+    for (const auto& line : lines) {
+        liveBytes += line.size();
+    }
+    EXPECT_LE(storage.arenaStats().usedBytes, 2 * liveBytes + 64 * 1024);
+    auto stored = storage.getArrayView(historyStorageKey);
+    EXPECT_TRUE(std::equal(stored.begin(), stored.end(), lines.begin(), lines.end()));
+}
+
+TEST_F(PersistentStorageTest, HistoryRecordLaunchTest) {
+    const int64_t day = 24 * 60 * 60;
+    int64_t now = 1760000000;
+    History history;
+
+    history.recordLaunch("A", false, now);
+    history.recordLaunch("B", true, now + 1);
+    const HistoryEntry& again = history.recordLaunch("A", true, now + 2);
+    EXPECT_EQ(again.input, "A");
+    EXPECT_EQ(again.launchCount, 2u);
+    EXPECT_EQ(again.enterpriseCount, 1u);
+    EXPECT_EQ(again.configCount, 1u);
+    EXPECT_EQ(again.lastLaunch, now + 2);
+    EXPECT_EQ(history.at(history.size() - 1).input, "A");
+
+    // A base used daily stays above a series of one-off bases opened after it
+    for (int i = 0; i < 10; ++i) {
+        history.recordLaunch("Daily", false, now + i * day);
+    }
+    for (int i = 0; i < 10; ++i) {
+        history.recordLaunch("OneOff" + std::to_string(i), false, now + 10 * day + i);
+    }
+    auto top = history.top(3);
+    ASSERT_EQ(top.size(), 3u);
+    EXPECT_EQ(top[0]->input, "Daily");
+    EXPECT_EQ(top[1]->input, "A");
+    EXPECT_EQ(top[2]->input, "OneOff9");
+
+    // Old launches decay: months later a single new launch wins
+    history.recordLaunch("Fresh", false, now + 120 * day);
+    EXPECT_EQ(history.top(1)[0]->input, "Fresh");
+    EXPECT_EQ(history.top(100).size(), history.size());
+}
+
+TEST_F(PersistentStorageTest, HistoryOrderMatchesFullSortTest) {
+    History history;
+    int64_t now = 1760000000;
+    for (int i = 0; i < 500; ++i) {
+        // Mix of repeated and new inputs with irregular gaps
+        history.recordLaunch("Base" + std::to_string((i * 7919) % 61), i % 3 == 0, now + (i * 104729) % 86400 + i * 3600);
+    }
+
+    std::vector<const HistoryEntry*> ordered = history.ordered();
+    std::vector<const HistoryEntry*> sorted = ordered;
+    std::stable_sort(sorted.begin(), sorted.end(), [](const HistoryEntry* a, const HistoryEntry* b) { return a->rank() < b->rank(); });
+    ASSERT_EQ(sorted.size(), history.size());
+    for (size_t i = 0; i < sorted.size(); ++i) {
+        EXPECT_EQ(sorted[i], ordered[i]);
+        EXPECT_EQ(&history.at(i), ordered[i]);
+        EXPECT_EQ(history.positionOf(*ordered[i]), i);
+    }
+}
+
+TEST_F(PersistentStorageTest, HistoryEntriesStayInPlaceTest) {
+    History history;
+    int64_t now = 1760000000;
+    const HistoryEntry& first = history.recordLaunch("A", false, now);
+    const HistoryEntry& second = history.recordLaunch("B", false, now + 1);
+    history.importEntries({{"Imported1", ""}, {"Imported2", ""}});
+
+    // Re-ranking moves the entry in the order, not in memory
+    EXPECT_EQ(&history.recordLaunch("A", false, now + 2), &first);
+    EXPECT_EQ(history.positionOf(first), 3u);
+    EXPECT_EQ(history.positionOf(second), 2u);
+    EXPECT_EQ(history.at(1).input, "Imported1");
+    EXPECT_EQ(history.at(0).input, "Imported2");
+
+    // Equal ranks: the later launch goes above
+    History tied;
+    tied.recordLaunch("X", false, now);
+    tied.recordLaunch("Y", false, now);
+    EXPECT_EQ(tied.top(1)[0]->input, "Y");
+    tied.recordLaunch("X", false, now);
+    tied.recordLaunch("Y", false, now);
+    EXPECT_EQ(tied.top(1)[0]->input, "Y");
+}
+
+TEST_F(PersistentStorageTest, HistoryEntryFormatTest) {
+    HistoryEntry entry;
+    entry.input = "File=\"C:\\My Bases\\Trade\";";
+    entry.launchCount = 5;
+    entry.enterpriseCount = 3;
+    entry.configCount = 1;
+    entry.lastLaunch = 1760000000;
+    entry.score = 2.5;
+    EXPECT_EQ(History::formatEntry(entry), "5 3 1 1760000000 2.5 File=\"C:\\My Bases\\Trade\";");
+
+    HistoryEntry parsed;
+    ASSERT_TRUE(History::parseEntry(History::formatEntry(entry), parsed));
+    EXPECT_EQ(parsed.input, entry.input);
+    EXPECT_EQ(parsed.launchCount, 5u);
+    EXPECT_EQ(parsed.enterpriseCount, 3u);
+    EXPECT_EQ(parsed.configCount, 1u);
+    EXPECT_EQ(parsed.lastLaunch, 1760000000);
+    EXPECT_DOUBLE_EQ(parsed.score, 2.5);
+
+    EXPECT_FALSE(History::parseEntry("C:\\Bases\\Trade", parsed));
+    EXPECT_FALSE(History::parseEntry("1 1 0 1760000000 1.0", parsed));
+    EXPECT_FALSE(History::parseEntry("x 0 0 1760000000 1.0 C:\\Bases\\Trade", parsed));
+    EXPECT_TRUE(History::parseEntry("1 1 0 1760000000 1.5e-05 C:\\Bases\\Trade", parsed));
+    EXPECT_DOUBLE_EQ(parsed.score, 1.5e-05);
+}
+
+TEST_F(PersistentStorageTest, HistoryLegacyMigrationTest) {
+    // Storage written by a version that kept a plain MRU list
+    {
+        std::ofstream file(storagePath);
+        file << "[array:basesHistory]\nC:\\Bases\\Old\nC:\\Bases\\Middle\nC:\\Bases\\Recent\n";
+    }
+
+    int64_t now = 1760000000;
+    PersistentStorage storage(storagePath);
+    storage.load();
+    History history;
+    history.load(storage, now);
+
+    ASSERT_EQ(history.size(), 3u);
+    EXPECT_EQ(history.at(0).input, "C:\\Bases\\Old");
+    EXPECT_EQ(history.at(2).input, "C:\\Bases\\Recent");
+    EXPECT_EQ(history.at(2).launchCount, 1u);
+
+    // A launch of the oldest entry counts twice now and moves it to the top
+    history.recordLaunch("C:\\Bases\\Old", false, now + 60);
+    history.save(storage);
+    storage.save();
+
+    PersistentStorage reloaded(storagePath);
+    reloaded.load();
+    // The legacy key stays readable by older versions, best entry last
+    EXPECT_EQ(reloaded.getArray(historyStorageKey), (std::vector<std::string>{"C:\\Bases\\Middle", "C:\\Bases\\Recent", "C:\\Bases\\Old"}));
+
+    // Entries an older version appended to the legacy list are picked up
+    std::vector<std::string> legacy = reloaded.getArray(historyStorageKey);
+    legacy.push_back("C:\\Bases\\AddedByOldVersion");
+    reloaded.put(historyStorageKey, legacy);
+
+    History migrated;
+    migrated.load(reloaded, now + 120);
+    ASSERT_EQ(migrated.size(), 4u);
+    const HistoryEntry* old = migrated.find("C:\\Bases\\Old");
+    ASSERT_NE(old, nullptr);
+    EXPECT_EQ(old->launchCount, 2u);
+    EXPECT_EQ(old->enterpriseCount, 1u);
+    EXPECT_NE(migrated.find("C:\\Bases\\AddedByOldVersion"), nullptr);
+}
+
+TEST_F(PersistentStorageTest, HistoryBaseKeyTest) {
+    uint64_t key = historyKeyHash("C:\\Bases\\Trade");
+    EXPECT_EQ(historyKeyHash("c:\\bases\\trade\\"), key);
+    EXPECT_EQ(historyKeyHash("\"C:\\Bases\\Trade\\1Cv8.1CD\""), key);
+    EXPECT_EQ(historyKeyHash("File=\"C:\\Bases\\Trade\";Usr=\"Admin\";"), key);
+    EXPECT_NE(historyKeyHash("C:\\Bases\\Trade2"), key);
+
+    EXPECT_EQ(historyBaseKey("Srvr=\"APP01\";Ref=\"Trade\";"), "srvr:app01\\trade");
+    EXPECT_EQ(historyBaseKey("ws=\"https://host/base/\";"), "ws:https://host/base");
+    EXPECT_EQ(historyBaseKey("  not a base "), "not a base");
+}
+
+TEST_F(PersistentStorageTest, HistoryRecordLaunchMergesSameBaseTest) {
+    History history;
+    history.recordLaunch("C:\\Bases\\Trade", false, 1760000000);
+    history.recordLaunch("File=\"c:\\bases\\trade\\\";", true, 1760000060);
+    history.recordLaunch("C:\\Bases\\Other", false, 1760000120);
+
+    ASSERT_EQ(history.size(), 2u);
+    const HistoryEntry* trade = history.find("c:\\bases\\trade\\1cv8.1cd");
+    ASSERT_NE(trade, nullptr);
+    EXPECT_EQ(trade->input, "C:\\Bases\\Trade");
+    EXPECT_EQ(trade->launchCount, 2u);
+    EXPECT_EQ(trade->configCount, 1u);
+    EXPECT_EQ(history.at(history.size() - 1).input, "C:\\Bases\\Trade");
+}
+
+TEST_F(PersistentStorageTest, HistoryKeyHashCollisionTest) {
+    // Two bases whose key hashes collide stay separate entries
+    const std::string first = "/b/7ede9095325934a2";
+    const std::string second = "/b/419a027e599eea11";
+    ASSERT_EQ(historyKeyHash(first), historyKeyHash(second));
+    ASSERT_NE(historyBaseKey(first), historyBaseKey(second));
+
+    History history;
+    history.recordLaunch(first, false, 1760000000);
+    history.recordLaunch(second, true, 1760000060);
+    history.recordLaunch(first, false, 1760000120);
+
+    ASSERT_EQ(history.size(), 2u);
+    const HistoryEntry* one = history.find(first);
+    const HistoryEntry* two = history.find(second);
+    ASSERT_NE(one, nullptr);
+    ASSERT_NE(two, nullptr);
+    EXPECT_EQ(one->input, first);
+    EXPECT_EQ(one->launchCount, 2u);
+    EXPECT_EQ(two->input, second);
+    EXPECT_EQ(two->launchCount, 1u);
+    EXPECT_EQ(two->configCount, 1u);
+    EXPECT_EQ(history.at(history.size() - 1).input, first);
+    EXPECT_EQ(history.find("/b/0000000000000000"), nullptr);
+
+    // Nor are they merged when loaded
+    PersistentStorage storage(storagePath);
+    history.save(storage);
+    History reloaded;
+    EXPECT_EQ(reloaded.load(storage, 1760000180), 0u);
+    ASSERT_EQ(reloaded.size(), 2u);
+    EXPECT_EQ(reloaded.find(second)->launchCount, 1u);
+    EXPECT_EQ(reloaded.find(first)->launchCount, 2u);
+}
+
+TEST_F(PersistentStorageTest, HistoryDuplicateMigrationTest) {
+    // Storage written while history compared inputs exactly
+    {
+        std::ofstream file(storagePath);
+        file << "[array:basesHistoryStats]\n"
+             << "1 1 0 1760000000 1 C:\\Bases\\Trade\n"
+             << "2 2 0 1760000100 2 D:\\Other\n"
+             << "3 1 2 1760000200 3 \"c:\\bases\\trade\\1Cv8.1CD\"\n"
+             << "[array:basesHistory]\n"
+             << "C:\\Bases\\Trade\nD:\\Other\n\"c:\\bases\\trade\\1Cv8.1CD\"\nc:/bases/trade/\n";
+    }
+
+    int64_t now = 1760000300;
+    PersistentStorage storage(storagePath);
+    storage.load();
+    History history;
+    EXPECT_EQ(history.load(storage, now), 2u);
+
+    ASSERT_EQ(history.size(), 2u);
+    const HistoryEntry* trade = history.find("C:\\Bases\\Trade");
+    ASSERT_NE(trade, nullptr);
+    // Launches of all three spellings are summed; the one an older version
+    // appended to the legacy list counts as launched now and is kept
+    EXPECT_EQ(trade->input, "c:/bases/trade/");
+    EXPECT_EQ(trade->launchCount, 5u);
+    EXPECT_EQ(trade->configCount, 2u);
+    EXPECT_EQ(trade->lastLaunch, now);
+    EXPECT_EQ(history.at(history.size() - 1).key, trade->key);
+
+    // Saved once, the collapsed list loads without merges
+    history.save(storage);
+    History reloaded;
+    EXPECT_EQ(reloaded.load(storage, now), 0u);
+    EXPECT_EQ(reloaded.size(), 2u);
+}
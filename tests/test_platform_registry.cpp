@@ -0,0 +1,197 @@
+#include <gtest/gtest.h>
+#include "platform_registry.h"
+#include "config.h"
+#include "error_handler.h"
+#include "launcher.h"
+#include "process_spawner.h"
+#include <filesystem>
+#include <fstream>
+#include <sstream>
+
+#ifndef _WIN32
+#include <cstdlib>
+#endif
+
+class PlatformRegistryTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        root = std::filesystem::absolute("test_platform_registry") / "1cv8";
+        std::filesystem::remove_all(root.parent_path());
+        std::filesystem::create_directories(root / "common");
+        ErrorHandler::setLogLevel(LogLevel::Warning);
+    }
+
+    void TearDown() override {
+        Config::clearOverrides();
+        ErrorHandler::setLogLevel(LogLevel::Info);
+        std::filesystem::remove_all(root.parent_path());
+    }
+
+    // <root>/<version>/bin/1cv8 (1cv8.exe on Windows), a copy of the stand-in starter
+    std::string install(const std::string& version) {
+        std::filesystem::path bin = root / version / "bin";
+        std::filesystem::create_directories(bin);
+#ifdef _WIN32
+        std::filesystem::path executable = bin / "1cv8.exe";
+        std::ofstream(executable).close();
+#else
+        std::filesystem::path executable = bin / "1cv8";
+        std::filesystem::copy_file(RUN1C_TEST_FIXTURES_DIR "/1cestart", executable);
+#endif
+        return executable.string();
+    }
+
+    // Directory listings change the root's mtime; moved on explicitly so coarse clocks still see it
+    void touchRoot(int seconds) {
+        std::filesystem::last_write_time(root, std::filesystem::last_write_time(root) + std::chrono::seconds(seconds));
+    }
+
+    static std::vector<std::string> versions(const PlatformRegistry& registry) {
+        std::vector<std::string> result;
+        for (const auto& install : registry.platforms()) {
+            result.push_back(install.version);
+        }
+        return result;
+    }
+
+    std::filesystem::path root;
+};
+
+TEST_F(PlatformRegistryTest, VersionsTest) {
+    EXPECT_LT(PlatformRegistry::compareVersions("8.3.9.2170", "8.3.10.2252"), 0);
+    EXPECT_GT(PlatformRegistry::compareVersions("8.3.24.1342", "8.3.24.1000"), 0);
+    EXPECT_EQ(PlatformRegistry::compareVersions("8.3", "8.3.0.0"), 0);
+
+    EXPECT_TRUE(PlatformRegistry::isVersionName("8.3.24.1342"));
+    EXPECT_FALSE(PlatformRegistry::isVersionName("common"));
+    EXPECT_FALSE(PlatformRegistry::isVersionName("8"));
+    EXPECT_FALSE(PlatformRegistry::isVersionName("8..3"));
+    EXPECT_FALSE(PlatformRegistry::isVersionName("8.3."));
+
+    EXPECT_TRUE(PlatformRegistry::matchesPrefix("8.3.24.1342", "8.3.24"));
+    EXPECT_TRUE(PlatformRegistry::matchesPrefix("8.3.24.1342", ""));
+    EXPECT_FALSE(PlatformRegistry::matchesPrefix("8.3.24.1342", "8.3.2"));
+    EXPECT_FALSE(PlatformRegistry::matchesPrefix("8.3", "8.3.24"));
+}
+
+TEST_F(PlatformRegistryTest, ScanFindsPlatformsTest) {
+    install("8.3.9.2170");
+    std::string newest = install("8.3.24.1342");
+    install("8.3.10.2252");
+    std::filesystem::create_directories(root / "8.3.25.1000");  // Installation without binaries yet
+    std::filesystem::create_directories(root / "conf");
+
+    PlatformRegistry registry({root.string(), (root / "missing").string()});
+    EXPECT_EQ(registry.refresh(), 2u);
+    EXPECT_EQ(versions(registry), (std::vector<std::string>{"8.3.24.1342", "8.3.10.2252", "8.3.9.2170"}));
+
+    ASSERT_TRUE(registry.select().has_value());
+    EXPECT_EQ(registry.select()->executable, newest);
+    EXPECT_EQ(registry.select("8.3.10")->version, "8.3.10.2252");
+    EXPECT_FALSE(registry.select("8.2").has_value());
+}
+
+TEST_F(PlatformRegistryTest, RefreshSkipsUnchangedRootsTest) {
+    install("8.3.23.1865");
+    PlatformRegistry registry({root.string()});
+    EXPECT_EQ(registry.refresh(), 1u);
+    EXPECT_EQ(registry.refresh(), 0u);
+
+    install("8.3.24.1342");
+    touchRoot(5);
+    EXPECT_EQ(registry.refresh(), 1u);
+    EXPECT_EQ(versions(registry), (std::vector<std::string>{"8.3.24.1342", "8.3.23.1865"}));
+
+    registry.invalidate();
+    EXPECT_TRUE(registry.platforms().empty());
+    EXPECT_EQ(registry.refresh(), 1u);
+    EXPECT_EQ(registry.platforms().size(), 2u);
+}
+
+TEST_F(PlatformRegistryTest, CacheRoundTripTest) {
+    install("8.3.23.1865");
+    install("8.3.24.1342");
+    PlatformRegistry registry({root.string()});
+    registry.refresh();
+    std::vector<std::string> lines = registry.serialize();
+    ASSERT_EQ(lines.size(), 3u);
+
+    // Cached entries are used as long as the root has not changed
+    PlatformRegistry restored({root.string()});
+    lines.push_back("exe|not-a-version|/nowhere");
+    lines.push_back("root|x|" + root.string());
+    restored.deserialize(lines);
+    EXPECT_EQ(versions(restored), versions(registry));
+    EXPECT_EQ(restored.refresh(), 0u);
+
+    // A root that is not configured any more is ignored
+    PlatformRegistry other({(root / "other").string()});
+    other.deserialize(registry.serialize());
+    EXPECT_TRUE(other.platforms().empty());
+}
+
+TEST_F(PlatformRegistryTest, PinsTest) {
+    install("8.3.22.2239");
+    install("8.3.24.1342");
+    PlatformRegistry registry({root.string()});
+    registry.refresh();
+
+    registry.setPin("File=\"C:\\Bases\\Trade\";", "8.3.22");
+    EXPECT_EQ(registry.resolve("C:\\Bases\\Trade")->version, "8.3.22.2239");
+    EXPECT_EQ(registry.resolve("C:\\Bases\\Other")->version, "8.3.24.1342");
+
+    registry.setPin("Srvr=\"app\";Ref=\"old\";", "8.2");
+    EXPECT_FALSE(registry.resolve("Srvr=\"app\";Ref=\"old\";").has_value());
+
+    PlatformRegistry restored({});
+    restored.deserializePins(registry.serializePins());
+    EXPECT_EQ(restored.pinFor("c:\\bases\\trade"), "8.3.22");
+    EXPECT_EQ(restored.serializePins(), registry.serializePins());
+
+    registry.setPin("C:\\Bases\\Trade", "");
+    EXPECT_EQ(registry.pinFor("C:\\Bases\\Trade"), "");
+    EXPECT_EQ(registry.serializePins(), (std::vector<std::string>{"8.2|Srvr=\"app\";Ref=\"old\";"}));
+}
+
+#ifndef _WIN32
+
+TEST_F(PlatformRegistryTest, LauncherStartsPlatformDirectlyTest) {
+    std::string platform = install("8.3.24.1342");
+    std::filesystem::path basePath = root.parent_path() / "base";
+    std::filesystem::create_directories(basePath);
+    std::string logPath = (root.parent_path() / "launch.log").string();
+    std::string input = "File=\"" + basePath.string() + "\";";
+
+    auto registry = std::make_shared<PlatformRegistry>(std::vector<std::string>{root.string()});
+    RUN1C launcher(RUN1C_TEST_FIXTURES_DIR "/1cestart");
+    launcher.setPlatformRegistry(registry);
+    auto plan = launcher.prepare(input);
+    ASSERT_TRUE(plan.has_value());
+
+    // Off by default: through the starter
+    EXPECT_EQ(launcher.programFor(input, *plan), launcher.getStarterPath());
+
+    ASSERT_TRUE(Config::set(ConfigKeys::directLaunch, true));
+    EXPECT_EQ(launcher.programFor(input, *plan), platform);
+
+    setenv("RUN1C_FAKE_STARTER_LOG", logPath.c_str(), 1);
+    ASSERT_TRUE(launcher.run(input, false));
+    ASSERT_TRUE(ProcessSpawner::instance().waitAll(std::chrono::seconds(10)));
+    unsetenv("RUN1C_FAKE_STARTER_LOG");
+
+    // 1cv8 takes the same arguments and runs in its own bin directory
+    std::ifstream log(logPath);
+    std::stringstream content;
+    content << log.rdbuf();
+    EXPECT_EQ(content.str(), "cwd=" + (root / "8.3.24.1342" / "bin").string() + "\narg=ENTERPRISE\narg=/F\narg=" + basePath.string() + "\n");
+
+    // A pin nothing matches, and a platform removed behind the cache, fall back to the starter
+    registry->setPin(input, "8.3.99");
+    EXPECT_EQ(launcher.programFor(input, *plan), launcher.getStarterPath());
+    registry->setPin(input, "");
+    std::filesystem::remove(platform);
+    EXPECT_EQ(launcher.programFor(input, *plan), launcher.getStarterPath());
+    EXPECT_TRUE(registry->platforms().empty());
+}
+
+#endif
@@ -0,0 +1,159 @@
+#include <gtest/gtest.h>
+#include "process_spawner.h"
+#include "error_handler.h"
+#include "launcher.h"
+#include <atomic>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+
+#ifdef _WIN32
+#include <Windows.h>
+#include <shellapi.h>
+#include "utils.h"
+#endif
+
+class ProcessSpawnerTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        ErrorHandler::setLogLevel(LogLevel::Warning);
+        workDir = std::filesystem::absolute("test_process_spawner");
+        std::filesystem::create_directories(workDir);
+        logPath = (workDir / "starter.log").string();
+    }
+
+    void TearDown() override {
+#ifndef _WIN32
+        unsetenv("RUN1C_FAKE_STARTER_LOG");
+        unsetenv("RUN1C_FAKE_STARTER_EXIT");
+#endif
+        std::filesystem::remove_all(workDir);
+        ErrorHandler::setLogLevel(LogLevel::Info);
+    }
+
+    // Lines written by the stand-in 1cestart
+    std::vector<std::string> readStarterLog() {
+        std::vector<std::string> lines;
+        std::ifstream log(logPath);
+        for (std::string line; std::getline(log, line);) {
+            lines.push_back(line);
+        }
+        return lines;
+    }
+
+    std::filesystem::path workDir;
+    std::string logPath;
+};
+
+TEST_F(ProcessSpawnerTest, QuoteWindowsArgumentTest) {
+    EXPECT_EQ(quoteWindowsArgument("ENTERPRISE"), "ENTERPRISE");
+    EXPECT_EQ(quoteWindowsArgument("C:\\Bases\\Trade"), "C:\\Bases\\Trade");
+    EXPECT_EQ(quoteWindowsArgument(""), "\"\"");
+    EXPECT_EQ(quoteWindowsArgument("C:\\My Bases\\Trade"), "\"C:\\My Bases\\Trade\"");
+    EXPECT_EQ(quoteWindowsArgument("say \"hi\""), "\"say \\\"hi\\\"\"");
+
+    // Backslashes are doubled only before a quote, including the closing one
+    EXPECT_EQ(quoteWindowsArgument("C:\\My Bases\\"), "\"C:\\My Bases\\\\\"");
+    EXPECT_EQ(quoteWindowsArgument("a\\\"b"), "\"a\\\\\\\"b\"");
+}
+
+TEST_F(ProcessSpawnerTest, BuildWindowsCommandLineTest) {
+    EXPECT_EQ(buildWindowsCommandLine("C:\\Program Files\\1cv8\\common\\1cestart.exe", {"CONFIG", "/F", "C:\\My Bases\\Trade"}),
+        "\"C:\\Program Files\\1cv8\\common\\1cestart.exe\" CONFIG /F \"C:\\My Bases\\Trade\"");
+}
+
+TEST_F(ProcessSpawnerTest, QuotePosixArgumentTest) {
+    EXPECT_EQ(quotePosixArgument("/opt/1cv8/common/1cestart"), "/opt/1cv8/common/1cestart");
+    EXPECT_EQ(quotePosixArgument(""), "''");
+    EXPECT_EQ(quotePosixArgument("/home/user/My Bases"), "'/home/user/My Bases'");
+    EXPECT_EQ(quotePosixArgument("it's"), "'it'\\''s'");
+}
+
+TEST_F(ProcessSpawnerTest, SpawnMissingProgramThrowsTest) {
+    EXPECT_THROW(ProcessSpawner::instance().spawn((workDir / "missing").string(), {}), std::runtime_error);
+    EXPECT_THROW(ProcessSpawner::instance().spawn("", {}), std::runtime_error);
+    EXPECT_NE(std::string(ProcessSpawner::instance().backendName()), "");
+}
+
+#ifdef _WIN32
+
+TEST_F(ProcessSpawnerTest, WindowsQuotingRoundTripTest) {
+    std::vector<std::string> args = {"CONFIG", "", "C:\\My Bases\\", "say \"hi\"", "a\\\\b", "tab\there"};
+    std::wstring commandLine = stringToWString(buildWindowsCommandLine("C:\\Program Files\\1cestart.exe", args));
+
+    int argc = 0;
+    LPWSTR* argv = CommandLineToArgvW(commandLine.c_str(), &argc);
+    ASSERT_NE(argv, nullptr);
+    ASSERT_EQ(argc, static_cast<int>(args.size()) + 1);
+    EXPECT_EQ(std::wstring(argv[0]), L"C:\\Program Files\\1cestart.exe");
+    for (size_t i = 0; i < args.size(); ++i) {
+        EXPECT_EQ(std::wstring(argv[i + 1]), stringToWString(args[i])) << args[i];
+    }
+    LocalFree(argv);
+}
+
+TEST_F(ProcessSpawnerTest, SpawnReportsExitCodeTest) {
+    std::atomic<int> exitCode{-1};
+    ProcessSpawner::instance().spawn(getEnvironmentVariable("ComSpec"), {"/c", "exit 3"},
+        [&exitCode](const ProcessExit& exit) { exitCode = exit.exitCode; });
+
+    ASSERT_TRUE(ProcessSpawner::instance().waitAll(std::chrono::seconds(10)));
+    EXPECT_EQ(exitCode.load(), 3);
+}
+
+#else
+
+TEST_F(ProcessSpawnerTest, SpawnStandInStarterTest) {
+    setenv("RUN1C_FAKE_STARTER_LOG", logPath.c_str(), 1);
+    setenv("RUN1C_FAKE_STARTER_EXIT", "3", 1);
+
+    std::atomic<int> exitCode{-1};
+    std::string starter = RUN1C_TEST_FIXTURES_DIR "/1cestart";
+    std::vector<std::string> args = {"CONFIG", "/F", "/home/user/My Bases/Торговля", "", "it's \"quoted\""};
+    int64_t pid = ProcessSpawner::instance().spawn(starter, args,
+        [&exitCode](const ProcessExit& exit) { exitCode = exit.exitCode; }, workDir.string());
+    EXPECT_GT(pid, 0);
+
+    ASSERT_TRUE(ProcessSpawner::instance().waitAll(std::chrono::seconds(10)));
+    EXPECT_EQ(exitCode.load(), 3);
+    EXPECT_EQ(ProcessSpawner::instance().runningCount(), 0u);
+
+    // Arguments arrive exactly as passed, no quoting involved
+    std::vector<std::string> expected = {"cwd=" + workDir.string()};
+    for (const auto& arg : args) {
+        expected.push_back("arg=" + arg);
+    }
+    EXPECT_EQ(readStarterLog(), expected);
+}
+
+TEST_F(ProcessSpawnerTest, ConcurrentSpawnsTest) {
+    setenv("RUN1C_FAKE_STARTER_LOG", logPath.c_str(), 1);
+
+    std::atomic<int> exits{0};
+    for (int i = 0; i < 20; ++i) {
+        ProcessSpawner::instance().spawn(RUN1C_TEST_FIXTURES_DIR "/1cestart", {std::to_string(i)},
+            [&exits](const ProcessExit& exit) { if (exit.exitCode == 0) ++exits; });
+    }
+
+    ASSERT_TRUE(ProcessSpawner::instance().waitAll(std::chrono::seconds(10)));
+    EXPECT_EQ(exits.load(), 20);
+    EXPECT_EQ(readStarterLog().size(), 40u);
+}
+
+TEST_F(ProcessSpawnerTest, LauncherEndToEndTest) {
+    setenv("RUN1C_FAKE_STARTER_LOG", logPath.c_str(), 1);
+    std::filesystem::create_directories(workDir / "My Base");
+
+    RUN1C launcher(RUN1C_TEST_FIXTURES_DIR "/1cestart");
+    std::string basePath = (workDir / "My Base").string();
+    ASSERT_TRUE(launcher.run("File=\"" + basePath + "\";", true));
+    ASSERT_TRUE(ProcessSpawner::instance().waitAll(std::chrono::seconds(10)));
+
+    std::vector<std::string> log = readStarterLog();
+    ASSERT_EQ(log.size(), 4u);
+    EXPECT_EQ(log[1], "arg=CONFIG");
+    EXPECT_EQ(log[2], "arg=/F");
+    EXPECT_EQ(log[3], "arg=" + basePath);
+}
+
+#endif
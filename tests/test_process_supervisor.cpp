@@ -0,0 +1,255 @@
+#include <gtest/gtest.h>
+#include "process_supervisor.h"
+#include "process_spawner.h"
+#include "error_handler.h"
+#include "launcher.h"
+#include <algorithm>
+#include <csignal>
+#include <filesystem>
+#include <thread>
+
+#ifdef _WIN32
+#include <Windows.h>
+#else
+#include <sys/wait.h>
+#include <unistd.h>
+#endif
+
+namespace {
+
+int64_t currentPid() {
+#ifdef _WIN32
+    return static_cast<int64_t>(GetCurrentProcessId());
+#else
+    return static_cast<int64_t>(getpid());
+#endif
+}
+
+const SupervisedProcess* findProcess(const ProcessSupervisor::Snapshot& snapshot, int64_t pid) {
+    auto it = std::find_if(snapshot->begin(), snapshot->end(), [pid](const SupervisedProcess& process) { return process.pid == pid; });
+    return it != snapshot->end() ? &*it : nullptr;
+}
+
+// No real process has a pid this large on either platform
+const int64_t missingPid = 0x7ffffff0;
+
+} // namespace
+
+class ProcessSupervisorTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        ErrorHandler::setLogLevel(LogLevel::Warning);
+    }
+
+    void TearDown() override {
+        ErrorHandler::setLogLevel(LogLevel::Info);
+    }
+};
+
+TEST_F(ProcessSupervisorTest, ParseProcStatTest) {
+    // Command names may contain spaces and parentheses
+    std::string stat = "4242 (1cv8 (copy) x) S 17 4242 4242 0 -1 4194560 900 0 0 0 250 50 0 0 20 0 12 0 100 123456789 2048 18446744073709551615";
+    ProcessStats stats;
+    ASSERT_TRUE(ProcessSupervisor::parseProcStat(stat, stats, 4096, 100));
+    EXPECT_EQ(stats.parentPid, 17);
+    EXPECT_EQ(stats.processGroup, 4242);
+    EXPECT_EQ(stats.cpuTimeNs, 3000000000ull);
+    EXPECT_EQ(stats.rssBytes, 2048ull * 4096);
+    EXPECT_FALSE(stats.exited);
+
+    std::string zombie = "4243 (1cestart) Z 17 4243 4243 0 -1 4194560 0 0 0 0 1 1 0 0 20 0 1 0 100 0 0 0";
+    ASSERT_TRUE(ProcessSupervisor::parseProcStat(zombie, stats));
+    EXPECT_TRUE(stats.exited);
+    EXPECT_EQ(stats.rssBytes, 0u);
+
+    EXPECT_FALSE(ProcessSupervisor::parseProcStat("4244 (truncated) S 1 2 3", stats));
+    EXPECT_FALSE(ProcessSupervisor::parseProcStat("", stats));
+}
+
+TEST_F(ProcessSupervisorTest, ParseProcIoTest) {
+    std::string io = "rchar: 1000\nwchar: 2000\nsyscr: 10\nsyscw: 20\nread_bytes: 40960\nwrite_bytes: 8192\ncancelled_write_bytes: 0\n";
+    ProcessStats stats;
+    ASSERT_TRUE(ProcessSupervisor::parseProcIo(io, stats));
+    EXPECT_EQ(stats.readBytes, 40960u);
+    EXPECT_EQ(stats.writeBytes, 8192u);
+
+    ProcessStats empty;
+    EXPECT_FALSE(ProcessSupervisor::parseProcIo("", empty));
+}
+
+TEST_F(ProcessSupervisorTest, SampleCurrentProcessTest) {
+    ProcessStats stats;
+    ASSERT_TRUE(ProcessSupervisor::readProcessStats(currentPid(), stats));
+    EXPECT_GT(stats.rssBytes, 0u);
+    EXPECT_FALSE(stats.exited);
+    EXPECT_FALSE(ProcessSupervisor::readProcessStats(missingPid, stats));
+
+    ProcessSupervisor supervisor(std::chrono::hours(1));
+    supervisor.track(currentPid(), "C:\\Bases\\Trade", "ENTERPRISE");
+    supervisor.sampleNow();
+    supervisor.sampleNow();
+
+    const SupervisedProcess* process = findProcess(supervisor.snapshot(), currentPid());
+    ASSERT_NE(process, nullptr);
+    EXPECT_EQ(process->state, SupervisedProcess::State::Running);
+    EXPECT_EQ(process->basePath, "C:\\Bases\\Trade");
+    EXPECT_EQ(process->mode, "ENTERPRISE");
+    EXPECT_GT(process->rssBytes, 0u);
+    EXPECT_GE(process->cpuPercent, 0.0);
+    EXPECT_GT(process->startTime, 0);
+
+    // Anything else is adopted from the test's process group (a pipe to grep, say)
+    ProcessSupervisor::Snapshot snapshot = supervisor.snapshot();
+    EXPECT_EQ(supervisor.runningCount(), static_cast<size_t>(std::count_if(snapshot->begin(), snapshot->end(),
+        [](const SupervisedProcess& other) { return other.pid == currentPid() || other.parentPid == currentPid(); })));
+}
+
+TEST_F(ProcessSupervisorTest, VanishedProcessIsExitedTest) {
+    ProcessSupervisor supervisor(std::chrono::hours(1));
+    supervisor.track(missingPid, "C:\\Bases\\Gone", "CONFIG");
+    EXPECT_EQ(supervisor.runningCount(), 1u);
+
+    supervisor.sampleNow();
+    const SupervisedProcess* process = findProcess(supervisor.snapshot(), missingPid);
+    ASSERT_NE(process, nullptr);
+    EXPECT_EQ(process->state, SupervisedProcess::State::Exited);
+    EXPECT_EQ(process->exitCode, -1);
+    EXPECT_EQ(supervisor.runningCount(), 0u);
+
+    // A late notification still supplies the exit code
+    supervisor.markExited(missingPid, 2);
+    EXPECT_EQ(findProcess(supervisor.snapshot(), missingPid)->exitCode, 2);
+}
+
+TEST_F(ProcessSupervisorTest, SnapshotIsStableAndOrderedTest) {
+    ProcessSupervisor supervisor(std::chrono::hours(1));
+    supervisor.track(missingPid, "first", "ENTERPRISE");
+    ProcessSupervisor::Snapshot before = supervisor.snapshot();
+
+    supervisor.track(currentPid(), "second", "ENTERPRISE");
+    supervisor.markExited(missingPid, 0);
+
+    // Earlier snapshots are never modified
+    ASSERT_EQ(before->size(), 1u);
+    EXPECT_EQ((*before)[0].state, SupervisedProcess::State::Running);
+
+    ProcessSupervisor::Snapshot after = supervisor.snapshot();
+    ASSERT_EQ(after->size(), 2u);
+    EXPECT_EQ((*after)[0].basePath, "second");
+    EXPECT_EQ((*after)[1].basePath, "first");
+}
+
+TEST_F(ProcessSupervisorTest, FinishedRetentionTest) {
+    ProcessSupervisor supervisor(std::chrono::hours(1));
+    size_t total = ProcessSupervisor::finishedRetention + 10;
+    for (size_t i = 0; i < total; ++i) {
+        supervisor.track(missingPid - static_cast<int64_t>(i), "base" + std::to_string(i), "ENTERPRISE");
+    }
+    supervisor.sampleNow();
+
+    ProcessSupervisor::Snapshot snapshot = supervisor.snapshot();
+    ASSERT_EQ(snapshot->size(), ProcessSupervisor::finishedRetention);
+    EXPECT_EQ(snapshot->front().basePath, "base" + std::to_string(total - 1));
+    EXPECT_EQ(snapshot->back().basePath, "base10");
+}
+
+TEST_F(ProcessSupervisorTest, ExitBeforeTrackTest) {
+    ProcessSupervisor supervisor(std::chrono::hours(1));
+    supervisor.markExited(missingPid, 5);
+    supervisor.track(missingPid, "C:\\Bases\\Quick", "ENTERPRISE");
+
+    const SupervisedProcess* process = findProcess(supervisor.snapshot(), missingPid);
+    ASSERT_NE(process, nullptr);
+    EXPECT_EQ(process->state, SupervisedProcess::State::Exited);
+    EXPECT_EQ(process->exitCode, 5);
+}
+
+#ifndef _WIN32
+
+TEST_F(ProcessSupervisorTest, LauncherReportsExitTest) {
+    std::filesystem::path basePath = std::filesystem::absolute("test_process_supervisor");
+    std::filesystem::create_directories(basePath);
+    setenv("RUN1C_FAKE_STARTER_EXIT", "4", 1);
+
+    auto supervisor = std::make_shared<ProcessSupervisor>(std::chrono::milliseconds(20));
+    RUN1C launcher(RUN1C_TEST_FIXTURES_DIR "/1cestart");
+    launcher.setSupervisor(supervisor);
+    ASSERT_TRUE(launcher.run("File=\"" + basePath.string() + "\";", false));
+    ASSERT_TRUE(ProcessSpawner::instance().waitAll(std::chrono::seconds(10)));
+    unsetenv("RUN1C_FAKE_STARTER_EXIT");
+
+    ProcessSupervisor::Snapshot snapshot = supervisor->snapshot();
+    ASSERT_FALSE(snapshot->empty());
+    const SupervisedProcess& starter = snapshot->front();
+    EXPECT_EQ(starter.state, SupervisedProcess::State::Exited);
+    EXPECT_EQ(starter.exitCode, 4);
+    EXPECT_EQ(starter.basePath, basePath.string());
+    EXPECT_EQ(starter.mode, "ENTERPRISE");
+
+    std::filesystem::remove_all(basePath);
+}
+
+TEST_F(ProcessSupervisorTest, AdoptsChildOfExitedStarterTest) {
+    std::filesystem::path basePath = std::filesystem::absolute("test_process_supervisor");
+    std::filesystem::create_directories(basePath);
+    setenv("RUN1C_FAKE_STARTER_CHILD", "5", 1);
+
+    // The starter exits before the first sample; its child is reparented, but stays in the launch's group
+    auto supervisor = std::make_shared<ProcessSupervisor>(std::chrono::milliseconds(200));
+    RUN1C launcher(RUN1C_TEST_FIXTURES_DIR "/1cestart");
+    launcher.setSupervisor(supervisor);
+    ASSERT_TRUE(launcher.run("File=\"" + basePath.string() + "\";", false));
+    ASSERT_TRUE(ProcessSpawner::instance().waitAll(std::chrono::seconds(10)));
+    unsetenv("RUN1C_FAKE_STARTER_CHILD");
+
+    const SupervisedProcess* child = nullptr;
+    ProcessSupervisor::Snapshot snapshot;
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (child == nullptr && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(std::chrono::milliseconds(50));
+        snapshot = supervisor->snapshot();
+        auto it = std::find_if(snapshot->begin(), snapshot->end(), [](const SupervisedProcess& process) { return process.parentPid != 0; });
+        child = it != snapshot->end() ? &*it : nullptr;
+    }
+    ASSERT_NE(child, nullptr);
+    EXPECT_EQ(child->state, SupervisedProcess::State::Running);
+    EXPECT_EQ(child->mode, "ENTERPRISE");
+    EXPECT_EQ(child->basePath, basePath.string());
+    const SupervisedProcess* starter = findProcess(snapshot, child->parentPid);
+    ASSERT_NE(starter, nullptr);
+    EXPECT_EQ(starter->state, SupervisedProcess::State::Exited);
+
+    kill(static_cast<pid_t>(child->pid), SIGTERM);
+    std::filesystem::remove_all(basePath);
+}
+
+TEST_F(ProcessSupervisorTest, AdoptsOnlyWithinGraceTest) {
+    ProcessSupervisor supervisor(std::chrono::hours(1), std::chrono::milliseconds(100));
+    supervisor.track(currentPid(), "C:\\Bases\\Trade", "ENTERPRISE");
+    supervisor.track(missingPid, "C:\\Bases\\Gone", "CONFIG");
+    std::this_thread::sleep_for(std::chrono::milliseconds(150));
+
+    pid_t child = fork();
+    ASSERT_GE(child, 0);
+    if (child == 0) {
+        pause();
+        _exit(0);
+    }
+
+    // Long after the launches only the tracked processes are sampled
+    supervisor.sampleNow();
+    EXPECT_EQ(findProcess(supervisor.snapshot(), child), nullptr);
+    EXPECT_NE(findProcess(supervisor.snapshot(), currentPid())->rssBytes, 0u);
+    EXPECT_EQ(findProcess(supervisor.snapshot(), missingPid)->state, SupervisedProcess::State::Exited);
+
+    // The vanished process opened the grace period again
+    supervisor.sampleNow();
+    const SupervisedProcess* adopted = findProcess(supervisor.snapshot(), child);
+    ASSERT_NE(adopted, nullptr);
+    EXPECT_EQ(adopted->parentPid, currentPid());
+
+    kill(child, SIGKILL);
+    waitpid(child, nullptr, 0);
+}
+
+#endif
@@ -0,0 +1,89 @@
+#include <gtest/gtest.h>
+#include "regex_cache.h"
+#include "utils.h"
+#include <thread>
+#include <vector>
+
+class RegexCacheTest : public ::testing::Test {
+};
+
+TEST_F(RegexCacheTest, HitsAndMissesTest) {
+    RegexCache cache(4);
+    RegexCache::Handle first = cache.get("\\d+");
+    RegexCache::Handle second = cache.get("\\d+");
+    EXPECT_EQ(first, second);
+
+    // Same text with other flags is another pattern
+    RegexCache::Handle icase = cache.get("\\d+", std::regex_constants::ECMAScript | std::regex_constants::icase);
+    EXPECT_NE(first, icase);
+
+    RegexCache::Stats stats = cache.stats();
+    EXPECT_EQ(stats.hits, 1u);
+    EXPECT_EQ(stats.misses, 2u);
+    EXPECT_EQ(stats.size, 2u);
+    EXPECT_TRUE(std::regex_match("123", *first));
+}
+
+TEST_F(RegexCacheTest, EvictsLeastRecentlyUsedTest) {
+    RegexCache cache(2);
+    RegexCache::Handle a = cache.get("a");
+    cache.get("b");
+    cache.get("a");         // b is now the least recently used
+    cache.get("c");
+
+    RegexCache::Stats stats = cache.stats();
+    EXPECT_EQ(stats.evictions, 1u);
+    EXPECT_EQ(stats.size, 2u);
+
+    EXPECT_EQ(cache.get("a"), a);
+    cache.get("b");
+    EXPECT_EQ(cache.stats().misses, 4u);
+
+    // Evicted handles stay usable
+    cache.clear();
+    EXPECT_TRUE(std::regex_match("a", *a));
+    EXPECT_EQ(cache.stats().size, 0u);
+}
+
+TEST_F(RegexCacheTest, InvalidPatternTest) {
+    RegexCache cache;
+    EXPECT_THROW(cache.get("(unclosed"), std::regex_error);
+    EXPECT_EQ(cache.stats().size, 0u);
+    EXPECT_THROW(cache.get("(unclosed"), std::regex_error);
+}
+
+TEST_F(RegexCacheTest, ConcurrentAccessTest) {
+    RegexCache cache(8);
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 4; ++t) {
+        threads.emplace_back([&cache, t]() {
+            for (int i = 0; i < 500; ++i) {
+                std::string pattern = "base" + std::to_string((i + t) % 12) + "\\d*";
+                EXPECT_TRUE(std::regex_match("base" + std::to_string((i + t) % 12) + "42", *cache.get(pattern)));
+            }
+        });
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    RegexCache::Stats stats = cache.stats();
+    EXPECT_EQ(stats.hits + stats.misses, 2000u);
+    EXPECT_LE(stats.size, 8u);
+}
+
+TEST_F(RegexCacheTest, ReplaceWithRegexUsesGlobalCacheTest) {
+    RegexCache::global().clear();
+    std::string text = "C:\\Bases\\Trade";
+    replaceWithRegex(text, "\\\\", "/");
+    replaceWithRegex(text, "\\\\", "/");
+    EXPECT_EQ(text, "C:/Bases/Trade");
+
+    RegexCache::Stats stats = RegexCache::global().stats();
+    EXPECT_EQ(stats.misses, 1u);
+    EXPECT_EQ(stats.hits, 1u);
+
+    std::regex precompiled("Trade");
+    replaceWithRegex(text, precompiled, "Торговля");
+    EXPECT_EQ(text, "C:/Bases/Торговля");
+}
@@ -0,0 +1,254 @@
+#include <gtest/gtest.h>
+#include "server_health.h"
+#include "error_handler.h"
+#include "frame_arena.h"
+#include "history.h"
+#include "task_runtime.h"
+#include <memory>
+#include <thread>
+#include <vector>
+
+#ifndef _WIN32
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+using namespace std::chrono_literals;
+
+class ServerHealthTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+        ErrorHandler::setLogLevel(LogLevel::Warning);
+    }
+
+    void TearDown() override {
+        ErrorHandler::setLogLevel(LogLevel::Info);
+    }
+
+    static std::string serverBase(const std::string& server) {
+        return "Srvr=\"" + server + "\";Ref=\"trade\";";
+    }
+
+    TaskRuntime runtime{1, 1};
+};
+
+TEST_F(ServerHealthTest, ParseEndpointsTest) {
+    auto endpoints = ServerHealthProber::parseEndpoints("App1");
+    ASSERT_EQ(endpoints.size(), 1u);
+    EXPECT_EQ(endpoints[0].host, "App1");
+    EXPECT_EQ(endpoints[0].port, ServerHealthProber::defaultPort);
+    EXPECT_EQ(endpoints[0].name(), "app1:1541");
+
+    endpoints = ServerHealthProber::parseEndpoints("tcp://app1:2541, app2;[fe80::1]:1741,::1");
+    ASSERT_EQ(endpoints.size(), 4u);
+    EXPECT_EQ(endpoints[0].name(), "app1:2541");
+    EXPECT_EQ(endpoints[1].name(), "app2:1541");
+    EXPECT_EQ(endpoints[2].host, "fe80::1");
+    EXPECT_EQ(endpoints[2].name(), "[fe80::1]:1741");
+    EXPECT_EQ(endpoints[3].name(), "[::1]:1541");
+
+    // Bad ports and empty items are skipped
+    EXPECT_TRUE(ServerHealthProber::parseEndpoints("").empty());
+    EXPECT_TRUE(ServerHealthProber::parseEndpoints("app:0,app:65536,app:x,:1541,[::1").empty());
+}
+
+TEST_F(ServerHealthTest, WatchesServerBasesOnlyTest) {
+    ServerHealthProber prober(runtime, 200ms);
+    EXPECT_FALSE(prober.watch("C:\\Bases\\Trade"));
+    EXPECT_FALSE(prober.watch("ws=\"http://host/base\";"));
+    EXPECT_FALSE(prober.watch("Srvr=\"\";Ref=\"trade\";"));
+    prober.waitIdle();
+    EXPECT_FALSE(prober.health(historyKeyHash("C:\\Bases\\Trade")).has_value());
+}
+
+TEST_F(ServerHealthTest, UnresolvableNameTest) {
+    ServerHealthProber prober(runtime, 300ms);
+    std::string base = serverBase("no-such-host.invalid");
+    auto started = std::chrono::steady_clock::now();
+    ASSERT_TRUE(prober.watch(base));
+    prober.waitIdle();
+
+    // Fails with the resolver's error, or at the resolve timeout without network
+    auto health = prober.health(historyKeyHash(base));
+    ASSERT_TRUE(health.has_value());
+    EXPECT_EQ(health->state, ServerReachability::Unreachable);
+    EXPECT_FALSE(health->error.empty());
+    EXPECT_LT(std::chrono::steady_clock::now() - started, 3s);
+}
+
+#ifndef _WIN32
+
+namespace {
+
+// Loopback listener on a free port; with backlog 0 and a filled queue, further connects hang
+struct Listener {
+    int socket = -1;
+    uint16_t port = 0;
+
+    explicit Listener(int backlog = 16) {
+        socket = ::socket(AF_INET, SOCK_STREAM, 0);
+        sockaddr_in address = {};
+        address.sin_family = AF_INET;
+        address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        socklen_t length = sizeof(address);
+        ::bind(socket, reinterpret_cast<sockaddr*>(&address), sizeof(address));
+        ::listen(socket, backlog);
+        ::getsockname(socket, reinterpret_cast<sockaddr*>(&address), &length);
+        port = ntohs(address.sin_port);
+    }
+
+    ~Listener() { close(); }
+
+    void close() {
+        if (socket >= 0) {
+            ::close(socket);
+            socket = -1;
+        }
+    }
+
+    std::string endpoint() const { return "127.0.0.1:" + std::to_string(port); }
+};
+
+// A port nothing listens on
+uint16_t closedPort() {
+    Listener listener;
+    return listener.port;
+}
+
+} // namespace
+
+TEST_F(ServerHealthTest, ReachableAndRefusedTest) {
+    Listener listener;
+    std::string up = serverBase(listener.endpoint());
+    std::string down = serverBase("127.0.0.1:" + std::to_string(closedPort()));
+
+    ServerHealthProber prober(runtime, 1s);
+    ASSERT_TRUE(prober.watch(up));
+    ASSERT_TRUE(prober.watch(down));
+    prober.waitIdle();
+
+    auto health = prober.health(historyKeyHash(up));
+    ASSERT_TRUE(health.has_value());
+    EXPECT_EQ(health->state, ServerReachability::Reachable);
+    EXPECT_EQ(health->endpoint, listener.endpoint());
+    EXPECT_LT(health->connectTime, 1s);
+
+    health = prober.health(historyKeyHash(down));
+    ASSERT_TRUE(health.has_value());
+    EXPECT_EQ(health->state, ServerReachability::Unreachable);
+    EXPECT_NE(health->error.find("refused"), std::string::npos) << health->error;
+
+    FrameArena arena;
+    EXPECT_STREQ(prober.lookupStatus(historyKeyHash(down), arena), "offline");
+    EXPECT_EQ(std::string(prober.lookupStatus(historyKeyHash(up), arena)).rfind("online ", 0), 0u);
+}
+
+TEST_F(ServerHealthTest, AnyEndpointOfClusterTest) {
+    Listener listener;
+    std::string cluster = serverBase("127.0.0.1:" + std::to_string(closedPort()) + ",localhost:" + std::to_string(listener.port));
+
+    ServerHealthProber prober(runtime, 1s);
+    ASSERT_TRUE(prober.watch(cluster));
+    // Another base on the same cluster, written differently, shares the probes
+    ASSERT_TRUE(prober.watch("Srvr=\"LOCALHOST:" + std::to_string(listener.port) + "\";Ref=\"other\";"));
+    prober.waitIdle();
+
+    auto health = prober.health(historyKeyHash(cluster));
+    ASSERT_TRUE(health.has_value());
+    EXPECT_EQ(health->state, ServerReachability::Reachable);
+    EXPECT_EQ(health->endpoint, "localhost:" + std::to_string(listener.port));
+}
+
+TEST_F(ServerHealthTest, ConnectTimeoutTest) {
+    Listener listener(0);
+    // Fill the accept queue; the probe's SYN is then dropped and it never connects
+    std::vector<int> clients;
+    for (int i = 0; i < 4; ++i) {
+        int client = ::socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK, 0);
+        sockaddr_in address = {};
+        address.sin_family = AF_INET;
+        address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+        address.sin_port = htons(listener.port);
+        ::connect(client, reinterpret_cast<sockaddr*>(&address), sizeof(address));
+        clients.push_back(client);
+    }
+    std::this_thread::sleep_for(50ms);
+
+    // Many endpoints at once still take one timeout, not one each
+    ServerHealthProber prober(runtime, 300ms);
+    std::vector<std::string> refused;
+    for (int i = 0; i < 20; ++i) {
+        refused.push_back(serverBase("127.0.0." + std::to_string(2 + i) + ":" + std::to_string(closedPort())));
+    }
+    std::string hanging = serverBase(listener.endpoint());
+    auto started = std::chrono::steady_clock::now();
+    ASSERT_TRUE(prober.watch(hanging));
+    for (const auto& base : refused) {
+        ASSERT_TRUE(prober.watch(base));
+    }
+    prober.waitIdle();
+    EXPECT_LT(std::chrono::steady_clock::now() - started, 3s);
+
+    auto health = prober.health(historyKeyHash(hanging));
+    ASSERT_TRUE(health.has_value());
+    EXPECT_EQ(health->state, ServerReachability::Unreachable);
+    EXPECT_EQ(health->error, "No answer within 300 ms");
+    for (const auto& base : refused) {
+        EXPECT_EQ(prober.health(historyKeyHash(base))->state, ServerReachability::Unreachable);
+    }
+
+    for (int client : clients) {
+        ::close(client);
+    }
+}
+
+TEST_F(ServerHealthTest, ProbedAgainAfterTtlTest) {
+    auto listener = std::make_unique<Listener>();
+    std::string base = serverBase(listener->endpoint());
+    ServerHealthProber prober(runtime, 500ms, 100ms);
+    ASSERT_TRUE(prober.watch(base));
+    prober.waitIdle();
+    ASSERT_EQ(prober.health(historyKeyHash(base))->state, ServerReachability::Reachable);
+
+    // The cached result stays until the next probe sees the server gone
+    listener.reset();
+    auto deadline = std::chrono::steady_clock::now() + 5s;
+    while (prober.health(historyKeyHash(base))->state == ServerReachability::Reachable
+           && std::chrono::steady_clock::now() < deadline) {
+        std::this_thread::sleep_for(20ms);
+    }
+    EXPECT_EQ(prober.health(historyKeyHash(base))->state, ServerReachability::Unreachable);
+}
+
+TEST_F(ServerHealthTest, NewEndpointWakesWaitingRoundTest) {
+    Listener first;
+    Listener second;
+    ServerHealthProber prober(runtime, 1s, 60s);
+    ASSERT_TRUE(prober.watch(serverBase(first.endpoint())));
+    prober.waitIdle();
+
+    // The round task waits a minute for the TTL; a new endpoint does not wait with it
+    auto started = std::chrono::steady_clock::now();
+    std::string base = serverBase(second.endpoint());
+    ASSERT_TRUE(prober.watch(base));
+    prober.waitIdle();
+    EXPECT_LT(std::chrono::steady_clock::now() - started, 2s);
+    EXPECT_EQ(prober.health(historyKeyHash(base))->state, ServerReachability::Reachable);
+}
+
+TEST_F(ServerHealthTest, RuntimeStopEndsRoundsTest) {
+    auto taskRuntime = std::make_unique<TaskRuntime>(1, 1);
+    Listener listener;
+    ServerHealthProber prober(*taskRuntime, 1s, 60s);
+    ASSERT_TRUE(prober.watch(serverBase(listener.endpoint())));
+    prober.waitIdle();
+
+    // The runtime goes first on shutdown; the prober is destroyed after it without hanging
+    auto started = std::chrono::steady_clock::now();
+    taskRuntime.reset();
+    EXPECT_LT(std::chrono::steady_clock::now() - started, 2s);
+}
+
+#endif
@@ -0,0 +1,246 @@
+#include <gtest/gtest.h>
+#include "single_instance.h"
+#include <chrono>
+#include <condition_variable>
+#include <cstdlib>
+#include <filesystem>
+#include <iostream>
+
+#ifdef _WIN32
+#include <Windows.h>
+#else
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <cstring>
+#endif
+
+namespace {
+
+const char* clientEndpointVariable = "RUN1C_TEST_INSTANCE_ENDPOINT";
+
+int64_t steadyNowNs() {
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// The forwarding side of the two-process test: sends its send time so the
+// server can measure delivery latency on the shared monotonic clock
+bool forwardTimestamp(const std::string& endpoint) {
+    return forwardToInstance(endpoint, {"--launch", "File=\"C:\\Bases\\Trade\";", std::to_string(steadyNowNs())});
+}
+
+} // namespace
+
+class SingleInstanceTest : public ::testing::Test {
+protected:
+    void SetUp() override {
+#ifdef _WIN32
+        endpoint = "\\\\.\\pipe\\run1c-test-" + std::to_string(GetCurrentProcessId());
+#else
+        endpoint = (std::filesystem::temp_directory_path() / ("run1c-test-" + std::to_string(getpid()) + ".sock")).string();
+#endif
+    }
+
+    // Waits for the listener thread to queue a request
+    std::vector<std::vector<std::string>> waitForRequests(InstanceServer& server, std::chrono::milliseconds timeout) {
+        auto deadline = std::chrono::steady_clock::now() + timeout;
+        std::unique_lock<std::mutex> lock(mutex);
+        while (true) {
+            auto requests = server.takeRequests();
+            if (!requests.empty() || !received.wait_until(lock, deadline, [this] { return notified; })) {
+                return requests;
+            }
+            notified = false;
+        }
+    }
+
+    InstanceServer::Notify makeNotify() {
+        return [this]() {
+            std::lock_guard<std::mutex> lock(mutex);
+            notified = true;
+            received.notify_all();
+        };
+    }
+
+    std::string endpoint;
+    std::mutex mutex;
+    std::condition_variable received;
+    bool notified = false;
+};
+
+TEST_F(SingleInstanceTest, MessageRoundTripTest) {
+    std::vector<std::string> args = {"--launch", "File=\"C:\\Базы\\Торговля\";", "", "--config"};
+    std::string message = encodeInstanceMessage(args);
+
+    std::vector<std::string> decoded;
+    ASSERT_TRUE(decodeInstanceMessage(message.substr(4), decoded));
+    EXPECT_EQ(decoded, args);
+
+    EXPECT_TRUE(decodeInstanceMessage(encodeInstanceMessage({}).substr(4), decoded));
+    EXPECT_TRUE(decoded.empty());
+}
+
+TEST_F(SingleInstanceTest, DecodeRejectsMalformedTest) {
+    std::string payload = encodeInstanceMessage({"--launch", "C:\\Bases\\Trade"}).substr(4);
+    std::vector<std::string> decoded;
+    EXPECT_FALSE(decodeInstanceMessage(payload.substr(0, payload.size() - 1), decoded));
+    EXPECT_FALSE(decodeInstanceMessage(payload + "x", decoded));
+    EXPECT_FALSE(decodeInstanceMessage("", decoded));
+}
+
+TEST_F(SingleInstanceTest, ForwardWithoutInstanceFailsTest) {
+    EXPECT_FALSE(forwardToInstance(endpoint, {}, 200));
+}
+
+TEST_F(SingleInstanceTest, ForwardToRunningInstanceTest) {
+    InstanceServer server(endpoint);
+    ASSERT_TRUE(server.start(makeNotify()));
+
+    // The endpoint belongs to the first instance
+    InstanceServer second(endpoint);
+    EXPECT_FALSE(second.start());
+
+    EXPECT_TRUE(forwardToInstance(endpoint, {}));
+    EXPECT_TRUE(forwardToInstance(endpoint, {"--launch", "C:\\Bases\\Trade", "--config"}));
+
+    std::vector<std::vector<std::string>> requests;
+    while (requests.size() < 2) {
+        auto batch = waitForRequests(server, std::chrono::seconds(5));
+        ASSERT_FALSE(batch.empty());
+        requests.insert(requests.end(), batch.begin(), batch.end());
+    }
+    EXPECT_TRUE(requests[0].empty());
+    EXPECT_EQ(requests[1], (std::vector<std::string>{"--launch", "C:\\Bases\\Trade", "--config"}));
+
+    server.stop();
+    EXPECT_FALSE(forwardToInstance(endpoint, {}, 200));
+
+    // Endpoint is free again after stop
+    EXPECT_TRUE(second.start());
+}
+
+#ifndef _WIN32
+
+namespace {
+
+int connectTo(const std::string& endpoint) {
+    sockaddr_un address = {};
+    address.sun_family = AF_UNIX;
+    std::memcpy(address.sun_path, endpoint.c_str(), endpoint.size() + 1);
+    int socket = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    if (::connect(socket, reinterpret_cast<sockaddr*>(&address), sizeof(address)) != 0) {
+        ::close(socket);
+        return -1;
+    }
+    return socket;
+}
+
+} // namespace
+
+TEST_F(SingleInstanceTest, OversizedMessageRejectedTest) {
+    InstanceServer server(endpoint);
+    ASSERT_TRUE(server.start(makeNotify()));
+
+    // A 4 GB size is refused before the listener allocates anything for it
+    int client = connectTo(endpoint);
+    ASSERT_GE(client, 0);
+    const unsigned char header[4] = {0xFF, 0xFF, 0xFF, 0xFF};
+    ASSERT_EQ(::write(client, header, sizeof(header)), 4);
+    char ack = 0;
+    EXPECT_EQ(::read(client, &ack, 1), 0);
+    ::close(client);
+
+    // The listener is still there for the next client
+    EXPECT_TRUE(forwardToInstance(endpoint, {"--launch", "C:\\Bases\\Trade"}));
+    auto requests = waitForRequests(server, std::chrono::seconds(5));
+    ASSERT_EQ(requests.size(), 1u);
+    EXPECT_EQ(requests[0], (std::vector<std::string>{"--launch", "C:\\Bases\\Trade"}));
+}
+
+TEST_F(SingleInstanceTest, HungInstanceTimesOutTest) {
+    // Connections are queued by the kernel but never answered
+    sockaddr_un address = {};
+    address.sun_family = AF_UNIX;
+    std::memcpy(address.sun_path, endpoint.c_str(), endpoint.size() + 1);
+    int listener = ::socket(AF_UNIX, SOCK_STREAM, 0);
+    ASSERT_EQ(::bind(listener, reinterpret_cast<sockaddr*>(&address), sizeof(address)), 0);
+    ASSERT_EQ(::listen(listener, 4), 0);
+
+    auto started = std::chrono::steady_clock::now();
+    EXPECT_FALSE(forwardToInstance(endpoint, {"--launch", "C:\\Bases\\Trade"}, 200));
+    EXPECT_LT(std::chrono::steady_clock::now() - started, std::chrono::seconds(2));
+
+    ::close(listener);
+    ::unlink(endpoint.c_str());
+}
+
+#endif
+
+// Runs in the child process of TwoProcessForwardingLatencyTest, skipped otherwise
+TEST_F(SingleInstanceTest, ForwardingClientProcess) {
+    const char* target = std::getenv(clientEndpointVariable);
+    if (target == nullptr) {
+        GTEST_SKIP() << "Only runs as the client of TwoProcessForwardingLatencyTest";
+    }
+    EXPECT_TRUE(forwardTimestamp(target));
+}
+
+TEST_F(SingleInstanceTest, TwoProcessForwardingLatencyTest) {
+    InstanceServer server(endpoint);
+    ASSERT_TRUE(server.start(makeNotify()));
+
+    const int rounds = 5;
+    int64_t totalLatencyNs = 0;
+    int64_t worstLatencyNs = 0;
+
+    for (int round = 0; round < rounds; ++round) {
+#ifdef _WIN32
+        wchar_t exePath[MAX_PATH];
+        GetModuleFileNameW(nullptr, exePath, MAX_PATH);
+        std::wstring commandLine = L"\"" + std::wstring(exePath) + L"\" --gtest_filter=SingleInstanceTest.ForwardingClientProcess";
+        SetEnvironmentVariableA(clientEndpointVariable, endpoint.c_str());
+
+        STARTUPINFOW startupInfo = {};
+        startupInfo.cb = sizeof(startupInfo);
+        PROCESS_INFORMATION processInfo = {};
+        ASSERT_TRUE(CreateProcessW(nullptr, commandLine.data(), nullptr, nullptr, FALSE, CREATE_NO_WINDOW, nullptr, nullptr, &startupInfo, &processInfo));
+        SetEnvironmentVariableA(clientEndpointVariable, nullptr);
+#else
+        pid_t child = fork();
+        ASSERT_GE(child, 0);
+        if (child == 0) {
+            _exit(forwardTimestamp(endpoint) ? 0 : 1);
+        }
+#endif
+
+        auto requests = waitForRequests(server, std::chrono::seconds(10));
+        int64_t receivedAt = steadyNowNs();
+
+#ifdef _WIN32
+        WaitForSingleObject(processInfo.hProcess, INFINITE);
+        DWORD exitCode = 1;
+        GetExitCodeProcess(processInfo.hProcess, &exitCode);
+        CloseHandle(processInfo.hProcess);
+        CloseHandle(processInfo.hThread);
+        EXPECT_EQ(exitCode, 0u);
+#else
+        int status = 0;
+        waitpid(child, &status, 0);
+        EXPECT_TRUE(WIFEXITED(status) && WEXITSTATUS(status) == 0);
+#endif
+
+        ASSERT_EQ(requests.size(), 1u);
+        ASSERT_EQ(requests[0].size(), 3u);
+        int64_t latencyNs = receivedAt - std::stoll(requests[0][2]);
+        totalLatencyNs += latencyNs;
+        worstLatencyNs = std::max(worstLatencyNs, latencyNs);
+    }
+
+    double averageMs = totalLatencyNs / 1e6 / rounds;
+    std::cout << "[ LATENCY  ] forward average " << averageMs << " ms, worst " << worstLatencyNs / 1e6 << " ms" << std::endl;
+    RecordProperty("forwardLatencyAverageUs", static_cast<int>(totalLatencyNs / 1000 / rounds));
+
+    // Forwarding must be far cheaper than starting SDL, OpenGL and fonts
+    EXPECT_LT(worstLatencyNs, 500'000'000);
+}
@@ -0,0 +1,58 @@
+#include <gtest/gtest.h>
+#include "string_arena.h"
+#include <string>
+#include <vector>
+
+class StringArenaTest : public ::testing::Test {
+};
+
+TEST_F(StringArenaTest, InternReturnsSameViewTest) {
+    StringArena arena;
+    std::string first = "File=\"C:\\Bases\\Trade\";";
+    std::string second = first;
+
+    std::string_view a = arena.intern(first);
+    std::string_view b = arena.intern(second);
+    EXPECT_EQ(a, first);
+    EXPECT_EQ(a.data(), b.data());
+    EXPECT_NE(a.data(), first.data());
+    EXPECT_NE(arena.intern("File=\"C:\\Bases\\Other\";").data(), a.data());
+
+    StringArena::Stats stats = arena.stats();
+    EXPECT_EQ(stats.strings, 2u);
+    EXPECT_EQ(stats.requests, 3u);
+    EXPECT_EQ(stats.usedBytes, first.size() * 2);
+    EXPECT_TRUE(arena.intern("").empty());
+}
+
+TEST_F(StringArenaTest, ViewsSurviveGrowthTest) {
+    // Small chunks and many strings, so chunks are added and the table rehashed
+    StringArena arena(256);
+    std::vector<std::string> inputs;
+    std::vector<std::string_view> views;
+    for (int i = 0; i < 5000; ++i) {
+        inputs.push_back("C:\\Bases\\Base" + std::to_string(i));
+        views.push_back(arena.intern(inputs.back()));
+    }
+    inputs.push_back(std::string(1000, 'x'));
+    views.push_back(arena.intern(inputs.back()));
+
+    StringArena moved = std::move(arena);
+    for (size_t i = 0; i < inputs.size(); ++i) {
+        ASSERT_EQ(views[i], inputs[i]);
+        ASSERT_EQ(moved.intern(inputs[i]).data(), views[i].data());
+    }
+    EXPECT_EQ(moved.stats().strings, inputs.size());
+    EXPECT_GT(moved.stats().chunks, 1u);
+}
+
+TEST_F(StringArenaTest, ClearTest) {
+    StringArena arena;
+    arena.intern("a");
+    arena.intern("b");
+    arena.clear();
+    EXPECT_EQ(arena.stats().strings, 0u);
+    EXPECT_EQ(arena.stats().reservedBytes, 0u);
+    EXPECT_EQ(arena.intern("a"), "a");
+    EXPECT_EQ(arena.stats().strings, 1u);
+}
@@ -0,0 +1,190 @@
+#include <gtest/gtest.h>
+#include "task_runtime.h"
+#include <atomic>
+#include <chrono>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+using namespace std::chrono_literals;
+
+class TaskRuntimeTest : public ::testing::Test {
+protected:
+    static Task<int> answer() {
+        co_return 42;
+    }
+
+    static Task<int> failing() {
+        throw std::runtime_error("no base");
+        co_return 0;
+    }
+};
+
+TEST_F(TaskRuntimeTest, ValuesAndExceptionsTest) {
+    EXPECT_EQ(blockingWait(answer()), 42);
+    EXPECT_THROW(blockingWait(failing()), std::runtime_error);
+
+    auto chained = []() -> Task<std::string> {
+        int value = co_await answer();
+        try {
+            co_await failing();
+        } catch (const std::runtime_error& e) {
+            co_return std::to_string(value) + " " + e.what();
+        }
+        co_return "";
+    };
+    EXPECT_EQ(blockingWait(chained()), "42 no base");
+}
+
+TEST_F(TaskRuntimeTest, SwitchesExecutorsTest) {
+    TaskRuntime runtime(2, 2);
+    std::thread::id caller = std::this_thread::get_id();
+    std::atomic<bool> finished{false};
+    std::thread::id ioThread;
+    std::thread::id uiThread;
+
+    auto task = [&]() -> Task<void> {
+        co_await runtime.io().schedule();
+        ioThread = std::this_thread::get_id();
+        co_await runtime.ui().schedule();
+        uiThread = std::this_thread::get_id();
+        finished = true;
+    };
+    runtime.spawn(task());
+
+    // The UI hop waits for the test thread, which plays the main loop here
+    for (int frame = 0; frame < 500 && !finished; ++frame) {
+        runtime.ui().drain();
+        std::this_thread::sleep_for(1ms);
+    }
+    ASSERT_TRUE(finished);
+    EXPECT_NE(ioThread, caller);
+    EXPECT_EQ(uiThread, caller);
+}
+
+TEST_F(TaskRuntimeTest, UiWakeAndDrainTest) {
+    TaskRuntime runtime(1, 1);
+    UiExecutor& ui = runtime.ui();
+    std::atomic<int> wakes{0};
+    ui.setWakeFunction([&wakes] { wakes.fetch_add(1); });
+
+    int resumed = 0;
+    auto hop = [&]() -> Task<void> {
+        co_await ui.schedule();
+        ++resumed;
+        co_await ui.schedule();     // Posted while draining: next frame
+        ++resumed;
+    };
+    runtime.spawn(hop());
+
+    EXPECT_EQ(wakes.load(), 1);
+    EXPECT_EQ(ui.pending(), 1u);
+    EXPECT_EQ(ui.drain(), 1u);
+    EXPECT_EQ(resumed, 1);
+    EXPECT_EQ(ui.drain(), 1u);
+    EXPECT_EQ(resumed, 2);
+    EXPECT_EQ(ui.drain(), 0u);
+}
+
+TEST_F(TaskRuntimeTest, FanOutIsStolenTest) {
+    TaskRuntime runtime(4, 1);
+    std::atomic<int> done{0};
+
+    // Everything is posted from one worker to its own deque; the others steal
+    auto leaf = [&]() -> Task<void> {
+        co_await runtime.cpu().schedule();
+        std::this_thread::sleep_for(1ms);
+        done.fetch_add(1);
+    };
+    auto root = [&]() -> Task<void> {
+        co_await runtime.cpu().schedule();
+        for (int i = 0; i < 200; ++i) {
+            runtime.spawn(leaf());
+        }
+    };
+    blockingWait(root());
+    runtime.cpu().waitIdle();
+
+    EXPECT_EQ(done.load(), 200);
+    EXPECT_GT(runtime.cpu().getStolenCount(), 0u);
+}
+
+TEST_F(TaskRuntimeTest, DelayAndTimeoutTest) {
+    TaskRuntime runtime(2, 1);
+
+    auto start = std::chrono::steady_clock::now();
+    blockingWait([&]() -> Task<void> { co_await runtime.delay(20ms); }());
+    EXPECT_GE(std::chrono::steady_clock::now() - start, 20ms);
+
+    // A timeout cancels a long delay well before it is due
+    CancellationSource timeout;
+    runtime.cancelAfter(timeout, 10ms);
+    start = std::chrono::steady_clock::now();
+    EXPECT_THROW(blockingWait([&]() -> Task<void> { co_await runtime.delay(10s, timeout.token()); }()), TaskCancelled);
+    EXPECT_LT(std::chrono::steady_clock::now() - start, 5s);
+
+    // Cancelled before the await starts
+    EXPECT_THROW(blockingWait([&]() -> Task<void> { co_await runtime.delay(10s, timeout.token()); }()), TaskCancelled);
+}
+
+// Cancellation racing the timer: each delay resumes exactly once, either way
+TEST_F(TaskRuntimeTest, DelayCancelRaceTest) {
+    TaskRuntime runtime(4, 1);
+    std::atomic<int> expired{0};
+    std::atomic<int> cancelled{0};
+    const int count = 500;
+
+    std::vector<CancellationSource> sources(count);
+    auto wait = [&](CancellationToken token) -> Task<void> {
+        try {
+            co_await runtime.delay(1ms, token);
+            expired.fetch_add(1);
+        } catch (const TaskCancelled&) {
+            cancelled.fetch_add(1);
+        }
+    };
+    for (int i = 0; i < count; ++i) {
+        runtime.spawn(wait(sources[i].token()));
+    }
+    std::thread canceller([&] {
+        for (auto& source : sources) {
+            source.cancel();
+        }
+    });
+    canceller.join();
+
+    for (int attempt = 0; attempt < 500 && expired + cancelled < count; ++attempt) {
+        std::this_thread::sleep_for(2ms);
+    }
+    runtime.cpu().waitIdle();
+    EXPECT_EQ(expired + cancelled, count);
+}
+
+TEST_F(TaskRuntimeTest, ShutdownFinishesWorkTest) {
+    std::atomic<int> done{0};
+    std::atomic<int> cancelled{0};
+    {
+        TaskRuntime runtime(2, 2);
+        auto work = [&]() -> Task<void> {
+            co_await runtime.io().schedule();
+            co_await runtime.cpu().schedule();
+            co_await runtime.ui().schedule();
+            done.fetch_add(1);
+        };
+        auto sleeper = [&]() -> Task<void> {
+            try {
+                co_await runtime.delay(1h);
+            } catch (const TaskCancelled&) {
+                cancelled.fetch_add(1);
+            }
+        };
+        for (int i = 0; i < 50; ++i) {
+            runtime.spawn(work());
+        }
+        runtime.spawn(sleeper());
+    }
+    // Pending timers were cancelled, the UI continuations ran on this thread
+    EXPECT_EQ(done.load(), 50);
+    EXPECT_EQ(cancelled.load(), 1);
+}
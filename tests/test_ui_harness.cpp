@@ -0,0 +1,90 @@
+#include <gtest/gtest.h>
+#include "main_window.h"
+#include "ui_harness.h"
+#include <string>
+
+class UiHarnessTest : public ::testing::Test {
+protected:
+    static std::string scriptPath(const std::string& name) {
+        return std::string(RUN1C_TEST_FIXTURES_DIR) + "/ui/" + name;
+    }
+
+    // Replays a recorded script against a fresh window with historySize bases
+    static void replayFixture(const std::string& name, size_t historySize) {
+        std::string error;
+        auto script = InputScript::load(scriptPath(name), &error);
+        ASSERT_TRUE(script.has_value()) << error;
+
+        UiHarness harness;
+        harness.fillHistory(historySize);
+        UiHarness::ReplayResult result = harness.replay(*script);
+        for (const auto& failure : result.failures) {
+            ADD_FAILURE() << name << " with " << historySize << " bases, " << failure;
+        }
+        EXPECT_FALSE(result.frameCpuNs.empty());
+    }
+};
+
+TEST_F(UiHarnessTest, ParseScriptTest) {
+    std::string error;
+    auto script = InputScript::parse("# comment\r\n\ntype abc def\nkey Shift+Enter\nkey F\nframes 3\nexpect input\nexpect launches 2\n", &error);
+    ASSERT_TRUE(script.has_value()) << error;
+    const auto& steps = script->getSteps();
+    ASSERT_EQ(steps.size(), 6u);
+    EXPECT_EQ(steps[0].action, InputStep::Action::Type);
+    EXPECT_EQ(steps[0].text, "abc def");
+    EXPECT_EQ(steps[0].line, 3);
+    EXPECT_EQ(steps[1].action, InputStep::Action::Key);
+    EXPECT_NE(steps[1].modifiers, 0);
+    EXPECT_EQ(steps[2].modifiers, 0);
+    EXPECT_EQ(steps[3].frames, 3);
+    EXPECT_EQ(steps[4].check, InputStep::Check::Input);
+    EXPECT_EQ(steps[4].text, "");
+    EXPECT_EQ(steps[5].check, InputStep::Check::Launches);
+
+    EXPECT_FALSE(InputScript::parse("frames 1\nkey Hyper+Q\n", &error).has_value());
+    EXPECT_EQ(error, "line 2: unknown key 'Hyper+Q'");
+    EXPECT_FALSE(InputScript::parse("frames -1\n", &error).has_value());
+    EXPECT_FALSE(InputScript::parse("expect error maybe\n", &error).has_value());
+    EXPECT_FALSE(InputScript::parse("click 10 20\n", &error).has_value());
+    EXPECT_FALSE(InputScript::load(scriptPath("missing.script"), &error).has_value());
+}
+
+TEST_F(UiHarnessTest, FailedExpectationIsReportedTest) {
+    UiHarness harness;
+    auto script = InputScript::parse("frames 2\ntype C:\\Bases\\One\nexpect input C:\\Bases\\Two\nexpect launches 0\n");
+    ASSERT_TRUE(script.has_value());
+    UiHarness::ReplayResult result = harness.replay(*script);
+    ASSERT_EQ(result.failures.size(), 1u);
+    EXPECT_EQ(result.failures[0], "line 3: expected 'C:\\Bases\\Two', got 'C:\\Bases\\One'");
+}
+
+// The same recordings hold at every history size, the list is clipped to what is visible
+TEST_F(UiHarnessTest, RecordedScriptsTest) {
+    for (size_t historySize : {10, 1000, 100000}) {
+        replayFixture("search_launch.script", historySize);
+        replayFixture("history_navigation.script", historySize);
+        replayFixture("focus_key.script", historySize);
+    }
+}
+
+TEST_F(UiHarnessTest, ReplayIsDeterministicTest) {
+    auto script = InputScript::load(scriptPath("history_navigation.script"));
+    ASSERT_TRUE(script.has_value());
+
+    UiHarness first;
+    first.fillHistory(100);
+    UiHarness second;
+    second.fillHistory(100);
+    UiHarness::ReplayResult firstResult = first.replay(*script);
+    UiHarness::ReplayResult secondResult = second.replay(*script);
+
+    EXPECT_EQ(firstResult.frameCpuNs.size(), secondResult.frameCpuNs.size());
+    ASSERT_EQ(first.getLaunches().size(), second.getLaunches().size());
+    for (size_t i = 0; i < first.getLaunches().size(); ++i) {
+        EXPECT_EQ(first.getLaunches()[i].input, second.getLaunches()[i].input);
+    }
+    EXPECT_EQ(first.getHistory().top(1)[0]->input, second.getHistory().top(1)[0]->input);
+    EXPECT_GE(firstResult.totalCpuNs(), firstResult.percentileCpuNs(0.99));
+    EXPECT_GE(firstResult.percentileCpuNs(0.99), firstResult.percentileCpuNs(0.5));
+}
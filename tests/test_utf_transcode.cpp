@@ -0,0 +1,233 @@
+#include <gtest/gtest.h>
+#include "utf_transcode.h"
+#include <random>
+#include <string>
+#include <vector>
+
+class UtfTranscodeTest : public ::testing::Test {
+protected:
+    // Converts with both implementations and checks they agree on everything
+    static TranscodeResult checkUtf8(const std::string& input, size_t capacity) {
+        std::vector<char16_t> fast(capacity + 1, u'?');
+        std::vector<char16_t> reference(capacity + 1, u'?');
+        TranscodeResult fastResult = utf8ToUtf16(input, fast.data(), capacity);
+        TranscodeResult referenceResult = utf8ToUtf16Scalar(input, reference.data(), capacity);
+        EXPECT_EQ(fastResult.status, referenceResult.status);
+        EXPECT_EQ(fastResult.read, referenceResult.read);
+        EXPECT_EQ(fastResult.written, referenceResult.written);
+        EXPECT_EQ(std::u16string(fast.data(), fastResult.written), std::u16string(reference.data(), referenceResult.written));
+        return referenceResult;
+    }
+
+    static TranscodeResult checkUtf16(const std::u16string& input, size_t capacity) {
+        std::vector<char> fast(capacity + 1, '?');
+        std::vector<char> reference(capacity + 1, '?');
+        TranscodeResult fastResult = utf16ToUtf8(input, fast.data(), capacity);
+        TranscodeResult referenceResult = utf16ToUtf8Scalar(input, reference.data(), capacity);
+        EXPECT_EQ(fastResult.status, referenceResult.status);
+        EXPECT_EQ(fastResult.read, referenceResult.read);
+        EXPECT_EQ(fastResult.written, referenceResult.written);
+        EXPECT_EQ(std::string(fast.data(), fastResult.written), std::string(reference.data(), referenceResult.written));
+        return referenceResult;
+    }
+
+    static std::string encodeUtf8(char32_t codePoint) {
+        std::string out;
+        if (codePoint < 0x80) {
+            out += static_cast<char>(codePoint);
+        } else if (codePoint < 0x800) {
+            out += static_cast<char>(0xC0 | (codePoint >> 6));
+            out += static_cast<char>(0x80 | (codePoint & 0x3F));
+        } else if (codePoint < 0x10000) {
+            out += static_cast<char>(0xE0 | (codePoint >> 12));
+            out += static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F));
+            out += static_cast<char>(0x80 | (codePoint & 0x3F));
+        } else {
+            out += static_cast<char>(0xF0 | (codePoint >> 18));
+            out += static_cast<char>(0x80 | ((codePoint >> 12) & 0x3F));
+            out += static_cast<char>(0x80 | ((codePoint >> 6) & 0x3F));
+            out += static_cast<char>(0x80 | (codePoint & 0x3F));
+        }
+        return out;
+    }
+};
+
+TEST_F(UtfTranscodeTest, KnownConversionsTest) {
+    EXPECT_EQ(toUtf16("C:\\Базы\\Торговля"), u"C:\\Базы\\Торговля");
+    EXPECT_EQ(toUtf16("€ 𝄞"), u"€ 𝄞");
+    EXPECT_EQ(toUtf8(u"C:\\Базы\\Торговля"), "C:\\Базы\\Торговля");
+    EXPECT_EQ(toUtf8(u"€ 𝄞"), "€ 𝄞");
+    EXPECT_EQ(toUtf16(""), u"");
+    EXPECT_EQ(toUtf8(u""), "");
+
+    // Long runs take the block paths
+    std::string cyrillic;
+    std::u16string cyrillic16;
+    for (int i = 0; i < 100; ++i) {
+        cyrillic += "Бухгалтерия";
+        cyrillic16 += u"Бухгалтерия";
+    }
+    EXPECT_EQ(toUtf16(cyrillic), cyrillic16);
+    EXPECT_EQ(toUtf8(cyrillic16), cyrillic);
+}
+
+TEST_F(UtfTranscodeTest, InvalidUtf8Test) {
+    const std::vector<std::string> invalid = {
+        "\x80",                 // Lone continuation byte
+        "\xC0\x80",             // Overlong NUL
+        "\xC1\xBF",             // Overlong ASCII
+        "\xE0\x80\x80",         // Overlong three-byte form
+        "\xED\xA0\x80",         // Encoded surrogate U+D800
+        "\xF0\x80\x80\x80",     // Overlong four-byte form
+        "\xF4\x90\x80\x80",     // Above U+10FFFF
+        "\xF5\x80\x80\x80",     // Invalid lead byte
+        "\xD0",                 // Truncated at the end
+        "\xE2\x82",
+        "\xD0\x41",             // Missing continuation
+    };
+    for (const auto& sequence : invalid) {
+        std::string input = "abc" + sequence;
+        TranscodeResult result = checkUtf8(input, utf16Capacity(input.size()));
+        EXPECT_EQ(result.status, TranscodeStatus::InvalidInput) << "sequence of " << sequence.size() << " bytes";
+        EXPECT_EQ(result.read, 3u);
+        EXPECT_EQ(result.written, 3u);
+    }
+
+    // Invalid bytes are replaced one by one
+    EXPECT_EQ(toUtf16("a\xC0\x80z"), u"a\uFFFD\uFFFDz");
+}
+
+TEST_F(UtfTranscodeTest, InvalidUtf16Test) {
+    const std::vector<std::u16string> invalid = {
+        std::u16string(1, char16_t(0xD800)),                        // Unpaired high surrogate at the end
+        std::u16string{char16_t(0xD800), u'a'},                     // High surrogate without low
+        std::u16string(1, char16_t(0xDC00)),                        // Lone low surrogate
+        std::u16string{char16_t(0xDC00), char16_t(0xD800)},         // Reversed pair
+    };
+    for (const auto& sequence : invalid) {
+        std::u16string input = u"Щит" + sequence;
+        TranscodeResult result = checkUtf16(input, utf8Capacity(input.size()));
+        EXPECT_EQ(result.status, TranscodeStatus::InvalidInput);
+        EXPECT_EQ(result.read, 3u);
+        EXPECT_EQ(result.written, 6u);
+    }
+
+    EXPECT_EQ(toUtf8(std::u16string{u'a', char16_t(0xDC00), u'z'}), "a\xEF\xBF\xBDz");
+}
+
+TEST_F(UtfTranscodeTest, BufferTooSmallTest) {
+    std::string input = "Торговля и склад, версия 3.0";
+    std::u16string expected = toUtf16(input);
+    for (size_t capacity = 0; capacity < expected.size(); ++capacity) {
+        TranscodeResult result = checkUtf8(input, capacity);
+        EXPECT_EQ(result.status, TranscodeStatus::BufferTooSmall);
+        EXPECT_LE(result.written, capacity);
+    }
+    EXPECT_TRUE(checkUtf8(input, expected.size()).ok());
+
+    // A surrogate pair is not split
+    TranscodeResult pair = checkUtf8("𝄞", 1);
+    EXPECT_EQ(pair.status, TranscodeStatus::BufferTooSmall);
+    EXPECT_EQ(pair.written, 0u);
+
+    for (size_t capacity = 0; capacity < input.size(); ++capacity) {
+        EXPECT_EQ(checkUtf16(expected, capacity).status, TranscodeStatus::BufferTooSmall);
+    }
+    EXPECT_TRUE(checkUtf16(expected, input.size()).ok());
+}
+
+TEST_F(UtfTranscodeTest, RandomValidInputTest) {
+    std::mt19937 random(20251018);
+    // Weighted towards the runs that take the block paths
+    std::uniform_int_distribution<int> kind(0, 9);
+    for (int iteration = 0; iteration < 2000; ++iteration) {
+        std::u32string codePoints;
+        int length = std::uniform_int_distribution<int>(0, 80)(random);
+        for (int i = 0; i < length; ++i) {
+            int k = kind(random);
+            if (k < 4) {
+                codePoints += static_cast<char32_t>(std::uniform_int_distribution<int>(0x20, 0x7E)(random));
+            } else if (k < 8) {
+                codePoints += static_cast<char32_t>(std::uniform_int_distribution<int>(0x410, 0x44F)(random));
+            } else if (k < 9) {
+                char32_t c = static_cast<char32_t>(std::uniform_int_distribution<int>(0x800, 0xFFFD)(random));
+                codePoints += (c >= 0xD800 && c <= 0xDFFF) ? char32_t(0x20AC) : c;
+            } else {
+                codePoints += static_cast<char32_t>(std::uniform_int_distribution<int>(0x10000, 0x10FFFF)(random));
+            }
+        }
+
+        std::string utf8;
+        for (char32_t c : codePoints) {
+            utf8 += encodeUtf8(c);
+        }
+        TranscodeResult result = checkUtf8(utf8, utf16Capacity(utf8.size()));
+        ASSERT_TRUE(result.ok());
+
+        std::u16string utf16 = toUtf16(utf8);
+        ASSERT_TRUE(checkUtf16(utf16, utf8Capacity(utf16.size())).ok());
+        ASSERT_EQ(toUtf8(utf16), utf8);
+    }
+}
+
+TEST_F(UtfTranscodeTest, AdversarialInputTest) {
+    std::mt19937 random(1541);
+
+    // A Cyrillic run with one byte corrupted at every position, so errors
+    // land at each offset of a block and in the scalar tail
+    std::string run;
+    for (int i = 0; i < 24; ++i) {
+        run += "Ж";
+    }
+    const unsigned char corruptions[] = {0x00, 0x41, 0x80, 0xBF, 0xC0, 0xC1, 0xC2, 0xE0, 0xED, 0xF4, 0xFF};
+    for (size_t position = 0; position < run.size(); ++position) {
+        for (unsigned char corruption : corruptions) {
+            std::string input = run;
+            input[position] = static_cast<char>(corruption);
+            checkUtf8(input, utf16Capacity(input.size()));
+        }
+    }
+
+    // Random bytes, mostly from the ranges that almost form valid sequences
+    const unsigned char alphabet[] = {0x20, 0x7F, 0x80, 0x8F, 0x90, 0x9F, 0xA0, 0xBF, 0xC0, 0xC2, 0xD0, 0xD1, 0xDF, 0xE0, 0xED, 0xEF, 0xF0, 0xF4, 0xF5};
+    std::uniform_int_distribution<size_t> pick(0, sizeof(alphabet) - 1);
+    for (int iteration = 0; iteration < 5000; ++iteration) {
+        std::string input(std::uniform_int_distribution<size_t>(0, 64)(random), '\0');
+        for (char& c : input) {
+            c = static_cast<char>(alphabet[pick(random)]);
+        }
+        checkUtf8(input, utf16Capacity(input.size()));
+        checkUtf8(input, input.size() / 2);
+    }
+
+    // Random UTF-16 units around the surrogate and two-byte boundaries
+    const char16_t units[] = {0x0041, 0x007F, 0x0080, 0x0416, 0x07FF, 0x0800, 0xD7FF, 0xD800, 0xDBFF, 0xDC00, 0xDFFF, 0xE000, 0xFFFF};
+    std::uniform_int_distribution<size_t> pickUnit(0, sizeof(units) / sizeof(units[0]) - 1);
+    for (int iteration = 0; iteration < 5000; ++iteration) {
+        std::u16string input(std::uniform_int_distribution<size_t>(0, 40)(random), u'\0');
+        for (char16_t& c : input) {
+            c = units[pickUnit(random)];
+        }
+        checkUtf16(input, utf8Capacity(input.size()));
+        checkUtf16(input, input.size());
+    }
+}
+
+TEST_F(UtfTranscodeTest, Utf16BufferTest) {
+    Utf16Buffer<16> small("C:\\Базы");
+    EXPECT_EQ(std::u16string(small.data()), u"C:\\Базы");
+    EXPECT_EQ(small.size(), 7u);
+
+    // Longer than the stack storage
+    std::string longPath = "\\\\server\\share";
+    for (int i = 0; i < 40; ++i) {
+        longPath += "\\Каталог";
+    }
+    Utf16Buffer<16> large(longPath);
+    EXPECT_EQ(std::u16string(large.data(), large.size()), toUtf16(longPath));
+    EXPECT_EQ(large.data()[large.size()], u'\0');
+
+    Utf16Buffer<> empty("");
+    EXPECT_TRUE(empty.empty());
+    EXPECT_EQ(empty.data()[0], u'\0');
+}
@@ -1,7 +1,9 @@
 #include <gtest/gtest.h>
 #include "utils.h"
+#include <algorithm>
 #include <filesystem>
 #include <fstream>
+#include <random>
 #include <string>
 
 class UtilsTest : public ::testing::Test {
@@ -36,6 +38,85 @@ TEST_F(UtilsTest, ReplaceSubstringTest) {
     EXPECT_EQ(testStr, "Hello world! This is a sample string with sample word.");
 }
 
+TEST_F(UtilsTest, ReplaceSubstringEdgeCasesTest) {
+    std::string testStr = "aaaa";
+    replaceSubstring(testStr, "aa", "a");
+    EXPECT_EQ(testStr, "aa");
+
+    // Replaced text is not matched again
+    testStr = "ab";
+    replaceSubstring(testStr, "a", "aa");
+    EXPECT_EQ(testStr, "aab");
+
+    testStr = "unchanged";
+    replaceSubstring(testStr, "", "x");
+    EXPECT_EQ(testStr, "unchanged");
+    replaceSubstring(testStr, "unchanged", "");
+    EXPECT_EQ(testStr, "");
+}
+
+TEST_F(UtilsTest, SubstringReplacerTest) {
+    SubstringReplacer replacer({{"he", "1"}, {"she", "2"}, {"his", "3"}, {"hers", "4"}, {"Торговля", "Trade"}});
+    EXPECT_EQ(replacer.replace("ushers"), "u2rs");
+    EXPECT_EQ(replacer.replace("his hers she"), "3 4 2");
+    EXPECT_EQ(replacer.replace("C:\\Базы\\Торговля"), "C:\\Базы\\Trade");
+    EXPECT_EQ(replacer.replace(""), "");
+
+    // A shorter match after a longer one that ended before it
+    SubstringReplacer overlapping({{"xa", "1"}, {"abc", "2"}, {"bc", "3"}});
+    EXPECT_EQ(overlapping.replace("xabc"), "13");
+
+    EXPECT_THROW(SubstringReplacer({{"a", "b"}, {"", "c"}}), std::invalid_argument);
+}
+
+TEST_F(UtilsTest, SubstringReplacerMatchesNaiveScanTest) {
+    // Leftmost, then longest pattern, scanning on after each replacement
+    auto naive = [](const std::string& text, const std::vector<std::pair<std::string, std::string>>& replacements) {
+        std::string result;
+        size_t i = 0;
+        while (i < text.size()) {
+            const std::pair<std::string, std::string>* best = nullptr;
+            for (const auto& replacement : replacements) {
+                if (text.compare(i, replacement.first.size(), replacement.first) == 0
+                    && (!best || replacement.first.size() > best->first.size())) {
+                    best = &replacement;
+                }
+            }
+            if (best) {
+                result += best->second;
+                i += best->first.size();
+            } else {
+                result += text[i++];
+            }
+        }
+        return result;
+    };
+
+    std::mt19937 random(38);
+    std::uniform_int_distribution<int> letter(0, 2);
+    auto randomString = [&](size_t minLength, size_t maxLength) {
+        std::string s(std::uniform_int_distribution<size_t>(minLength, maxLength)(random), 'a');
+        for (char& c : s) {
+            c = static_cast<char>('a' + letter(random));
+        }
+        return s;
+    };
+    for (int iteration = 0; iteration < 2000; ++iteration) {
+        std::vector<std::pair<std::string, std::string>> replacements;
+        int count = std::uniform_int_distribution<int>(1, 5)(random);
+        for (int i = 0; i < count; ++i) {
+            std::string from = randomString(1, 4);
+            bool repeated = std::any_of(replacements.begin(), replacements.end(), [&from](const auto& r) { return r.first == from; });
+            if (!repeated) {
+                replacements.emplace_back(from, randomString(0, 3));
+            }
+        }
+        std::string text = randomString(0, 60);
+        ASSERT_EQ(SubstringReplacer(replacements).replace(text), naive(text, replacements)) << text;
+    }
+}
+
+#ifdef _WIN32
 TEST_F(UtilsTest, StringToWStringTest) {
     std::string testStr = "Hello world!";
     std::wstring wstr = stringToWString(testStr);
@@ -48,6 +129,7 @@ TEST_F(UtilsTest, StringToWStringTest) {
     
     EXPECT_EQ(result, testStr);
 }
+#endif
 
 TEST_F(UtilsTest, CreateFileIfNotExistsTest) {
     std::string newFilePath = "new_test_file.txt";
@@ -77,5 +159,5 @@ TEST_F(UtilsTest, CreateFileIfNotExistsExistingFileTest) {
     EXPECT_EQ(std::filesystem::file_size(testFilePath), originalSize);
 }
 
-// Skip testing launchProcess as it's more complex and requires mocks for process creation
+// Process spawning is covered in test_process_spawner.cpp
 // Skip testing getEnvironmentVariable as it depends on the system environment
\ No newline at end of file